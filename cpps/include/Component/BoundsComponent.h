@@ -0,0 +1,51 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <optional>
+
+#include "./math_util.h"
+
+// Bounding sphere of a paintable, in the paintable's space
+class BoundsComponent {
+ public:
+  BoundsComponent() {
+    sphere = std::nullopt;
+    is_under_brush = true;
+  }
+
+  void merge(const BoundingSphere& other_sphere) {
+    sphere = sphere.has_value()
+                 ? mergeBoundingSpheres(sphere.value(), other_sphere)
+                 : other_sphere;
+  }
+
+  // Empty while the paintable has no parts
+  std::optional<BoundingSphere> sphere;
+  // Whether the sphere intersects the brush cone, updated by
+  // cull_system::cullByBrush, then narrowed down to the triangles by
+  // pick_system::pickByBrush
+  bool is_under_brush;
+};
@@ -32,9 +32,17 @@ class BrushComponent {
     nozzle_fov = glm::radians(45.0f);
     air_pressure = 1.5f;
     paint_color = glm::vec3(1.0f, 0.5f, 0.0f);
+    position = glm::vec3(0.0f);
+    direction = glm::vec3(0.0f, 0.0f, -1.0f);
+    up = glm::vec3(0.0f, 1.0f, 0.0f);
   }
 
   float nozzle_fov;
   float air_pressure;
   glm::vec3 paint_color;
+
+  // Nozzle placement in world space, see transform_system::transformBrush
+  glm::vec3 position;
+  glm::vec3 direction;
+  glm::vec3 up;
 };
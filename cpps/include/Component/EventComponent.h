@@ -26,11 +26,21 @@
 
 #include <glm/glm.hpp>
 #include <optional>
+#include <string>
+#include <vector>
 
 enum class ModelOptions {
   CUBE = 0,
   PLANE = 1,
   SPHERE = 2,
+  STRESS = 3,
+  CAR = 4,
+};
+
+// Mesh file picked on the page, see mesh_import
+struct ImportMeshEvent {
+  std::string file_name;
+  std::vector<char> bytes;
 };
 
 class EventComponent {
@@ -40,10 +50,14 @@ class EventComponent {
     update_model = std::nullopt;
     reset_paint = std::nullopt;
     reset_position = std::nullopt;
+    run_stress_test = std::nullopt;
+    import_mesh = std::nullopt;
   }
 
   std::optional<glm::ivec2> update_canvas_size;
   std::optional<ModelOptions> update_model;
   std::optional<std::monostate> reset_paint;
   std::optional<std::monostate> reset_position;
+  std::optional<std::monostate> run_stress_test;
+  std::optional<ImportMeshEvent> import_mesh;
 };
@@ -24,17 +24,40 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <span>
 #include <vector>
 
+#include "./math_util.h"
+
+// Layout of the vertex buffer, which is uploaded as stored: 20 bytes instead
+// of the 32 of float normals and texture coordinates
 struct Vertex {
   glm::vec3 position;
-  glm::vec3 normal;
-  glm::vec2 tex_coords;
+  // Octahedral encoding of the unit normal, see packNormal
+  glm::i16vec2 normal;
+  // Normalized to 16 bits, so they are clamped to [0, 1]
+  glm::u16vec2 tex_coords;
 };
 
+// Projects the normal onto an octahedron, whose lower half is unfolded over
+// the square, so that 16 bits per component spread evenly over directions
+glm::i16vec2 packNormal(const glm::vec3& normal);
+glm::vec3 unpackNormal(const glm::i16vec2& packed_normal);
+glm::u16vec2 packTexCoords(const glm::vec2& tex_coords);
+glm::vec2 unpackTexCoords(const glm::u16vec2& packed_tex_coords);
+
+// Bytes per index in the index buffer, which is 16 bits when they can address
+// every vertex without using 0xFFFF, which WebGL2 always takes for the
+// primitive restart index
+size_t getIndexSize(size_t vertex_count);
+
 enum class GeometryPreset { PLANE, QUAD, SPHERE };
 
+glm::ivec2 getDefaultGeometrySegments(GeometryPreset preset);
+
 class GeometryComponent {
  public:
   GeometryComponent() {
@@ -43,7 +66,38 @@ class GeometryComponent {
   }
 
   GeometryComponent(GeometryPreset preset);
+  GeometryComponent(GeometryPreset preset, int width_segments,
+                    int height_segments);
 
   std::vector<Vertex> vertices;
   std::vector<unsigned int> indices;
 };
+
+// Read-only vertices and indices in GPU layout, of a GeometryComponent or of
+// an asset pack
+struct GeometryView {
+  GeometryView() = default;
+  GeometryView(const GeometryComponent& geometry_component)
+      : vertices(geometry_component.vertices),
+        indices(geometry_component.indices.data()),
+        index_count(geometry_component.indices.size()),
+        index_size(sizeof(unsigned int)) {}
+
+  std::span<const Vertex> vertices;
+  const void* indices = nullptr;
+  size_t index_count = 0;
+  // 2 or 4 bytes, see getIndexSize
+  size_t index_size = sizeof(unsigned int);
+
+  uint32_t getIndex(size_t i) const {
+    return index_size == sizeof(uint16_t)
+               ? static_cast<const uint16_t*>(indices)[i]
+               : static_cast<const uint32_t*>(indices)[i];
+  }
+
+  size_t getIndexBytes() const { return index_count * index_size; }
+};
+
+// Centered on the bounding box, which is tight enough for the presets and
+// imported meshes
+BoundingSphere getBoundingSphere(const GeometryView& geometry_view);
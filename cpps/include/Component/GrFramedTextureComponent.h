@@ -28,10 +28,18 @@
 
 class GrFramedTextureComponent : public GrTextureComponent {
  public:
+  // The framebuffer renders to the first level
   GrFramedTextureComponent(TextureType texture_type, const std::string& name,
-                           int width, int height);
+                           int width, int height, int level_count = 1);
+
+  GrFramedTextureComponent(GrFramedTextureComponent&& other) noexcept;
+  GrFramedTextureComponent& operator=(
+      GrFramedTextureComponent&& other) noexcept;
 
   ~GrFramedTextureComponent();
 
+  // Clears every level
+  void clear();
+
   unsigned int framebuffer_id;
 };
\ No newline at end of file
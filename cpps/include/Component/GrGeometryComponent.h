@@ -24,16 +24,29 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
+// GL objects are allocated on the first upload, when the buffer sizes are
+// known, so that buffers of the same size can be recycled from the pool
 class GrGeometryComponent {
  public:
   GrGeometryComponent();
 
   ~GrGeometryComponent();
 
+  // Returns true if the buffers were recycled and already have the requested
+  // sizes, so they can be updated in place
+  bool allocate(size_t vertex_buffer_size, size_t index_buffer_size);
+
   unsigned int vao_id;
   unsigned int vbo_id;
   unsigned int ebo_id;
   int vertex_count;
+  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+  unsigned int index_type;
+  size_t vertex_buffer_size;
+  size_t index_buffer_size;
+  // Duration of the last upload, reported by geometry_cache
+  double upload_ms;
 };
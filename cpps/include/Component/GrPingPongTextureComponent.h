@@ -24,21 +24,46 @@
 
 #pragma once
 
+#include <array>
 #include <string>
 
 #include "./Component/GrFramedTextureComponent.h"
+#include "./UvRects.h"
 
 class GrPingPongTextureComponent {
  public:
   GrPingPongTextureComponent(TextureType texture_type, const std::string& name,
-                             int width, int height) {
+                             int width, int height, int level_count = 1) {
     ping_framed_texture_component = std::make_unique<GrFramedTextureComponent>(
-        texture_type, name, width, height);
+        texture_type, name, width, height, level_count);
     pong_framed_texture_component = std::make_unique<GrFramedTextureComponent>(
-        texture_type, name, width, height);
+        texture_type, name, width, height, level_count);
   }
 
   void switchTexture() { is_ping = !is_ping; }
+
+  // Marks texture coordinates written to, whose mips become outdated in both
+  // textures: the previous texture is written to again, from the current one,
+  // when the textures are switched.
+  void markDirty(const UvRects& uv_rects) {
+    for (auto& texture_dirty_uv_rects : dirty_uv_rects) {
+      texture_dirty_uv_rects.merge(uv_rects);
+    }
+  }
+  void markDirty(const UvRect& uv_rect) {
+    for (auto& texture_dirty_uv_rects : dirty_uv_rects) {
+      texture_dirty_uv_rects.add(uv_rect);
+    }
+  }
+  // Where the mips of the current texture are outdated. Clear them once they
+  // are updated.
+  UvRects& getCurrentDirtyUvRects() { return dirty_uv_rects[is_ping ? 0 : 1]; }
+  void clearDirty() {
+    for (auto& texture_dirty_uv_rects : dirty_uv_rects) {
+      texture_dirty_uv_rects.clear();
+    }
+  }
+
   std::reference_wrapper<GrFramedTextureComponent> getCurrentFramedTexture() {
     return is_ping ? std::ref(*ping_framed_texture_component)
                    : std::ref(*pong_framed_texture_component);
@@ -53,4 +78,5 @@ class GrPingPongTextureComponent {
 
  private:
   bool is_ping = true;
+  std::array<UvRects, 2> dirty_uv_rects;
 };
@@ -24,14 +24,61 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
 #include <string>
 
 enum class TextureType { R8, RGBA, RGBA16, DEPTH };
 
+inline int getTextureBytesPerPixel(TextureType texture_type) {
+  switch (texture_type) {
+    case TextureType::R8:
+      return 1;
+    case TextureType::RGBA:
+      return 4;
+    case TextureType::RGBA16:
+      return 8;
+    case TextureType::DEPTH:
+      return 2;
+    default:
+      throw std::invalid_argument("Invalid texture type");
+  }
+}
+
+// Levels of a full mip chain, down to 1x1
+inline int getMipLevelCount(int width, int height) {
+  int level_count = 1;
+  while ((std::max(width, height) >> level_count) > 0) {
+    level_count++;
+  }
+  return level_count;
+}
+
+inline size_t getTextureBytes(TextureType texture_type, int width, int height,
+                              int level_count) {
+  size_t bytes = 0;
+  for (int level = 0; level < level_count; level++) {
+    bytes += static_cast<size_t>(std::max(width >> level, 1)) *
+             std::max(height >> level, 1) *
+             getTextureBytesPerPixel(texture_type);
+  }
+  return bytes;
+}
+
 class GrTextureComponent {
  public:
+  // Textures with more than one level are sampled trilinearly, their mips
+  // being up to the owner to fill, e.g. paint_system::updatePaintedMipmaps
   GrTextureComponent(TextureType texture_type, const std::string& name,
-                     int width, int height);
+                     int width, int height, int level_count = 1);
+
+  // Move-only, so that it can be stored in an EntityRegistry. A moved-from
+  // component owns no texture.
+  GrTextureComponent(GrTextureComponent&& other) noexcept;
+  GrTextureComponent& operator=(GrTextureComponent&& other) noexcept;
+  GrTextureComponent(const GrTextureComponent&) = delete;
+  GrTextureComponent& operator=(const GrTextureComponent&) = delete;
 
   ~GrTextureComponent();
 
@@ -39,5 +86,6 @@ class GrTextureComponent {
   std::string name;
   int width;
   int height;
+  int level_count;
   TextureType texture_type;
 };
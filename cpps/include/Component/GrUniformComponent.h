@@ -30,6 +30,13 @@ class GrUniformComponent {
  public:
   GrUniformComponent(std::string uniform_block_name);
 
+  // Move-only, so that it can be stored in an EntityRegistry. A moved-from
+  // component owns no buffer.
+  GrUniformComponent(GrUniformComponent&& other) noexcept;
+  GrUniformComponent& operator=(GrUniformComponent&& other) noexcept;
+  GrUniformComponent(const GrUniformComponent&) = delete;
+  GrUniformComponent& operator=(const GrUniformComponent&) = delete;
+
   ~GrUniformComponent();
 
   std::string uniform_block_name;
@@ -25,7 +25,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include <map>
+#include <unordered_map>
 
 enum class InputKey {
   UP = 0,
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+enum class LightType { DIRECTIONAL, POINT };
+
+struct Light {
+  LightType type;
+  glm::vec3 color;
+  float intensity;
+  // Direction the light travels in, for directional lights
+  glm::vec3 direction = glm::vec3(0.0f);
+  // For point lights
+  glm::vec3 position = glm::vec3(0.0f);
+  float quadratic_attenuation = 0.0f;
+};
+
+// Lights and material of the phong shaders, uploaded into LightingBlock by
+// gr_sync_system::updateLightingUniform. Set `needs_update` after changing
+// them.
+class LightingComponent {
+ public:
+  LightingComponent() { reset(); }
+
+  // A warm room with a ceiling light, a lamp and a window
+  void reset() {
+    ambient_color = glm::vec3(0.8f, 0.8f, 0.75f);
+    ambient_intensity = 0.4f;
+
+    lights = {
+        {.type = LightType::DIRECTIONAL,
+         .color = glm::vec3(1.0f, 1.0f, 0.95f),
+         .intensity = 0.9f,
+         .direction = glm::vec3(0.0f, -1.0f, 0.0f)},
+        {.type = LightType::POINT,
+         .color = glm::vec3(1.0f, 0.85f, 0.7f),
+         .intensity = 0.6f,
+         .position = glm::vec3(2.0f, 3.0f, 2.0f),
+         .quadratic_attenuation = 0.2f},
+        {.type = LightType::POINT,
+         .color = glm::vec3(0.8f, 0.85f, 1.0f),
+         .intensity = 0.4f,
+         .position = glm::vec3(0.0f, 3.0f, -3.0f),
+         .quadratic_attenuation = 0.2f},
+    };
+
+    material_color = glm::vec3(1.0f);
+    material_diffuse = 0.5f;
+    material_specular = 0.5f;
+    material_shininess = 64.0f;
+
+    needs_update = true;
+  }
+
+  glm::vec3 ambient_color;
+  float ambient_intensity;
+  // Only the first MAX_LIGHTS are uploaded
+  std::vector<Light> lights;
+
+  // Unpainted color, which the painted map is blended over
+  glm::vec3 material_color;
+  float material_diffuse;
+  float material_specular;
+  float material_shininess;
+
+  bool needs_update;
+};
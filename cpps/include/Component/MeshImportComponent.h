@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "./constants.h"
+#include "./geometry_cache.h"
+#include "./mesh_import.h"
+#include "./uv_atlas.h"
+
+enum class MeshImportStage {
+  IDLE,
+  PARSE,
+  // One part per step, like BUILD_GEOMETRY
+  PACK_UVS,
+  BUILD_GEOMETRY,
+  // Back on the main thread, hands the model to the model switch
+  SWITCH,
+};
+
+// Progress of a mesh file import, see manage_system::stepMeshImport. Each
+// step runs on a worker, so that the current model keeps rendering meanwhile,
+// or within the frame budget on the main thread in builds without workers.
+// The members a step writes are only read once it is done, except `stage`,
+// which is checked every frame to skip systems while importing.
+class MeshImportComponent {
+ public:
+  MeshImportComponent() {
+    frame_budget_ms = MODEL_SWITCH_FRAME_BUDGET_MS;
+    is_step_running = false;
+    reset();
+  }
+
+  // Only while no step is running
+  void reset() {
+    stage = MeshImportStage::IDLE;
+    is_canceled = false;
+    error.clear();
+    file_name.clear();
+    bytes = std::vector<char>();
+    parts.clear();
+    uv_reports.clear();
+    geometries.clear();
+    next_part_index = 0;
+    texel_density = 0.0f;
+    triangle_count = 0;
+    miss_count_before = 0.0;
+    parse_ms = 0.0;
+    atlas_ms = 0.0;
+    bvh_ms = 0.0;
+    frame_count = 0;
+  }
+
+  // Drops the import, at once or when its running step is done
+  void cancel() {
+    if (is_step_running) {
+      is_canceled = true;
+    } else {
+      reset();
+    }
+  }
+
+  double frame_budget_ms;
+
+  // Written by the running step
+  std::atomic<MeshImportStage> stage;
+  // Set while a step runs on a worker
+  std::atomic<bool> is_step_running;
+  // Set when another model was picked meanwhile, dropping the import once its
+  // running step is done. Only touched on the main thread.
+  bool is_canceled;
+  // What the failed step threw
+  std::string error;
+
+  std::string file_name;
+  std::vector<char> bytes;
+  std::vector<mesh_import::ImportedPart> parts;
+  std::vector<uv_atlas::PartUvReport> uv_reports;
+  // Built from the geometries of `parts`, in the same order
+  std::vector<geometry_cache::BuiltGeometry> geometries;
+  // Within `parts`, for PACK_UVS and BUILD_GEOMETRY
+  size_t next_part_index;
+  // Of every part once the mesh is scaled, see uv_atlas::getImportTexelDensity
+  float texel_density;
+
+  size_t triangle_count;
+  // Vertex shader runs over every part before optimizing, per triangle
+  double miss_count_before;
+  double parse_ms;
+  double atlas_ms;
+  double bvh_ms;
+  int frame_count;
+};
@@ -24,33 +24,37 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
-#include "./Component/GrUniformComponent.h"
-#include "./Component/TransformComponent.h"
 #include "./Entity/PaintableEntity.h"
+#include "./constants.h"
 
-struct TransformUpdatingChild {
-  std::reference_wrapper<TransformComponent> transform_component;
-  std::reference_wrapper<GrUniformComponent> gr_uniform_component;
-};
-
-class TransformUpdatingView {
+// Progress of a model switch that builds the paintables of the next scene one
+// part at a time, so that no single frame pays for the whole model
+class ModelSwitchComponent {
  public:
-  TransformUpdatingView(
-      std::reference_wrapper<PaintableEntity> paintable_entity)
-      : parent_transform_component(
-            std::ref(*paintable_entity.get().transform_component)) {
-    for (const auto& paintable_part :
-         paintable_entity.get().paintable_part_entities) {
-      children_transforms.push_back(
-          {.transform_component =
-               std::ref(*paintable_part->transform_component),
-           .gr_uniform_component =
-               std::ref(*paintable_part->gr_transform_uniform_component)});
-    }
+  ModelSwitchComponent() {
+    frame_budget_ms = MODEL_SWITCH_FRAME_BUDGET_MS;
+    reset();
   }
 
-  std::reference_wrapper<TransformComponent> parent_transform_component;
-  std::vector<TransformUpdatingChild> children_transforms;
+  void reset() {
+    descriptors.clear();
+    next_paintable_index = 0;
+    next_part_index = 0;
+    frame_count = 0;
+    work_ms = 0.0;
+    max_slice_ms = 0.0;
+  }
+
+  double frame_budget_ms;
+
+  std::vector<PaintableDescriptor> descriptors;
+  size_t next_paintable_index;
+  // Within the parts of the paintable at next_paintable_index
+  size_t next_part_index;
+  int frame_count;
+  double work_ms;
+  double max_slice_ms;
 };
@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <optional>
+
+#include "./EntityRegistry.h"
+
+struct PickHit {
+  // Index in RootManager::paintable_entities
+  size_t paintable_index;
+  EntityHandle part_handle;
+  // World space distance from the brush nozzle
+  float distance;
+  // Weights of the triangle's three vertices
+  glm::vec3 barycentrics;
+  glm::vec2 uv;
+};
+
+// Result of pick_system::pickByBrush for the current frame
+class PickComponent {
+ public:
+  PickComponent() { reset(); }
+
+  void reset() {
+    pointer_hit = std::nullopt;
+    is_cone_hit = false;
+  }
+
+  // Nearest part on the ray through the pointer
+  std::optional<PickHit> pointer_hit;
+  // Whether any part may be inside the brush cone, i.e. whether painting
+  // could change anything
+  bool is_cone_hit;
+};
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+struct ProfileSample {
+  const char* name;
+  double total_ms;
+  double max_ms;
+  int count;
+};
+
+class ProfileComponent {
+ public:
+  ProfileComponent() {
+    is_enabled = false;
+    sync_gpu = false;
+    // Room for every system, so that the first profiled frame does not
+    // allocate either
+    samples.reserve(64);
+  }
+
+  // `name` must be a string literal; samples are matched by pointer so that
+  // recording never allocates once every system has been seen
+  void record(const char* name, double elapsed_ms) {
+    for (auto& sample : samples) {
+      if (sample.name == name) {
+        sample.total_ms += elapsed_ms;
+        sample.max_ms = std::max(sample.max_ms, elapsed_ms);
+        sample.count++;
+        return;
+      }
+    }
+
+    samples.push_back({name, elapsed_ms, elapsed_ms, 1});
+  }
+
+  void reset() { samples.clear(); }
+
+  bool is_enabled;
+  // Waits for the GPU after every profiled system, so that the measured time
+  // includes the GL work it issued and not only the command submission
+  bool sync_gpu;
+  std::vector<ProfileSample> samples;
+};
@@ -31,8 +31,11 @@ class RenderConfigComponent {
   RenderConfigComponent(const glm::vec4& clear_color)
       : clear_color(clear_color) {
     canvas_size = glm::ivec2(0, 0);
+    is_instancing_enabled = true;
   }
 
   glm::vec4 clear_color;
   glm::ivec2 canvas_size;
+  // Draws parts sharing a geometry with one instanced call per batch
+  bool is_instancing_enabled;
 };
@@ -24,28 +24,25 @@
 
 #pragma once
 
-#include "./Component/GrGeometryComponent.h"
-#include "./Component/GrUniformComponent.h"
-#include "./Entity/PaintableEntity.h"
+#include <memory>
 
-struct GrModelGeometry {
-  std::reference_wrapper<GrGeometryComponent> gr_geometry_component;
-  std::reference_wrapper<GrUniformComponent> gr_uniform_component;
-};
+#include "./Component/GeometryComponent.h"
+#include "./Component/GrGeometryComponent.h"
+#include "./MeshletSet.h"
+#include "./TriangleBvh.h"
 
-class GrModelGeometriesView {
+// Geometry shared with every other entity using the same mesh, see
+// geometry_cache. Every member is immutable once uploaded.
+class SharedGeometryComponent {
  public:
-  GrModelGeometriesView(
-      std::reference_wrapper<PaintableEntity> paintable_entity) {
-    for (const auto& paintable_part :
-         paintable_entity.get().paintable_part_entities) {
-      gr_model_geometries.push_back(
-          {.gr_geometry_component =
-               std::ref(*paintable_part->gr_geometry_component),
-           .gr_uniform_component =
-               std::ref(*paintable_part->gr_transform_uniform_component)});
-    }
-  }
-
-  std::vector<GrModelGeometry> gr_model_geometries;
+  // Null for geometry loaded from an asset pack, which `storage` keeps alive
+  std::shared_ptr<GeometryComponent> geometry_component;
+  std::shared_ptr<const void> storage;
+  // Vertices and indices of either, for uploading and picking
+  GeometryView view;
+  std::shared_ptr<GrGeometryComponent> gr_geometry_component;
+  // Built along with the geometry, for picking on the CPU
+  std::shared_ptr<TriangleBvh> bvh;
+  // For drawing only what is under the brush
+  std::shared_ptr<MeshletSet> meshlets;
 };
@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "./Entity/PaintableEntity.h"
+
+struct StressTestCase {
+  int part_count;
+  int painted_map_size;
+  // Zooming out samples the painted maps from smaller mips
+  float camera_radius = 3.0f;
+};
+
+struct StressTestResult {
+  StressTestCase test_case;
+  double frame_ms;
+  size_t gr_live_bytes;
+  size_t gr_peak_bytes;
+  // Heap allocations during the measured frames, which should be none
+  size_t allocation_count;
+  std::string system_report;
+};
+
+class StressTestComponent {
+ public:
+  StressTestComponent() {
+    for (int part_count : {1, 4, 16, 64}) {
+      for (int painted_map_size : {256, 512, 1024}) {
+        cases.push_back({part_count, painted_map_size});
+      }
+    }
+    for (float camera_radius : {1.5f, 6.0f, 12.0f}) {
+      cases.push_back({16, 1024, camera_radius});
+    }
+
+    geometry_segments = 16;
+    layout = StressLayout::GRID;
+    warmup_frames = 10;
+    measured_frames = 120;
+    max_case_bytes = 512 * 1024 * 1024;
+
+    is_running = false;
+    current_case_index = 0;
+    current_frame = 0;
+    case_start_ms = 0.0;
+    case_start_allocation_count = 0;
+  }
+
+  std::vector<StressTestCase> cases;
+  int geometry_segments;
+  StressLayout layout;
+  int warmup_frames;
+  int measured_frames;
+  // Cases needing more GPU memory than this are skipped, since the browser
+  // would lose the WebGL context long before we get a number
+  size_t max_case_bytes;
+
+  bool is_running;
+  size_t current_case_index;
+  int current_frame;
+  double case_start_ms;
+  size_t case_start_allocation_count;
+  std::vector<StressTestResult> results;
+};
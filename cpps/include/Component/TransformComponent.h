@@ -27,24 +27,35 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include "./TransformHierarchy.h"
+
 class TransformComponent {
  public:
   TransformComponent() {
     scale = glm::vec3(1.0f, 1.0f, 1.0f);
     rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
     translation = glm::vec3(0.0f, 0.0f, 0.0f);
+    initial_scale = scale;
+    initial_rotation = rotation;
+    initial_translation = translation;
     needs_update = true;
   }
 
   TransformComponent(glm::vec3 scale, glm::quat rotation, glm::vec3 translation)
-      : scale(scale), rotation(rotation), translation(translation) {
+      : scale(scale),
+        rotation(rotation),
+        translation(translation),
+        initial_scale(scale),
+        initial_rotation(rotation),
+        initial_translation(translation) {
     needs_update = true;
   }
 
+  // Returns to the transform the component was created with
   void reset() {
-    scale = glm::vec3(1.0f, 1.0f, 1.0f);
-    rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
-    translation = glm::vec3(0.0f, 0.0f, 0.0f);
+    scale = initial_scale;
+    rotation = initial_rotation;
+    translation = initial_translation;
     needs_update = true;
   }
 
@@ -52,4 +63,12 @@ class TransformComponent {
   glm::quat rotation;
   glm::vec3 translation;
   bool needs_update;
+  // Node holding the transform in the scene's TransformHierarchy, which gets
+  // the transform by transform_system::syncTransformNode
+  TransformHandle node;
+
+ private:
+  glm::vec3 initial_scale;
+  glm::quat initial_rotation;
+  glm::vec3 initial_translation;
 };
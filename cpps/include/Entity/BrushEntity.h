@@ -27,12 +27,17 @@
 #include "./Component/BrushComponent.h"
 #include "./Component/GrFramedTextureComponent.h"
 #include "./Component/GrUniformComponent.h"
+#include "./Component/PickComponent.h"
 #include "./constants.h"
+#include "./gr_resource_registry.h"
 
 class BrushEntity {
  public:
   BrushEntity() {
+    gr_resource_registry::OwnerScope owner_scope("BrushEntity");
+
     brush_component = std::make_unique<BrushComponent>();
+    pick_component = std::make_unique<PickComponent>();
 
     gr_brush_uniform_component =
         std::make_unique<GrUniformComponent>("BrushBlock");
@@ -43,6 +48,7 @@ class BrushEntity {
   }
 
   std::unique_ptr<BrushComponent> brush_component;
+  std::unique_ptr<PickComponent> pick_component;
   std::unique_ptr<GrUniformComponent> gr_brush_uniform_component;
   std::unique_ptr<GrFramedTextureComponent>
       gr_brush_depth_framed_texture_component;
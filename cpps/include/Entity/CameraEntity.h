@@ -26,10 +26,13 @@
 
 #include "./Component/CameraComponent.h"
 #include "./Component/GrUniformComponent.h"
+#include "./gr_resource_registry.h"
 
 class CameraEntity {
  public:
   CameraEntity() {
+    gr_resource_registry::OwnerScope owner_scope("CameraEntity");
+
     camera_component = std::make_unique<CameraComponent>();
     gr_camera_uniform_component =
         std::make_unique<GrUniformComponent>("CameraBlock");
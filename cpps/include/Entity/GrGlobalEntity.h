@@ -27,18 +27,25 @@
 #include "./Component/GrGeometryComponent.h"
 #include "./Component/GrShaderManagerComponent.h"
 #include "./Component/GrUniformComponent.h"
+#include "./gr_resource_registry.h"
 
 class GrGlobalEntity {
  public:
   GrGlobalEntity() {
+    gr_resource_registry::OwnerScope owner_scope("GrGlobalEntity");
+
     gr_shader_manager_component = std::make_unique<GrShaderManagerComponent>();
     gr_time_uniform_component =
         std::make_unique<GrUniformComponent>("TimeBlock");
+    gr_instance_uniform_component =
+        std::make_unique<GrUniformComponent>("InstanceBlock");
     gr_quad_geometry_component = std::make_unique<GrGeometryComponent>();
   }
 
   std::unique_ptr<GrShaderManagerComponent> gr_shader_manager_component;
   std::unique_ptr<GrUniformComponent> gr_time_uniform_component;
+  // Refilled for every instanced draw, see gr_sync_system
+  std::unique_ptr<GrUniformComponent> gr_instance_uniform_component;
 
   // NOTICE: if you use more global geometries, you should implement Manager
   // class like GrShaderManagerComponent
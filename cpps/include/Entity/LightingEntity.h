@@ -24,20 +24,20 @@
 
 #pragma once
 
-#include "./Component/GrPingPongTextureComponent.h"
-#include "./Entity/PaintableEntity.h"
+#include "./Component/GrUniformComponent.h"
+#include "./Component/LightingComponent.h"
+#include "./gr_resource_registry.h"
 
-class PaintedTexturesView {
+class LightingEntity {
  public:
-  PaintedTexturesView(
-      std::reference_wrapper<PaintableEntity> paintable_entity) {
-    for (const auto& paintable_part :
-         paintable_entity.get().paintable_part_entities) {
-      paintable_gr_ping_pong_textures.push_back(
-          std::ref(*paintable_part->gr_painted_ping_pong_texture_component));
-    }
+  LightingEntity() {
+    gr_resource_registry::OwnerScope owner_scope("LightingEntity");
+
+    lighting_component = std::make_unique<LightingComponent>();
+    gr_lighting_uniform_component =
+        std::make_unique<GrUniformComponent>("LightingBlock");
   }
 
-  std::vector<std::reference_wrapper<GrPingPongTextureComponent>>
-      paintable_gr_ping_pong_textures;
+  std::unique_ptr<LightingComponent> lighting_component;
+  std::unique_ptr<GrUniformComponent> gr_lighting_uniform_component;
 };
@@ -0,0 +1,46 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "./Component/MeshImportComponent.h"
+#include "./Component/ModelSwitchComponent.h"
+#include "./Entity/PaintableEntity.h"
+
+class ModelSwitchEntity {
+ public:
+  ModelSwitchEntity() {
+    model_switch_component = std::make_unique<ModelSwitchComponent>();
+    mesh_import_component = std::make_unique<MeshImportComponent>();
+  }
+
+  std::unique_ptr<ModelSwitchComponent> model_switch_component;
+  // Import whose model is handed to model_switch_component once built
+  std::unique_ptr<MeshImportComponent> mesh_import_component;
+  // Paintables under construction, swapped in once every part is built
+  std::vector<std::unique_ptr<PaintableEntity>> pending_paintable_entities;
+};
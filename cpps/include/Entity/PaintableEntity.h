@@ -26,17 +26,90 @@
 
 #include <vector>
 
+#include "./Component/BoundsComponent.h"
 #include "./Component/MaterialComponent.h"
 #include "./Component/TransformComponent.h"
 #include "./PaintablePartEntity.h"
+#include "./TransformHierarchy.h"
+#include "./View/InstanceBatchesView.h"
+#include "./asset_pack.h"
+#include "./geometry_cache.h"
+#include "./mesh_import.h"
+#include "./stress_scene.h"
 
-enum class PaintablePreset { CUBE, PLANE, SPHERE };
+// Scenes of one or more paintables. CAR is a box body with four wheels, each
+// wheel being a paintable of its own.
+enum class PaintablePreset { CUBE, PLANE, SPHERE, STRESS, CAR };
+
+// Parametric scene used to measure how the engine scales with the number of
+// parts, their tessellation and the painted map resolution
+struct StressPresetOptions {
+  int part_count = 16;
+  int geometry_segments = 16;
+  int painted_map_size = 512;
+  StressLayout layout = StressLayout::GRID;
+  PaintablePartPreset part_preset = PaintablePartPreset::PLANE;
+};
+
+// One paintable of a scene, placed by its own transform
+struct PaintableDescriptor {
+  glm::vec3 scale = glm::vec3(1.0f);
+  glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+  glm::vec3 translation = glm::vec3(0.0f);
+
+  std::vector<PaintablePartDescriptor> part_descriptors;
+};
+
+std::vector<PaintableDescriptor> getPaintableDescriptors(
+    PaintablePreset preset);
+
+std::vector<PaintableDescriptor> getStressPaintableDescriptors(
+    const StressPresetOptions& options);
+
+// One paintable with a MESH part per imported material, scaled and centered
+// to the size of the SPHERE preset. `geometries` are those of `parts` built by
+// geometry_cache::build, which they move into.
+PaintableDescriptor getMeshPaintableDescriptor(
+    const std::vector<mesh_import::ImportedPart>& parts,
+    std::vector<geometry_cache::BuiltGeometry>&& geometries);
+
+// Paintables of an asset pack, as they were stored by the converter. The
+// geometries and painted maps are read from the pack in place.
+std::vector<PaintableDescriptor> getAssetPackPaintableDescriptors(
+    std::shared_ptr<const asset_pack::AssetPack> asset_pack);
+
+// Upper bound of the GPU memory a scene built from `descriptors` will allocate
+size_t estimatePaintableBytes(
+    const std::vector<PaintableDescriptor>& descriptors);
 
 class PaintableEntity {
  public:
-  PaintableEntity(PaintablePreset preset);
+  // Creates the paintable with every part of `descriptor`, its transform being
+  // a child of `parent_node`
+  PaintableEntity(
+      const PaintableDescriptor& descriptor,
+      std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+      TransformHandle parent_node);
+  // Destroys the transform nodes of the paintable and its parts
+  ~PaintableEntity();
+
+  PaintableEntity(const PaintableEntity&) = delete;
+  PaintableEntity& operator=(const PaintableEntity&) = delete;
 
+  // Outlives the paintable, see RootManager::scene_entity
+  std::reference_wrapper<TransformHierarchy> transform_hierarchy;
   std::unique_ptr<MaterialComponent> material_component;
   std::unique_ptr<TransformComponent> transform_component;
-  std::vector<std::unique_ptr<PaintablePartEntity>> paintable_part_entities;
+  std::unique_ptr<BoundsComponent> bounds_component;
+  // Parts of this paintable, see createPaintablePartEntity
+  std::unique_ptr<EntityRegistry> part_registry;
+  // Declared after part_registry, so that it unsubscribes before the registry
+  // is destroyed
+  std::unique_ptr<InstanceBatchesView> instance_batches_view;
 };
+
+// Creates a part of `paintable_entity`, see createPaintablePartEntity, and
+// grows the paintable's bounds to contain it
+EntityHandle addPaintablePart(
+    std::reference_wrapper<PaintableEntity> paintable_entity,
+    const PaintablePartDescriptor& descriptor);
@@ -25,27 +25,57 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <memory>
+#include <span>
 
 #include "./Component/GeometryComponent.h"
 #include "./Component/GrFramedTextureComponent.h"
-#include "./Component/GrGeometryComponent.h"
 #include "./Component/GrPingPongTextureComponent.h"
 #include "./Component/GrUniformComponent.h"
-#include "./Component/TransformComponent.h"
+#include "./Component/MeshletSelectionComponent.h"
+#include "./Component/SharedGeometryComponent.h"
+#include "./Component/TransformNodeComponent.h"
+#include "./EntityRegistry.h"
+#include "./constants.h"
 
-enum class PaintablePartPreset { PLANE, SPHERE };
+// MESH parts take their geometry from the descriptor, e.g. from mesh_import
+enum class PaintablePartPreset { PLANE, SPHERE, MESH };
 
-class PaintablePartEntity {
- public:
-  PaintablePartEntity(PaintablePartPreset preset, glm::vec3 scale,
-                      glm::quat rotation, glm::vec3 translation);
+struct PaintablePartDescriptor {
+  PaintablePartPreset preset;
+  glm::vec3 scale = glm::vec3(1.0f);
+  glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+  glm::vec3 translation = glm::vec3(0.0f);
 
-  std::unique_ptr<GeometryComponent> geometry_component;
-  std::unique_ptr<GrGeometryComponent> gr_geometry_component;
-  std::unique_ptr<GrUniformComponent> gr_transform_uniform_component;
-  std::unique_ptr<TransformComponent> transform_component;
+  // Segments per axis for PLANE, latitude rings for SPHERE (the sphere uses
+  // twice as many longitude segments). 0 keeps the geometry preset's default.
+  int geometry_segments = 0;
+  int painted_map_size = DEFAULT_PAINTED_MAP_SIZE;
 
-  std::unique_ptr<GrFramedTextureComponent> gr_paint_framed_texture_component;
-  std::unique_ptr<GrPingPongTextureComponent>
-      gr_painted_ping_pong_texture_component;
+  // Geometry of MESH parts, already acquired from geometry_cache
+  SharedGeometryComponent geometry = {};
+  // RGBA half floats the painted map starts with, kept alive by
+  // geometry.storage. Empty for a cleared map.
+  std::span<const char> baked_painted_map = {};
 };
+
+// Upper bound of the GPU memory a part built from `descriptor` will allocate.
+// The geometry share is only allocated once among parts with the same
+// geometry.
+size_t estimatePaintablePartBytes(const PaintablePartDescriptor& descriptor);
+size_t estimatePaintablePartTextureBytes(
+    const PaintablePartDescriptor& descriptor);
+size_t estimatePaintablePartGeometryBytes(
+    const PaintablePartDescriptor& descriptor);
+
+// Creates a part in the part registry of its paintable, with the components
+// - TransformNodeComponent, a child of `parent_node` in `transform_hierarchy`
+// - SharedGeometryComponent
+// - GrUniformComponent, the "ModelBlock" of the part
+// - GrFramedTextureComponent, the paint map of the current stroke
+// - GrPingPongTextureComponent, the accumulated painted map
+// - MeshletSelectionComponent, the meshlets under the brush
+EntityHandle createPaintablePartEntity(
+    std::reference_wrapper<EntityRegistry> part_registry,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    TransformHandle parent_node, const PaintablePartDescriptor& descriptor);
@@ -0,0 +1,48 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "./Component/TransformComponent.h"
+#include "./TransformHierarchy.h"
+
+// Root of every transform of the scene. Paintables are children of the scene
+// node, and parts are children of their paintable.
+class SceneEntity {
+ public:
+  SceneEntity() {
+    transform_hierarchy = std::make_unique<TransformHierarchy>();
+
+    transform_component = std::make_unique<TransformComponent>();
+    transform_component->node = transform_hierarchy->create(
+        TransformHandle(), transform_component->scale,
+        transform_component->rotation, transform_component->translation);
+  }
+
+  std::unique_ptr<TransformHierarchy> transform_hierarchy;
+  // Rotated by the user, turning every paintable about the world origin
+  std::unique_ptr<TransformComponent> transform_component;
+};
@@ -0,0 +1,565 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Generational reference to an entity of an EntityRegistry. A handle stays
+// invalid once its entity is destroyed, even if the slot gets reused.
+struct EntityHandle {
+  uint32_t index = 0;
+  // 0 is never a live generation, so a default handle refers to nothing
+  uint32_t generation = 0;
+
+  bool operator==(const EntityHandle& other) const = default;
+};
+
+inline size_t getNextComponentTypeId() {
+  static size_t next_component_type_id = 0;
+  return next_component_type_id++;
+}
+
+template <typename Component>
+size_t getComponentTypeId() {
+  static const size_t component_type_id = getNextComponentTypeId();
+  return component_type_id;
+}
+
+class ComponentColumnBase {
+ public:
+  virtual ~ComponentColumnBase() = default;
+
+  virtual std::unique_ptr<ComponentColumnBase> createEmpty() const = 0;
+  // Appends the component at `row` to `destination`, leaving a moved-from
+  // component behind
+  virtual void moveTo(size_t row, ComponentColumnBase& destination) = 0;
+  virtual void swapRemove(size_t row) = 0;
+};
+
+template <typename Component>
+class ComponentColumn : public ComponentColumnBase {
+ public:
+  std::unique_ptr<ComponentColumnBase> createEmpty() const override {
+    return std::make_unique<ComponentColumn<Component>>();
+  }
+
+  void moveTo(size_t row, ComponentColumnBase& destination) override {
+    static_cast<ComponentColumn<Component>&>(destination)
+        .components.push_back(std::move(components[row]));
+  }
+
+  void swapRemove(size_t row) override {
+    if (row + 1 != components.size()) {
+      components[row] = std::move(components.back());
+    }
+    components.pop_back();
+  }
+
+  std::vector<Component> components;
+};
+
+// Entities with exactly the same set of component types. Every component type
+// is stored contiguously, and row i of every column belongs to entities[i].
+class Archetype {
+ public:
+  Archetype(std::vector<size_t> type_ids,
+            std::vector<std::unique_ptr<ComponentColumnBase>> columns)
+      : type_ids(std::move(type_ids)), columns(std::move(columns)) {}
+
+  bool hasType(size_t type_id) const { return findColumn(type_id) >= 0; }
+
+  template <typename Component>
+  std::vector<Component>& getComponents() {
+    int column_index = findColumn(getComponentTypeId<Component>());
+    if (column_index < 0) {
+      throw std::invalid_argument("Archetype has no such component");
+    }
+
+    return static_cast<ComponentColumn<Component>&>(*columns[column_index])
+        .components;
+  }
+
+  int findColumn(size_t type_id) const {
+    for (size_t i = 0; i < type_ids.size(); i++) {
+      if (type_ids[i] == type_id) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Sorted, parallel to columns
+  std::vector<size_t> type_ids;
+  std::vector<std::unique_ptr<ComponentColumnBase>> columns;
+  std::vector<EntityHandle> entities;
+};
+
+// Iterates every entity having all of `Components`, archetype by archetype.
+// Adding or removing entities or components invalidates the query.
+template <typename... Components>
+class EntityQuery {
+ public:
+  typedef std::tuple<std::vector<EntityHandle>*, std::vector<Components>*...>
+      Chunk;
+
+  class Iterator {
+   public:
+    Iterator(const std::vector<Chunk>& chunks, size_t chunk_index)
+        : chunks(chunks), chunk_index(chunk_index), row(0) {
+      skipEmptyChunks();
+    }
+
+    std::tuple<Components&...> operator*() const {
+      const auto& chunk = chunks[chunk_index];
+      return std::tuple<Components&...>(
+          (*std::get<std::vector<Components>*>(chunk))[row]...);
+    }
+
+    Iterator& operator++() {
+      row++;
+      skipEmptyChunks();
+      return *this;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return chunk_index != other.chunk_index || row != other.row;
+    }
+
+   private:
+    void skipEmptyChunks() {
+      while (chunk_index < chunks.size() &&
+             row >= std::get<0>(chunks[chunk_index])->size()) {
+        chunk_index++;
+        row = 0;
+      }
+    }
+
+    const std::vector<Chunk>& chunks;
+    size_t chunk_index;
+    size_t row;
+  };
+
+  EntityQuery(const std::vector<Chunk>& chunks) : chunks(chunks) {}
+
+  Iterator begin() const { return Iterator(chunks, 0); }
+  Iterator end() const { return Iterator(chunks, chunks.size()); }
+
+  // Calls `function(EntityHandle, Components&...)` for every entity
+  template <typename Function>
+  void each(Function function) const {
+    for (const auto& chunk : chunks) {
+      const auto& entities = *std::get<0>(chunk);
+      auto columns =
+          std::make_tuple(std::get<std::vector<Components>*>(chunk)->data()...);
+
+      for (size_t row = 0; row < entities.size(); row++) {
+        function(entities[row],
+                 std::get<Components*>(columns)[row]...);
+      }
+    }
+  }
+
+  size_t size() const {
+    size_t entity_count = 0;
+    for (const auto& chunk : chunks) {
+      entity_count += std::get<0>(chunk)->size();
+    }
+    return entity_count;
+  }
+
+ private:
+  const std::vector<Chunk>& chunks;
+};
+
+class EntityQueryCacheBase {
+ public:
+  virtual ~EntityQueryCacheBase() = default;
+
+  // Number of archetypes when the chunks were collected
+  size_t archetype_count = SIZE_MAX;
+};
+
+// Chunks matching a query, kept until an archetype gets added. Archetypes are
+// never removed and their arrays stay in place, so the chunks stay valid.
+template <typename... Components>
+class EntityQueryCache : public EntityQueryCacheBase {
+ public:
+  std::vector<typename EntityQuery<Components...>::Chunk> chunks;
+};
+
+// Archetype-based storage: entities are generational handles, and their
+// components live in per-type arrays grouped by the exact set of component
+// types the entity has. Components must be movable, since adding or removing
+// entities and components moves them around.
+//
+// Views that are expensive to rebuild can subscribe to a component type to be
+// told when entities gain or lose it, see subscribe.
+class EntityRegistry {
+ public:
+  typedef std::function<void(EntityHandle)> EntityCallback;
+
+  EntityRegistry() = default;
+  EntityRegistry(const EntityRegistry&) = delete;
+  EntityRegistry& operator=(const EntityRegistry&) = delete;
+
+  template <typename... Components>
+  EntityHandle create(Components&&... components) {
+    Archetype& archetype = getArchetype<std::decay_t<Components>...>();
+
+    (archetype.getComponents<std::decay_t<Components>>().push_back(
+         std::forward<Components>(components)),
+     ...);
+
+    auto handle = allocateHandle();
+    archetype.entities.push_back(handle);
+    records[handle.index].archetype = &archetype;
+    records[handle.index].row = archetype.entities.size() - 1;
+
+    notifyAdded(archetype.type_ids, handle);
+
+    return handle;
+  }
+
+  void destroy(EntityHandle handle) {
+    auto& record = getRecord(handle);
+
+    notifyRemoved(record.archetype->type_ids, handle);
+    removeRow(*record.archetype, record.row);
+
+    record.archetype = nullptr;
+    record.generation++;
+    // Skip the null generation on wrap around
+    if (record.generation == 0) {
+      record.generation = 1;
+    }
+    free_indices.push_back(handle.index);
+    entity_count--;
+  }
+
+  bool isAlive(EntityHandle handle) const {
+    return handle.index < records.size() &&
+           records[handle.index].generation == handle.generation &&
+           records[handle.index].archetype != nullptr;
+  }
+
+  template <typename Component>
+  bool has(EntityHandle handle) const {
+    return isAlive(handle) && records[handle.index].archetype->hasType(
+                                  getComponentTypeId<Component>());
+  }
+
+  template <typename Component>
+  Component& get(EntityHandle handle) {
+    auto& record = getRecord(handle);
+    return record.archetype->getComponents<Component>()[record.row];
+  }
+
+  // Adds `component` to the entity, or replaces the one it already has
+  template <typename Component>
+  void add(EntityHandle handle, Component&& component) {
+    typedef std::decay_t<Component> ComponentType;
+
+    auto type_id = getComponentTypeId<ComponentType>();
+
+    // Subscribers see a replaced component as removed and added again
+    if (has<ComponentType>(handle)) {
+      notifyRemoved({type_id}, handle);
+      get<ComponentType>(handle) = std::forward<Component>(component);
+      notifyAdded({type_id}, handle);
+      return;
+    }
+
+    auto& record = getRecord(handle);
+    auto& source = *record.archetype;
+
+    auto type_ids = source.type_ids;
+    type_ids.push_back(type_id);
+    sortTypeIds(type_ids);
+
+    Archetype& destination = getArchetype(type_ids, [&source](size_t type_id) {
+      int column_index = source.findColumn(type_id);
+      if (column_index < 0) {
+        return std::unique_ptr<ComponentColumnBase>(
+            std::make_unique<ComponentColumn<ComponentType>>());
+      }
+      return source.columns[column_index]->createEmpty();
+    });
+
+    for (size_t i = 0; i < source.type_ids.size(); i++) {
+      source.columns[i]->moveTo(
+          record.row,
+          *destination.columns[destination.findColumn(source.type_ids[i])]);
+    }
+    destination.getComponents<ComponentType>().push_back(
+        std::forward<Component>(component));
+
+    moveRecord(handle, source, destination);
+
+    notifyAdded({type_id}, handle);
+  }
+
+  template <typename Component>
+  void remove(EntityHandle handle) {
+    if (!has<Component>(handle)) {
+      return;
+    }
+
+    auto& record = getRecord(handle);
+    auto& source = *record.archetype;
+    auto removed_type_id = getComponentTypeId<Component>();
+
+    notifyRemoved({removed_type_id}, handle);
+
+    std::vector<size_t> type_ids;
+    for (auto type_id : source.type_ids) {
+      if (type_id != removed_type_id) {
+        type_ids.push_back(type_id);
+      }
+    }
+
+    auto& destination = getArchetype(type_ids, [&source](size_t type_id) {
+      return source.columns[source.findColumn(type_id)]->createEmpty();
+    });
+
+    for (size_t i = 0; i < destination.type_ids.size(); i++) {
+      source.columns[source.findColumn(destination.type_ids[i])]->moveTo(
+          record.row, *destination.columns[i]);
+    }
+
+    moveRecord(handle, source, destination);
+  }
+
+  // Matching archetypes are only searched again after an archetype was added,
+  // so repeated queries do not allocate. Queries update that cache, so they
+  // must not run concurrently on the same registry.
+  template <typename... Components>
+  EntityQuery<Components...> query() {
+    size_t query_type_id = getComponentTypeId<EntityQuery<Components...>>();
+    if (query_type_id >= query_caches.size()) {
+      query_caches.resize(query_type_id + 1);
+    }
+
+    auto& query_cache = query_caches[query_type_id];
+    if (!query_cache) {
+      query_cache = std::make_unique<EntityQueryCache<Components...>>();
+    }
+
+    auto& chunks =
+        static_cast<EntityQueryCache<Components...>&>(*query_cache).chunks;
+
+    if (query_cache->archetype_count != archetypes.size()) {
+      chunks.clear();
+      for (auto& [type_ids, archetype_ptr] : archetypes) {
+        Archetype& archetype = *archetype_ptr;
+
+        if ((archetype.hasType(getComponentTypeId<Components>()) && ...)) {
+          chunks.push_back(std::make_tuple(
+              &archetype.entities, &archetype.getComponents<Components>()...));
+        }
+      }
+      query_cache->archetype_count = archetypes.size();
+    }
+
+    return EntityQuery<Components...>(chunks);
+  }
+
+  // Calls `on_added` after an entity gains a `Component`, and `on_removed`
+  // before it loses one, while its components can still be read. Entities
+  // that already exist are not reported. Callbacks must not add or remove
+  // entities, components or subscriptions.
+  template <typename Component>
+  size_t subscribe(EntityCallback on_added, EntityCallback on_removed) {
+    subscriptions.push_back({
+        .subscription_id = next_subscription_id,
+        .type_id = getComponentTypeId<Component>(),
+        .on_added = std::move(on_added),
+        .on_removed = std::move(on_removed),
+    });
+    return next_subscription_id++;
+  }
+
+  void unsubscribe(size_t subscription_id) {
+    std::erase_if(subscriptions, [subscription_id](const auto& subscription) {
+      return subscription.subscription_id == subscription_id;
+    });
+  }
+
+  size_t size() const { return entity_count; }
+
+ private:
+  struct Subscription {
+    size_t subscription_id;
+    size_t type_id;
+    EntityCallback on_added;
+    EntityCallback on_removed;
+  };
+
+  struct EntityRecord {
+    Archetype* archetype;
+    size_t row;
+    uint32_t generation;
+  };
+
+  static void sortTypeIds(std::vector<size_t>& type_ids) {
+    std::sort(type_ids.begin(), type_ids.end());
+    if (std::adjacent_find(type_ids.begin(), type_ids.end()) !=
+        type_ids.end()) {
+      throw std::invalid_argument("Entity has duplicated component types");
+    }
+  }
+
+  template <typename... Components>
+  Archetype& getArchetype() {
+    std::vector<size_t> type_ids = {getComponentTypeId<Components>()...};
+    sortTypeIds(type_ids);
+
+    auto it = archetypes.find(type_ids);
+    if (it != archetypes.end()) {
+      return *it->second;
+    }
+
+    // Columns are created in declaration order and sorted by type ID after
+    std::vector<std::pair<size_t, std::unique_ptr<ComponentColumnBase>>>
+        typed_columns;
+    (typed_columns.push_back({getComponentTypeId<Components>(),
+                              std::make_unique<ComponentColumn<Components>>()}),
+     ...);
+
+    return getArchetype(type_ids, [&typed_columns](size_t type_id) {
+      for (auto& [column_type_id, column] : typed_columns) {
+        if (column_type_id == type_id) {
+          return std::move(column);
+        }
+      }
+      throw std::invalid_argument("Missing component column");
+    });
+  }
+
+  template <typename CreateColumn>
+  Archetype& getArchetype(const std::vector<size_t>& type_ids,
+                          CreateColumn create_column) {
+    auto it = archetypes.find(type_ids);
+    if (it != archetypes.end()) {
+      return *it->second;
+    }
+
+    std::vector<std::unique_ptr<ComponentColumnBase>> columns;
+    for (auto type_id : type_ids) {
+      columns.push_back(create_column(type_id));
+    }
+
+    auto archetype = std::make_unique<Archetype>(type_ids, std::move(columns));
+    auto& archetype_ref = *archetype;
+    archetypes.emplace(type_ids, std::move(archetype));
+
+    return archetype_ref;
+  }
+
+  EntityHandle allocateHandle() {
+    entity_count++;
+
+    if (!free_indices.empty()) {
+      uint32_t index = free_indices.back();
+      free_indices.pop_back();
+      return {index, records[index].generation};
+    }
+
+    records.push_back({nullptr, 0, 1});
+    return {static_cast<uint32_t>(records.size() - 1), 1};
+  }
+
+  EntityRecord& getRecord(EntityHandle handle) {
+    if (!isAlive(handle)) {
+      throw std::invalid_argument("Entity handle is not alive");
+    }
+    return records[handle.index];
+  }
+
+  // Removes `row` by moving the last row into it
+  void removeRow(Archetype& archetype, size_t row) {
+    for (auto& column : archetype.columns) {
+      column->swapRemove(row);
+    }
+
+    auto last_row = archetype.entities.size() - 1;
+    if (row != last_row) {
+      archetype.entities[row] = archetype.entities[last_row];
+      records[archetype.entities[row].index].row = row;
+    }
+    archetype.entities.pop_back();
+  }
+
+  // Finishes moving an entity whose components were appended to destination
+  void moveRecord(EntityHandle handle, Archetype& source,
+                  Archetype& destination) {
+    auto& record = records[handle.index];
+
+    removeRow(source, record.row);
+
+    destination.entities.push_back(handle);
+    record.archetype = &destination;
+    record.row = destination.entities.size() - 1;
+  }
+
+  void notifyAdded(const std::vector<size_t>& type_ids, EntityHandle handle) {
+    for (const auto& subscription : subscriptions) {
+      if (subscription.on_added &&
+          std::binary_search(type_ids.begin(), type_ids.end(),
+                             subscription.type_id)) {
+        subscription.on_added(handle);
+      }
+    }
+  }
+
+  void notifyRemoved(const std::vector<size_t>& type_ids,
+                     EntityHandle handle) {
+    for (const auto& subscription : subscriptions) {
+      if (subscription.on_removed &&
+          std::binary_search(type_ids.begin(), type_ids.end(),
+                             subscription.type_id)) {
+        subscription.on_removed(handle);
+      }
+    }
+  }
+
+  std::map<std::vector<size_t>, std::unique_ptr<Archetype>> archetypes;
+  std::vector<EntityRecord> records;
+  std::vector<uint32_t> free_indices;
+  size_t entity_count = 0;
+  std::vector<Subscription> subscriptions;
+  size_t next_subscription_id = 0;
+  // Indexed by the component type ID of the query
+  std::vector<std::unique_ptr<EntityQueryCacheBase>> query_caches;
+};
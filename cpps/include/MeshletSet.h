@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./UvRects.h"
+#include "./constants.h"
+#include "./math_util.h"
+
+// Every normal is within the angle whose cosine is `cos` of the unit vector
+// `axis`. 0 or less bounds nothing.
+struct NormalCone {
+  glm::vec3 axis;
+  float cos;
+};
+
+// Consecutive triangles of a geometry's indices, with bounds to cull them by
+struct Meshlet {
+  uint32_t first_index;
+  uint32_t index_count;
+  BoundingSphere sphere;
+  // Of the vertex normals, which the brush weighs paint by
+  NormalCone vertex_cone;
+  // Of the triangle planes, on the side of their vertex normals, which tells
+  // whether the triangles can occlude anything from the brush
+  NormalCone face_cone;
+};
+
+// Consecutive triangles within a meshlet spanning much of the texture
+// coordinates, with bounds to tell where the brush paints it by
+struct TriangleGroup {
+  uint32_t first_index;
+  uint32_t index_count;
+  BoundingSphere sphere;
+  UvRect uv_rect;
+};
+
+struct MeshletRange {
+  uint32_t first_index;
+  uint32_t index_count;
+};
+
+// Index ranges to draw, in increasing order. Ranges are merged across the
+// smallest gaps between them, so that they never take more than
+// MAX_MESHLET_DRAW_RANGES draw calls, at the cost of drawing the gaps.
+class MeshletRanges {
+ public:
+  void clear() { range_count = 0; }
+
+  // `range` must not start before the previously added range
+  void add(const MeshletRange& range);
+  // Adds the ranges of both, e.g. of instances drawn together
+  void merge(const MeshletRanges& other);
+
+  std::span<const MeshletRange> get() const {
+    return {ranges.data(), range_count};
+  }
+  bool empty() const { return range_count == 0; }
+
+ private:
+  std::array<MeshletRange, MAX_MESHLET_DRAW_RANGES + 1> ranges;
+  size_t range_count = 0;
+};
+
+// Reorders the triangles so that every MESHLET_TRIANGLE_COUNT consecutive
+// triangles are close together: meshlets grow over triangles sharing
+// vertices, seeded in Morton order of the triangle centers. Call before
+// building anything that refers to triangles by index, e.g. a TriangleBvh.
+void clusterTriangles(GeometryComponent& geometry_component);
+
+// Meshlets of MESHLET_TRIANGLE_COUNT consecutive triangles, which are tight
+// when the triangles went through clusterTriangles, and still valid when
+// they did not, e.g. for asset packs written before it existed.
+class MeshletSet {
+ public:
+  explicit MeshletSet(const GeometryView& geometry_view);
+  // Copies stored meshlets of `geometry_view` instead of building them.
+  // Throws std::runtime_error if they refer outside of its indices.
+  MeshletSet(std::span<const Meshlet> meshlets,
+             const GeometryView& geometry_view);
+
+  // Appends the meshlets, transformed by `matrix`, that may be inside the
+  // cone at `apex` around the unit vector `axis` and face the apex to
+  // `depth_ranges` and `decal_ranges`. For the depth pass, facing follows
+  // the triangle planes: the surface nearest to the apex faces it, unless
+  // the mesh is open and seen from behind, whose back the brush cannot paint
+  // either. For the decal pass, it follows the vertex normals.
+  //
+  // The texture coordinates the decal meshlets can be painted at are added
+  // to `decal_uv_rects`: the UV bounds of each meshlet, or for meshlets
+  // spanning more than MAX_UNCLIPPED_MESHLET_UV_AREA, those of their
+  // triangle groups in the cone, or of the triangles of such groups clipped
+  // to the pyramid around the cone. `geometry_view` must be the one the
+  // meshlets were built from.
+  void selectInCone(const GeometryView& geometry_view, const glm::mat4& matrix,
+                    const glm::vec3& apex, const glm::vec3& axis,
+                    float half_angle, MeshletRanges& depth_ranges,
+                    MeshletRanges& decal_ranges,
+                    UvRects& decal_uv_rects) const;
+
+  std::span<const Meshlet> getMeshlets() const { return meshlets; }
+
+ private:
+  void buildTriangleGroups(const GeometryView& geometry_view);
+
+  std::vector<Meshlet> meshlets;
+  // Of the texture coordinates of each meshlet, which are not stored in
+  // asset packs, like the triangle groups
+  std::vector<UvRect> uv_rects;
+  // Those of meshlet i are first_triangle_groups[i] up to
+  // first_triangle_groups[i + 1]. Only meshlets spanning more than
+  // MAX_UNCLIPPED_MESHLET_UV_AREA have any.
+  std::vector<TriangleGroup> triangle_groups;
+  std::vector<uint32_t> first_triangle_groups;
+};
@@ -29,28 +29,50 @@
 #include "./Entity/ClientInputEntity.h"
 #include "./Entity/ConfigEntity.h"
 #include "./Entity/GrGlobalEntity.h"
+#include "./Entity/LightingEntity.h"
+#include "./Entity/ModelSwitchEntity.h"
 #include "./Entity/PaintableEntity.h"
-#include "./View/GrModelGeometriesView.h"
-#include "./View/PaintedTexturesView.h"
-#include "./View/RenderItemsView.h"
-#include "./View/TransformUpdatingView.h"
+#include "./Entity/SceneEntity.h"
+#include "./Entity/StressTestEntity.h"
 #include "./system/render_system.h"
 
 class RootManager {
  public:
   RootManager();
 
-  void resetPaintable(PaintablePreset paintable_preset);
-  void resetPaintableViews();
+  // Replaces every paintable entity with the ones of a scene, applying the
+  // GPU memory budget policy of gr_resource_registry. Returns false if the
+  // new scene was refused.
+  bool resetPaintable(PaintablePreset paintable_preset);
+  bool resetPaintable(const StressPresetOptions& stress_preset_options);
+  bool resetPaintable(std::vector<PaintableDescriptor> descriptors);
+
+  // Starts building the paintables of a new scene in the background, see
+  // manage_system::stepModelSwitch. The current ones keep rendering until
+  // swapPaintable is called. Returns false if the new scene was refused by
+  // the GPU memory budget.
+  bool beginPaintableSwitch(std::vector<PaintableDescriptor> descriptors);
+  // Also drops a mesh import in progress, see manage_system::stepMeshImport
+  void cancelPaintableSwitch();
+  void swapPaintable();
 
   std::unique_ptr<ConfigEntity> config_entity;
   std::unique_ptr<ClientInputEntity> client_input_entity;
   std::unique_ptr<GrGlobalEntity> gr_global_entity;
   std::unique_ptr<CameraEntity> camera_entity;
   std::unique_ptr<BrushEntity> brush_entity;
-  std::unique_ptr<PaintableEntity> paintable_entity;
-  std::unique_ptr<RenderItemsView> render_items_view;
-  std::unique_ptr<PaintedTexturesView> painted_textures_view;
-  std::unique_ptr<TransformUpdatingView> transform_updating_view;
-  std::unique_ptr<GrModelGeometriesView> gr_model_geometries_view;
+  std::unique_ptr<LightingEntity> lighting_entity;
+  // Declared before the paintables, which remove their transforms from it
+  std::unique_ptr<SceneEntity> scene_entity;
+  std::vector<std::unique_ptr<PaintableEntity>> paintable_entities;
+  std::unique_ptr<StressTestEntity> stress_test_entity;
+  std::unique_ptr<ModelSwitchEntity> model_switch_entity;
+
+ private:
+  // Applies the budget policy of gr_resource_registry to the descriptors,
+  // assuming reusable_bytes of live resources are freed before allocating
+  bool applyMemoryBudget(std::vector<PaintableDescriptor>& descriptors,
+                         size_t reusable_bytes);
+  std::unique_ptr<PaintableEntity> createPaintable(
+      const PaintableDescriptor& descriptor);
 };
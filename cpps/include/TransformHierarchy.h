@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+#include "./math_util.h"
+
+// Generational reference to a node of a TransformHierarchy
+struct TransformHandle {
+  uint32_t index = 0;
+  // 0 is never a live generation, so a default handle refers to nothing
+  uint32_t generation = 0;
+
+  bool operator==(const TransformHandle& other) const = default;
+};
+
+// Tree of local transforms with cached local and world matrices.
+//
+// Nodes are stored in pre-order, so the subtree of a node is the contiguous
+// range following it, and parents always come before their children. Setting
+// a local transform only marks the node; update() then recomputes the dirty
+// local matrices in one pass, and the world matrices of the dirty subtrees
+// range by range, leaving unchanged subtrees untouched.
+//
+// Every recomputed world matrix gets a new version, so that consumers can tell
+// whether the matrix changed since they last read it.
+//
+// Matrices are SimdMat4, which glm composes with SIMD in the SIMD flavor.
+class TransformHierarchy {
+ public:
+  // Creates a node as the last child of `parent`, or as a root for a default
+  // handle. Moves the nodes after it, so prefer building trees top down.
+  TransformHandle create(TransformHandle parent, const glm::vec3& scale,
+                         const glm::quat& rotation,
+                         const glm::vec3& translation);
+
+  // Destroys the node along with its subtree
+  void destroy(TransformHandle handle);
+
+  bool isAlive(TransformHandle handle) const;
+
+  void setLocal(TransformHandle handle, const glm::vec3& scale,
+                const glm::quat& rotation, const glm::vec3& translation);
+
+  // Recomputes the matrices of every node changed since the last update, and
+  // the world matrices of their subtrees
+  void update();
+
+  // As of the last update
+  const SimdMat4& getWorldMatrix(TransformHandle handle) const;
+  uint64_t getWorldVersion(TransformHandle handle) const;
+
+  size_t size() const { return handle_indices.size(); }
+
+ private:
+  static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+  uint32_t getSlot(TransformHandle handle) const;
+  void markDirty(uint32_t handle_index);
+
+  // Indexed by slot, i.e. the position of the node in pre-order
+  std::vector<uint32_t> handle_indices;
+  std::vector<uint32_t> parent_slots;
+  // Number of nodes in the subtree, the node included
+  std::vector<uint32_t> subtree_sizes;
+  std::vector<glm::vec3> scales;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> translations;
+  std::vector<SimdMat4> local_matrices;
+  std::vector<SimdMat4> world_matrices;
+  std::vector<uint64_t> world_versions;
+
+  // Indexed by handle index
+  std::vector<uint32_t> slots;
+  std::vector<uint32_t> generations;
+  std::vector<uint8_t> is_dirty;
+  std::vector<uint32_t> free_handle_indices;
+
+  // Handle indices of the nodes set since the last update
+  std::vector<uint32_t> dirty_handle_indices;
+  // Scratch space of update, kept to avoid allocating every frame
+  std::vector<uint32_t> dirty_slots;
+  uint64_t version = 0;
+};
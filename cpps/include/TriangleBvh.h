@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./ray_kernels.h"
+
+// Node of a flattened TriangleBvh with up to four children, whose bounds are
+// tested against a ray at once by ray_kernels
+struct alignas(16) BvhNode {
+  ray_kernels::BoxBlock child_bounds;
+  // Node index of inner children, first triangle block of leaves
+  uint32_t children[ray_kernels::LANE_COUNT];
+  // Triangle blocks of leaves, 0 for inner children
+  uint32_t block_counts[ray_kernels::LANE_COUNT];
+  uint32_t child_count;
+};
+
+struct BvhHit {
+  float distance;
+  // Barycentric weights of v1 and v2
+  float u;
+  float v;
+  // Index of the triangle in the indices of the geometry
+  uint32_t triangle_index;
+};
+
+// Arrays of a built TriangleBvh, to store it in an asset pack
+struct TriangleBvhData {
+  std::span<const BvhNode> nodes;
+  std::span<const ray_kernels::TriangleBlock> triangle_blocks;
+  std::span<const uint32_t> triangle_indices;
+  size_t triangle_count;
+};
+
+// Bounding volume hierarchy over the triangles of a geometry, built as a
+// binary tree with the surface area heuristic, then collapsed into nodes of
+// four children. Nodes are stored depth first in one array, and leaves copy
+// their triangles into blocks of four, so that traversal does not touch the
+// geometry and tests four boxes or triangles per step.
+class TriangleBvh {
+ public:
+  explicit TriangleBvh(const GeometryView& geometry_view);
+  // Copies a stored BVH instead of building it. Throws std::runtime_error if
+  // the arrays do not form a valid tree, so that traversal stays in bounds.
+  explicit TriangleBvh(const TriangleBvhData& data);
+
+  // Nearest triangle hit by the ray closer than `max_distance`, in units of
+  // `ray_direction`, which does not need to be normalized
+  std::optional<BvhHit> intersectRay(
+      const glm::vec3& ray_origin, const glm::vec3& ray_direction,
+      float max_distance = std::numeric_limits<float>::infinity()) const;
+
+  // Whether any triangle, transformed by `matrix`, may be inside the cone at
+  // `apex` around the unit vector `axis`. Tests bounding spheres, so it may
+  // report triangles just outside of the cone.
+  bool intersectsCone(const glm::mat4& matrix, const glm::vec3& apex,
+                      const glm::vec3& axis, float half_angle) const;
+
+  size_t getNodeCount() const { return nodes.size(); }
+  size_t getTriangleCount() const { return triangle_count; }
+  TriangleBvhData getData() const {
+    return {nodes, triangle_blocks, triangle_indices, triangle_count};
+  }
+
+ private:
+  std::vector<BvhNode> nodes;
+  std::vector<ray_kernels::TriangleBlock> triangle_blocks;
+  // Index of each triangle in the geometry, by block lane, and UINT32_MAX for
+  // the padding of partial blocks
+  std::vector<uint32_t> triangle_indices;
+  size_t triangle_count = 0;
+};
@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+
+#include "./constants.h"
+
+// Bounds of texture coordinates. Empty while `min` is greater than `max`.
+struct UvRect {
+  glm::vec2 min = glm::vec2(std::numeric_limits<float>::max());
+  glm::vec2 max = glm::vec2(std::numeric_limits<float>::lowest());
+
+  void add(const glm::vec2& uv) {
+    min = glm::min(min, uv);
+    max = glm::max(max, uv);
+  }
+  bool empty() const { return min.x > max.x || min.y > max.y; }
+  float getArea() const {
+    return empty() ? 0.0f : (max.x - min.x) * (max.y - min.y);
+  }
+};
+
+inline UvRect mergeUvRects(const UvRect& a, const UvRect& b) {
+  return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+}
+
+struct TexelRect {
+  glm::ivec2 min;
+  // Exclusive
+  glm::ivec2 max;
+
+  int getArea() const { return (max.x - min.x) * (max.y - min.y); }
+};
+
+// Size of mip `level` of a texture, as glTexImage2D allocates it
+inline glm::ivec2 getMipSize(const glm::ivec2& size, int level) {
+  return glm::max(size >> level, glm::ivec2(1));
+}
+
+// Texels of mip `level` of a `size` texture that rasterizing within `rect` can
+// write to, or that are filtered from those in the levels above. Widened by a
+// texel on each side at level 0 against rounding in the rasterizer.
+inline TexelRect getTexelRect(const UvRect& rect, const glm::ivec2& size,
+                              int level) {
+  glm::ivec2 min = glm::max(
+      glm::ivec2(glm::floor(rect.min * glm::vec2(size))) - 1, glm::ivec2(0));
+  glm::ivec2 max = glm::max(
+      glm::ivec2(glm::ceil(rect.max * glm::vec2(size))) + 1, glm::ivec2(0));
+  glm::ivec2 level_size = getMipSize(size, level);
+
+  return {glm::min(min >> level, level_size),
+          glm::min((max + (1 << level) - 1) >> level, level_size)};
+}
+
+// Rects covering every texture coordinate added, merged into at most
+// MAX_DIRTY_UV_RECTS by growing their area the least, like MeshletRanges
+// merges draw ranges.
+class UvRects {
+ public:
+  void clear() { rect_count = 0; }
+
+  void add(const UvRect& rect) {
+    if (rect.empty()) {
+      return;
+    }
+
+    // Merged with a rect when that covers no more than both do apart. The
+    // merged rect may then be merged with others in turn.
+    for (size_t i = 0; i < rect_count; i++) {
+      auto merged_rect = mergeUvRects(rects[i], rect);
+      if (merged_rect.getArea() <= rects[i].getArea() + rect.getArea()) {
+        rects[i] = rects[rect_count - 1];
+        rect_count--;
+        add(merged_rect);
+        return;
+      }
+    }
+
+    rects[rect_count] = rect;
+    rect_count++;
+    if (rect_count <= MAX_DIRTY_UV_RECTS) {
+      return;
+    }
+
+    size_t merged_a = 0;
+    size_t merged_b = 1;
+    float smallest_growth = std::numeric_limits<float>::max();
+    for (size_t a = 0; a < rect_count; a++) {
+      for (size_t b = a + 1; b < rect_count; b++) {
+        float growth = mergeUvRects(rects[a], rects[b]).getArea() -
+                       rects[a].getArea() - rects[b].getArea();
+        if (growth < smallest_growth) {
+          smallest_growth = growth;
+          merged_a = a;
+          merged_b = b;
+        }
+      }
+    }
+
+    rects[merged_a] = mergeUvRects(rects[merged_a], rects[merged_b]);
+    rects[merged_b] = rects[rect_count - 1];
+    rect_count--;
+  }
+
+  void merge(const UvRects& other) {
+    for (const auto& rect : other.get()) {
+      add(rect);
+    }
+  }
+
+  std::span<const UvRect> get() const { return {rects.data(), rect_count}; }
+  bool empty() const { return rect_count == 0; }
+
+ private:
+  std::array<UvRect, MAX_DIRTY_UV_RECTS + 1> rects;
+  size_t rect_count = 0;
+};
+
+// Bounds of the rects added, per cell of a grid over the texture
+// coordinates their centers are in. Adding is constant time, unlike adding
+// to UvRects, so that many small rects can be gathered before merging the
+// bounds of each cell into UvRects.
+class UvRectGrid {
+ public:
+  void add(const UvRect& rect) {
+    if (rect.empty()) {
+      return;
+    }
+
+    glm::ivec2 cell = glm::clamp(
+        glm::ivec2(glm::floor((rect.min + rect.max) * 0.5f *
+                              static_cast<float>(UV_RECT_GRID_SIZE))),
+        glm::ivec2(0), glm::ivec2(UV_RECT_GRID_SIZE - 1));
+    auto& cell_rect = cell_rects[cell.y * UV_RECT_GRID_SIZE + cell.x];
+    cell_rect = mergeUvRects(cell_rect, rect);
+  }
+
+  void addTo(UvRects& uv_rects) const {
+    for (const auto& cell_rect : cell_rects) {
+      uv_rects.add(cell_rect);
+    }
+  }
+
+ private:
+  std::array<UvRect, UV_RECT_GRID_SIZE * UV_RECT_GRID_SIZE> cell_rects;
+};
+
+using TexelRects = std::array<TexelRect, MAX_DIRTY_UV_RECTS>;
+
+// Non-empty texel rects of mip `level` covering `uv_rects`, or the whole level
+// once they would add up to as many texels. Returns the number written to
+// `texel_rects`.
+inline size_t getDirtyTexelRects(const UvRects& uv_rects,
+                                 const glm::ivec2& size, int level,
+                                 TexelRects& texel_rects) {
+  glm::ivec2 level_size = getMipSize(size, level);
+  size_t texel_rect_count = 0;
+  int texel_count = 0;
+  for (const auto& uv_rect : uv_rects.get()) {
+    auto texel_rect = getTexelRect(uv_rect, size, level);
+    if (texel_rect.getArea() <= 0) {
+      continue;
+    }
+
+    texel_rects[texel_rect_count++] = texel_rect;
+    texel_count += texel_rect.getArea();
+  }
+
+  if (texel_count >= level_size.x * level_size.y) {
+    texel_rects[0] = {glm::ivec2(0), level_size};
+    return 1;
+  }
+
+  return texel_rect_count;
+}
@@ -0,0 +1,186 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "./Component/GrGeometryComponent.h"
+#include "./Component/SharedGeometryComponent.h"
+#include "./EntityRegistry.h"
+#include "./TransformHierarchy.h"
+#include "./constants.h"
+
+// Parts sharing one geometry, drawn with a single instanced call. A batch may
+// be empty after its parts were removed, and is then reused by the next part.
+struct InstanceBatch {
+  std::reference_wrapper<GrGeometryComponent> gr_geometry_component;
+  std::vector<EntityHandle> part_handles;
+};
+
+// Batches of at most `max_batch_size` parts, updated one part at a time.
+// Handle storage is reserved per batch, so adding parts never reallocates it.
+// Lookups are flat vectors rather than maps, which would allocate a node per
+// part inserted.
+class InstanceBatchList {
+ public:
+  explicit InstanceBatchList(size_t max_batch_size)
+      : max_batch_size(max_batch_size) {}
+
+  void insert(EntityHandle part_handle,
+              GrGeometryComponent& gr_geometry_component) {
+    size_t batch_index = findOpenBatch(gr_geometry_component);
+    if (batch_index == NO_BATCH) {
+      batch_index = allocateBatch(gr_geometry_component);
+    }
+
+    batches[batch_index].part_handles.push_back(part_handle);
+
+    if (part_handle.index >= batch_index_by_part.size()) {
+      batch_index_by_part.resize(part_handle.index + 1, NO_BATCH);
+    }
+    batch_index_by_part[part_handle.index] = batch_index;
+  }
+
+  void erase(EntityHandle part_handle) {
+    if (part_handle.index >= batch_index_by_part.size() ||
+        batch_index_by_part[part_handle.index] == NO_BATCH) {
+      return;
+    }
+
+    auto batch_index = batch_index_by_part[part_handle.index];
+    auto& batch = batches[batch_index];
+    batch_index_by_part[part_handle.index] = NO_BATCH;
+
+    auto handle_it = std::find(batch.part_handles.begin(),
+                               batch.part_handles.end(), part_handle);
+    *handle_it = batch.part_handles.back();
+    batch.part_handles.pop_back();
+
+    // The geometry may be released once its last part is gone
+    if (batch.part_handles.empty()) {
+      free_batch_indices.push_back(batch_index);
+    }
+  }
+
+  std::vector<InstanceBatch> batches;
+
+ private:
+  static constexpr size_t NO_BATCH = SIZE_MAX;
+
+  // Scanning costs a pointer comparison per batch, while a map from geometry
+  // to batches would allocate. Empty batches are skipped, as their geometry
+  // may be gone.
+  size_t findOpenBatch(const GrGeometryComponent& gr_geometry_component) {
+    for (size_t i = 0; i < batches.size(); i++) {
+      const auto& batch = batches[i];
+      if (!batch.part_handles.empty() &&
+          batch.part_handles.size() < max_batch_size &&
+          &batch.gr_geometry_component.get() == &gr_geometry_component) {
+        return i;
+      }
+    }
+    return NO_BATCH;
+  }
+
+  size_t allocateBatch(GrGeometryComponent& gr_geometry_component) {
+    if (!free_batch_indices.empty()) {
+      auto batch_index = free_batch_indices.back();
+      free_batch_indices.pop_back();
+      batches[batch_index].gr_geometry_component =
+          std::ref(gr_geometry_component);
+      return batch_index;
+    }
+
+    batches.push_back({
+        .gr_geometry_component = std::ref(gr_geometry_component),
+        .part_handles = {},
+    });
+    batches.back().part_handles.reserve(max_batch_size);
+    return batches.size() - 1;
+  }
+
+  size_t max_batch_size;
+  // Indexed by handle index, which is unique among live entities
+  std::vector<size_t> batch_index_by_part;
+  std::vector<size_t> free_batch_indices;
+};
+
+// Instance batches of the parts in a part registry. Instead of being rebuilt
+// when the paintable changes, the view follows parts as they are created and
+// destroyed.
+class InstanceBatchesView {
+ public:
+  InstanceBatchesView(
+      std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+      std::reference_wrapper<EntityRegistry> part_registry)
+      : transform_hierarchy(transform_hierarchy),
+        part_registry(part_registry),
+        // The render pass samples a painted map per instance, the brush depth
+        // pass only needs the model matrices
+        render_batches(MAX_PAINTED_MAP_INSTANCES),
+        depth_batches(MAX_INSTANCES_PER_DRAW) {
+    part_registry.get().query<SharedGeometryComponent>().each(
+        [this](EntityHandle part_handle,
+               SharedGeometryComponent& shared_geometry_component) {
+          insertPart(part_handle, shared_geometry_component);
+        });
+
+    subscription_id = part_registry.get().subscribe<SharedGeometryComponent>(
+        [this](EntityHandle part_handle) {
+          insertPart(part_handle,
+                     this->part_registry.get().get<SharedGeometryComponent>(
+                         part_handle));
+        },
+        [this](EntityHandle part_handle) {
+          render_batches.erase(part_handle);
+          depth_batches.erase(part_handle);
+        });
+  }
+
+  ~InstanceBatchesView() { part_registry.get().unsubscribe(subscription_id); }
+
+  // The subscription refers to this view
+  InstanceBatchesView(const InstanceBatchesView&) = delete;
+  InstanceBatchesView& operator=(const InstanceBatchesView&) = delete;
+
+  // Holds the world matrices of the parts
+  std::reference_wrapper<TransformHierarchy> transform_hierarchy;
+  std::reference_wrapper<EntityRegistry> part_registry;
+  InstanceBatchList render_batches;
+  InstanceBatchList depth_batches;
+
+ private:
+  void insertPart(EntityHandle part_handle,
+                  SharedGeometryComponent& shared_geometry_component) {
+    auto& gr_geometry_component =
+        *shared_geometry_component.gr_geometry_component;
+    render_batches.insert(part_handle, gr_geometry_component);
+    depth_batches.insert(part_handle, gr_geometry_component);
+  }
+
+  size_t subscription_id;
+};
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+// Counts allocations made through operator new, so that the stress test and
+// tools/frame_allocation_check can check that steady frames do not touch the
+// heap, and the bytes they hold, for tools/mesh_import_benchmark to measure
+// peak memory. Memory allocated with malloc directly is not counted.
+//
+// Replacing operator new is only compiled in builds defining
+// SIENNA_ALLOCATION_COUNTER, see the `stress` preset; other builds count
+// nothing.
+namespace allocation_counter {
+
+bool isCounting();
+
+size_t getAllocationCount();
+
+// Bytes allocated and not yet deleted
+size_t getLiveBytes();
+
+// Highest live bytes since the last call to resetPeakBytes
+size_t getPeakBytes();
+void resetPeakBytes();
+
+}  // namespace allocation_counter
@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./MeshletSet.h"
+#include "./TriangleBvh.h"
+
+// Binary pack of paintables whose geometry is stored in GPU layout, so that it
+// is uploaded straight from the mapped or fetched file instead of being parsed
+// into a GeometryComponent first.
+//
+// The file is a header, a section table and sections aligned to
+// SECTION_ALIGNMENT. Sections of one kind hold the arrays of every part, each
+// array starting at a multiple of ARRAY_ALIGNMENT, and parts refer to them by
+// byte offset within the section. Numbers are little endian, as in WebAssembly
+// and on the platforms the converter runs on.
+namespace asset_pack {
+
+constexpr uint32_t MAGIC = 0x4B504E53;  // "SNPK"
+constexpr uint32_t VERSION = 2;
+constexpr size_t SECTION_ALIGNMENT = 64;
+constexpr size_t ARRAY_ALIGNMENT = 16;
+constexpr uint64_t NO_PAINTED_MAP = UINT64_MAX;
+
+enum class SectionType : uint32_t {
+  PAINTABLES,
+  PARTS,
+  TRANSFORMS,
+  VERTICES,
+  INDICES,
+  BVH_NODES,
+  BVH_TRIANGLE_BLOCKS,
+  BVH_TRIANGLE_INDICES,
+  PAINTED_MAPS,
+  STRINGS,
+  MESHLETS,
+  COUNT,
+};
+
+struct PackHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t section_count;
+  uint32_t reserved;
+  uint64_t file_size;
+};
+
+struct PackSection {
+  SectionType type;
+  uint32_t reserved;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct PackTransform {
+  float scale[3];
+  // x, y, z, w
+  float rotation[4];
+  float translation[3];
+};
+
+struct PackPaintable {
+  uint32_t transform_index;
+  uint32_t first_part;
+  uint32_t part_count;
+  uint32_t reserved;
+};
+
+struct PackPart {
+  uint32_t transform_index;
+  uint32_t painted_map_size;
+  uint32_t name_offset;
+  uint32_t name_size;
+
+  uint64_t vertex_offset;
+  uint64_t vertex_count;
+  uint64_t index_offset;
+  uint64_t index_count;
+  // 2 or 4 bytes, see getIndexSize
+  uint32_t index_size;
+  // Zero when the pack has no BVH for the part, which then gets built
+  uint32_t bvh_node_count;
+
+  uint64_t bvh_node_offset;
+  uint64_t bvh_triangle_block_offset;
+  uint64_t bvh_triangle_block_count;
+  uint64_t bvh_triangle_index_offset;
+  uint64_t bvh_triangle_count;
+  // RGBA half floats of painted_map_size squared pixels, or NO_PAINTED_MAP
+  uint64_t painted_map_offset;
+  // Zero when the pack has no meshlets for the part, which then get built
+  uint64_t meshlet_offset;
+  uint64_t meshlet_count;
+};
+
+// A pack in memory. Every accessor returns spans into the pack, which stay
+// valid as long as the pack does.
+class AssetPack {
+ public:
+  // Throws std::runtime_error if the header, the section table or any part
+  // refers outside of `bytes` or to misaligned arrays, if a part asks for a
+  // painted map size out of range, or has 16 bit indices with more vertices
+  // than getIndexSize allows. `storage` owns the memory of `bytes`.
+  AssetPack(std::span<const char> bytes, std::shared_ptr<const void> storage);
+
+  // Memory maps the file, native tools only
+  static std::shared_ptr<const AssetPack> open(const std::string& path);
+  // Takes over `bytes`, which are only copied if they are not aligned enough
+  static std::shared_ptr<const AssetPack> fromBytes(std::vector<char>&& bytes);
+
+  std::span<const PackPaintable> getPaintables() const { return paintables; }
+  std::span<const PackPart> getParts() const { return parts; }
+  const PackTransform& getTransform(uint32_t transform_index) const;
+  std::string_view getPartName(size_t part_index) const;
+
+  GeometryView getGeometryView(size_t part_index) const;
+  std::optional<TriangleBvhData> getBvhData(size_t part_index) const;
+  // Empty when the part has no stored meshlets
+  std::span<const Meshlet> getMeshlets(size_t part_index) const;
+  // Empty when the part has no baked painted map
+  std::span<const char> getPaintedMap(size_t part_index) const;
+
+  size_t getSize() const { return bytes.size(); }
+
+ private:
+  template <typename T>
+  std::span<const T> getArray(SectionType type, uint64_t offset,
+                              uint64_t count) const;
+  // Every element of the section
+  template <typename T>
+  std::span<const T> getTable(SectionType type) const;
+
+  std::span<const char> bytes;
+  std::shared_ptr<const void> storage;
+  std::span<const char> sections[static_cast<size_t>(SectionType::COUNT)];
+  std::span<const PackPaintable> paintables;
+  std::span<const PackPart> parts;
+  std::span<const PackTransform> transforms;
+};
+
+struct PartSource {
+  std::string name;
+  GeometryView geometry;
+  // Null to leave the BVH out of the pack, trading load time for size
+  const TriangleBvh* bvh = nullptr;
+  // Null to leave the meshlets out, building them on load instead
+  const MeshletSet* meshlets = nullptr;
+  PackTransform transform;
+  // 0, or within [MIN_PAINTED_MAP_SIZE, MAX_PAINTED_MAP_SIZE]. Baked maps
+  // need a size.
+  int painted_map_size = 0;
+  // RGBA half floats of painted_map_size squared pixels, or empty
+  std::span<const char> painted_map;
+};
+
+struct PaintableSource {
+  PackTransform transform;
+  std::vector<PartSource> parts;
+};
+
+// Writes a pack, narrowing indices to 16 bits where they fit. Throws
+// std::invalid_argument if a painted map size is out of range, or a painted
+// map does not match its size.
+std::vector<char> buildAssetPack(
+    const std::vector<PaintableSource>& paintables);
+
+// Whether `file_name` has the .snpk extension, case insensitive
+bool isAssetPackFile(std::string_view file_name);
+
+}  // namespace asset_pack
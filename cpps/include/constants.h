@@ -24,5 +24,70 @@
 
 #pragma once
 
+#include <cstddef>
+
 inline const int BRUSH_DEPTH_TEXTURE_WIDTH = 1024;
 inline const int BRUSH_DEPTH_TEXTURE_HEIGHT = 1024;
+
+inline const int DEFAULT_PAINTED_MAP_SIZE = 800;
+inline const int MIN_PAINTED_MAP_SIZE = 64;
+// Every WebGL 2 implementation supports textures this large
+inline const int MAX_PAINTED_MAP_SIZE = 4096;
+
+// Texels per unit of length in the painted maps of imported meshes, once they
+// are scaled to the size of the SPHERE preset: as many texels as the preset's
+// painted map has, spread evenly over the sphere
+inline const float MESH_TEXEL_DENSITY = 450.0f;
+// Empty texels around UV charts, so that filtering does not blend them
+inline const int UV_ATLAS_PADDING_TEXELS = 2;
+
+inline const unsigned long GR_RESOURCE_RELEASE_DELAY_FRAMES = 3;
+inline const unsigned long GR_RESOURCE_POOL_EXPIRY_FRAMES = 600;
+
+// CPU time a model switch may spend building parts within one frame
+inline const double MODEL_SWITCH_FRAME_BUDGET_MS = 4.0;
+
+inline const unsigned long GEOMETRY_CACHE_EXPIRY_FRAMES = 600;
+
+// Triangles per meshlet, the unit the brush passes cull geometry by, see
+// MeshletSet
+inline const size_t MESHLET_TRIANGLE_COUNT = 128;
+// Draw calls per part and pass the selected meshlets are merged into
+inline const size_t MAX_MESHLET_DRAW_RANGES = 16;
+// Rects per part the texture coordinates painted in a frame are merged into,
+// see UvRects
+inline const size_t MAX_DIRTY_UV_RECTS = 8;
+// Cells per side of the grid the rects painted by a part's meshlets are
+// gathered in before merging them, see UvRectGrid
+inline const int UV_RECT_GRID_SIZE = 8;
+// Share of the painted map above which a meshlet is tested against the brush
+// by triangle group to find what it paints, instead of taking the meshlet's
+// UV bounds, and above which the triangles of a group are clipped to the
+// brush. Coarse meshes, e.g. the one quad of the PLANE preset, would
+// otherwise mark most of their painted maps as painted.
+inline const float MAX_UNCLIPPED_MESHLET_UV_AREA = 1.0f / 256.0f;
+// Triangles per group such meshlets are split into, see TriangleGroup
+inline const size_t TRIANGLE_GROUP_TRIANGLE_COUNT = 16;
+
+// Entries of the FIFO post-transform vertex cache mesh_optimizer orders
+// triangles for and measures the cache miss ratio with
+inline const size_t VERTEX_CACHE_SIZE = 16;
+
+// Length of the model and normal matrix arrays in InstanceBlock. 128 mat4s
+// and 128 mat3s, padded by std140 to 48 bytes each, stay below the 16 KB
+// uniform block size every WebGL 2 implementation supports.
+inline const int MAX_INSTANCES_PER_DRAW = 128;
+// Instanced draws select each instance's painted map from a sampler array,
+// which GLSL ES 3.00 only allows to index with constants, so batches sampling
+// painted maps are limited by the available texture units
+inline const int MAX_PAINTED_MAP_INSTANCES = 8;
+
+// Length of the light array in LightingBlock
+inline const int MAX_LIGHTS = 8;
+
+// CPU systems run concurrently on at most this many workers, see
+// SystemScheduler
+inline const size_t MAX_JOB_WORKER_COUNT = 4;
+
+// Initial size of the per-frame arena, see frame_arena.h
+inline const size_t FRAME_ARENA_INITIAL_BYTES = 64 * 1024;
@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Bump allocator for data that only lives until the end of the frame. The
+// arena is reset at the start of every frame; allocations that do not fit
+// get an overflow block, and the arena grows to fit them at the next reset,
+// so that a steady frame stops touching the heap after a few frames.
+//
+// Only use it from the thread running the main loop. Memory may be shared
+// with jobs that finish within the allocating scope.
+namespace frame_arena {
+
+// Invalidates every allocation. Call at the start of every frame.
+void reset();
+
+void* allocate(size_t size, size_t alignment);
+
+// Bytes reserved by the arena, including overflow blocks
+size_t getCapacityBytes();
+
+// Fixed-capacity array in the frame arena. Elements are never destroyed.
+template <typename T>
+class FrameVector {
+  static_assert(std::is_trivially_destructible_v<T>,
+                "Frame arena memory is released without destructors");
+
+ public:
+  explicit FrameVector(size_t capacity)
+      : elements(static_cast<T*>(allocate(sizeof(T) * capacity, alignof(T)))),
+        capacity(capacity),
+        element_count(0) {}
+
+  void push_back(const T& element) {
+    if (element_count == capacity) {
+      throw std::length_error("FrameVector is full");
+    }
+    new (elements + element_count) T(element);
+    element_count++;
+  }
+
+  T& operator[](size_t index) { return elements[index]; }
+  const T& operator[](size_t index) const { return elements[index]; }
+
+  T* data() { return elements; }
+  size_t size() const { return element_count; }
+
+  std::span<T> span() { return {elements, element_count}; }
+  std::span<const T> span() const { return {elements, element_count}; }
+
+ private:
+  T* elements;
+  size_t capacity;
+  size_t element_count;
+};
+
+}  // namespace frame_arena
@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "./Component/GeometryComponent.h"
+#include "./Component/SharedGeometryComponent.h"
+#include "./asset_pack.h"
+
+struct GeometryCacheStats {
+  size_t entry_count;
+  size_t hit_count;
+  size_t miss_count;
+  // Bytes the parts sharing a geometry would otherwise hold on the GPU
+  size_t gpu_bytes_saved;
+  // Generation and upload time spent once instead of once per hit
+  double ms_avoided;
+};
+
+// Shares immutable geometry between every part that uses it, keyed by preset
+// and segments, by content hash for geometry that was built elsewhere, or by
+// asset pack and part.
+// The returned components must not be modified; per-part differences belong
+// in the transform.
+//
+// The cache keeps its own reference, so that switching back to a model does
+// not regenerate its geometry. Entries nobody else references are dropped
+// after GEOMETRY_CACHE_EXPIRY_FRAMES, handing their buffers to
+// gr_resource_pool.
+//
+// Generated and imported geometry is reordered by mesh_optimizer, and every
+// entry gets its MeshletSet along with its BVH.
+//
+// Geometry is uploaded by gr_sync_system; a GrGeometryComponent with a zero
+// vao_id has not been uploaded yet.
+namespace geometry_cache {
+
+// Imported geometry reordered by mesh_optimizer, with its BVH and meshlets
+struct BuiltGeometry {
+  std::shared_ptr<GeometryComponent> geometry_component;
+  std::shared_ptr<TriangleBvh> bvh;
+  std::shared_ptr<MeshletSet> meshlets;
+  uint64_t hash;
+  double generate_ms;
+};
+
+// Builds the entry of imported geometry without touching the cache, so that
+// it can run on a worker while the main thread keeps rendering
+BuiltGeometry build(GeometryComponent&& geometry_component);
+
+SharedGeometryComponent acquire(GeometryPreset preset, int width_segments,
+                                int height_segments);
+// Shares imported geometry built by build(), or the entry of the same content
+// if there is one, dropping the new build
+SharedGeometryComponent acquire(BuiltGeometry&& built_geometry);
+// Geometry is read from the pack in place, which the entry keeps alive. The
+// stored BVH is used when the pack has one.
+SharedGeometryComponent acquire(
+    std::shared_ptr<const asset_pack::AssetPack> asset_pack,
+    size_t part_index);
+
+// Advances the frame counter and drops expired entries. Call once per frame.
+void collect();
+
+// Drops every entry nobody else references
+void trim();
+
+GeometryCacheStats getStats();
+
+}  // namespace geometry_cache
@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+
+#include "./Component/GrTextureComponent.h"
+
+struct GrPooledGeometry {
+  unsigned int vao_id;
+  unsigned int vbo_id;
+  unsigned int ebo_id;
+};
+
+// Recycles GL objects of destroyed Gr* components, so that replacing an entity
+// with one of the same shape (e.g. switching models) does not delete and
+// recreate every texture, framebuffer and buffer.
+//
+// Released objects stay pending for GR_RESOURCE_RELEASE_DELAY_FRAMES before
+// they can be acquired again, and are deleted once they have been idle for
+// GR_RESOURCE_POOL_EXPIRY_FRAMES. Recycled objects keep their previous
+// contents; callers are responsible for clearing them.
+namespace gr_resource_pool {
+
+// Advances the frame counter, promotes pending objects and deletes expired
+// ones. Call once per frame.
+void collect();
+
+// Deletes every pooled object right away, including pending ones
+void trim();
+
+// Bytes held by pending and idle objects
+size_t getIdleBytes();
+
+std::optional<unsigned int> acquireTexture(TextureType texture_type, int width,
+                                           int height, int level_count);
+void releaseTexture(unsigned int texture_id, TextureType texture_type,
+                    int width, int height, int level_count);
+
+// Framebuffers are pooled together with the texture they are attached to
+std::optional<unsigned int> acquireFramebuffer(unsigned int texture_id);
+void releaseFramebuffer(unsigned int framebuffer_id, unsigned int texture_id);
+
+std::optional<GrPooledGeometry> acquireGeometry(size_t vertex_buffer_size,
+                                                size_t index_buffer_size);
+void releaseGeometry(const GrPooledGeometry& geometry,
+                     size_t vertex_buffer_size, size_t index_buffer_size);
+
+std::optional<unsigned int> acquireUniformBuffer();
+void releaseUniformBuffer(unsigned int uniform_buffer_id);
+
+}  // namespace gr_resource_pool
@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+enum class GrResourceCategory {
+  TEXTURE = 0,
+  FRAMEBUFFER = 1,
+  VERTEX_ARRAY = 2,
+  VERTEX_BUFFER = 3,
+  INDEX_BUFFER = 4,
+  UNIFORM_BUFFER = 5,
+};
+
+inline const int GR_RESOURCE_CATEGORY_COUNT = 6;
+
+enum class GrMemoryBudgetPolicy { LOG = 0, DOWNSCALE = 1, REFUSE = 2 };
+
+struct GrResourceCategoryStats {
+  size_t count;
+  size_t bytes;
+};
+
+// Keeps track of every GL object created by the Gr* components, so that the
+// GPU memory of the scene can be inspected and kept under a budget. GL objects
+// are keyed by their category and name, since names are only unique per type.
+namespace gr_resource_registry {
+
+void registerResource(GrResourceCategory category, unsigned int gl_id,
+                      size_t bytes);
+
+void resizeResource(GrResourceCategory category, unsigned int gl_id,
+                    size_t bytes);
+
+void unregisterResource(GrResourceCategory category, unsigned int gl_id);
+
+// Moves an already registered resource to another owner, or to the current
+// owner if none is given
+void assignResource(GrResourceCategory category, unsigned int gl_id,
+                    const char* owner = nullptr);
+
+size_t getLiveBytes();
+
+size_t getPeakBytes();
+
+void resetPeakBytes();
+
+GrResourceCategoryStats getCategoryStats(GrResourceCategory category);
+
+size_t getOwnerBytes(const std::string& owner);
+
+const std::unordered_map<std::string, size_t>& getOwnerBytesMap();
+
+size_t getBudgetBytes();
+
+GrMemoryBudgetPolicy getBudgetPolicy();
+
+void setBudget(size_t budget_bytes, GrMemoryBudgetPolicy policy);
+
+// Attributes the resources registered during its lifetime to `owner`, which is
+// usually the name of the entity creating them
+class OwnerScope {
+ public:
+  OwnerScope(const char* owner);
+  ~OwnerScope();
+
+ private:
+  const char* prev_owner;
+};
+
+}  // namespace gr_resource_registry
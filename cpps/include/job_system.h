@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+// Work-stealing job pool. Every worker owns a queue it takes its newest job
+// from, and steals the oldest job of another queue when its own is empty.
+// Threads waiting on jobs run queued jobs meanwhile, so jobs may submit and
+// wait on other jobs.
+//
+// In WASM builds without -pthread, or when no workers were started, jobs run
+// on the thread submitting them.
+namespace job_system {
+
+// Starts up to `max_worker_count` workers, leaving one hardware thread for
+// the caller. Does nothing if workers are already running.
+void init(size_t max_worker_count);
+
+// Waits for the workers to finish queued jobs and stops them
+void shutdown();
+
+size_t getWorkerCount();
+
+// Jobs may run in any order and on any worker
+void submit(std::function<void()> job);
+
+// Runs `job` on a worker once it has no other job to run, for long work that
+// must not hold up the caller. Unlike submit, threads waiting on jobs never
+// pick it up, so a frame waiting on its own jobs is not stalled by it.
+// Without workers it runs on the calling thread.
+void submitBackground(std::function<void()> job);
+
+// Runs one queued job on the calling thread. Returns false if there was none.
+bool runPendingJob();
+
+// Jobs that can be waited on together
+class JobGroup {
+ public:
+  JobGroup() = default;
+  JobGroup(const JobGroup&) = delete;
+  JobGroup& operator=(const JobGroup&) = delete;
+  ~JobGroup() { wait(); }
+
+  void run(std::function<void()> job);
+
+  // Returns once every job of the group has finished, running queued jobs
+  // while waiting
+  void wait();
+
+ private:
+  std::atomic<size_t> pending_count = 0;
+};
+
+// Calls `function(chunk_begin, chunk_end)` over chunks of [begin, end) of at
+// least `grain_size` items, on the workers and the calling thread. Returns
+// once every chunk is done.
+template <typename Function>
+void parallelFor(size_t begin, size_t end, size_t grain_size,
+                 Function&& function) {
+  if (begin >= end) {
+    return;
+  }
+
+  // Without workers the chunks would all run here anyway, so skip wrapping
+  // them into jobs
+  if (getWorkerCount() == 0) {
+    function(begin, end);
+    return;
+  }
+
+  // A few chunks per thread, so that stealing can even out uneven chunks
+  size_t item_count = end - begin;
+  size_t max_chunk_count = (getWorkerCount() + 1) * 4;
+  size_t chunk_count = std::clamp(item_count / std::max(grain_size, size_t(1)),
+                                  size_t(1), max_chunk_count);
+
+  if (chunk_count == 1) {
+    function(begin, end);
+    return;
+  }
+
+  size_t chunk_size = (item_count + chunk_count - 1) / chunk_count;
+
+  JobGroup job_group;
+  for (size_t chunk_begin = begin + chunk_size; chunk_begin < end;
+       chunk_begin += chunk_size) {
+    size_t chunk_end = std::min(chunk_begin + chunk_size, end);
+    job_group.run([&function, chunk_begin, chunk_end] {
+      function(chunk_begin, chunk_end);
+    });
+  }
+
+  function(begin, std::min(begin + chunk_size, end));
+  job_group.wait();
+}
+
+}  // namespace job_system
@@ -24,10 +24,23 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <optional>
 
+// Matrices composed on the CPU, e.g. by TransformHierarchy. glm only uses SIMD
+// for aligned types, which exist when it is built with GLM_FORCE_INTRINSICS, as
+// the SIENNA_SIMD flavor does. Both have the layout of glm::mat4.
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+#include <glm/gtc/type_aligned.hpp>
+typedef glm::aligned_mat4 SimdMat4;
+#else
+typedef glm::mat4 SimdMat4;
+#endif
+
 inline glm::vec3 getPositionOnSphere(float radius, float phi, float theta) {
   return glm::vec3(radius * std::sin(phi) * std::sin(theta),
                    radius * std::cos(phi),
@@ -46,14 +59,21 @@ inline glm::vec3 getRightOnSphere(float phi, float theta) {
 inline glm::mat4x4 getTransformMatrix(const glm::vec3& scale,
                                       const glm::quat& rotation,
                                       const glm::vec3& translation) {
-  // Order matters: scale -> rotate -> translate
-  // Due to right multiplication of matrices
-  glm::mat4 model_matrix = glm::mat4(1.0f);
-  model_matrix = glm::translate(model_matrix, translation);
-  model_matrix = model_matrix * glm::mat4_cast(rotation);
-  model_matrix = glm::scale(model_matrix, scale);
-
-  return model_matrix;
+  // Same as translate * rotate * scale, written out instead of multiplying
+  // three matrices: the rotation columns are scaled, and the translation is
+  // the last column
+  glm::mat3 rotation_matrix = glm::mat3_cast(rotation);
+
+  return glm::mat4(glm::vec4(rotation_matrix[0] * scale.x, 0.0f),
+                   glm::vec4(rotation_matrix[1] * scale.y, 0.0f),
+                   glm::vec4(rotation_matrix[2] * scale.z, 0.0f),
+                   glm::vec4(translation, 1.0f));
+}
+
+// Transforms normals as `matrix` transforms positions, even when it scales
+// non-uniformly. The columns are padded to vec4s, as std140 lays out a mat3.
+inline glm::mat3x4 getNormalMatrix(const glm::mat4& matrix) {
+  return glm::mat3x4(glm::transpose(glm::inverse(glm::mat3(matrix))));
 }
 
 struct RayIntersectionResultSet {
@@ -64,21 +84,27 @@ struct RayIntersectionResultSet {
 
 typedef std::optional<RayIntersectionResultSet> RayIntersectionResult;
 
-inline RayIntersectionResult getRayIntersectionDistance(
-    const glm::vec3& ray_origin, const glm::vec3& ray_direction,
-    const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
-  const float EPSILON = 1e-04f;
+// Shared with the vectorized tests of ray_kernels, which must agree with
+// getRayIntersectionDistance
+const float RAY_INTERSECTION_EPSILON = 1e-04f;
 
-  // Find vectors for two edges sharing v0
-  glm::vec3 edge1 = v1 - v0;
-  glm::vec3 edge2 = v2 - v0;
+// Same as getRayIntersectionDistance, for a triangle given by v0 and the two
+// edges sharing it, as stored by ray_kernels
+inline RayIntersectionResult getRayEdgesIntersectionDistance(
+    const glm::vec3& ray_origin, const glm::vec3& ray_direction,
+    const glm::vec3& v0, const glm::vec3& edge1, const glm::vec3& edge2) {
+  const float EPSILON = RAY_INTERSECTION_EPSILON;
 
   // Begin calculating determinant - also used to calculate `u` parameter
   glm::vec3 h = glm::cross(ray_direction, edge2);
   float a = glm::dot(edge1, h);
 
-  // If determinant is near zero, ray is parallel to the triangle plane
-  if (a > -EPSILON && a < EPSILON) return std::nullopt;
+  // If determinant is near zero, ray is parallel to the triangle plane. The
+  // determinant scales with the edges, so it is compared relative to them, or
+  // small triangles of dense meshes would all count as parallel.
+  if (a * a <= EPSILON * EPSILON * glm::dot(edge1, edge1) * glm::dot(h, h)) {
+    return std::nullopt;
+  }
 
   // Calculate the inverse of the determinant
   float f = 1.0f / a;
@@ -102,6 +128,35 @@ inline RayIntersectionResult getRayIntersectionDistance(
   return RayIntersectionResultSet{t, u, v};
 }
 
+inline RayIntersectionResult getRayIntersectionDistance(
+    const glm::vec3& ray_origin, const glm::vec3& ray_direction,
+    const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2) {
+  // Find vectors for two edges sharing v0
+  return getRayEdgesIntersectionDistance(ray_origin, ray_direction, v0,
+                                         v1 - v0, v2 - v0);
+}
+
+// Distance at which the ray enters the box, 0 if it starts inside, or nothing
+// if it misses the box before `max_distance`. Takes the inverse of the ray
+// direction, whose zero components give infinities.
+inline std::optional<float> getRayBoxDistance(
+    const glm::vec3& ray_origin, const glm::vec3& inverse_direction,
+    const glm::vec3& box_min, const glm::vec3& box_max, float max_distance) {
+  glm::vec3 t0 = (box_min - ray_origin) * inverse_direction;
+  glm::vec3 t1 = (box_max - ray_origin) * inverse_direction;
+  glm::vec3 t_min = glm::min(t0, t1);
+  glm::vec3 t_max = glm::max(t0, t1);
+
+  float t_enter = std::max(std::max(t_min.x, t_min.y), std::max(t_min.z, 0.0f));
+  float t_exit =
+      std::min(std::min(t_max.x, t_max.y), std::min(t_max.z, max_distance));
+
+  if (t_enter > t_exit) {
+    return std::nullopt;
+  }
+  return t_enter;
+}
+
 inline glm::vec3 getRayDirectionFromScreen(const glm::vec2& screen_position,
                                            const glm::vec2& canvas_size,
                                            float fovy,
@@ -130,3 +185,59 @@ inline glm::mat4 getRayViewMatrix(const glm::vec3& ray_origin,
 
   return glm::lookAt(ray_origin, ray_origin + ray_direction, up);
 }
+
+struct BoundingSphere {
+  glm::vec3 center;
+  float radius;
+};
+
+// Smallest sphere containing both spheres
+inline BoundingSphere mergeBoundingSpheres(const BoundingSphere& a,
+                                           const BoundingSphere& b) {
+  glm::vec3 offset = b.center - a.center;
+  float distance = glm::length(offset);
+
+  if (distance + b.radius <= a.radius) {
+    return a;
+  }
+  if (distance + a.radius <= b.radius) {
+    return b;
+  }
+
+  float radius = (distance + a.radius + b.radius) * 0.5f;
+  return {a.center + offset * ((radius - a.radius) / distance), radius};
+}
+
+// Sphere containing `sphere` transformed by `matrix`, which may scale
+// non-uniformly
+inline BoundingSphere transformBoundingSphere(const BoundingSphere& sphere,
+                                              const glm::mat4& matrix) {
+  float max_scale = std::max({glm::length(glm::vec3(matrix[0])),
+                              glm::length(glm::vec3(matrix[1])),
+                              glm::length(glm::vec3(matrix[2]))});
+
+  return {glm::vec3(matrix * glm::vec4(sphere.center, 1.0f)),
+          sphere.radius * max_scale};
+}
+
+// Half angle of the cone around a square frustum, whose corners are the
+// farthest from the axis
+inline float getFrustumConeHalfAngle(float fov) {
+  return std::atan(std::sqrt(2.0f) * std::tan(fov / 2.0f));
+}
+
+// Whether the sphere touches the infinite cone at `apex` around the unit
+// vector `axis`. Conservative behind the apex, where it may return true for
+// spheres close to it.
+inline bool isSphereInCone(const BoundingSphere& sphere, const glm::vec3& apex,
+                           const glm::vec3& axis, float half_angle) {
+  glm::vec3 offset = sphere.center - apex;
+  float axial_distance = glm::dot(offset, axis);
+  float radial_distance = glm::length(offset - axis * axial_distance);
+
+  // Distance from the center to the cone surface, negative inside the cone
+  float distance = std::cos(half_angle) * radial_distance -
+                   std::sin(half_angle) * axial_distance;
+
+  return distance <= sphere.radius;
+}
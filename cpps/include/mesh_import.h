@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+
+// Imports triangle meshes from Wavefront OBJ and binary glTF (.glb) files.
+// Parsing works on the file bytes in place, without a per-line allocation, and
+// spreads over job_system workers: OBJ text is split into chunks at line
+// breaks, glTF primitives are converted independently. Every material becomes
+// one geometry, so that it can be a paintable part of its own.
+//
+// Texture coordinates are clamped to [0, 1] by the vertex format, so painting
+// needs meshes whose UVs do not overlap or tile. Missing normals are smoothed
+// from the faces.
+namespace mesh_import {
+
+enum class MeshFormat { OBJ, GLB };
+
+// Picks the format from the extension of `file_name`, which is case
+// insensitive
+MeshFormat getMeshFormat(std::string_view file_name);
+
+struct ImportedPart {
+  std::string material_name;
+  GeometryComponent geometry_component;
+  // Set by uv_atlas::packImportedPart, 0 keeps the default
+  int painted_map_size = 0;
+};
+
+// Each function throws std::runtime_error on malformed or unsupported input.
+//
+// Groups faces by their `usemtl` material. Objects, groups and smoothing
+// groups are ignored, polygons are triangulated as fans.
+std::vector<ImportedPart> importObj(std::span<const char> bytes);
+// Reads triangle primitives of the default scene, transformed by their
+// nodes, and groups them by material. Buffers must be embedded in the .glb.
+std::vector<ImportedPart> importGlb(std::span<const char> bytes);
+std::vector<ImportedPart> importMesh(std::span<const char> bytes,
+                                     MeshFormat format);
+
+}  // namespace mesh_import
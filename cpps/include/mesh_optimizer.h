@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "./Component/GeometryComponent.h"
+#include "./constants.h"
+
+// Reorders geometry for the GPU before it is uploaded: every pass runs the
+// vertex shader once per vertex missing the post-transform cache, fetches
+// vertices in index order, and shades fragments that later triangles may
+// cover.
+//
+// Triangles are first clustered into meshlets, see clusterTriangles, and
+// stay in their meshlets. Within a meshlet, they are ordered for the vertex
+// cache with Tipsify (Sander et al., "Fast Triangle Reordering for Vertex
+// Locality and Reduced Overdraw"), cut where the cache starts over, and the
+// pieces are sorted to draw those facing out from the center of the mesh
+// first, as they tend to cover the others. Meshlets are sorted the same way,
+// in coarse steps that keep neighboring meshlets together for the brush
+// passes. Vertices are then renumbered in order of first use, dropping
+// unused ones.
+namespace mesh_optimizer {
+
+struct MeshOptimizerStats {
+  // Average cache miss ratio: vertex shader runs per triangle, with a FIFO
+  // cache of VERTEX_CACHE_SIZE vertices. 0.5 is the best a regular grid can
+  // reach, 3 the worst.
+  float acmr_before;
+  float acmr_after;
+  size_t vertex_count_before;
+  size_t vertex_count_after;
+};
+
+float getAcmr(const GeometryView& geometry_view,
+              size_t cache_size = VERTEX_CACHE_SIZE);
+
+// Meshlets are processed on job_system workers. The result only depends on
+// the geometry, so identical geometry stays identical.
+MeshOptimizerStats optimizeMesh(GeometryComponent& geometry_component);
+
+}  // namespace mesh_optimizer
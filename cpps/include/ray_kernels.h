@@ -0,0 +1,350 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <limits>
+
+#include "./math_util.h"
+
+// Vector width of the kernels. 4 lanes map to SSE natively and to SIMD128
+// under Emscripten, and the scalar fallback runs the tests of math_util lane
+// by lane. SIENNA_SCALAR_KERNELS forces the fallback, to compare against it.
+#if defined(SIENNA_SCALAR_KERNELS)
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define SIENNA_KERNELS_WASM_SIMD
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIENNA_KERNELS_SSE
+#endif
+
+// Ray tests against blocks of four triangles or boxes, stored by component so
+// that each component of the four loads into one vector
+namespace ray_kernels {
+
+const int LANE_COUNT = 4;
+
+struct alignas(16) TriangleBlock {
+  float v0_x[LANE_COUNT];
+  float v0_y[LANE_COUNT];
+  float v0_z[LANE_COUNT];
+  // v1 - v0 and v2 - v0, as computed by getRayIntersectionDistance
+  float edge1_x[LANE_COUNT];
+  float edge1_y[LANE_COUNT];
+  float edge1_z[LANE_COUNT];
+  float edge2_x[LANE_COUNT];
+  float edge2_y[LANE_COUNT];
+  float edge2_z[LANE_COUNT];
+};
+
+struct alignas(16) BoxBlock {
+  float min_x[LANE_COUNT];
+  float min_y[LANE_COUNT];
+  float min_z[LANE_COUNT];
+  float max_x[LANE_COUNT];
+  float max_y[LANE_COUNT];
+  float max_z[LANE_COUNT];
+};
+
+struct TriangleBlockHit {
+  // -1 if no triangle was hit
+  int lane;
+  float distance;
+  float u;
+  float v;
+};
+
+#if defined(SIENNA_KERNELS_WASM_SIMD)
+
+constexpr const char* BACKEND_NAME = "simd128";
+
+struct Float4 {
+  v128_t value;
+};
+struct Mask4 {
+  v128_t value;
+};
+
+inline Float4 loadFloat4(const float* values) {
+  return {wasm_v128_load(values)};
+}
+inline Float4 splatFloat4(float value) { return {wasm_f32x4_splat(value)}; }
+inline void storeFloat4(float* values, Float4 a) {
+  wasm_v128_store(values, a.value);
+}
+
+inline Float4 operator+(Float4 a, Float4 b) {
+  return {wasm_f32x4_add(a.value, b.value)};
+}
+inline Float4 operator-(Float4 a, Float4 b) {
+  return {wasm_f32x4_sub(a.value, b.value)};
+}
+inline Float4 operator*(Float4 a, Float4 b) {
+  return {wasm_f32x4_mul(a.value, b.value)};
+}
+inline Float4 operator/(Float4 a, Float4 b) {
+  return {wasm_f32x4_div(a.value, b.value)};
+}
+// b < a ? b : a, like std::min
+inline Float4 min(Float4 a, Float4 b) {
+  return {wasm_f32x4_pmin(a.value, b.value)};
+}
+inline Float4 max(Float4 a, Float4 b) {
+  return {wasm_f32x4_pmax(a.value, b.value)};
+}
+
+inline Mask4 operator<(Float4 a, Float4 b) {
+  return {wasm_f32x4_lt(a.value, b.value)};
+}
+inline Mask4 operator<=(Float4 a, Float4 b) {
+  return {wasm_f32x4_le(a.value, b.value)};
+}
+inline Mask4 operator>(Float4 a, Float4 b) {
+  return {wasm_f32x4_gt(a.value, b.value)};
+}
+inline Mask4 operator>=(Float4 a, Float4 b) {
+  return {wasm_f32x4_ge(a.value, b.value)};
+}
+inline Mask4 operator&(Mask4 a, Mask4 b) {
+  return {wasm_v128_and(a.value, b.value)};
+}
+
+// One bit per lane, lane 0 in the lowest bit
+inline int getMaskBits(Mask4 mask) { return wasm_i32x4_bitmask(mask.value); }
+
+inline Float4 select(Mask4 mask, Float4 a, Float4 b) {
+  return {wasm_v128_bitselect(a.value, b.value, mask.value)};
+}
+
+#elif defined(SIENNA_KERNELS_SSE)
+
+constexpr const char* BACKEND_NAME = "sse";
+
+struct Float4 {
+  __m128 value;
+};
+struct Mask4 {
+  __m128 value;
+};
+
+inline Float4 loadFloat4(const float* values) {
+  return {_mm_load_ps(values)};
+}
+inline Float4 splatFloat4(float value) { return {_mm_set1_ps(value)}; }
+inline void storeFloat4(float* values, Float4 a) {
+  _mm_store_ps(values, a.value);
+}
+
+inline Float4 operator+(Float4 a, Float4 b) {
+  return {_mm_add_ps(a.value, b.value)};
+}
+inline Float4 operator-(Float4 a, Float4 b) {
+  return {_mm_sub_ps(a.value, b.value)};
+}
+inline Float4 operator*(Float4 a, Float4 b) {
+  return {_mm_mul_ps(a.value, b.value)};
+}
+inline Float4 operator/(Float4 a, Float4 b) {
+  return {_mm_div_ps(a.value, b.value)};
+}
+// b < a ? b : a, like std::min
+inline Float4 min(Float4 a, Float4 b) { return {_mm_min_ps(b.value, a.value)}; }
+inline Float4 max(Float4 a, Float4 b) { return {_mm_max_ps(b.value, a.value)}; }
+
+inline Mask4 operator<(Float4 a, Float4 b) {
+  return {_mm_cmplt_ps(a.value, b.value)};
+}
+inline Mask4 operator<=(Float4 a, Float4 b) {
+  return {_mm_cmple_ps(a.value, b.value)};
+}
+inline Mask4 operator>(Float4 a, Float4 b) {
+  return {_mm_cmpgt_ps(a.value, b.value)};
+}
+inline Mask4 operator>=(Float4 a, Float4 b) {
+  return {_mm_cmpge_ps(a.value, b.value)};
+}
+inline Mask4 operator&(Mask4 a, Mask4 b) {
+  return {_mm_and_ps(a.value, b.value)};
+}
+
+// One bit per lane, lane 0 in the lowest bit
+inline int getMaskBits(Mask4 mask) { return _mm_movemask_ps(mask.value); }
+
+inline Float4 select(Mask4 mask, Float4 a, Float4 b) {
+  return {_mm_or_ps(_mm_and_ps(mask.value, a.value),
+                    _mm_andnot_ps(mask.value, b.value))};
+}
+
+#else
+
+constexpr const char* BACKEND_NAME = "scalar";
+
+#endif
+
+// The four triangles of `block` against one ray, with the same tests and the
+// same operation order as getRayIntersectionDistance. Returns the nearest hit
+// closer than `max_distance`. Lanes of degenerate triangles never hit, which
+// is how partial blocks are padded.
+inline TriangleBlockHit intersectRayTriangleBlock(
+    const glm::vec3& ray_origin, const glm::vec3& ray_direction,
+    const TriangleBlock& block, float max_distance) {
+#if defined(SIENNA_KERNELS_WASM_SIMD) || defined(SIENNA_KERNELS_SSE)
+  Float4 direction_x = splatFloat4(ray_direction.x);
+  Float4 direction_y = splatFloat4(ray_direction.y);
+  Float4 direction_z = splatFloat4(ray_direction.z);
+
+  Float4 edge1_x = loadFloat4(block.edge1_x);
+  Float4 edge1_y = loadFloat4(block.edge1_y);
+  Float4 edge1_z = loadFloat4(block.edge1_z);
+  Float4 edge2_x = loadFloat4(block.edge2_x);
+  Float4 edge2_y = loadFloat4(block.edge2_y);
+  Float4 edge2_z = loadFloat4(block.edge2_z);
+
+  // h = cross(ray_direction, edge2)
+  Float4 h_x = direction_y * edge2_z - edge2_y * direction_z;
+  Float4 h_y = direction_z * edge2_x - edge2_z * direction_x;
+  Float4 h_z = direction_x * edge2_y - edge2_x * direction_y;
+
+  Float4 a = (edge1_x * h_x + edge1_y * h_y) + edge1_z * h_z;
+
+  Float4 edge1_length2 =
+      (edge1_x * edge1_x + edge1_y * edge1_y) + edge1_z * edge1_z;
+  Float4 h_length2 = (h_x * h_x + h_y * h_y) + h_z * h_z;
+  Mask4 is_not_parallel =
+      a * a > splatFloat4(RAY_INTERSECTION_EPSILON * RAY_INTERSECTION_EPSILON) *
+                  edge1_length2 * h_length2;
+
+  Float4 f = splatFloat4(1.0f) / a;
+
+  Float4 s_x = splatFloat4(ray_origin.x) - loadFloat4(block.v0_x);
+  Float4 s_y = splatFloat4(ray_origin.y) - loadFloat4(block.v0_y);
+  Float4 s_z = splatFloat4(ray_origin.z) - loadFloat4(block.v0_z);
+
+  Float4 u = f * ((s_x * h_x + s_y * h_y) + s_z * h_z);
+
+  // q = cross(s, edge1)
+  Float4 q_x = s_y * edge1_z - edge1_y * s_z;
+  Float4 q_y = s_z * edge1_x - edge1_z * s_x;
+  Float4 q_z = s_x * edge1_y - edge1_x * s_y;
+
+  Float4 v = f * ((direction_x * q_x + direction_y * q_y) + direction_z * q_z);
+  Float4 t = f * ((edge2_x * q_x + edge2_y * q_y) + edge2_z * q_z);
+
+  Float4 zero = splatFloat4(0.0f);
+  Float4 one = splatFloat4(1.0f);
+  Mask4 is_hit = is_not_parallel & (u >= zero) & (u <= one) & (v >= zero) &
+                 (u + v <= one) & (t >= splatFloat4(RAY_INTERSECTION_EPSILON)) &
+                 (t < splatFloat4(max_distance));
+
+  int hit_bits = getMaskBits(is_hit);
+  if (hit_bits == 0) {
+    return {-1, 0.0f, 0.0f, 0.0f};
+  }
+
+  alignas(16) float distances[LANE_COUNT];
+  alignas(16) float us[LANE_COUNT];
+  alignas(16) float vs[LANE_COUNT];
+  storeFloat4(distances, t);
+  storeFloat4(us, u);
+  storeFloat4(vs, v);
+
+  TriangleBlockHit hit = {-1, max_distance, 0.0f, 0.0f};
+  for (int lane = 0; lane < LANE_COUNT; lane++) {
+    if ((hit_bits >> lane & 1) && distances[lane] < hit.distance) {
+      hit = {lane, distances[lane], us[lane], vs[lane]};
+    }
+  }
+
+  return hit;
+#else
+  // Without vectors, the early outs of the scalar test are cheaper than
+  // computing every lane to the end
+  TriangleBlockHit hit = {-1, max_distance, 0.0f, 0.0f};
+  for (int lane = 0; lane < LANE_COUNT; lane++) {
+    auto result = getRayEdgesIntersectionDistance(
+        ray_origin, ray_direction,
+        glm::vec3(block.v0_x[lane], block.v0_y[lane], block.v0_z[lane]),
+        glm::vec3(block.edge1_x[lane], block.edge1_y[lane],
+                  block.edge1_z[lane]),
+        glm::vec3(block.edge2_x[lane], block.edge2_y[lane],
+                  block.edge2_z[lane]));
+    if (result.has_value() && result->distance < hit.distance) {
+      hit = {lane, result->distance, result->u, result->v};
+    }
+  }
+
+  return hit;
+#endif
+}
+
+// The four boxes of `block` against one ray, with the same tests as
+// getRayBoxDistance. Returns a bit per box hit closer than `max_distance`,
+// lane 0 in the lowest bit, and writes the entry distances of every lane.
+inline int intersectRayBoxBlock(const glm::vec3& ray_origin,
+                                const glm::vec3& inverse_direction,
+                                const BoxBlock& block, float max_distance,
+                                float* distances) {
+#if defined(SIENNA_KERNELS_WASM_SIMD) || defined(SIENNA_KERNELS_SSE)
+  Float4 origin_x = splatFloat4(ray_origin.x);
+  Float4 origin_y = splatFloat4(ray_origin.y);
+  Float4 origin_z = splatFloat4(ray_origin.z);
+  Float4 inverse_x = splatFloat4(inverse_direction.x);
+  Float4 inverse_y = splatFloat4(inverse_direction.y);
+  Float4 inverse_z = splatFloat4(inverse_direction.z);
+
+  Float4 t0_x = (loadFloat4(block.min_x) - origin_x) * inverse_x;
+  Float4 t0_y = (loadFloat4(block.min_y) - origin_y) * inverse_y;
+  Float4 t0_z = (loadFloat4(block.min_z) - origin_z) * inverse_z;
+  Float4 t1_x = (loadFloat4(block.max_x) - origin_x) * inverse_x;
+  Float4 t1_y = (loadFloat4(block.max_y) - origin_y) * inverse_y;
+  Float4 t1_z = (loadFloat4(block.max_z) - origin_z) * inverse_z;
+
+  Float4 t_enter =
+      max(max(min(t0_x, t1_x), min(t0_y, t1_y)),
+          max(min(t0_z, t1_z), splatFloat4(0.0f)));
+  Float4 t_exit = min(min(max(t0_x, t1_x), max(t0_y, t1_y)),
+                      min(max(t0_z, t1_z), splatFloat4(max_distance)));
+
+  storeFloat4(distances, t_enter);
+
+  return getMaskBits(t_enter <= t_exit);
+#else
+  int hit_bits = 0;
+  for (int lane = 0; lane < LANE_COUNT; lane++) {
+    auto distance = getRayBoxDistance(
+        ray_origin, inverse_direction,
+        glm::vec3(block.min_x[lane], block.min_y[lane], block.min_z[lane]),
+        glm::vec3(block.max_x[lane], block.max_y[lane], block.max_z[lane]),
+        max_distance);
+    distances[lane] = distance.value_or(max_distance);
+    hit_bits |= distance.has_value() << lane;
+  }
+
+  return hit_bits;
+#endif
+}
+
+}  // namespace ray_kernels
@@ -24,12 +24,13 @@
 
 #pragma once
 
-#include <vector>
+#include <span>
 
 #include "./Component/GrGeometryComponent.h"
 #include "./Component/GrShaderManagerComponent.h"
 #include "./Component/GrTextureComponent.h"
 #include "./Component/GrUniformComponent.h"
+#include "./MeshletSet.h"
 #include "./shader/core.h"
 
 void drawGrComponents(
@@ -37,7 +38,48 @@ void drawGrComponents(
     std::reference_wrapper<GrShaderManagerComponent>
         gr_shader_manager_component,
     std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
-    const std::vector<std::reference_wrapper<GrUniformComponent>>&
+    std::span<const std::reference_wrapper<GrUniformComponent>>
         gr_uniform_components,
-    const std::vector<std::reference_wrapper<GrTextureComponent>>&
+    std::span<const std::reference_wrapper<GrTextureComponent>>
         gr_texture_components);
+
+// Draws `instance_count` instances with a single call. Instance textures are
+// bound to the sampler array named after them, one element per instance.
+void drawGrComponentsInstanced(
+    ShaderType shader_type,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
+    std::span<const std::reference_wrapper<GrUniformComponent>>
+        gr_uniform_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_texture_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_instance_texture_components,
+    int instance_count);
+
+// Same as drawGrComponents, drawing only `index_ranges` of the indices with
+// one call per range
+void drawGrComponentRanges(
+    ShaderType shader_type,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
+    std::span<const std::reference_wrapper<GrUniformComponent>>
+        gr_uniform_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_texture_components,
+    std::span<const MeshletRange> index_ranges);
+
+void drawGrComponentRangesInstanced(
+    ShaderType shader_type,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
+    std::span<const std::reference_wrapper<GrUniformComponent>>
+        gr_uniform_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_texture_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_instance_texture_components,
+    int instance_count, std::span<const MeshletRange> index_ranges);
@@ -26,8 +26,34 @@
 
 #include <string>
 
+#include "./constants.h"
+
 namespace shader_source {
 
+// Makes the float declarations that follow highp. Fragment shaders need it to
+// project for the brush, whose depth test is finer than mediump floats, which
+// may only have 10 bits of mantissa.
+inline const std::string highp_float_block = R"(
+    precision highp float;
+)";
+
+// Vertex attributes, as laid out by Vertex in GeometryComponent.h
+inline const std::string vertex_block = R"(
+    layout (location = 0) in vec3 a_position;
+    layout (location = 1) in vec2 a_normal;
+    layout (location = 2) in vec2 a_texCoord;
+
+    // Same as unpackNormal
+    vec3 getNormal()
+    {
+        vec3 normal = vec3(a_normal, 1.0 - abs(a_normal.x) - abs(a_normal.y));
+        float fold = max(-normal.z, 0.0);
+        normal.x += normal.x >= 0.0 ? -fold : fold;
+        normal.y += normal.y >= 0.0 ? -fold : fold;
+        return normalize(normal);
+    }
+)";
+
 inline const std::string camera_block = R"(
     layout (std140) uniform CameraBlock
     {
@@ -37,13 +63,64 @@ inline const std::string camera_block = R"(
     };
 )";
 
+// The normal matrices, transpose(inverse(mat3(model matrix))), are computed
+// once per upload on the CPU, see getNormalMatrix
 inline const std::string model_block = R"(
     layout (std140) uniform ModelBlock
     {
         mat4 u_model_matrix;
+        mat3 u_model_normalMatrix;
     };
 )";
 
+inline const std::string instance_block =
+    R"(
+    layout (std140) uniform InstanceBlock
+    {
+        mat4 u_instance_modelMatrices[)" +
+    std::to_string(MAX_INSTANCES_PER_DRAW) + R"(];
+        mat3 u_instance_normalMatrices[)" +
+    std::to_string(MAX_INSTANCES_PER_DRAW) + R"(];
+    };
+)";
+
+inline const std::string painted_map_block = R"(
+    uniform sampler2D u_paintedMapTexture;
+
+    vec4 getPaintedColor(vec2 texCoord)
+    {
+        return texture(u_paintedMapTexture, texCoord);
+    }
+)";
+
+// Every instance reads its own painted map, selected by its instance ID
+inline std::string getInstancedPaintedMapBlock() {
+  std::string cases = "";
+  for (int i = 0; i < MAX_PAINTED_MAP_INSTANCES; i++) {
+    cases += "            case " + std::to_string(i) +
+             ": return texture(u_paintedMapTexture[" + std::to_string(i) +
+             "], texCoord);\n";
+  }
+
+  return R"(
+    uniform sampler2D u_paintedMapTexture[)" +
+         std::to_string(MAX_PAINTED_MAP_INSTANCES) + R"(];
+
+    flat in int v_instanceId;
+
+    vec4 getPaintedColor(vec2 texCoord)
+    {
+        switch (v_instanceId)
+        {
+)" + cases + R"(            default: return vec4(0.0);
+        }
+    }
+)";
+}
+
+inline const std::string instanced_painted_map_block =
+    getInstancedPaintedMapBlock();
+
 inline const std::string brush_block = R"(
     layout (std140) uniform BrushBlock
     {
@@ -56,6 +133,32 @@ inline const std::string brush_block = R"(
     };
 )";
 
+// Lights as phong_fragment uses them, with the material already applied to
+// their colors, see gr_sync_system::updateLightingUniform:
+// - `vector` is the unit vector towards a directional light, with w = 0, or
+//   the position of a point light, with w = 1,
+// - `diffuse` and `specular` are the colors each light adds, and the w of
+//   `diffuse` the quadratic attenuation of a point light.
+inline const std::string lighting_block =
+    R"(
+    struct Light
+    {
+        vec4 vector;
+        vec4 diffuse;
+        vec4 specular;
+    };
+
+    layout (std140) uniform LightingBlock
+    {
+        vec3 u_lighting_ambient;
+        int u_lighting_lightCount;
+        vec3 u_lighting_materialColor;
+        float u_lighting_shininess;
+        Light u_lighting_lights[)" +
+    std::to_string(MAX_LIGHTS) + R"(];
+    };
+)";
+
 inline const std::string time_block = R"(
     layout (std140) uniform TimeBlock
     {
@@ -26,6 +26,8 @@
 
 #include <GLES3/gl3.h>
 
+#include <stdexcept>
+
 #include "./shader/source.h"
 
 enum class ShaderType {
@@ -33,9 +35,24 @@ enum class ShaderType {
   PHONG,
   BRUSH_DECAL,
   BRUSH_DEPTH,
-  PAINT_BLEND
+  PAINT_BLEND,
+  PHONG_INSTANCED,
+  BRUSH_DEPTH_INSTANCED,
+  PAINTED_MIPMAP
 };
 
+// Variant of `shader_type` reading model matrices from InstanceBlock
+inline ShaderType getInstancedShaderType(ShaderType shader_type) {
+  switch (shader_type) {
+    case ShaderType::PHONG:
+      return ShaderType::PHONG_INSTANCED;
+    case ShaderType::BRUSH_DEPTH:
+      return ShaderType::BRUSH_DEPTH_INSTANCED;
+    default:
+      throw std::invalid_argument("Shader type has no instanced variant");
+  }
+}
+
 inline const std::string SHADER_DEFAULT_HEADER = R"(#version 300 es
     precision mediump float;
 )";
@@ -62,6 +79,7 @@ inline std::string getVertexShaderSource(ShaderType shader_type) {
       shader_source += getStringFromSource(shader_source::basic_vertex);
       break;
     case ShaderType::PAINT_BLEND:
+    case ShaderType::PAINTED_MIPMAP:
       shader_source += getStringFromSource(shader_source::texture_quad_vertex);
       break;
     case ShaderType::BRUSH_DECAL:
@@ -70,6 +88,14 @@ inline std::string getVertexShaderSource(ShaderType shader_type) {
     case ShaderType::BRUSH_DEPTH:
       shader_source += getStringFromSource(shader_source::brush_depth_vertex);
       break;
+    case ShaderType::PHONG_INSTANCED:
+      shader_source +=
+          getStringFromSource(shader_source::basic_instanced_vertex);
+      break;
+    case ShaderType::BRUSH_DEPTH_INSTANCED:
+      shader_source +=
+          getStringFromSource(shader_source::brush_depth_instanced_vertex);
+      break;
     default:
       throw std::runtime_error("ERROR::SHADER::VERTEX::INVALID_SHADER_TYPE\n");
   }
@@ -92,11 +118,20 @@ inline std::string getFragmentShaderSource(ShaderType shader_type) {
       shader_source += getStringFromSource(shader_source::brush_decal_fragment);
       break;
     case ShaderType::BRUSH_DEPTH:
+    case ShaderType::BRUSH_DEPTH_INSTANCED:
       shader_source += getStringFromSource(shader_source::empty_fragment);
       break;
     case ShaderType::PAINT_BLEND:
       shader_source += getStringFromSource(shader_source::paint_blend_fragment);
       break;
+    case ShaderType::PHONG_INSTANCED:
+      shader_source +=
+          getStringFromSource(shader_source::phong_instanced_fragment);
+      break;
+    case ShaderType::PAINTED_MIPMAP:
+      shader_source +=
+          getStringFromSource(shader_source::painted_mipmap_fragment);
+      break;
     default:
       throw std::runtime_error(
           "ERROR::SHADER::FRAGMENT::INVALID_SHADER_TYPE\n");
@@ -37,11 +37,7 @@ struct ShaderSourceGroup {
 };
 
 inline const ShaderSourceGroup basic_vertex = {
-    .blocks = {camera_block, model_block}, .source = R"(
-    layout (location = 0) in vec3 a_position;
-    layout (location = 1) in vec3 a_normal;
-    layout (location = 2) in vec2 a_texCoord;
-
+    .blocks = {vertex_block, camera_block, model_block}, .source = R"(
     out vec3 v_position;
     out vec3 v_normal;
     out vec2 v_texCoord;
@@ -53,22 +49,44 @@ inline const ShaderSourceGroup basic_vertex = {
         vec4 modelPosition = u_model_matrix * vec4(a_position, 1.0);
         v_position = modelPosition.xyz;
 
-        mat3 normalMatrix = transpose(inverse(mat3(u_model_matrix)));
-        v_normal = normalize(normalMatrix * a_normal);
+        v_normal = normalize(u_model_normalMatrix * getNormal());
 
         v_texCoord = a_texCoord;
     }
 )"};
 
-inline const ShaderSourceGroup brush_decal_vertex = {
-    .blocks = {brush_block, model_block}, .source = R"(
-    layout (location = 0) in vec3 a_position;
-    layout (location = 1) in vec3 a_normal;
-    layout (location = 2) in vec2 a_texCoord;
+inline const ShaderSourceGroup basic_instanced_vertex = {
+    .blocks = {vertex_block, camera_block, instance_block},
+    .source = R"(
+    out vec3 v_position;
+    out vec3 v_normal;
+    out vec2 v_texCoord;
+    flat out int v_instanceId;
+
+    void main()
+    {
+        mat4 modelMatrix = u_instance_modelMatrices[gl_InstanceID];
+
+        gl_Position = u_camera_projectionMatrix * u_camera_viewMatrix * modelMatrix * vec4(a_position, 1.0);
 
+        vec4 modelPosition = modelMatrix * vec4(a_position, 1.0);
+        v_position = modelPosition.xyz;
+
+        v_normal = normalize(u_instance_normalMatrices[gl_InstanceID] * getNormal());
+
+        v_texCoord = a_texCoord;
+        v_instanceId = gl_InstanceID;
+    }
+)"};
+
+// Rasterizes in texture space, so the world position is interpolated linearly
+// over the surface, and projected for the brush per fragment: a projection
+// divided per vertex would be interpolated without perspective correction,
+// which needs finely tessellated geometry to look right
+inline const ShaderSourceGroup brush_decal_vertex = {
+    .blocks = {vertex_block, model_block}, .source = R"(
     out vec3 v_position;
     out vec3 v_normal;
-    out vec3 v_projectedPosition;
     out vec2 v_texCoord;
 
     void main()
@@ -78,21 +96,14 @@ inline const ShaderSourceGroup brush_decal_vertex = {
         vec4 modelPosition = u_model_matrix * vec4(a_position, 1.0);
         v_position = modelPosition.xyz;
 
-        vec4 projectedPosition = u_brush_projectionMatrix * u_brush_viewMatrix * modelPosition;
-        v_projectedPosition = projectedPosition.xyz / projectedPosition.w;
-
-        mat3 normalMatrix = transpose(inverse(mat3(u_model_matrix)));
-        v_normal = normalize(normalMatrix * a_normal);
+        v_normal = normalize(u_model_normalMatrix * getNormal());
 
         gl_Position = vec4(v_texCoord * 2.0 - 1.0, 0.0, 1.0);
     }
 )"};
 
-inline const ShaderSourceGroup texture_quad_vertex = {.source = R"(
-    layout (location = 0) in vec3 a_position;
-    layout (location = 1) in vec3 a_normal;
-    layout (location = 2) in vec2 a_texCoord;
-
+inline const ShaderSourceGroup texture_quad_vertex = {
+    .blocks = {vertex_block}, .source = R"(
     out vec2 v_texCoord;
 
     void main()
@@ -103,11 +114,7 @@ inline const ShaderSourceGroup texture_quad_vertex = {.source = R"(
 )"};
 
 inline const ShaderSourceGroup brush_depth_vertex = {
-    .blocks = {brush_block, model_block}, .source = R"(
-    layout (location = 0) in vec3 a_position;
-    layout (location = 1) in vec3 a_normal;
-    layout (location = 2) in vec2 a_texCoord;
-
+    .blocks = {vertex_block, brush_block, model_block}, .source = R"(
     void main()
     {
         vec4 modelPosition = u_model_matrix * vec4(a_position, 1.0);
@@ -115,6 +122,16 @@ inline const ShaderSourceGroup brush_depth_vertex = {
     }
 )"};
 
+inline const ShaderSourceGroup brush_depth_instanced_vertex = {
+    .blocks = {vertex_block, brush_block, instance_block},
+    .source = R"(
+    void main()
+    {
+        vec4 modelPosition = u_instance_modelMatrices[gl_InstanceID] * vec4(a_position, 1.0);
+        gl_Position = u_brush_projectionMatrix * u_brush_viewMatrix * modelPosition;
+    }
+)"};
+
 inline const ShaderSourceGroup empty_fragment = {.source = R"(
     void main()
     {
@@ -122,21 +139,29 @@ inline const ShaderSourceGroup empty_fragment = {.source = R"(
 )"};
 
 inline const ShaderSourceGroup brush_decal_fragment = {
-    .blocks = {time_block, brush_block}, .source = R"(
+    .blocks = {highp_float_block, time_block, brush_block}, .source = R"(
     uniform sampler2D u_brushDepthTexture;
 
     out vec4 FragColor;
 
     in vec3 v_position;
     in vec3 v_normal;
-    in vec3 v_projectedPosition;
     in vec2 v_texCoord;
 
     float g_intensity_coff = 0.05;
 
     void main()
     {
-        float centerDistance = length(v_projectedPosition.xy);
+        vec4 clipPosition = u_brush_projectionMatrix * u_brush_viewMatrix * vec4(v_position, 1.0);
+
+        // Discard fragments behind the nozzle
+        if (clipPosition.w <= 0.0)
+        {
+            discard;
+        }
+
+        vec3 projectedPosition = clipPosition.xyz / clipPosition.w;
+        float centerDistance = length(projectedPosition.xy);
 
         // Discard fragments outside the unit circle
         if (centerDistance - 1e-05 > 1.0)
@@ -144,8 +169,8 @@ inline const ShaderSourceGroup brush_decal_fragment = {
             discard;
         }
 
-        float brushDepth = texture(u_brushDepthTexture, v_projectedPosition.xy * 0.5 + 0.5).r;
-        float normalizedZ = v_projectedPosition.z * 0.5 + 0.5;
+        float brushDepth = texture(u_brushDepthTexture, projectedPosition.xy * 0.5 + 0.5).r;
+        float normalizedZ = projectedPosition.z * 0.5 + 0.5;
 
         // Discard fragments behind the brush
         if (normalizedZ - brushDepth > 2.0 * 1e-5)
@@ -177,7 +202,8 @@ inline const ShaderSourceGroup paint_blend_fragment = {.source = R"(
     in vec2 v_texCoord;
 
     void main() {
-        vec4 prevPaintedColor = texture(u_paintedMapTexture, v_texCoord);
+        // Texels map one to one, so only the first level is read
+        vec4 prevPaintedColor = textureLod(u_paintedMapTexture, v_texCoord, 0.0);
         vec4 paintColor = texture(u_paintMapTexture, v_texCoord);
 
         float prevIntensity = prevPaintedColor.a;
@@ -196,85 +222,44 @@ inline const ShaderSourceGroup paint_blend_fragment = {.source = R"(
     }
 )"};
 
-inline const ShaderSourceGroup texture_test_fragment = {.source = R"(
-    out vec4 FragColor;
+// Writes a texel of a painted map mip from the 2x2 texels of the level above,
+// the base level of the texture while this runs. Colors are weighted by paint
+// intensity, so that unpainted texels do not darken painted ones.
+inline const ShaderSourceGroup painted_mipmap_fragment = {.source = R"(
+    uniform sampler2D u_paintedMapTexture;
 
-    in vec2 v_texCoord;
+    out vec4 FragColor;
 
     void main()
     {
-        FragColor = vec4(v_texCoord, 0.0, 1.0);
-    }
-)"};
-
-inline const ShaderSourceGroup phong_fragment = {.blocks = {camera_block},
-                                                 .source = R"(
-    struct AmbientLight
-    {
-        vec3 color;
-        float intensity;
-    };
-
-    struct DirectionalLight
-    {
-        vec3 color;
-        vec3 direction;
-        float intensity;
-    };
-
-    struct PointLight
-    {
-        vec3 color;
-        vec3 position;
-        float intensity;
-        float quadraticAttenuation;
-    };
+        ivec2 maxTexel = textureSize(u_paintedMapTexture, 0) - 1;
+        ivec2 texel = ivec2(gl_FragCoord.xy) * 2;
 
-    struct Material
-    {
-        vec3 color;
-        float diffuse;
-        float specular;
-        float alpha;
-    };
-
-    vec3 getAmbientDiffuse(AmbientLight ambient_light, Material material)
-    {
-        return material.color * ambient_light.color * ambient_light.intensity * material.diffuse;
-    }
+        vec4 sum = vec4(0.0);
+        for (int i = 0; i < 4; i++)
+        {
+            vec4 color = texelFetch(u_paintedMapTexture, min(texel + ivec2(i & 1, i >> 1), maxTexel), 0);
+            sum += vec4(color.rgb * color.a, color.a);
+        }
 
-    vec3 getDirectionalDiffuse(DirectionalLight directional_light, Material material, vec3 normal)
-    {
-        vec3 lightVector = normalize(-directional_light.direction);
-        return material.diffuse * max(dot(normal, lightVector), 0.0) * material.color * directional_light.color * directional_light.intensity;
+        FragColor = vec4(sum.a > 0.0 ? sum.rgb / sum.a : vec3(0.0), sum.a * 0.25);
     }
+)"};
 
-    vec3 getDirectionalSpecular(DirectionalLight directional_light, Material material, vec3 normal, vec3 viewVector)
-    {
-        vec3 lightVector = normalize(-directional_light.direction);
-        vec3 reflection = reflect(-lightVector, normal);
-        return material.specular * pow(max(0.0, dot(reflection, viewVector)), material.alpha) * material.color * directional_light.color * directional_light.intensity;
-    }
+inline const ShaderSourceGroup texture_test_fragment = {.source = R"(
+    out vec4 FragColor;
 
-    vec3 getPointDiffuse(PointLight point_light, Material material, vec3 normal, vec3 position)
-    {
-        vec3 lightVector = normalize(point_light.position - position);
-        float distance = length(point_light.position - position);
-        float attenuation = 1.0 / (1.0 + point_light.quadraticAttenuation * distance * distance);
-        return material.diffuse * max(dot(normal, lightVector), 0.0) * material.color * point_light.color * point_light.intensity * attenuation;
-    }
+    in vec2 v_texCoord;
 
-    vec3 getPointSpecular(PointLight point_light, Material material, vec3 normal, vec3 position, vec3 viewVector)
+    void main()
     {
-        vec3 lightVector = normalize(point_light.position - position);
-        vec3 reflection = reflect(-lightVector, normal);
-        float distance = length(point_light.position - position);
-        float attenuation = 1.0 / (1.0 + point_light.quadraticAttenuation * distance * distance);
-        return material.specular * pow(max(0.0, dot(reflection, viewVector)), material.alpha) * material.color * point_light.color * point_light.intensity * attenuation;
+        FragColor = vec4(v_texCoord, 0.0, 1.0);
     }
+)"};
 
-    uniform sampler2D u_paintedMapTexture;
-
+// Shared by the phong fragment shaders, which only differ in where the
+// painted map is read from (see getPaintedColor)
+inline const std::string phong_fragment_source = R"(
     in vec3 v_normal;
     in vec3 v_position;
     in vec2 v_texCoord;
@@ -283,56 +268,41 @@ inline const ShaderSourceGroup phong_fragment = {.blocks = {camera_block},
 
     void main()
     {
-        AmbientLight g_ambient_light;
-        g_ambient_light.color = vec3(0.8, 0.8, 0.75); // warm room light
-        g_ambient_light.intensity = 0.4;
-
-        DirectionalLight g_ceiling_light;
-        g_ceiling_light.color = vec3(1.0, 1.0, 0.95); // warm ceiling light
-        g_ceiling_light.direction = vec3(0.0, -1.0, 0.0);
-        g_ceiling_light.intensity = 0.9;
-
-        PointLight g_fill_light;
-        g_fill_light.color = vec3(1.0, 0.85, 0.7); // warm white as from a lamp
-        g_fill_light.position = vec3(2.0, 3.0, 2.0);
-        g_fill_light.intensity = 0.6;
-        g_fill_light.quadraticAttenuation = 0.20;
-
-        PointLight g_rim_light;
-        g_rim_light.color = vec3(0.8, 0.85, 1.0); // cool white as from a window
-        g_rim_light.position = vec3(0.0, 3.0, -3.0);
-        g_rim_light.intensity = 0.4;
-        g_rim_light.quadraticAttenuation = 0.20;
-
-        Material g_material;
-        g_material.color = vec3(1.0, 1.0, 1.0);
-        g_material.diffuse = 0.5;
-        g_material.specular = 0.5;
-        g_material.alpha = 64.0;
-
-        vec4 paintColor = texture(u_paintedMapTexture, v_texCoord);
-        g_material.color = mix(g_material.color, vec3(paintColor), paintColor.a);
+        vec4 paintColor = getPaintedColor(v_texCoord);
+        vec3 materialColor = mix(u_lighting_materialColor, vec3(paintColor), paintColor.a);
 
         vec3 normal = normalize(v_normal);
         vec3 viewVector = normalize(u_camera_eye - v_position);
 
-        vec3 ambientDiffuse = getAmbientDiffuse(g_ambient_light, g_material);
+        vec3 color = u_lighting_ambient;
+        for (int i = 0; i < u_lighting_lightCount; i++)
+        {
+            Light light = u_lighting_lights[i];
+
+            // Directional lights have w = 0, so neither move nor attenuate
+            vec3 toLight = light.vector.xyz - v_position * light.vector.w;
+            float distanceSquared = dot(toLight, toLight) * light.vector.w;
+            float attenuation = 1.0 / (1.0 + light.diffuse.w * distanceSquared);
 
-        vec3 ceilingDiffuse = getDirectionalDiffuse(g_ceiling_light, g_material, normal);
-        vec3 ceilingSpecular = getDirectionalSpecular(g_ceiling_light, g_material, normal, viewVector);
+            vec3 lightVector = normalize(toLight);
+            vec3 reflection = reflect(-lightVector, normal);
 
-        vec3 fillDiffuse = getPointDiffuse(g_fill_light, g_material, normal, v_position);
-        vec3 fillSpecular = getPointSpecular(g_fill_light, g_material, normal, v_position, viewVector);
+            float diffuse = max(dot(normal, lightVector), 0.0);
+            float specular = pow(max(dot(reflection, viewVector), 0.0), u_lighting_shininess);
 
-        vec3 rimDiffuse = getPointDiffuse(g_rim_light, g_material, normal, v_position);
-        vec3 rimSpecular = getPointSpecular(g_rim_light, g_material, normal, v_position, viewVector);
+            color += (light.diffuse.rgb * diffuse + light.specular.rgb * specular) * attenuation;
+        }
 
-        vec3 diffuseColor = ambientDiffuse + ceilingDiffuse + fillDiffuse + rimDiffuse;
-        vec3 specularColor = ceilingSpecular + fillSpecular + rimSpecular;
-        
-        vec3 color = diffuseColor + specularColor;
-        FragColor = vec4(color, 1.0);
+        FragColor = vec4(materialColor * color, 1.0);
     }
-)"};
+)";
+
+inline const ShaderSourceGroup phong_fragment = {
+    .blocks = {camera_block, lighting_block, painted_map_block},
+    .source = phong_fragment_source};
+
+inline const ShaderSourceGroup phong_instanced_fragment = {
+    .blocks = {camera_block, lighting_block, instanced_painted_map_block},
+    .source = phong_fragment_source};
 
 }  // namespace shader_source
@@ -0,0 +1,58 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+#include "./Component/InputComponent.h"
+
+enum class StressLayout { GRID, RING };
+
+// Layout and brush stroke of the stress test. Free of GL, so that
+// tools/frame_allocation_check drives the same scene natively.
+namespace stress_scene {
+
+// The stroke goes around once per period, so its poses repeat every stroke
+inline const float STROKE_PERIOD_MS = 2000.0f;
+
+struct PartPlacement {
+  glm::vec3 scale;
+  glm::quat rotation;
+  glm::vec3 translation;
+};
+
+// GRID fits a square grid of parts facing the camera into a unit square. RING
+// places parts facing outwards around the Y axis, like the side faces of a
+// cube.
+std::vector<PartPlacement> getPartPlacements(StressLayout layout,
+                                             int part_count);
+
+// Holds the pointer down on a circle around the canvas center
+void driveScriptedStroke(float elapsed_ms, const glm::ivec2& canvas_size,
+                         InputComponent& input_component);
+
+}  // namespace stress_scene
@@ -24,8 +24,11 @@
 
 #pragma once
 
+#include <emscripten/val.h>
+
 #include "./Component/EventComponent.h"
 #include "./Component/InputComponent.h"
+#include "./Component/LightingComponent.h"
 
 namespace client_sync_system {
 
@@ -33,4 +36,20 @@ void syncInput(std::reference_wrapper<InputComponent> input_component);
 
 void consumeEvent(std::reference_wrapper<EventComponent> event_component);
 
+// Lighting as a JS object:
+// {
+//   ambient: {color: [r, g, b], intensity},
+//   lights: [{type: 'directional' | 'point', color, intensity,
+//             direction: [x, y, z], position: [x, y, z],
+//             quadraticAttenuation}],
+//   material: {color, diffuse, specular, shininess},
+// }
+emscripten::val getLightingValue(
+    std::reference_wrapper<LightingComponent> lighting_component);
+
+// Applies the properties present in a lighting object as returned by
+// getLightingValue, keeping the others. Lights are replaced as a whole list.
+void setLighting(const emscripten::val& lighting,
+                 std::reference_wrapper<LightingComponent> lighting_component);
+
 }  // namespace client_sync_system
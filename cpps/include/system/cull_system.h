@@ -0,0 +1,53 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "./Component/BoundsComponent.h"
+#include "./Component/BrushComponent.h"
+#include "./Component/TransformComponent.h"
+#include "./EntityRegistry.h"
+#include "./TransformHierarchy.h"
+
+namespace cull_system {
+
+// Updates whether the paintable can be under the brush, i.e. whether its
+// bounds intersect the cone around the brush frustum. Paintables outside of it
+// can be skipped by the brush depth and paint passes.
+void cullByBrush(
+    std::reference_wrapper<BrushComponent> brush_component,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    std::reference_wrapper<TransformComponent> transform_component,
+    std::reference_wrapper<BoundsComponent> bounds_component);
+
+// Updates the MeshletSelectionComponent of every part to the meshlets the
+// brush can paint: those inside the cone the brush projection paints within,
+// and for the paint pass, facing the nozzle. Brush passes then cost as much
+// as the brush footprint rather than the whole part.
+void selectMeshletsByBrush(
+    std::reference_wrapper<BrushComponent> brush_component,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    std::reference_wrapper<EntityRegistry> part_registry);
+
+}  // namespace cull_system
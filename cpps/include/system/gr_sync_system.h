@@ -24,41 +24,70 @@
 
 #pragma once
 
+#include <span>
+
 #include "./Component/BrushComponent.h"
 #include "./Component/CameraComponent.h"
 #include "./Component/GeometryComponent.h"
 #include "./Component/GrGeometryComponent.h"
+#include "./Component/GrPingPongTextureComponent.h"
 #include "./Component/GrTextureComponent.h"
 #include "./Component/GrUniformComponent.h"
 #include "./Component/InputComponent.h"
+#include "./Component/LightingComponent.h"
 #include "./Component/MaterialComponent.h"
 #include "./Component/RenderConfigComponent.h"
-#include "./Component/TransformComponent.h"
-#include "./View/TransformUpdatingView.h"
+#include "./Component/TransformNodeComponent.h"
+#include "./EntityRegistry.h"
+#include "./TransformHierarchy.h"
+#include "./View/InstanceBatchesView.h"
 
 namespace gr_sync_system {
 
+// Uploads the vertices and indices of the view as they are stored, except for
+// 32 bit indices that fit in 16 bits, which are narrowed first
 void updateGeometry(
-    std::reference_wrapper<GeometryComponent> geometry_component,
+    const GeometryView& geometry_view,
     std::reference_wrapper<GrGeometryComponent> gr_geometry_component);
 
 void updateGeometry(
     GeometryPreset geometry_preset,
     std::reference_wrapper<GrGeometryComponent> gr_geometry_component);
 
+// Writes RGBA half floats into the current painted map, e.g. one baked into an
+// asset pack. Maps of another size are skipped, since the budget policy may
+// have downscaled the painted maps.
+void updatePaintedMap(std::span<const char> painted_map,
+                      std::reference_wrapper<GrPingPongTextureComponent>
+                          gr_painted_ping_pong_texture_component);
+
 void updateCameraUniform(
     std::reference_wrapper<RenderConfigComponent> render_config_component,
     std::reference_wrapper<CameraComponent> camera_component,
     std::reference_wrapper<GrUniformComponent> gr_uniform_component);
 
+// Uploads the model and normal matrices of the parts in `part_registry` whose
+// world matrix has changed since their last upload
 void updateTransformUniforms(
-    std::reference_wrapper<TransformUpdatingView> transform_updating_view);
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    std::reference_wrapper<EntityRegistry> part_registry);
+
+// Uploads the model and normal matrices of `instance_batch` into
+// InstanceBlock. Called right before each instanced draw, since every batch
+// shares the buffer.
+void updateInstanceUniform(
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    std::reference_wrapper<EntityRegistry> part_registry,
+    const InstanceBatch& instance_batch,
+    std::reference_wrapper<GrUniformComponent> gr_uniform_component);
 
 void updateBrushUniform(
     std::reference_wrapper<BrushComponent> brush_component,
-    std::reference_wrapper<InputComponent> input_component,
-    std::reference_wrapper<RenderConfigComponent> render_config_component,
-    std::reference_wrapper<CameraComponent> camera_component,
+    std::reference_wrapper<GrUniformComponent> gr_uniform_component);
+
+// Uploads the lights and material into LightingBlock, if they have changed
+void updateLightingUniform(
+    std::reference_wrapper<LightingComponent> lighting_component,
     std::reference_wrapper<GrUniformComponent> gr_uniform_component);
 
 void updateTimeUniform(
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "./Component/BrushComponent.h"
 #include "./Component/InputComponent.h"
 
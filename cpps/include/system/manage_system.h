@@ -26,10 +26,14 @@
 
 #include "./Component/CameraComponent.h"
 #include "./Component/EventComponent.h"
+#include "./Component/GrPingPongTextureComponent.h"
+#include "./Component/MeshImportComponent.h"
+#include "./Component/ModelSwitchComponent.h"
+#include "./Component/ProfileComponent.h"
 #include "./Component/RenderConfigComponent.h"
 #include "./Component/TransformComponent.h"
+#include "./EntityRegistry.h"
 #include "./RootManager.h"
-#include "./View/PaintedTexturesView.h"
 
 namespace manage_system {
 
@@ -48,17 +52,57 @@ inline bool isChangeModel(
   return event_component.get().update_model.has_value();
 }
 
+inline bool isImportMesh(
+    std::reference_wrapper<EventComponent> event_component) {
+  return event_component.get().import_mesh.has_value();
+}
+
+inline bool isMeshImporting(
+    std::reference_wrapper<MeshImportComponent> mesh_import_component) {
+  return mesh_import_component.get().stage != MeshImportStage::IDLE;
+}
+
+inline bool isModelSwitching(
+    std::reference_wrapper<ModelSwitchComponent> model_switch_component) {
+  return !model_switch_component.get().descriptors.empty();
+}
+
 void resetPainted(
     std::reference_wrapper<EventComponent> event_component,
     std::reference_wrapper<RenderConfigComponent> render_config_component,
-    std::reference_wrapper<PaintedTexturesView> painted_textures_view);
+    std::reference_wrapper<EntityRegistry> part_registry);
 
 void resetModel(std::reference_wrapper<EventComponent> event_component,
                 std::reference_wrapper<RootManager> root_manager);
 
+// Starts importing the mesh file of the event, see stepMeshImport, or switches
+// to the paintables of an asset pack. A file that fails to import is logged,
+// keeping the current model. Load stats are logged while profiling.
+void importMesh(std::reference_wrapper<EventComponent> event_component,
+                std::reference_wrapper<ProfileComponent> profile_component,
+                std::reference_wrapper<RootManager> root_manager);
+
+// Runs the next steps of the mesh import: parsing, then packing the UVs and
+// building the geometry of each part in turn. Steps run on a worker while the
+// current model keeps rendering, or without workers, on the main thread until
+// the frame budget runs out. Once every part is built, switches to a
+// paintable with a part per material, logging the UV reports and timings
+// while profiling.
+void stepMeshImport(std::reference_wrapper<ProfileComponent> profile_component,
+                    std::reference_wrapper<RootManager> root_manager);
+
+// Builds and uploads parts of the pending paintable until the frame budget
+// runs out, and swaps it in once it is complete. At least one part is built
+// per frame so that the switch always makes progress. The switch timing and
+// geometry cache stats are logged while profiling.
+void stepModelSwitch(std::reference_wrapper<ProfileComponent> profile_component,
+                     std::reference_wrapper<RootManager> root_manager);
+
+// Resets the camera and the scene rotation, and every paintable to where the
+// scene placed it
 void resetPosition(
     std::reference_wrapper<EventComponent> event_component,
     std::reference_wrapper<CameraComponent> camera_component,
-    std::reference_wrapper<TransformComponent> transform_component);
+    std::reference_wrapper<RootManager> root_manager);
 
 }  // namespace manage_system
@@ -32,18 +32,39 @@
 #include "./Component/GrShaderManagerComponent.h"
 #include "./Component/GrTextureComponent.h"
 #include "./Component/GrUniformComponent.h"
-#include "./View/GrModelGeometriesView.h"
+#include "./Component/MeshletSelectionComponent.h"
+#include "./Component/SharedGeometryComponent.h"
+#include "./EntityRegistry.h"
+#include "./View/InstanceBatchesView.h"
 
 namespace paint_system {
 
+// Clears the brush depth map once per frame, before the paintables under the
+// brush are drawn into it by updateBrushDepth or updateBrushDepthInstanced
+void clearBrushDepth(std::reference_wrapper<GrFramedTextureComponent>
+                         gr_brush_depth_framed_texture_component);
+
+// Both draw the depth ranges of each part's MeshletSelectionComponent.
+// Instanced parts sharing a geometry draw the ranges of all of them.
 void updateBrushDepth(
     std::reference_wrapper<GrShaderManagerComponent>
         gr_shader_manager_component,
     std::reference_wrapper<GrUniformComponent> gr_brush_uniform_component,
     std::reference_wrapper<GrFramedTextureComponent>
         gr_brush_depth_framed_texture_component,
-    std::reference_wrapper<GrModelGeometriesView> gr_model_geometries_view);
+    std::reference_wrapper<EntityRegistry> part_registry);
+
+void updateBrushDepthInstanced(
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrUniformComponent> gr_brush_uniform_component,
+    std::reference_wrapper<GrFramedTextureComponent>
+        gr_brush_depth_framed_texture_component,
+    std::reference_wrapper<GrUniformComponent> gr_instance_uniform_component,
+    std::reference_wrapper<InstanceBatchesView> instance_batches_view);
 
+// Draws the decal ranges of the part's MeshletSelectionComponent into its
+// paint map
 void paint(
     std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
     std::reference_wrapper<GrShaderManagerComponent>
@@ -52,14 +73,29 @@ void paint(
     std::reference_wrapper<GrUniformComponent> gr_model_uniform_component,
     std::reference_wrapper<GrUniformComponent> gr_time_uniform_component,
     std::reference_wrapper<GrTextureComponent> gr_brush_depth_texture_component,
+    std::reference_wrapper<MeshletSelectionComponent>
+        meshlet_selection_component,
     std::reference_wrapper<GrFramedTextureComponent>
         gr_paint_framed_texture_component);
 
+// Blends the paint map into the painted map, marking the decal UV rects of
+// the part's MeshletSelectionComponent as dirty
 void updatePaintedMap(
     std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
     std::reference_wrapper<GrShaderManagerComponent>
         gr_shader_manager_component,
     std::reference_wrapper<GrTextureComponent> gr_paint_texture_component,
+    std::reference_wrapper<MeshletSelectionComponent>
+        meshlet_selection_component,
+    std::reference_wrapper<GrPingPongTextureComponent>
+        gr_painted_ping_pong_texture_component);
+
+// Downsamples the dirty rects of the current painted map into each of its
+// mips in turn, instead of regenerating the whole chain
+void updatePaintedMipmaps(
+    std::reference_wrapper<GrGeometryComponent> gr_quad_geometry_component,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
     std::reference_wrapper<GrPingPongTextureComponent>
         gr_painted_ping_pong_texture_component);
 
@@ -0,0 +1,58 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#ifdef TARGET_EMSCRIPTEN
+#include <emscripten/val.h>
+#endif
+
+#include "./Component/BoundsComponent.h"
+#include "./Component/BrushComponent.h"
+#include "./Component/PickComponent.h"
+#include "./EntityRegistry.h"
+#include "./TransformHierarchy.h"
+
+namespace pick_system {
+
+// Picks the parts of one paintable against the brush, on top of the hits of
+// the paintables picked before it in the frame:
+// - casts the ray through the pointer, keeping the nearest hit,
+// - narrows `bounds_component.is_under_brush` from the bounding sphere test of
+//   cull_system::cullByBrush down to whether any triangle is in the cone.
+// Rays and cones are tested in part space against the BVH of each geometry.
+void pickByBrush(std::reference_wrapper<BrushComponent> brush_component,
+                 std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+                 size_t paintable_index,
+                 std::reference_wrapper<EntityRegistry> part_registry,
+                 std::reference_wrapper<BoundsComponent> bounds_component,
+                 std::reference_wrapper<PickComponent> pick_component);
+
+#ifdef TARGET_EMSCRIPTEN
+// Pointer hit as a JS object, or null if the pointer is not over a part
+emscripten::val getPointerHitValue(
+    std::reference_wrapper<PickComponent> pick_component);
+#endif
+
+}  // namespace pick_system
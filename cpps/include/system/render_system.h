@@ -35,7 +35,9 @@
 #include "./Component/GrUniformComponent.h"
 #include "./Component/MaterialComponent.h"
 #include "./Component/RenderConfigComponent.h"
-#include "./View/RenderItemsView.h"
+#include "./Component/SharedGeometryComponent.h"
+#include "./EntityRegistry.h"
+#include "./View/InstanceBatchesView.h"
 
 namespace render_system {
 
@@ -46,11 +48,26 @@ void adjustViewportSize(
     std::reference_wrapper<RenderConfigComponent> render_config_component,
     std::reference_wrapper<CameraComponent> camera_component);
 
+// Clears the canvas once per frame, before every paintable is drawn by render
+// or renderInstanced
+void clearCanvas(
+    std::reference_wrapper<RenderConfigComponent> render_config_component);
+
 void render(
-    std::reference_wrapper<RenderConfigComponent> render_config_component,
     std::reference_wrapper<MaterialComponent> material_component,
     std::reference_wrapper<GrShaderManagerComponent>
         gr_shader_manager_component,
-    std::reference_wrapper<RenderItemsView> render_items_view);
+    std::reference_wrapper<GrUniformComponent> gr_camera_uniform_component,
+    std::reference_wrapper<GrUniformComponent> gr_lighting_uniform_component,
+    std::reference_wrapper<EntityRegistry> part_registry);
+
+void renderInstanced(
+    std::reference_wrapper<MaterialComponent> material_component,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrUniformComponent> gr_camera_uniform_component,
+    std::reference_wrapper<GrUniformComponent> gr_lighting_uniform_component,
+    std::reference_wrapper<GrUniformComponent> gr_instance_uniform_component,
+    std::reference_wrapper<InstanceBatchesView> instance_batches_view);
 
 }  // namespace render_system
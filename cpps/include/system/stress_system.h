@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "./Component/EventComponent.h"
+#include "./Component/InputComponent.h"
+#include "./Component/ProfileComponent.h"
+#include "./Component/RenderConfigComponent.h"
+#include "./Component/StressTestComponent.h"
+#include "./Entity/PaintableEntity.h"
+#include "./RootManager.h"
+
+namespace stress_system {
+
+inline bool isStressTestRequested(
+    std::reference_wrapper<EventComponent> event_component) {
+  return event_component.get().run_stress_test.has_value();
+}
+
+inline bool isStressTestRunning(
+    std::reference_wrapper<StressTestComponent> stress_test_component) {
+  return stress_test_component.get().is_running;
+}
+
+void startStressTest(
+    std::reference_wrapper<EventComponent> event_component,
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    std::reference_wrapper<ProfileComponent> profile_component);
+
+// Loads the paintable of the current case when a case begins. Returns true if
+// the paintable entity was replaced and its geometries need to be uploaded.
+bool prepareCase(
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    std::reference_wrapper<ProfileComponent> profile_component,
+    std::reference_wrapper<RootManager> root_manager);
+
+// Overrides the client pointer with a circular stroke around the canvas center
+void driveScriptedStroke(
+    float elapsed_ms,
+    std::reference_wrapper<RenderConfigComponent> render_config_component,
+    std::reference_wrapper<InputComponent> input_component);
+
+void recordFrame(
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    std::reference_wrapper<ProfileComponent> profile_component);
+
+}  // namespace stress_system
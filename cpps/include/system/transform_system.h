@@ -24,9 +24,12 @@
 
 #pragma once
 
+#include "./Component/BrushComponent.h"
 #include "./Component/CameraComponent.h"
 #include "./Component/InputComponent.h"
+#include "./Component/RenderConfigComponent.h"
 #include "./Component/TransformComponent.h"
+#include "./TransformHierarchy.h"
 
 namespace transform_system {
 
@@ -34,9 +37,27 @@ void transformCamera(float delta_ms,
                      std::reference_wrapper<InputComponent> input_component,
                      std::reference_wrapper<CameraComponent> camera_component);
 
-void transformPaintable(
+// Rotates the scene, i.e. every paintable about the world origin
+void transformScene(
     float delta_ms, std::reference_wrapper<InputComponent> input_component,
     std::reference_wrapper<CameraComponent> camera_component,
     std::reference_wrapper<TransformComponent> transform_component);
 
+// Copies a changed transform into its node of `transform_hierarchy`
+void syncTransformNode(
+    std::reference_wrapper<TransformComponent> transform_component,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy);
+
+// Recomputes the world matrices of the nodes synced since the last update
+void updateWorldMatrices(
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy);
+
+// Places the brush nozzle just in front of the camera, pointing along the ray
+// through the pointer
+void transformBrush(
+    std::reference_wrapper<InputComponent> input_component,
+    std::reference_wrapper<RenderConfigComponent> render_config_component,
+    std::reference_wrapper<CameraComponent> camera_component,
+    std::reference_wrapper<BrushComponent> brush_component);
+
 }  // namespace transform_system
@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "./Component/ProfileComponent.h"
+#include "./EntityRegistry.h"
+
+enum class SystemThread {
+  // CPU-only work, may run on a job_system worker
+  ANY,
+  // Work issuing GL calls or calling into JS, which is only valid on the
+  // thread owning the GL context
+  CONTEXT,
+};
+
+// Identifies the data a system accesses. Any type can be a resource, e.g. a
+// component, or an entity type for systems replacing the whole entity.
+template <typename... Resources>
+std::vector<size_t> getResourceIds() {
+  return {getComponentTypeId<Resources>()...};
+}
+
+struct SystemDescriptor {
+  // String literal, also used as the ProfileComponent sample name
+  const char* name;
+  std::vector<size_t> reads;
+  std::vector<size_t> writes;
+  SystemThread thread;
+  // Skips the system for the frame when it returns false. Optional.
+  std::function<bool()> is_active = {};
+  std::function<void(float elapsed_ms, float delta_ms)> run;
+};
+
+// Runs the systems of a frame in dependency order. A system depends on every
+// system added before it that writes what it reads or writes, or reads what it
+// writes; CONTEXT systems additionally run one at a time in the order they
+// were added. Independent ANY systems run concurrently on job_system workers,
+// while the calling thread, which must own the GL context, runs CONTEXT
+// systems.
+class SystemScheduler {
+ public:
+  SystemScheduler() = default;
+  SystemScheduler(const SystemScheduler&) = delete;
+  SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+  void add(SystemDescriptor system_descriptor);
+
+  // Builds the dependency graph. Call once after adding every system.
+  void build();
+
+  // Runs every system once and records their time into `profile_component`
+  // if profiling is enabled
+  void run(float elapsed_ms, float delta_ms,
+           std::reference_wrapper<ProfileComponent> profile_component);
+
+ private:
+  struct SystemNode {
+    SystemDescriptor descriptor;
+    std::vector<size_t> dependents;
+    size_t dependency_count = 0;
+
+    // Per frame state
+    size_t remaining_dependency_count = 0;
+    bool is_skipped = false;
+    double elapsed_ms = 0.0;
+    // Dependents this node made ready, reserved by build
+    std::vector<size_t> ready_dependents;
+  };
+
+  void dispatch(size_t node_index);
+  void runNode(size_t node_index);
+  void completeNode(size_t node_index);
+
+  std::vector<SystemNode> nodes;
+  bool is_built = false;
+
+  // Per frame state, guarded by mutex
+  std::mutex mutex;
+  std::condition_variable condition;
+  // Every node is queued at most once a frame, so reserving one slot per node
+  // in build keeps the queue from allocating
+  std::vector<size_t> context_queue;
+  size_t context_queue_head = 0;
+  // ANY systems submitted to the job system and not yet started, which run
+  // picks up while it has no CONTEXT system to run
+  size_t queued_job_count = 0;
+  size_t remaining_count = 0;
+  float frame_elapsed_ms = 0.0f;
+  float frame_delta_ms = 0.0f;
+  bool sync_gpu = false;
+};
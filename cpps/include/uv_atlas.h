@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./constants.h"
+#include "./mesh_import.h"
+
+// Generates texture coordinates for painting. The brush paints in UV space, so
+// every triangle needs a region of the painted map of its own, and the map is
+// only as small as the UVs are tightly packed.
+//
+// Triangles are grown into charts of faces within 45 degrees of the chart's
+// average normal, each chart is projected onto the plane of that normal and
+// rotated to its smallest bounding rectangle. The charts are then rasterized at
+// the requested texel density and placed, largest first and in either of two
+// orientations, at the lowest free spot of a texel bitmap, so that small charts
+// fill the gaps around large ones. The bitmap grows until everything fits.
+// Charts are processed on job_system workers.
+namespace uv_atlas {
+
+struct UvAtlasOptions {
+  // Texels per unit of length of the mesh
+  float texel_density;
+  int padding = UV_ATLAS_PADDING_TEXELS;
+  int max_painted_map_size = MAX_PAINTED_MAP_SIZE;
+};
+
+struct UvAtlasStats {
+  size_t chart_count;
+  int painted_map_size;
+  // Lower than requested when the atlas did not fit in the largest map
+  float texel_density;
+  // Fraction of the painted map covered by triangles
+  float utilization;
+};
+
+struct UvAtlas {
+  // The source geometry with new texture coordinates, and vertices split
+  // where they belong to several charts
+  GeometryComponent geometry_component;
+  UvAtlasStats stats;
+};
+
+UvAtlas buildUvAtlas(const GeometryComponent& geometry_component,
+                     const UvAtlasOptions& options);
+
+// Existing texture coordinates, rasterized at `resolution` squared texels
+struct UvLayoutStats {
+  // Fraction of the map covered by triangles
+  float utilization;
+  // Fraction of the covered texels that are covered more than once
+  float overlap;
+  // Sum of the triangle areas in UV space, and on the surface
+  float uv_area;
+  float surface_area;
+};
+
+UvLayoutStats measureUvLayout(const GeometryComponent& geometry_component,
+                              int resolution);
+
+struct PartUvReport {
+  bool is_repacked;
+  size_t chart_count;
+  float original_utilization;
+  // Painted map size the original UVs need for the same texel density, 0 when
+  // they are missing
+  int original_painted_map_size;
+  float utilization;
+  int painted_map_size;
+};
+
+// Replaces the UVs of every part whose UVs are missing or overlap, or would
+// need a larger painted map than an atlas, and sets the painted map size of
+// every part. `texel_density` applies once the mesh is scaled to the size of
+// the SPHERE preset, see getMeshPaintableDescriptor. Parts are processed in
+// parallel.
+std::vector<PartUvReport> packImportedParts(
+    std::vector<mesh_import::ImportedPart>& parts, float texel_density);
+
+// The steps of packImportedParts, for packing the parts one at a time: the
+// texel density of every part once the mesh is scaled, and packing one part
+// at that density
+float getImportTexelDensity(const std::vector<mesh_import::ImportedPart>& parts,
+                            float texel_density);
+PartUvReport packImportedPart(mesh_import::ImportedPart& part,
+                              float texel_density);
+
+// Paint map and the two painted ping pong maps of a part, with their mips
+size_t getPaintedMapBytes(int painted_map_size);
+
+}  // namespace uv_atlas
@@ -24,10 +24,15 @@
 
 #include "./Component/GeometryComponent.h"
 
+#include <algorithm>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
 #include <vector>
 
+#include "./job_system.h"
+
 std::vector<Vertex> generatePlaneVertices(const glm::vec3& right,
                                           const glm::vec3& up, float half_width,
                                           float half_height, float half_depth,
@@ -41,11 +46,68 @@ std::vector<Vertex> generateSphereVertices(float radius = 0.5,
 std::vector<unsigned int> generateSphereIndices(int width_segments = 64,
                                                 int height_segments = 32);
 
-GeometryComponent::GeometryComponent(GeometryPreset preset) {
+glm::ivec2 getDefaultGeometrySegments(GeometryPreset preset) {
   if (preset == GeometryPreset::PLANE) {
-    int width_segments = 16;
-    int height_segments = 16;
+    // Flat, so one quad is enough: the brush projects per fragment
+    return glm::ivec2(1, 1);
+  } else if (preset == GeometryPreset::QUAD) {
+    return glm::ivec2(1, 1);
+  } else if (preset == GeometryPreset::SPHERE) {
+    return glm::ivec2(64, 32);
+  } else {
+    throw std::invalid_argument("Invalid geometry preset");
+  }
+}
+
+glm::i16vec2 packNormal(const glm::vec3& normal) {
+  float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+  if (length == 0.0f) {
+    return glm::i16vec2(0);
+  }
+
+  glm::vec2 octahedral = glm::vec2(normal) / length;
+  if (normal.z < 0.0f) {
+    octahedral = (1.0f - glm::abs(glm::vec2(octahedral.y, octahedral.x))) *
+                 glm::vec2(octahedral.x >= 0.0f ? 1.0f : -1.0f,
+                           octahedral.y >= 0.0f ? 1.0f : -1.0f);
+  }
 
+  return glm::packSnorm<int16_t>(octahedral);
+}
+
+// Same as getNormal of the vertex shaders
+glm::vec3 unpackNormal(const glm::i16vec2& packed_normal) {
+  glm::vec2 octahedral = glm::unpackSnorm<float>(packed_normal);
+  glm::vec3 normal =
+      glm::vec3(octahedral, 1.0f - std::abs(octahedral.x) -
+                                std::abs(octahedral.y));
+
+  float fold = std::max(-normal.z, 0.0f);
+  normal.x += normal.x >= 0.0f ? -fold : fold;
+  normal.y += normal.y >= 0.0f ? -fold : fold;
+
+  return glm::normalize(normal);
+}
+
+glm::u16vec2 packTexCoords(const glm::vec2& tex_coords) {
+  return glm::packUnorm<uint16_t>(tex_coords);
+}
+
+glm::vec2 unpackTexCoords(const glm::u16vec2& packed_tex_coords) {
+  return glm::unpackUnorm<float>(packed_tex_coords);
+}
+
+size_t getIndexSize(size_t vertex_count) {
+  return vertex_count <= UINT16_MAX ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+GeometryComponent::GeometryComponent(GeometryPreset preset)
+    : GeometryComponent(preset, getDefaultGeometrySegments(preset).x,
+                        getDefaultGeometrySegments(preset).y) {}
+
+GeometryComponent::GeometryComponent(GeometryPreset preset, int width_segments,
+                                     int height_segments) {
+  if (preset == GeometryPreset::PLANE) {
     vertices = generatePlaneVertices(glm::vec3(1.0f, 0.0f, 0.0f),
                                      glm::vec3(0.0f, 1.0f, 0.0f), 0.5f, 0.5f,
                                      0.0f, width_segments, height_segments);
@@ -53,11 +115,11 @@ GeometryComponent::GeometryComponent(GeometryPreset preset) {
   } else if (preset == GeometryPreset::QUAD) {
     vertices = generatePlaneVertices(glm::vec3(1.0f, 0.0f, 0.0f),
                                      glm::vec3(0.0f, 1.0f, 0.0f), 1.0f, 1.0f,
-                                     0.0f, 1, 1);
-    indices = generatePlaneIndices(1, 1);
+                                     0.0f, width_segments, height_segments);
+    indices = generatePlaneIndices(width_segments, height_segments);
   } else if (preset == GeometryPreset::SPHERE) {
-    vertices = generateSphereVertices();
-    indices = generateSphereIndices();
+    vertices = generateSphereVertices(0.5f, width_segments, height_segments);
+    indices = generateSphereIndices(width_segments, height_segments);
   } else {
     throw std::invalid_argument("Invalid geometry preset");
   }
@@ -85,9 +147,10 @@ std::vector<Vertex> generatePlaneVertices(const glm::vec3& right,
 
       Vertex vertex = {
           .position = position,
-          .normal = front,
-          .tex_coords = glm::vec2(static_cast<float>(i) / width_segments,
-                                  static_cast<float>(j) / height_segments),
+          .normal = packNormal(front),
+          .tex_coords =
+              packTexCoords(glm::vec2(static_cast<float>(i) / width_segments,
+                                      static_cast<float>(j) / height_segments)),
       };
 
       vertices[j * (width_segments + 1) + i] = vertex;
@@ -141,27 +204,41 @@ std::vector<Vertex> generateSphereVertices(float radius, int width_segments,
   float polar_step = glm::pi<float>() / height_segments;
   float azimuth_step = (glm::pi<float>() * 2.0f) / width_segments;
 
-  for (int j = 0; j <= height_segments; ++j) {
-    float u_offset = (j == 0 || j == height_segments) ? 0.5f : 0.0f;
-    float polar = polar_step * j + glm::half_pi<float>();
-
-    for (int i = 0; i <= width_segments; ++i) {
-      float azimuth = azimuth_step * i;
-      float x = radius * cos(polar) * cos(azimuth);
-      float y = radius * sin(polar);
-      float z = radius * cos(polar) * sin(azimuth);
-
-      glm::vec3 position = glm::vec3(x, y, z);
-      glm::vec3 normal = glm::normalize(position);
-
-      float u = static_cast<float>(i) / width_segments;
-      float v = static_cast<float>(j) / height_segments;
-      glm::vec2 tex_coord = glm::vec2(u, v);
-
-      vertices[j * (width_segments + 1) + i] = {position, normal, tex_coord};
-    }
+  // Every row shares the same azimuths, so their sines and cosines are only
+  // computed once, and the inner loop is left with products, which the
+  // compiler vectorizes
+  std::vector<float> azimuth_cosines(width_segments + 1);
+  std::vector<float> azimuth_sines(width_segments + 1);
+  for (int i = 0; i <= width_segments; ++i) {
+    azimuth_cosines[i] = cos(azimuth_step * i);
+    azimuth_sines[i] = sin(azimuth_step * i);
   }
 
+  // Rows are independent, so they are generated in parallel
+  job_system::parallelFor(
+      0, height_segments + 1, 8, [&](size_t row_begin, size_t row_end) {
+        for (int j = static_cast<int>(row_begin);
+             j < static_cast<int>(row_end); ++j) {
+          float polar = polar_step * j + glm::half_pi<float>();
+          float polar_cosine = cos(polar);
+          float polar_sine = sin(polar);
+          float v = static_cast<float>(j) / height_segments;
+          Vertex* row = vertices.data() + j * (width_segments + 1);
+
+          for (int i = 0; i <= width_segments; ++i) {
+            // On the unit sphere, so the normal needs no normalization
+            glm::vec3 normal =
+                glm::vec3(polar_cosine * azimuth_cosines[i], polar_sine,
+                          polar_cosine * azimuth_sines[i]);
+
+            float u = static_cast<float>(i) / width_segments;
+
+            row[i] = {normal * radius, packNormal(normal),
+                      packTexCoords(glm::vec2(u, v))};
+          }
+        }
+      });
+
   return vertices;
 }
 
@@ -215,3 +292,25 @@ std::vector<unsigned int> generateSphereIndices(int width_segments,
 
   return indices;
 }
+
+BoundingSphere getBoundingSphere(const GeometryView& geometry_view) {
+  const auto& vertices = geometry_view.vertices;
+  if (vertices.empty()) {
+    return {glm::vec3(0.0f), 0.0f};
+  }
+
+  glm::vec3 min_position = vertices.front().position;
+  glm::vec3 max_position = min_position;
+  for (const auto& vertex : vertices) {
+    min_position = glm::min(min_position, vertex.position);
+    max_position = glm::max(max_position, vertex.position);
+  }
+
+  glm::vec3 center = (min_position + max_position) * 0.5f;
+  float radius = 0.0f;
+  for (const auto& vertex : vertices) {
+    radius = std::max(radius, glm::length(vertex.position - center));
+  }
+
+  return {center, radius};
+}
@@ -28,8 +28,13 @@
 
 #include <stdexcept>
 
+#include "./gr_resource_registry.h"
+
 GrFramebufferComponent::GrFramebufferComponent() {
   glGenFramebuffers(1, &framebuffer_id);
+
+  gr_resource_registry::registerResource(GrResourceCategory::FRAMEBUFFER,
+                                         framebuffer_id, 0);
 }
 
 GrFramebufferComponent::GrFramebufferComponent(unsigned int texture_id) {
@@ -44,8 +49,13 @@ GrFramebufferComponent::GrFramebufferComponent(unsigned int texture_id) {
   }
 
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  gr_resource_registry::registerResource(GrResourceCategory::FRAMEBUFFER,
+                                         framebuffer_id, 0);
 }
 
 GrFramebufferComponent::~GrFramebufferComponent() {
+  gr_resource_registry::unregisterResource(GrResourceCategory::FRAMEBUFFER,
+                                           framebuffer_id);
   glDeleteFramebuffers(1, &framebuffer_id);
 }
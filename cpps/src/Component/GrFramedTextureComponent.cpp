@@ -26,24 +26,85 @@
 
 #include <GLES3/gl3.h>
 
+#include <utility>
+
+#include "./gr_resource_pool.h"
+#include "./gr_resource_registry.h"
+
 GrFramedTextureComponent::GrFramedTextureComponent(TextureType texture_type,
                                                    const std::string& name,
-                                                   int width, int height)
-    : GrTextureComponent(texture_type, name, width, height) {
-  glGenFramebuffers(1, &framebuffer_id);
-  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+                                                   int width, int height,
+                                                   int level_count)
+    : GrTextureComponent(texture_type, name, width, height, level_count) {
+  auto recycled_framebuffer_id =
+      gr_resource_pool::acquireFramebuffer(texture_id);
 
-  if (texture_type == TextureType::DEPTH) {
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
-                           texture_id, 0);
+  if (recycled_framebuffer_id.has_value()) {
+    framebuffer_id = recycled_framebuffer_id.value();
   } else {
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                           texture_id, 0);
+    glGenFramebuffers(1, &framebuffer_id);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+
+    if (texture_type == TextureType::DEPTH) {
+      glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
+                             GL_TEXTURE_2D, texture_id, 0);
+    } else {
+      glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                             GL_TEXTURE_2D, texture_id, 0);
+    }
+
+    gr_resource_registry::registerResource(GrResourceCategory::FRAMEBUFFER,
+                                           framebuffer_id, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
   }
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  // The texture may be recycled from the pool with stale contents
+  clear();
+}
+
+GrFramedTextureComponent::GrFramedTextureComponent(
+    GrFramedTextureComponent&& other) noexcept
+    : GrTextureComponent(std::move(other)),
+      framebuffer_id(other.framebuffer_id) {
+  other.framebuffer_id = 0;
+}
+
+GrFramedTextureComponent& GrFramedTextureComponent::operator=(
+    GrFramedTextureComponent&& other) noexcept {
+  GrTextureComponent::operator=(std::move(other));
+  std::swap(framebuffer_id, other.framebuffer_id);
+
+  return *this;
 }
 
 GrFramedTextureComponent::~GrFramedTextureComponent() {
-  glDeleteFramebuffers(1, &framebuffer_id);
+  if (framebuffer_id == 0) {
+    return;
+  }
+
+  gr_resource_pool::releaseFramebuffer(framebuffer_id, texture_id);
+}
+
+void GrFramedTextureComponent::clear() {
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_id);
+
+  if (texture_type == TextureType::DEPTH) {
+    glClear(GL_DEPTH_BUFFER_BIT);
+  } else {
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // The other levels are attached in turn, then the first one again
+    for (int level = 1; level < level_count; level++) {
+      glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                             GL_TEXTURE_2D, texture_id, level);
+      glClear(GL_COLOR_BUFFER_BIT);
+    }
+    if (level_count > 1) {
+      glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                             GL_TEXTURE_2D, texture_id, 0);
+    }
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
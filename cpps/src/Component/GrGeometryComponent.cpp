@@ -26,16 +26,61 @@
 
 #include <GLES3/gl3.h>
 
+#include "./gr_resource_pool.h"
+#include "./gr_resource_registry.h"
+
 GrGeometryComponent::GrGeometryComponent() {
-  glGenVertexArrays(1, &vao_id);
-  glGenBuffers(1, &vbo_id);
-  glGenBuffers(1, &ebo_id);
+  vao_id = 0;
+  vbo_id = 0;
+  ebo_id = 0;
 
   vertex_count = 0;
+  index_type = GL_UNSIGNED_INT;
+  vertex_buffer_size = 0;
+  index_buffer_size = 0;
+  upload_ms = 0.0;
 }
 
 GrGeometryComponent ::~GrGeometryComponent() {
-  glDeleteVertexArrays(1, &vao_id);
-  glDeleteBuffers(1, &vbo_id);
-  glDeleteBuffers(1, &ebo_id);
+  if (vao_id == 0) {
+    return;
+  }
+
+  gr_resource_pool::releaseGeometry({vao_id, vbo_id, ebo_id},
+                                    vertex_buffer_size, index_buffer_size);
+}
+
+bool GrGeometryComponent::allocate(size_t vertex_buffer_size,
+                                   size_t index_buffer_size) {
+  if (vao_id != 0) {
+    return this->vertex_buffer_size == vertex_buffer_size &&
+           this->index_buffer_size == index_buffer_size;
+  }
+
+  auto recycled_geometry =
+      gr_resource_pool::acquireGeometry(vertex_buffer_size, index_buffer_size);
+
+  if (recycled_geometry.has_value()) {
+    vao_id = recycled_geometry.value().vao_id;
+    vbo_id = recycled_geometry.value().vbo_id;
+    ebo_id = recycled_geometry.value().ebo_id;
+    this->vertex_buffer_size = vertex_buffer_size;
+    this->index_buffer_size = index_buffer_size;
+
+    return true;
+  }
+
+  glGenVertexArrays(1, &vao_id);
+  glGenBuffers(1, &vbo_id);
+  glGenBuffers(1, &ebo_id);
+
+  // Buffer sizes are updated when the geometry gets uploaded
+  gr_resource_registry::registerResource(GrResourceCategory::VERTEX_ARRAY,
+                                         vao_id, 0);
+  gr_resource_registry::registerResource(GrResourceCategory::VERTEX_BUFFER,
+                                         vbo_id, 0);
+  gr_resource_registry::registerResource(GrResourceCategory::INDEX_BUFFER,
+                                         ebo_id, 0);
+
+  return false;
 }
@@ -26,28 +26,52 @@
 
 #include <GLES3/gl3.h>
 
+#include <algorithm>
+#include <utility>
+
+#include "./gr_resource_pool.h"
+#include "./gr_resource_registry.h"
+
 GrTextureComponent::GrTextureComponent(TextureType texture_type,
                                        const std::string& name, int width,
-                                       int height)
-    : name(name), width(width), height(height), texture_type(texture_type) {
+                                       int height, int level_count)
+    : name(name),
+      width(width),
+      height(height),
+      level_count(level_count),
+      texture_type(texture_type) {
+  auto recycled_texture_id = gr_resource_pool::acquireTexture(
+      texture_type, width, height, level_count);
+
+  if (recycled_texture_id.has_value()) {
+    texture_id = recycled_texture_id.value();
+    return;
+  }
+
   glGenTextures(1, &texture_id);
   glBindTexture(GL_TEXTURE_2D, texture_id);
 
-  if (texture_type == TextureType::R8) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED,
-                 GL_UNSIGNED_BYTE, nullptr);
-  } else if (texture_type == TextureType::RGBA) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, nullptr);
-  } else if (texture_type == TextureType::RGBA16) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA,
-                 GL_FLOAT, nullptr);
-
-  } else if (texture_type == TextureType::DEPTH) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT16, width, height, 0,
-                 GL_DEPTH_COMPONENT, GL_UNSIGNED_SHORT, nullptr);
-  } else {
-    throw std::invalid_argument("Invalid texture type");
+  for (int level = 0; level < level_count; level++) {
+    int level_width = std::max(width >> level, 1);
+    int level_height = std::max(height >> level, 1);
+
+    if (texture_type == TextureType::R8) {
+      glTexImage2D(GL_TEXTURE_2D, level, GL_R8, level_width, level_height, 0,
+                   GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    } else if (texture_type == TextureType::RGBA) {
+      glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, level_width, level_height,
+                   0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    } else if (texture_type == TextureType::RGBA16) {
+      glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA16F, level_width,
+                   level_height, 0, GL_RGBA, GL_FLOAT, nullptr);
+
+    } else if (texture_type == TextureType::DEPTH) {
+      glTexImage2D(GL_TEXTURE_2D, level, GL_DEPTH_COMPONENT16, level_width,
+                   level_height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_SHORT,
+                   nullptr);
+    } else {
+      throw std::invalid_argument("Invalid texture type");
+    }
   }
 
   if (texture_type == TextureType::DEPTH) {
@@ -56,8 +80,10 @@ GrTextureComponent::GrTextureComponent(TextureType texture_type,
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   } else {
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    level_count > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   }
@@ -67,6 +93,40 @@ GrTextureComponent::GrTextureComponent(TextureType texture_type,
   // glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, borderColor);
 
   glBindTexture(GL_TEXTURE_2D, 0);
+
+  gr_resource_registry::registerResource(
+      GrResourceCategory::TEXTURE, texture_id,
+      getTextureBytes(texture_type, width, height, level_count));
 }
 
-GrTextureComponent::~GrTextureComponent() { glDeleteTextures(1, &texture_id); }
+GrTextureComponent::GrTextureComponent(GrTextureComponent&& other) noexcept
+    : texture_id(other.texture_id),
+      name(std::move(other.name)),
+      width(other.width),
+      height(other.height),
+      level_count(other.level_count),
+      texture_type(other.texture_type) {
+  other.texture_id = 0;
+}
+
+GrTextureComponent& GrTextureComponent::operator=(
+    GrTextureComponent&& other) noexcept {
+  // The other component releases our texture when it gets destroyed
+  std::swap(texture_id, other.texture_id);
+  std::swap(name, other.name);
+  std::swap(width, other.width);
+  std::swap(height, other.height);
+  std::swap(level_count, other.level_count);
+  std::swap(texture_type, other.texture_type);
+
+  return *this;
+}
+
+GrTextureComponent::~GrTextureComponent() {
+  if (texture_id == 0) {
+    return;
+  }
+
+  gr_resource_pool::releaseTexture(texture_id, texture_type, width, height,
+                                   level_count);
+}
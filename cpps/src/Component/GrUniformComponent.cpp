@@ -26,11 +26,46 @@
 
 #include <GLES3/gl3.h>
 
+#include <utility>
+
+#include "./gr_resource_pool.h"
+#include "./gr_resource_registry.h"
+
 GrUniformComponent::GrUniformComponent(std::string uniform_block_name)
     : uniform_block_name(uniform_block_name) {
+  auto recycled_uniform_buffer_id = gr_resource_pool::acquireUniformBuffer();
+
+  if (recycled_uniform_buffer_id.has_value()) {
+    uniform_buffer_id = recycled_uniform_buffer_id.value();
+    return;
+  }
+
   glGenBuffers(1, &uniform_buffer_id);
+
+  // The size is updated whenever the uniform data gets uploaded
+  gr_resource_registry::registerResource(GrResourceCategory::UNIFORM_BUFFER,
+                                         uniform_buffer_id, 0);
+}
+
+GrUniformComponent::GrUniformComponent(GrUniformComponent&& other) noexcept
+    : uniform_block_name(std::move(other.uniform_block_name)),
+      uniform_buffer_id(other.uniform_buffer_id) {
+  other.uniform_buffer_id = 0;
+}
+
+GrUniformComponent& GrUniformComponent::operator=(
+    GrUniformComponent&& other) noexcept {
+  // The other component releases our buffer when it gets destroyed
+  std::swap(uniform_block_name, other.uniform_block_name);
+  std::swap(uniform_buffer_id, other.uniform_buffer_id);
+
+  return *this;
 }
 
 GrUniformComponent::~GrUniformComponent() {
-  glDeleteBuffers(1, &uniform_buffer_id);
+  if (uniform_buffer_id == 0) {
+    return;
+  }
+
+  gr_resource_pool::releaseUniformBuffer(uniform_buffer_id);
 }
@@ -24,61 +24,283 @@
 
 #include "./Entity/PaintableEntity.h"
 
+#include <algorithm>
+#include <glm/gtc/type_ptr.hpp>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <utility>
+
+#include "./geometry_cache.h"
+#include "./gr_resource_registry.h"
+#include "./math_util.h"
 #include "./shader/core.h"
 
-PaintableEntity::PaintableEntity(PaintablePreset preset) {
+std::vector<PaintablePartDescriptor> getPaintablePartDescriptors(
+    PaintablePreset preset);
+std::vector<PaintablePartDescriptor> getStressPartDescriptors(
+    const StressPresetOptions& options);
+
+PaintableEntity::PaintableEntity(
+    const PaintableDescriptor& descriptor,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    TransformHandle parent_node)
+    : transform_hierarchy(transform_hierarchy) {
+  gr_resource_registry::OwnerScope owner_scope("PaintableEntity");
+
   material_component = std::make_unique<MaterialComponent>(ShaderType::PHONG);
-  transform_component = std::make_unique<TransformComponent>();
+  transform_component = std::make_unique<TransformComponent>(
+      descriptor.scale, descriptor.rotation, descriptor.translation);
+  transform_component->node = transform_hierarchy.get().create(
+      parent_node, descriptor.scale, descriptor.rotation,
+      descriptor.translation);
+  bounds_component = std::make_unique<BoundsComponent>();
+
+  part_registry = std::make_unique<EntityRegistry>();
+  instance_batches_view = std::make_unique<InstanceBatchesView>(
+      transform_hierarchy, std::ref(*part_registry));
+  for (const auto& part_descriptor : descriptor.part_descriptors) {
+    addPaintablePart(std::ref(*this), part_descriptor);
+  }
+}
+
+PaintableEntity::~PaintableEntity() {
+  // Part nodes are children of the paintable's node
+  transform_hierarchy.get().destroy(transform_component->node);
+}
+
+EntityHandle addPaintablePart(
+    std::reference_wrapper<PaintableEntity> paintable_entity,
+    const PaintablePartDescriptor& descriptor) {
+  auto& part_registry = *paintable_entity.get().part_registry;
+  auto part_handle = createPaintablePartEntity(
+      std::ref(part_registry), paintable_entity.get().transform_hierarchy,
+      paintable_entity.get().transform_component->node, descriptor);
+
+  const auto& geometry_view =
+      part_registry.get<SharedGeometryComponent>(part_handle).view;
+  paintable_entity.get().bounds_component->merge(transformBoundingSphere(
+      getBoundingSphere(geometry_view),
+      getTransformMatrix(descriptor.scale, descriptor.rotation,
+                         descriptor.translation)));
+
+  return part_handle;
+}
+
+std::vector<PaintableDescriptor> getPaintableDescriptors(
+    PaintablePreset preset) {
+  if (preset == PaintablePreset::STRESS) {
+    return getStressPaintableDescriptors(StressPresetOptions());
+  }
+
+  if (preset != PaintablePreset::CAR) {
+    return {{.part_descriptors = getPaintablePartDescriptors(preset)}};
+  }
+
+  // The body is a stretched cube, and the wheels are flattened spheres on its
+  // sides, facing the Z axis
+  std::vector<PaintableDescriptor> descriptors = {
+      {.scale = glm::vec3(1.5f, 0.5f, 1.0f),
+       .translation = glm::vec3(0.0f, 0.1f, 0.0f),
+       .part_descriptors = getPaintablePartDescriptors(PaintablePreset::CUBE)},
+  };
+
+  for (float x : {-0.4f, 0.4f}) {
+    for (float z : {-0.42f, 0.42f}) {
+      descriptors.push_back({
+          .scale = glm::vec3(0.3f, 0.3f, 0.1f),
+          .translation = glm::vec3(x, -0.15f, z),
+          .part_descriptors =
+              getPaintablePartDescriptors(PaintablePreset::SPHERE),
+      });
+    }
+  }
+
+  return descriptors;
+}
+
+std::vector<PaintableDescriptor> getStressPaintableDescriptors(
+    const StressPresetOptions& options) {
+  return {{.part_descriptors = getStressPartDescriptors(options)}};
+}
+
+PaintableDescriptor getMeshPaintableDescriptor(
+    const std::vector<mesh_import::ImportedPart>& parts,
+    std::vector<geometry_cache::BuiltGeometry>&& geometries) {
+  if (geometries.size() != parts.size()) {
+    throw std::invalid_argument("Every imported part needs its geometry");
+  }
+
+  PaintableDescriptor descriptor;
+  std::optional<BoundingSphere> bounds;
 
+  for (size_t i = 0; i < parts.size(); i++) {
+    auto part_bounds = getBoundingSphere(*geometries[i].geometry_component);
+    bounds = bounds ? mergeBoundingSpheres(*bounds, part_bounds) : part_bounds;
+
+    descriptor.part_descriptors.push_back({
+        .preset = PaintablePartPreset::MESH,
+        .painted_map_size = parts[i].painted_map_size > 0
+                                ? parts[i].painted_map_size
+                                : DEFAULT_PAINTED_MAP_SIZE,
+        .geometry = geometry_cache::acquire(std::move(geometries[i])),
+    });
+  }
+
+  // Same size as the SPHERE preset, whose radius is 0.5
+  if (bounds && bounds->radius > 0.0f) {
+    descriptor.scale = glm::vec3(0.5f / bounds->radius);
+    descriptor.translation = -bounds->center * descriptor.scale;
+  }
+
+  return descriptor;
+}
+
+std::vector<PaintableDescriptor> getAssetPackPaintableDescriptors(
+    std::shared_ptr<const asset_pack::AssetPack> asset_pack) {
+  auto get_transform = [&asset_pack](uint32_t transform_index) {
+    const auto& transform = asset_pack->getTransform(transform_index);
+    return std::make_tuple(
+        glm::make_vec3(transform.scale),
+        glm::quat(transform.rotation[3], transform.rotation[0],
+                  transform.rotation[1], transform.rotation[2]),
+        glm::make_vec3(transform.translation));
+  };
+
+  std::vector<PaintableDescriptor> descriptors;
+  for (const auto& paintable : asset_pack->getPaintables()) {
+    auto& descriptor = descriptors.emplace_back();
+    std::tie(descriptor.scale, descriptor.rotation, descriptor.translation) =
+        get_transform(paintable.transform_index);
+
+    for (uint32_t i = 0; i < paintable.part_count; i++) {
+      size_t part_index = paintable.first_part + i;
+      const auto& part = asset_pack->getParts()[part_index];
+
+      auto& part_descriptor = descriptor.part_descriptors.emplace_back();
+      part_descriptor.preset = PaintablePartPreset::MESH;
+      std::tie(part_descriptor.scale, part_descriptor.rotation,
+               part_descriptor.translation) =
+          get_transform(part.transform_index);
+      if (part.painted_map_size > 0) {
+        part_descriptor.painted_map_size =
+            static_cast<int>(part.painted_map_size);
+      }
+      part_descriptor.geometry =
+          geometry_cache::acquire(asset_pack, part_index);
+      part_descriptor.baked_painted_map = asset_pack->getPaintedMap(part_index);
+    }
+  }
+
+  return descriptors;
+}
+
+std::vector<PaintablePartDescriptor> getPaintablePartDescriptors(
+    PaintablePreset preset) {
   if (preset == PaintablePreset::CUBE) {
-    // front face
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::PLANE, glm::vec3(0.8f),
-        glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)), glm::vec3(0.0f, 0.0f, 0.4f)));
-
-    // back face
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::PLANE, glm::vec3(0.8f),
-        glm::quat(glm::vec3(0.0f, glm::radians(180.0f), 0.0f)),
-        glm::vec3(0.0f, 0.0f, -0.4f)));
-
-    // left face
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::PLANE, glm::vec3(0.8f),
-        glm::quat(glm::vec3(0.0f, glm::radians(-90.0f), 0.0f)),
-        glm::vec3(-0.4f, 0.0f, 0.0f)));
-
-    // right face
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::PLANE, glm::vec3(0.8f),
-        glm::quat(glm::vec3(0.0f, glm::radians(90.0f), 0.0f)),
-        glm::vec3(0.4f, 0.0f, 0.0f)));
-
-    // top face
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::PLANE, glm::vec3(0.8f),
-        glm::quat(glm::vec3(glm::radians(-90.0f), 0.0f, 0.0f)),
-        glm::vec3(0.0f, 0.4f, 0.0f)));
-
-    // bottom face
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::PLANE, glm::vec3(0.8f),
-        glm::quat(glm::vec3(glm::radians(90.0f), 0.0f, 0.0f)),
-        glm::vec3(0.0f, -0.4f, 0.0f)));
+    return {
+        // front face
+        {.preset = PaintablePartPreset::PLANE,
+         .scale = glm::vec3(0.8f),
+         .rotation = glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
+         .translation = glm::vec3(0.0f, 0.0f, 0.4f)},
+        // back face
+        {.preset = PaintablePartPreset::PLANE,
+         .scale = glm::vec3(0.8f),
+         .rotation = glm::quat(glm::vec3(0.0f, glm::radians(180.0f), 0.0f)),
+         .translation = glm::vec3(0.0f, 0.0f, -0.4f)},
+        // left face
+        {.preset = PaintablePartPreset::PLANE,
+         .scale = glm::vec3(0.8f),
+         .rotation = glm::quat(glm::vec3(0.0f, glm::radians(-90.0f), 0.0f)),
+         .translation = glm::vec3(-0.4f, 0.0f, 0.0f)},
+        // right face
+        {.preset = PaintablePartPreset::PLANE,
+         .scale = glm::vec3(0.8f),
+         .rotation = glm::quat(glm::vec3(0.0f, glm::radians(90.0f), 0.0f)),
+         .translation = glm::vec3(0.4f, 0.0f, 0.0f)},
+        // top face
+        {.preset = PaintablePartPreset::PLANE,
+         .scale = glm::vec3(0.8f),
+         .rotation = glm::quat(glm::vec3(glm::radians(-90.0f), 0.0f, 0.0f)),
+         .translation = glm::vec3(0.0f, 0.4f, 0.0f)},
+        // bottom face
+        {.preset = PaintablePartPreset::PLANE,
+         .scale = glm::vec3(0.8f),
+         .rotation = glm::quat(glm::vec3(glm::radians(90.0f), 0.0f, 0.0f)),
+         .translation = glm::vec3(0.0f, -0.4f, 0.0f)},
+    };
   } else if (preset == PaintablePreset::PLANE) {
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::PLANE, glm::vec3(1.0f, 1.0f, 1.0f),
-        glm::quat(glm::vec3(glm::radians(-90.0f), 0.0f, 0.0f)),
-        glm::vec3(0.0f, 0.0f, 0.0f)));
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::PLANE, glm::vec3(1.0f, 1.0f, 1.0f),
-        glm::quat(glm::vec3(glm::radians(90.0f), 0.0f, 0.0f)),
-        glm::vec3(0.0f, -0.0001f, 0.0f)));
+    return {
+        {.preset = PaintablePartPreset::PLANE,
+         .scale = glm::vec3(1.0f, 1.0f, 1.0f),
+         .rotation = glm::quat(glm::vec3(glm::radians(-90.0f), 0.0f, 0.0f)),
+         .translation = glm::vec3(0.0f, 0.0f, 0.0f)},
+        {.preset = PaintablePartPreset::PLANE,
+         .scale = glm::vec3(1.0f, 1.0f, 1.0f),
+         .rotation = glm::quat(glm::vec3(glm::radians(90.0f), 0.0f, 0.0f)),
+         .translation = glm::vec3(0.0f, -0.0001f, 0.0f)},
+    };
   } else if (preset == PaintablePreset::SPHERE) {
-    paintable_part_entities.push_back(std::make_unique<PaintablePartEntity>(
-        PaintablePartPreset::SPHERE, glm::vec3(1.0f, 1.0f, 1.0f),
-        glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)), glm::vec3(0.0f, 0.0f, 0.0f)));
+    return {
+        {.preset = PaintablePartPreset::SPHERE,
+         .scale = glm::vec3(1.0f, 1.0f, 1.0f),
+         .rotation = glm::quat(glm::vec3(0.0f, 0.0f, 0.0f)),
+         .translation = glm::vec3(0.0f, 0.0f, 0.0f)},
+    };
+  } else if (preset == PaintablePreset::STRESS) {
+    return getStressPartDescriptors(StressPresetOptions());
   } else {
     throw std::invalid_argument("Invalid paintable preset");
   }
 }
+
+std::vector<PaintablePartDescriptor> getStressPartDescriptors(
+    const StressPresetOptions& options) {
+  auto placements =
+      stress_scene::getPartPlacements(options.layout, options.part_count);
+
+  std::vector<PaintablePartDescriptor> descriptors;
+  descriptors.reserve(placements.size());
+
+  for (const auto& placement : placements) {
+    descriptors.push_back({
+        .preset = options.part_preset,
+        .scale = placement.scale,
+        .rotation = placement.rotation,
+        .translation = placement.translation,
+        .geometry_segments = options.geometry_segments,
+        .painted_map_size = options.painted_map_size,
+    });
+  }
+
+  return descriptors;
+}
+
+size_t estimatePaintableBytes(
+    const std::vector<PaintableDescriptor>& descriptors) {
+  size_t bytes = 0;
+  std::set<std::pair<PaintablePartPreset, int>> geometry_keys;
+  std::set<const Vertex*> mesh_geometries;
+
+  for (const auto& paintable_descriptor : descriptors) {
+    for (const auto& descriptor : paintable_descriptor.part_descriptors) {
+      bytes += estimatePaintablePartTextureBytes(descriptor);
+
+      // Parts with the same geometry share it through geometry_cache
+      bool is_new_geometry =
+          descriptor.preset == PaintablePartPreset::MESH
+              ? mesh_geometries
+                    .insert(descriptor.geometry.view.vertices.data())
+                    .second
+              : geometry_keys
+                    .insert({descriptor.preset, descriptor.geometry_segments})
+                    .second;
+      if (is_new_geometry) {
+        bytes += estimatePaintablePartGeometryBytes(descriptor);
+      }
+    }
+  }
+
+  return bytes;
+}
@@ -24,36 +24,105 @@
 
 #include "./Entity/PaintablePartEntity.h"
 
-PaintablePartEntity::PaintablePartEntity(PaintablePartPreset preset,
-                                         glm::vec3 scale, glm::quat rotation,
-                                         glm::vec3 translation) {
-  int painted_map_width = 800;
-  int painted_map_height = 800;
-
-  gr_geometry_component = std::make_unique<GrGeometryComponent>();
-
-  gr_transform_uniform_component =
-      std::make_unique<GrUniformComponent>("ModelBlock");
-
-  transform_component =
-      std::make_unique<TransformComponent>(scale, rotation, translation);
-
-  gr_paint_framed_texture_component =
-      std::make_unique<GrFramedTextureComponent>(
-          TextureType::RGBA16, "u_paintMapTexture", painted_map_width,
-          painted_map_height);
-  gr_painted_ping_pong_texture_component =
-      std::make_unique<GrPingPongTextureComponent>(
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "./geometry_cache.h"
+
+GeometryPreset getGeometryPreset(PaintablePartPreset preset);
+glm::ivec2 getGeometrySegments(const PaintablePartDescriptor& descriptor);
+
+EntityHandle createPaintablePartEntity(
+    std::reference_wrapper<EntityRegistry> part_registry,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    TransformHandle parent_node, const PaintablePartDescriptor& descriptor) {
+  int painted_map_width = descriptor.painted_map_size;
+  int painted_map_height = descriptor.painted_map_size;
+
+  SharedGeometryComponent shared_geometry_component = descriptor.geometry;
+  if (descriptor.preset != PaintablePartPreset::MESH) {
+    auto geometry_segments = getGeometrySegments(descriptor);
+    shared_geometry_component =
+        geometry_cache::acquire(getGeometryPreset(descriptor.preset),
+                                geometry_segments.x, geometry_segments.y);
+  } else if (!shared_geometry_component.gr_geometry_component) {
+    throw std::invalid_argument("MESH part without geometry");
+  }
+
+  return part_registry.get().create(
+      TransformNodeComponent{
+          .node = transform_hierarchy.get().create(
+              parent_node, descriptor.scale, descriptor.rotation,
+              descriptor.translation),
+      },
+      std::move(shared_geometry_component),
+      GrUniformComponent("ModelBlock"),
+      GrFramedTextureComponent(TextureType::RGBA16, "u_paintMapTexture",
+                               painted_map_width, painted_map_height),
+      GrPingPongTextureComponent(
           TextureType::RGBA16, "u_paintedMapTexture", painted_map_width,
-          painted_map_height);
+          painted_map_height,
+          getMipLevelCount(painted_map_width, painted_map_height)),
+      MeshletSelectionComponent());
+}
+
+size_t estimatePaintablePartBytes(const PaintablePartDescriptor& descriptor) {
+  return estimatePaintablePartTextureBytes(descriptor) +
+         estimatePaintablePartGeometryBytes(descriptor);
+}
+
+size_t estimatePaintablePartTextureBytes(
+    const PaintablePartDescriptor& descriptor) {
+  // Paint map and the two painted ping pong maps, with their mips
+  int size = descriptor.painted_map_size;
+  return getTextureBytes(TextureType::RGBA16, size, size, 1) +
+         2 * getTextureBytes(TextureType::RGBA16, size, size,
+                             getMipLevelCount(size, size));
+}
+
+size_t estimatePaintablePartGeometryBytes(
+    const PaintablePartDescriptor& descriptor) {
+  if (descriptor.preset == PaintablePartPreset::MESH) {
+    const auto& geometry_view = descriptor.geometry.view;
+    return geometry_view.vertices.size_bytes() +
+           geometry_view.index_count *
+               std::min(getIndexSize(geometry_view.vertices.size()),
+                        geometry_view.index_size);
+  }
+
+  auto geometry_segments = getGeometrySegments(descriptor);
+
+  size_t vertex_count = static_cast<size_t>(geometry_segments.x + 1) *
+                        (geometry_segments.y + 1);
+  size_t index_count =
+      static_cast<size_t>(geometry_segments.x) * geometry_segments.y * 6;
 
+  return vertex_count * sizeof(Vertex) +
+         index_count * getIndexSize(vertex_count);
+}
+
+GeometryPreset getGeometryPreset(PaintablePartPreset preset) {
   if (preset == PaintablePartPreset::PLANE) {
-    geometry_component =
-        std::make_unique<GeometryComponent>(GeometryPreset::PLANE);
+    return GeometryPreset::PLANE;
   } else if (preset == PaintablePartPreset::SPHERE) {
-    geometry_component =
-        std::make_unique<GeometryComponent>(GeometryPreset::SPHERE);
+    return GeometryPreset::SPHERE;
   } else {
     throw std::invalid_argument("Invalid paintable part preset");
   }
 }
+
+glm::ivec2 getGeometrySegments(const PaintablePartDescriptor& descriptor) {
+  auto geometry_preset = getGeometryPreset(descriptor.preset);
+
+  if (descriptor.geometry_segments <= 0) {
+    return getDefaultGeometrySegments(geometry_preset);
+  }
+
+  if (geometry_preset == GeometryPreset::SPHERE) {
+    return glm::ivec2(descriptor.geometry_segments * 2,
+                      descriptor.geometry_segments);
+  }
+
+  return glm::ivec2(descriptor.geometry_segments);
+}
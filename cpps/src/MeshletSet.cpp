@@ -0,0 +1,621 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./MeshletSet.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "./job_system.h"
+
+namespace {
+
+// Spreads the low 10 bits of `value` to every third bit
+uint32_t spreadBits(uint32_t value) {
+  value &= 0x3ff;
+  value = (value | (value << 16)) & 0x30000ff;
+  value = (value | (value << 8)) & 0x300f00f;
+  value = (value | (value << 4)) & 0x30c30c3;
+  value = (value | (value << 2)) & 0x9249249;
+  return value;
+}
+
+// Interleaves 10 bits per axis of a position within [0, 1]
+uint32_t getMortonCode(const glm::vec3& position) {
+  glm::uvec3 cell = glm::uvec3(glm::clamp(position, 0.0f, 1.0f) * 1023.0f);
+  return spreadBits(cell.x) | (spreadBits(cell.y) << 1) |
+         (spreadBits(cell.z) << 2);
+}
+
+// Cone around the normals, from their sum. Normals are added per corner, so
+// that the sum weighs them roughly by area.
+class NormalConeBuilder {
+ public:
+  void add(const glm::vec3& normal) { normal_sum += normal; }
+
+  NormalCone getCone() const {
+    float normal_sum_length = glm::length(normal_sum);
+    if (normal_sum_length <= 1e-6f) {
+      return {glm::vec3(0.0f, 0.0f, 1.0f), -1.0f};
+    }
+    return {normal_sum / normal_sum_length, 1.0f};
+  }
+
+ private:
+  glm::vec3 normal_sum = glm::vec3(0.0f);
+};
+
+void widenCone(NormalCone& cone, const glm::vec3& normal) {
+  if (cone.cos > 0.0f) {
+    cone.cos = std::min(cone.cos, glm::dot(normal, cone.axis));
+  }
+}
+
+// Normal of the triangle plane, on the side of its vertex normals, or zero
+// for a degenerate triangle
+glm::vec3 getFaceNormal(const glm::vec3* positions, const glm::vec3* normals) {
+  glm::vec3 normal =
+      glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+  float normal_length = glm::length(normal);
+  if (normal_length <= 0.0f) {
+    return glm::vec3(0.0f);
+  }
+
+  glm::vec3 vertex_normal_sum = normals[0] + normals[1] + normals[2];
+  return normal / (glm::dot(normal, vertex_normal_sum) < 0.0f
+                       ? -normal_length
+                       : normal_length);
+}
+
+Meshlet buildMeshlet(const GeometryView& geometry_view, uint32_t first_index,
+                     uint32_t index_count) {
+  // Vertices of each corner, unpacked once
+  std::array<glm::vec3, MESHLET_TRIANGLE_COUNT * 3> positions;
+  std::array<glm::vec3, MESHLET_TRIANGLE_COUNT * 3> normals;
+  std::array<glm::vec3, MESHLET_TRIANGLE_COUNT> face_normals;
+
+  glm::vec3 min_position = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 max_position = glm::vec3(std::numeric_limits<float>::lowest());
+  NormalConeBuilder vertex_cone_builder;
+  NormalConeBuilder face_cone_builder;
+  for (uint32_t i = 0; i < index_count; i++) {
+    const auto& vertex =
+        geometry_view.vertices[geometry_view.getIndex(first_index + i)];
+    positions[i] = vertex.position;
+    normals[i] = unpackNormal(vertex.normal);
+
+    min_position = glm::min(min_position, positions[i]);
+    max_position = glm::max(max_position, positions[i]);
+    vertex_cone_builder.add(normals[i]);
+
+    if (i % 3 == 2) {
+      face_normals[i / 3] =
+          getFaceNormal(&positions[i - 2], &normals[i - 2]);
+      face_cone_builder.add(face_normals[i / 3]);
+    }
+  }
+
+  Meshlet meshlet = {
+      .first_index = first_index,
+      .index_count = index_count,
+      .sphere = {(min_position + max_position) * 0.5f, 0.0f},
+      .vertex_cone = vertex_cone_builder.getCone(),
+      .face_cone = face_cone_builder.getCone(),
+  };
+
+  for (uint32_t i = 0; i < index_count; i++) {
+    meshlet.sphere.radius =
+        std::max(meshlet.sphere.radius,
+                 glm::length(positions[i] - meshlet.sphere.center));
+    widenCone(meshlet.vertex_cone, normals[i]);
+
+    // Degenerate triangles cover nothing
+    if (i % 3 == 2 && face_normals[i / 3] != glm::vec3(0.0f)) {
+      widenCone(meshlet.face_cone, face_normals[i / 3]);
+    }
+  }
+
+  return meshlet;
+}
+
+// Whether every normal within `cone` points away from `apex`, anywhere in
+// `sphere`. The directions from the sphere to the apex are within the angle
+// the sphere subtends of the direction to its center, so they all have to be
+// more than 90 degrees plus the cone angle from the cone axis.
+bool isFacingAway(const NormalCone& cone, const BoundingSphere& sphere,
+                  const glm::vec3& apex) {
+  if (cone.cos <= 0.0f) {
+    return false;
+  }
+
+  glm::vec3 offset = apex - sphere.center;
+  float distance = glm::length(offset);
+  if (distance <= sphere.radius) {
+    return false;
+  }
+
+  float cone_sin = std::sqrt(1.0f - cone.cos * cone.cos);
+  float sphere_sin = sphere.radius / distance;
+  float sphere_cos = std::sqrt(1.0f - sphere_sin * sphere_sin);
+
+  // Both angles together reach past 90 degrees, so some direction is in front
+  if (cone.cos * sphere_cos - cone_sin * sphere_sin <= 0.0f) {
+    return false;
+  }
+
+  return glm::dot(cone.axis, offset) <=
+         -distance * (cone_sin * sphere_cos + cone.cos * sphere_sin);
+}
+
+UvRect getMeshletUvRect(const GeometryView& geometry_view,
+                        const Meshlet& meshlet) {
+  UvRect uv_rect;
+  for (uint32_t i = 0; i < meshlet.index_count; i++) {
+    uv_rect.add(unpackTexCoords(
+        geometry_view.vertices[geometry_view.getIndex(meshlet.first_index + i)]
+            .tex_coords));
+  }
+
+  return uv_rect;
+}
+
+TriangleGroup buildTriangleGroup(const GeometryView& geometry_view,
+                                 uint32_t first_index, uint32_t index_count) {
+  glm::vec3 min_position = glm::vec3(std::numeric_limits<float>::max());
+  glm::vec3 max_position = glm::vec3(std::numeric_limits<float>::lowest());
+  TriangleGroup triangle_group = {
+      .first_index = first_index,
+      .index_count = index_count,
+      // Both are filled in below
+      .sphere = {glm::vec3(0.0f), 0.0f},
+      .uv_rect = UvRect(),
+  };
+  for (uint32_t i = 0; i < index_count; i++) {
+    const auto& vertex =
+        geometry_view.vertices[geometry_view.getIndex(first_index + i)];
+    min_position = glm::min(min_position, vertex.position);
+    max_position = glm::max(max_position, vertex.position);
+    triangle_group.uv_rect.add(unpackTexCoords(vertex.tex_coords));
+  }
+
+  triangle_group.sphere = {(min_position + max_position) * 0.5f, 0.0f};
+  for (uint32_t i = 0; i < index_count; i++) {
+    triangle_group.sphere.radius = std::max(
+        triangle_group.sphere.radius,
+        glm::length(
+            geometry_view.vertices[geometry_view.getIndex(first_index + i)]
+                .position -
+            triangle_group.sphere.center));
+  }
+
+  return triangle_group;
+}
+
+struct ClipVertex {
+  glm::vec3 position;
+  glm::vec2 uv;
+};
+
+// UV bounds of the part of a triangle inside every plane through `apex`,
+// given by its normal, which points outside
+UvRect clipTriangleUvs(const std::array<ClipVertex, 3>& triangle,
+                       const std::array<glm::vec3, 4>& plane_normals,
+                       const glm::vec3& apex) {
+  // Most triangles are either inside every plane or outside one of them
+  bool is_inside = true;
+  for (const auto& plane_normal : plane_normals) {
+    int outside_count = 0;
+    for (const auto& vertex : triangle) {
+      outside_count += glm::dot(plane_normal, vertex.position - apex) > 0.0f;
+    }
+    if (outside_count == 3) {
+      return {};
+    }
+    is_inside &= outside_count == 0;
+  }
+  if (is_inside) {
+    UvRect uv_rect;
+    for (const auto& vertex : triangle) {
+      uv_rect.add(vertex.uv);
+    }
+    return uv_rect;
+  }
+
+  // Clipping by a plane adds at most one vertex
+  std::array<ClipVertex, 7> polygon;
+  std::array<ClipVertex, 7> clipped_polygon;
+  std::copy(triangle.begin(), triangle.end(), polygon.begin());
+  size_t vertex_count = 3;
+
+  for (const auto& plane_normal : plane_normals) {
+    size_t clipped_vertex_count = 0;
+    for (size_t i = 0; i < vertex_count; i++) {
+      const auto& a = polygon[i];
+      const auto& b = polygon[(i + 1) % vertex_count];
+      float a_distance = glm::dot(plane_normal, a.position - apex);
+      float b_distance = glm::dot(plane_normal, b.position - apex);
+
+      if (a_distance <= 0.0f) {
+        clipped_polygon[clipped_vertex_count++] = a;
+      }
+      if ((a_distance <= 0.0f) != (b_distance <= 0.0f)) {
+        float t = a_distance / (a_distance - b_distance);
+        clipped_polygon[clipped_vertex_count++] = {
+            glm::mix(a.position, b.position, t), glm::mix(a.uv, b.uv, t)};
+      }
+    }
+
+    polygon = clipped_polygon;
+    vertex_count = clipped_vertex_count;
+    if (vertex_count == 0) {
+      return {};
+    }
+  }
+
+  UvRect uv_rect;
+  for (size_t i = 0; i < vertex_count; i++) {
+    uv_rect.add(polygon[i].uv);
+  }
+
+  return uv_rect;
+}
+
+}  // namespace
+
+void MeshletRanges::add(const MeshletRange& range) {
+  if (range_count > 0) {
+    auto& last_range = ranges[range_count - 1];
+    uint32_t last_end = last_range.first_index + last_range.index_count;
+    if (range.first_index <= last_end) {
+      last_range.index_count =
+          std::max(last_end, range.first_index + range.index_count) -
+          last_range.first_index;
+      return;
+    }
+  }
+
+  ranges[range_count] = range;
+  range_count++;
+  if (range_count <= MAX_MESHLET_DRAW_RANGES) {
+    return;
+  }
+
+  size_t merged_index = 0;
+  uint32_t smallest_gap = std::numeric_limits<uint32_t>::max();
+  for (size_t i = 0; i + 1 < range_count; i++) {
+    uint32_t gap = ranges[i + 1].first_index -
+                   (ranges[i].first_index + ranges[i].index_count);
+    if (gap < smallest_gap) {
+      smallest_gap = gap;
+      merged_index = i;
+    }
+  }
+
+  const auto& next_range = ranges[merged_index + 1];
+  ranges[merged_index].index_count = next_range.first_index +
+                                     next_range.index_count -
+                                     ranges[merged_index].first_index;
+  std::copy(ranges.begin() + merged_index + 2, ranges.begin() + range_count,
+            ranges.begin() + merged_index + 1);
+  range_count--;
+}
+
+void MeshletRanges::merge(const MeshletRanges& other) {
+  auto a = get();
+  auto b = other.get();
+
+  MeshletRanges merged;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < a.size() || j < b.size()) {
+    if (j == b.size() ||
+        (i < a.size() && a[i].first_index <= b[j].first_index)) {
+      merged.add(a[i]);
+      i++;
+    } else {
+      merged.add(b[j]);
+      j++;
+    }
+  }
+
+  *this = merged;
+}
+
+void clusterTriangles(GeometryComponent& geometry_component) {
+  const auto& vertices = geometry_component.vertices;
+  auto& indices = geometry_component.indices;
+  size_t triangle_count = indices.size() / 3;
+  if (triangle_count <= MESHLET_TRIANGLE_COUNT) {
+    return;
+  }
+
+  auto bounds = getBoundingSphere(geometry_component);
+  glm::vec3 bounds_min = bounds.center - glm::vec3(bounds.radius);
+  float bounds_scale = bounds.radius > 0.0f ? 0.5f / bounds.radius : 0.0f;
+
+  // Morton code of the center of each triangle in the high bits, and the
+  // triangle in the low bits
+  std::vector<uint64_t> seeds(triangle_count);
+  job_system::parallelFor(
+      0, triangle_count, 4096, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t triangle = chunk_begin; triangle < chunk_end; triangle++) {
+          glm::vec3 center = (vertices[indices[triangle * 3]].position +
+                              vertices[indices[triangle * 3 + 1]].position +
+                              vertices[indices[triangle * 3 + 2]].position) /
+                             3.0f;
+          uint64_t code = getMortonCode((center - bounds_min) * bounds_scale);
+          seeds[triangle] = (code << 32) | triangle;
+        }
+      });
+  std::sort(seeds.begin(), seeds.end());
+
+  // Triangles around each vertex
+  std::vector<uint32_t> vertex_offsets(vertices.size() + 1, 0);
+  for (auto index : indices) {
+    vertex_offsets[index + 1]++;
+  }
+  for (size_t i = 1; i < vertex_offsets.size(); i++) {
+    vertex_offsets[i] += vertex_offsets[i - 1];
+  }
+  std::vector<uint32_t> vertex_triangles(indices.size());
+  std::vector<uint32_t> vertex_cursors(vertex_offsets.begin(),
+                                       vertex_offsets.end() - 1);
+  for (size_t i = 0; i < indices.size(); i++) {
+    vertex_triangles[vertex_cursors[indices[i]]++] =
+        static_cast<uint32_t>(i / 3);
+  }
+  // Triangles before the cursor are clustered, so that vertices shared by
+  // many triangles are only scanned once
+  std::copy(vertex_offsets.begin(), vertex_offsets.end() - 1,
+            vertex_cursors.begin());
+
+  // Meshlets grow breadth first over triangles sharing vertices, and take the
+  // next seed when they run out of neighbors. `order` doubles as the queue.
+  std::vector<bool> is_clustered(triangle_count, false);
+  std::vector<uint32_t> order;
+  order.reserve(triangle_count);
+  size_t seed_index = 0;
+
+  while (order.size() < triangle_count) {
+    size_t meshlet_end =
+        std::min(order.size() + MESHLET_TRIANGLE_COUNT, triangle_count);
+    size_t queue_index = order.size();
+
+    while (order.size() < meshlet_end) {
+      if (queue_index == order.size()) {
+        while (is_clustered[static_cast<uint32_t>(seeds[seed_index])]) {
+          seed_index++;
+        }
+        uint32_t seed = static_cast<uint32_t>(seeds[seed_index]);
+        is_clustered[seed] = true;
+        order.push_back(seed);
+      }
+
+      uint32_t triangle = order[queue_index];
+      queue_index++;
+      for (int corner = 0; corner < 3; corner++) {
+        uint32_t vertex = indices[triangle * 3 + corner];
+        for (auto& cursor = vertex_cursors[vertex];
+             cursor < vertex_offsets[vertex + 1] &&
+             order.size() < meshlet_end;
+             cursor++) {
+          uint32_t neighbor = vertex_triangles[cursor];
+          if (!is_clustered[neighbor]) {
+            is_clustered[neighbor] = true;
+            order.push_back(neighbor);
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<unsigned int> clustered_indices(indices.size());
+  for (size_t i = 0; i < triangle_count; i++) {
+    std::copy_n(indices.begin() + order[i] * 3, 3,
+                clustered_indices.begin() + i * 3);
+  }
+  indices = std::move(clustered_indices);
+}
+
+MeshletSet::MeshletSet(const GeometryView& geometry_view) {
+  size_t triangle_count = geometry_view.index_count / 3;
+  size_t meshlet_count =
+      (triangle_count + MESHLET_TRIANGLE_COUNT - 1) / MESHLET_TRIANGLE_COUNT;
+  meshlets.resize(meshlet_count);
+  uv_rects.resize(meshlet_count);
+
+  job_system::parallelFor(
+      0, meshlet_count, 64, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t i = chunk_begin; i < chunk_end; i++) {
+          size_t first_triangle = i * MESHLET_TRIANGLE_COUNT;
+          size_t meshlet_triangle_count = std::min(
+              MESHLET_TRIANGLE_COUNT, triangle_count - first_triangle);
+          meshlets[i] =
+              buildMeshlet(geometry_view,
+                           static_cast<uint32_t>(first_triangle * 3),
+                           static_cast<uint32_t>(meshlet_triangle_count * 3));
+          uv_rects[i] = getMeshletUvRect(geometry_view, meshlets[i]);
+        }
+      });
+
+  buildTriangleGroups(geometry_view);
+}
+
+MeshletSet::MeshletSet(std::span<const Meshlet> meshlets,
+                       const GeometryView& geometry_view)
+    : meshlets(meshlets.begin(), meshlets.end()) {
+  size_t index_count = geometry_view.index_count;
+  for (const auto& meshlet : meshlets) {
+    if (meshlet.first_index % 3 != 0 || meshlet.index_count % 3 != 0 ||
+        meshlet.first_index > index_count ||
+        meshlet.index_count > index_count - meshlet.first_index) {
+      throw std::runtime_error("Invalid meshlet");
+    }
+  }
+
+  uv_rects.resize(meshlets.size());
+  job_system::parallelFor(
+      0, meshlets.size(), 64, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t i = chunk_begin; i < chunk_end; i++) {
+          uv_rects[i] = getMeshletUvRect(geometry_view, meshlets[i]);
+        }
+      });
+
+  buildTriangleGroups(geometry_view);
+}
+
+void MeshletSet::buildTriangleGroups(const GeometryView& geometry_view) {
+  first_triangle_groups.reserve(meshlets.size() + 1);
+  first_triangle_groups.push_back(0);
+
+  for (size_t i = 0; i < meshlets.size(); i++) {
+    if (uv_rects[i].getArea() > MAX_UNCLIPPED_MESHLET_UV_AREA) {
+      const auto& meshlet = meshlets[i];
+      auto group_index_count =
+          static_cast<uint32_t>(TRIANGLE_GROUP_TRIANGLE_COUNT * 3);
+      for (uint32_t first_index = meshlet.first_index;
+           first_index < meshlet.first_index + meshlet.index_count;
+           first_index += group_index_count) {
+        triangle_groups.push_back(buildTriangleGroup(
+            geometry_view, first_index,
+            std::min(group_index_count,
+                     meshlet.first_index + meshlet.index_count -
+                         first_index)));
+      }
+    }
+
+    first_triangle_groups.push_back(
+        static_cast<uint32_t>(triangle_groups.size()));
+  }
+}
+
+void MeshletSet::selectInCone(const GeometryView& geometry_view,
+                              const glm::mat4& matrix, const glm::vec3& apex,
+                              const glm::vec3& axis, float half_angle,
+                              MeshletRanges& depth_ranges,
+                              MeshletRanges& decal_ranges,
+                              UvRects& decal_uv_rects) const {
+  // Facing is tested in the meshlets' space, where the normals are:
+  // transforming normals by the inverse transpose keeps their dot products
+  // with transformed offsets
+  glm::vec3 local_apex =
+      glm::vec3(glm::inverse(matrix) * glm::vec4(apex, 1.0f));
+
+  // Same as isSphereInCone on transformBoundingSphere, with what does not
+  // depend on the meshlet taken out of the loop
+  float cone_cos = std::cos(half_angle);
+  float cone_sin = std::sin(half_angle);
+  float max_scale = std::max({glm::length(glm::vec3(matrix[0])),
+                              glm::length(glm::vec3(matrix[1])),
+                              glm::length(glm::vec3(matrix[2]))});
+
+  // Sides of the square pyramid around the cone, with any roll. Their
+  // normals are transformed into the meshlets' space by the transpose, which
+  // keeps their dot products with transformed offsets.
+  glm::vec3 side = glm::normalize(glm::cross(
+      axis, std::abs(axis.y) < 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f)
+                                    : glm::vec3(1.0f, 0.0f, 0.0f)));
+  glm::vec3 up = glm::cross(side, axis);
+  glm::vec3 axial = axis * std::tan(half_angle);
+  glm::mat3 normal_to_local = glm::transpose(glm::mat3(matrix));
+  std::array<glm::vec3, 4> local_plane_normals = {
+      normal_to_local * (side - axial), normal_to_local * (-side - axial),
+      normal_to_local * (up - axial), normal_to_local * (-up - axial)};
+  UvRectGrid decal_uv_rect_grid;
+
+  for (size_t meshlet_index = 0; meshlet_index < meshlets.size();
+       meshlet_index++) {
+    const auto& meshlet = meshlets[meshlet_index];
+    glm::vec3 offset =
+        glm::vec3(matrix * glm::vec4(meshlet.sphere.center, 1.0f)) - apex;
+    float axial_distance = glm::dot(offset, axis);
+    float radial_distance = glm::length(offset - axis * axial_distance);
+    if (cone_cos * radial_distance - cone_sin * axial_distance >
+        meshlet.sphere.radius * max_scale) {
+      continue;
+    }
+
+    MeshletRange range = {meshlet.first_index, meshlet.index_count};
+    if (!isFacingAway(meshlet.face_cone, meshlet.sphere, local_apex)) {
+      depth_ranges.add(range);
+    }
+    if (isFacingAway(meshlet.vertex_cone, meshlet.sphere, local_apex)) {
+      continue;
+    }
+    decal_ranges.add(range);
+
+    if (first_triangle_groups[meshlet_index] ==
+        first_triangle_groups[meshlet_index + 1]) {
+      decal_uv_rect_grid.add(uv_rects[meshlet_index]);
+      continue;
+    }
+
+    // Meshlets spanning much of the texture coordinates are tested by
+    // triangle group, and the triangles of large groups the cone may cross
+    // are clipped to the pyramid around it
+    for (uint32_t group_index = first_triangle_groups[meshlet_index];
+         group_index < first_triangle_groups[meshlet_index + 1];
+         group_index++) {
+      const auto& triangle_group = triangle_groups[group_index];
+      glm::vec3 group_offset =
+          glm::vec3(matrix * glm::vec4(triangle_group.sphere.center, 1.0f)) -
+          apex;
+      float group_axial_distance = glm::dot(group_offset, axis);
+      float cone_distance =
+          cone_cos *
+              glm::length(group_offset - axis * group_axial_distance) -
+          cone_sin * group_axial_distance;
+      float scaled_radius = triangle_group.sphere.radius * max_scale;
+      if (cone_distance > scaled_radius) {
+        continue;
+      }
+
+      bool is_inside_cone = cone_distance < -scaled_radius &&
+                            group_axial_distance > scaled_radius;
+      if (is_inside_cone ||
+          triangle_group.uv_rect.getArea() <= MAX_UNCLIPPED_MESHLET_UV_AREA) {
+        decal_uv_rect_grid.add(triangle_group.uv_rect);
+        continue;
+      }
+
+      for (uint32_t i = 0; i < triangle_group.index_count; i += 3) {
+        std::array<ClipVertex, 3> triangle;
+        for (uint32_t corner = 0; corner < 3; corner++) {
+          const auto& vertex = geometry_view.vertices[geometry_view.getIndex(
+              triangle_group.first_index + i + corner)];
+          triangle[corner] = {vertex.position,
+                              unpackTexCoords(vertex.tex_coords)};
+        }
+        decal_uv_rect_grid.add(
+            clipTriangleUvs(triangle, local_plane_normals, local_apex));
+      }
+    }
+  }
+
+  decal_uv_rect_grid.addTo(decal_uv_rects);
+}
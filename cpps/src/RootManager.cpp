@@ -24,36 +24,195 @@
 
 #include "./RootManager.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include "./geometry_cache.h"
+#include "./gr_resource_pool.h"
+#include "./gr_resource_registry.h"
+
+int getMaxPaintedMapSize(const std::vector<PaintableDescriptor>& descriptors);
+
 RootManager::RootManager() {
   config_entity = std::make_unique<ConfigEntity>();
   client_input_entity = std::make_unique<ClientInputEntity>();
   gr_global_entity = std::make_unique<GrGlobalEntity>();
   camera_entity = std::make_unique<CameraEntity>();
   brush_entity = std::make_unique<BrushEntity>();
-  paintable_entity = std::make_unique<PaintableEntity>(PaintablePreset::CUBE);
-
-  render_items_view = std::make_unique<RenderItemsView>(
-      std::ref(*paintable_entity), std::ref(*camera_entity));
-  painted_textures_view =
-      std::make_unique<PaintedTexturesView>(std::ref(*paintable_entity));
-  transform_updating_view =
-      std::make_unique<TransformUpdatingView>(std::ref(*paintable_entity));
-  gr_model_geometries_view =
-      std::make_unique<GrModelGeometriesView>(std::ref(*paintable_entity));
-}
-
-void RootManager::resetPaintable(PaintablePreset paintable_preset) {
-  paintable_entity = std::make_unique<PaintableEntity>(paintable_preset);
-  resetPaintableViews();
-}
-
-void RootManager::resetPaintableViews() {
-  render_items_view = std::make_unique<RenderItemsView>(
-      std::ref(*paintable_entity), std::ref(*camera_entity));
-  painted_textures_view =
-      std::make_unique<PaintedTexturesView>(std::ref(*paintable_entity));
-  transform_updating_view =
-      std::make_unique<TransformUpdatingView>(std::ref(*paintable_entity));
-  gr_model_geometries_view =
-      std::make_unique<GrModelGeometriesView>(std::ref(*paintable_entity));
-}
\ No newline at end of file
+  lighting_entity = std::make_unique<LightingEntity>();
+  scene_entity = std::make_unique<SceneEntity>();
+  for (const auto& descriptor :
+       getPaintableDescriptors(PaintablePreset::CUBE)) {
+    paintable_entities.push_back(createPaintable(descriptor));
+  }
+  stress_test_entity = std::make_unique<StressTestEntity>();
+  model_switch_entity = std::make_unique<ModelSwitchEntity>();
+}
+
+bool RootManager::resetPaintable(PaintablePreset paintable_preset) {
+  return resetPaintable(getPaintableDescriptors(paintable_preset));
+}
+
+bool RootManager::resetPaintable(
+    const StressPresetOptions& stress_preset_options) {
+  return resetPaintable(getStressPaintableDescriptors(stress_preset_options));
+}
+
+bool RootManager::resetPaintable(
+    std::vector<PaintableDescriptor> descriptors) {
+  cancelPaintableSwitch();
+
+  // The current paintables are released before the new ones get allocated,
+  // and pooled objects are deleted if they do not fit next to them
+  size_t reusable_bytes =
+      gr_resource_registry::getOwnerBytes("PaintableEntity") +
+      gr_resource_pool::getIdleBytes();
+
+  if (!applyMemoryBudget(descriptors, reusable_bytes)) {
+    return false;
+  }
+
+  size_t required_bytes = estimatePaintableBytes(descriptors);
+
+  paintable_entities.clear();
+
+  if (gr_resource_registry::getLiveBytes() + required_bytes >
+      gr_resource_registry::getBudgetBytes()) {
+    geometry_cache::trim();
+    gr_resource_pool::trim();
+  }
+
+  for (const auto& descriptor : descriptors) {
+    paintable_entities.push_back(createPaintable(descriptor));
+  }
+
+  return true;
+}
+
+bool RootManager::beginPaintableSwitch(
+    std::vector<PaintableDescriptor> descriptors) {
+  cancelPaintableSwitch();
+
+  if (descriptors.empty()) {
+    throw std::invalid_argument("Scene has no paintables");
+  }
+
+  // Both scenes are alive until the swap, so only pooled objects can make room
+  // for the new one
+  size_t reusable_bytes = gr_resource_pool::getIdleBytes();
+
+  if (!applyMemoryBudget(descriptors, reusable_bytes)) {
+    return false;
+  }
+
+  if (gr_resource_registry::getLiveBytes() +
+          estimatePaintableBytes(descriptors) >
+      gr_resource_registry::getBudgetBytes()) {
+    geometry_cache::trim();
+    gr_resource_pool::trim();
+  }
+
+  // Parts are added by manage_system::stepModelSwitch
+  for (const auto& descriptor : descriptors) {
+    model_switch_entity->pending_paintable_entities.push_back(
+        createPaintable(PaintableDescriptor{
+            .scale = descriptor.scale,
+            .rotation = descriptor.rotation,
+            .translation = descriptor.translation,
+            .part_descriptors = {},
+        }));
+  }
+
+  auto& model_switch_component =
+      *model_switch_entity->model_switch_component;
+  model_switch_component.descriptors = std::move(descriptors);
+
+  return true;
+}
+
+void RootManager::cancelPaintableSwitch() {
+  model_switch_entity->pending_paintable_entities.clear();
+  model_switch_entity->model_switch_component->reset();
+  model_switch_entity->mesh_import_component->cancel();
+}
+
+void RootManager::swapPaintable() {
+  // The previous paintables are released along with the pending list
+  paintable_entities.swap(model_switch_entity->pending_paintable_entities);
+  model_switch_entity->pending_paintable_entities.clear();
+  model_switch_entity->model_switch_component->reset();
+}
+
+bool RootManager::applyMemoryBudget(
+    std::vector<PaintableDescriptor>& descriptors, size_t reusable_bytes) {
+  size_t other_bytes = gr_resource_registry::getLiveBytes() - reusable_bytes;
+  size_t budget_bytes = gr_resource_registry::getBudgetBytes();
+  size_t available_bytes =
+      budget_bytes > other_bytes ? budget_bytes - other_bytes : 0;
+  size_t required_bytes = estimatePaintableBytes(descriptors);
+  // Like the model switch stats, only refusals are logged unless profiling
+  bool is_logged = stress_test_entity->profile_component->is_enabled;
+
+  if (required_bytes > available_bytes) {
+    switch (gr_resource_registry::getBudgetPolicy()) {
+      case GrMemoryBudgetPolicy::LOG:
+        if (is_logged) {
+          printf("[gr] paintable needs %.1f MB, %.1f MB left in budget\n",
+                 required_bytes / (1024.0 * 1024.0),
+                 available_bytes / (1024.0 * 1024.0));
+        }
+        break;
+      case GrMemoryBudgetPolicy::DOWNSCALE:
+        while (required_bytes > available_bytes) {
+          bool is_downscaled = false;
+          for (auto& paintable_descriptor : descriptors) {
+            for (auto& descriptor : paintable_descriptor.part_descriptors) {
+              if (descriptor.painted_map_size / 2 >= MIN_PAINTED_MAP_SIZE) {
+                descriptor.painted_map_size /= 2;
+                is_downscaled = true;
+              }
+            }
+          }
+
+          if (!is_downscaled) {
+            break;
+          }
+
+          required_bytes = estimatePaintableBytes(descriptors);
+        }
+        if (is_logged) {
+          printf(
+              "[gr] paintable downscaled to %d px painted maps (%.1f MB)\n",
+              getMaxPaintedMapSize(descriptors),
+              required_bytes / (1024.0 * 1024.0));
+        }
+        break;
+      case GrMemoryBudgetPolicy::REFUSE:
+        printf("[gr] paintable refused: needs %.1f MB, %.1f MB left\n",
+               required_bytes / (1024.0 * 1024.0),
+               available_bytes / (1024.0 * 1024.0));
+        return false;
+    }
+  }
+
+  return true;
+}
+
+std::unique_ptr<PaintableEntity> RootManager::createPaintable(
+    const PaintableDescriptor& descriptor) {
+  return std::make_unique<PaintableEntity>(
+      descriptor, std::ref(*scene_entity->transform_hierarchy),
+      scene_entity->transform_component->node);
+}
+
+int getMaxPaintedMapSize(const std::vector<PaintableDescriptor>& descriptors) {
+  int max_painted_map_size = 0;
+  for (const auto& paintable_descriptor : descriptors) {
+    for (const auto& descriptor : paintable_descriptor.part_descriptors) {
+      max_painted_map_size =
+          std::max(max_painted_map_size, descriptor.painted_map_size);
+    }
+  }
+  return max_painted_map_size;
+}
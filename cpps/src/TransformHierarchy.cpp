@@ -0,0 +1,217 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./TransformHierarchy.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "./math_util.h"
+
+template <typename T>
+void insertAt(std::vector<T>& values, uint32_t slot, const T& value) {
+  values.insert(values.begin() + slot, value);
+}
+
+template <typename T>
+void eraseRange(std::vector<T>& values, uint32_t slot, uint32_t count) {
+  values.erase(values.begin() + slot, values.begin() + slot + count);
+}
+
+TransformHandle TransformHierarchy::create(TransformHandle parent,
+                                           const glm::vec3& scale,
+                                           const glm::quat& rotation,
+                                           const glm::vec3& translation) {
+  uint32_t parent_slot = NO_SLOT;
+  uint32_t slot = handle_indices.size();
+
+  if (parent != TransformHandle()) {
+    parent_slot = getSlot(parent);
+    slot = parent_slot + subtree_sizes[parent_slot];
+
+    for (uint32_t ancestor_slot = parent_slot; ancestor_slot != NO_SLOT;
+         ancestor_slot = parent_slots[ancestor_slot]) {
+      subtree_sizes[ancestor_slot]++;
+    }
+  }
+
+  for (size_t i = slot; i < parent_slots.size(); i++) {
+    if (parent_slots[i] != NO_SLOT && parent_slots[i] >= slot) {
+      parent_slots[i]++;
+    }
+  }
+
+  uint32_t handle_index;
+  if (!free_handle_indices.empty()) {
+    handle_index = free_handle_indices.back();
+    free_handle_indices.pop_back();
+  } else {
+    handle_index = slots.size();
+    slots.push_back(NO_SLOT);
+    generations.push_back(1);
+    is_dirty.push_back(0);
+  }
+
+  insertAt(handle_indices, slot, handle_index);
+  insertAt(parent_slots, slot, parent_slot);
+  insertAt(subtree_sizes, slot, 1u);
+  insertAt(scales, slot, scale);
+  insertAt(rotations, slot, rotation);
+  insertAt(translations, slot, translation);
+  insertAt(local_matrices, slot, SimdMat4(1.0f));
+  insertAt(world_matrices, slot, SimdMat4(1.0f));
+  insertAt(world_versions, slot, uint64_t(0));
+
+  for (size_t i = slot; i < handle_indices.size(); i++) {
+    slots[handle_indices[i]] = i;
+  }
+
+  markDirty(handle_index);
+
+  return {handle_index, generations[handle_index]};
+}
+
+void TransformHierarchy::destroy(TransformHandle handle) {
+  uint32_t slot = getSlot(handle);
+  uint32_t count = subtree_sizes[slot];
+
+  for (uint32_t ancestor_slot = parent_slots[slot]; ancestor_slot != NO_SLOT;
+       ancestor_slot = parent_slots[ancestor_slot]) {
+    subtree_sizes[ancestor_slot] -= count;
+  }
+
+  for (uint32_t i = slot; i < slot + count; i++) {
+    uint32_t handle_index = handle_indices[i];
+    slots[handle_index] = NO_SLOT;
+    is_dirty[handle_index] = 0;
+    // Skip 0 on wrap around, which would make default handles alive
+    generations[handle_index] = std::max(generations[handle_index] + 1, 1u);
+    free_handle_indices.push_back(handle_index);
+  }
+
+  eraseRange(handle_indices, slot, count);
+  eraseRange(parent_slots, slot, count);
+  eraseRange(subtree_sizes, slot, count);
+  eraseRange(scales, slot, count);
+  eraseRange(rotations, slot, count);
+  eraseRange(translations, slot, count);
+  eraseRange(local_matrices, slot, count);
+  eraseRange(world_matrices, slot, count);
+  eraseRange(world_versions, slot, count);
+
+  for (size_t i = slot; i < handle_indices.size(); i++) {
+    if (parent_slots[i] != NO_SLOT && parent_slots[i] >= slot) {
+      parent_slots[i] -= count;
+    }
+    slots[handle_indices[i]] = i;
+  }
+}
+
+bool TransformHierarchy::isAlive(TransformHandle handle) const {
+  return handle.index < slots.size() && slots[handle.index] != NO_SLOT &&
+         generations[handle.index] == handle.generation;
+}
+
+void TransformHierarchy::setLocal(TransformHandle handle,
+                                  const glm::vec3& scale,
+                                  const glm::quat& rotation,
+                                  const glm::vec3& translation) {
+  uint32_t slot = getSlot(handle);
+
+  scales[slot] = scale;
+  rotations[slot] = rotation;
+  translations[slot] = translation;
+
+  markDirty(handle.index);
+}
+
+void TransformHierarchy::update() {
+  dirty_slots.clear();
+  for (auto handle_index : dirty_handle_indices) {
+    // Listed twice, or destroyed since
+    if (!is_dirty[handle_index]) {
+      continue;
+    }
+    is_dirty[handle_index] = 0;
+    dirty_slots.push_back(slots[handle_index]);
+  }
+  dirty_handle_indices.clear();
+
+  if (dirty_slots.empty()) {
+    return;
+  }
+
+  for (auto slot : dirty_slots) {
+    local_matrices[slot] =
+        getTransformMatrix(scales[slot], rotations[slot], translations[slot]);
+  }
+
+  version++;
+
+  // Dirty nodes inside a subtree already recomputed are skipped, since their
+  // local matrix is already part of it
+  std::sort(dirty_slots.begin(), dirty_slots.end());
+  uint32_t composed_end = 0;
+
+  for (auto slot : dirty_slots) {
+    if (slot < composed_end) {
+      continue;
+    }
+
+    // Parents come first within the range, and the parent of the range is up
+    // to date, so the range is composed front to back in a single pass
+    composed_end = slot + subtree_sizes[slot];
+    for (uint32_t i = slot; i < composed_end; i++) {
+      uint32_t parent_slot = parent_slots[i];
+      world_matrices[i] =
+          parent_slot == NO_SLOT
+              ? local_matrices[i]
+              : world_matrices[parent_slot] * local_matrices[i];
+      world_versions[i] = version;
+    }
+  }
+}
+
+const SimdMat4& TransformHierarchy::getWorldMatrix(
+    TransformHandle handle) const {
+  return world_matrices[getSlot(handle)];
+}
+
+uint64_t TransformHierarchy::getWorldVersion(TransformHandle handle) const {
+  return world_versions[getSlot(handle)];
+}
+
+uint32_t TransformHierarchy::getSlot(TransformHandle handle) const {
+  if (!isAlive(handle)) {
+    throw std::invalid_argument("Transform handle is not alive");
+  }
+  return slots[handle.index];
+}
+
+void TransformHierarchy::markDirty(uint32_t handle_index) {
+  if (!is_dirty[handle_index]) {
+    is_dirty[handle_index] = 1;
+    dirty_handle_indices.push_back(handle_index);
+  }
+}
@@ -0,0 +1,592 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./TriangleBvh.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+
+#include "./math_util.h"
+
+using ray_kernels::LANE_COUNT;
+
+// SAH bins per axis, and the largest leaf the heuristic may choose to keep
+const uint32_t BIN_COUNT = 16;
+const uint32_t MAX_LEAF_TRIANGLES = 2 * LANE_COUNT;
+// Deeper nodes become leaves, which bounds the traversal stack. Every node
+// popped pushes at most three more than it takes.
+const uint32_t MAX_BVH_DEPTH = 60;
+const size_t MAX_STACK_SIZE = (LANE_COUNT - 1) * (MAX_BVH_DEPTH + 1) + 1;
+const uint32_t NO_TRIANGLE = UINT32_MAX;
+
+struct Aabb {
+  glm::vec3 min = glm::vec3(std::numeric_limits<float>::infinity());
+  glm::vec3 max = glm::vec3(-std::numeric_limits<float>::infinity());
+
+  void grow(const glm::vec3& point) {
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+  }
+
+  void grow(const Aabb& other) {
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+  }
+
+  float getArea() const {
+    glm::vec3 extent = max - min;
+    return 2.0f * (extent.x * extent.y + extent.y * extent.z +
+                   extent.z * extent.x);
+  }
+};
+
+// Node of the binary tree, before it is collapsed. The left child directly
+// follows its parent.
+struct BinaryNode {
+  Aabb bounds;
+  // First triangle of a leaf, or the right child of an inner node
+  uint32_t first_index;
+  // 0 for inner nodes
+  uint32_t triangle_count;
+};
+
+struct BvhBuilder {
+  const GeometryView& geometry_view;
+  const std::vector<Aabb>& triangle_bounds;
+  const std::vector<glm::vec3>& centroids;
+  // Triangles of the geometry, sorted by leaf
+  std::vector<uint32_t> sorted_triangles;
+  std::vector<BinaryNode> binary_nodes;
+};
+
+uint32_t getBlockCount(uint32_t triangle_count) {
+  return (triangle_count + LANE_COUNT - 1) / LANE_COUNT;
+}
+
+void buildBinaryNode(BvhBuilder& builder, uint32_t begin, uint32_t end,
+                     uint32_t depth);
+uint32_t collapseNode(BvhBuilder& builder, uint32_t binary_index,
+                      std::vector<BvhNode>& nodes,
+                      std::vector<ray_kernels::TriangleBlock>& triangle_blocks,
+                      std::vector<uint32_t>& triangle_indices);
+uint32_t addLeafBlocks(const BvhBuilder& builder,
+                       const BinaryNode& binary_node,
+                       std::vector<ray_kernels::TriangleBlock>& triangle_blocks,
+                       std::vector<uint32_t>& triangle_indices);
+
+TriangleBvh::TriangleBvh(const GeometryView& geometry_view) {
+  const auto& vertices = geometry_view.vertices;
+  triangle_count = geometry_view.index_count / 3;
+
+  if (triangle_count == 0) {
+    return;
+  }
+
+  std::vector<Aabb> triangle_bounds(triangle_count);
+  std::vector<glm::vec3> centroids(triangle_count);
+  for (uint32_t i = 0; i < triangle_count; i++) {
+    for (uint32_t corner = 0; corner < 3; corner++) {
+      triangle_bounds[i].grow(
+          vertices[geometry_view.getIndex(i * 3 + corner)].position);
+    }
+    centroids[i] = (triangle_bounds[i].min + triangle_bounds[i].max) * 0.5f;
+  }
+
+  BvhBuilder builder = {
+      .geometry_view = geometry_view,
+      .triangle_bounds = triangle_bounds,
+      .centroids = centroids,
+      .sorted_triangles = std::vector<uint32_t>(triangle_count),
+      .binary_nodes = {},
+  };
+  std::iota(builder.sorted_triangles.begin(), builder.sorted_triangles.end(),
+            0);
+  buildBinaryNode(builder, 0, triangle_count, 0);
+
+  collapseNode(builder, 0, nodes, triangle_blocks, triangle_indices);
+  nodes.shrink_to_fit();
+  triangle_blocks.shrink_to_fit();
+  triangle_indices.shrink_to_fit();
+}
+
+TriangleBvh::TriangleBvh(const TriangleBvhData& data)
+    : nodes(data.nodes.begin(), data.nodes.end()),
+      triangle_blocks(data.triangle_blocks.begin(),
+                      data.triangle_blocks.end()),
+      triangle_indices(data.triangle_indices.begin(),
+                       data.triangle_indices.end()),
+      triangle_count(data.triangle_count) {
+  if (triangle_indices.size() != triangle_blocks.size() * LANE_COUNT ||
+      std::any_of(triangle_indices.begin(), triangle_indices.end(),
+                  [this](uint32_t triangle_index) {
+                    return triangle_index != NO_TRIANGLE &&
+                           triangle_index >= triangle_count;
+                  })) {
+    throw std::runtime_error("Invalid BVH triangles");
+  }
+
+  // Children are stored after their parent, which rules out cycles, and no
+  // deeper than a built tree, which keeps the traversal stack large enough
+  std::vector<uint32_t> depths(nodes.size(), 0);
+  for (uint32_t node_index = 0; node_index < nodes.size(); node_index++) {
+    const auto& node = nodes[node_index];
+    if (node.child_count > LANE_COUNT) {
+      throw std::runtime_error("Invalid BVH node");
+    }
+
+    for (uint32_t lane = 0; lane < node.child_count; lane++) {
+      uint32_t child = node.children[lane];
+      uint32_t block_count = node.block_counts[lane];
+
+      if (block_count > 0) {
+        if (child > triangle_blocks.size() ||
+            block_count > triangle_blocks.size() - child) {
+          throw std::runtime_error("Invalid BVH leaf");
+        }
+      } else if (child <= node_index || child >= nodes.size() ||
+                 depths[node_index] >= MAX_BVH_DEPTH) {
+        throw std::runtime_error("Invalid BVH node");
+      } else {
+        depths[child] = std::max(depths[child], depths[node_index] + 1);
+      }
+    }
+  }
+}
+
+std::optional<BvhHit> TriangleBvh::intersectRay(const glm::vec3& ray_origin,
+                                                const glm::vec3& ray_direction,
+                                                float max_distance) const {
+  if (nodes.empty()) {
+    return std::nullopt;
+  }
+
+  struct StackEntry {
+    uint32_t node_index;
+    float distance;
+  };
+
+  // Zero components give infinities, which the slab test handles
+  glm::vec3 inverse_direction = 1.0f / ray_direction;
+
+  std::optional<BvhHit> nearest_hit;
+  float nearest_distance = max_distance;
+
+  std::array<StackEntry, MAX_STACK_SIZE> stack;
+  size_t stack_size = 0;
+  stack[stack_size++] = {0, 0.0f};
+
+  while (stack_size > 0) {
+    auto entry = stack[--stack_size];
+    // A closer hit may have been found since the node was pushed
+    if (entry.distance >= nearest_distance) {
+      continue;
+    }
+
+    const auto& node = nodes[entry.node_index];
+
+    alignas(16) float distances[LANE_COUNT];
+    int hit_bits = ray_kernels::intersectRayBoxBlock(
+                       ray_origin, inverse_direction, node.child_bounds,
+                       nearest_distance, distances) &
+                   ((1 << node.child_count) - 1);
+
+    // Children hit, nearest first
+    std::array<int, LANE_COUNT> hit_lanes;
+    int hit_count = 0;
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+      if (!(hit_bits >> lane & 1)) {
+        continue;
+      }
+
+      int i = hit_count++;
+      for (; i > 0 && distances[hit_lanes[i - 1]] > distances[lane]; i--) {
+        hit_lanes[i] = hit_lanes[i - 1];
+      }
+      hit_lanes[i] = lane;
+    }
+
+    // Inner children are pushed farthest first, so that the nearest is popped
+    // first, and leaves are tested right away
+    for (int i = hit_count - 1; i >= 0; i--) {
+      int lane = hit_lanes[i];
+      if (node.block_counts[lane] == 0) {
+        stack[stack_size++] = {node.children[lane], distances[lane]};
+      }
+    }
+
+    for (int i = 0; i < hit_count; i++) {
+      int lane = hit_lanes[i];
+      if (node.block_counts[lane] == 0 ||
+          distances[lane] >= nearest_distance) {
+        continue;
+      }
+
+      uint32_t first_block = node.children[lane];
+      for (uint32_t block_index = first_block;
+           block_index < first_block + node.block_counts[lane];
+           block_index++) {
+        auto hit = ray_kernels::intersectRayTriangleBlock(
+            ray_origin, ray_direction, triangle_blocks[block_index],
+            nearest_distance);
+
+        if (hit.lane >= 0) {
+          nearest_distance = hit.distance;
+          nearest_hit = BvhHit{
+              .distance = hit.distance,
+              .u = hit.u,
+              .v = hit.v,
+              .triangle_index =
+                  triangle_indices[block_index * LANE_COUNT + hit.lane],
+          };
+        }
+      }
+    }
+  }
+
+  return nearest_hit;
+}
+
+bool TriangleBvh::intersectsCone(const glm::mat4& matrix,
+                                 const glm::vec3& apex, const glm::vec3& axis,
+                                 float half_angle) const {
+  if (nodes.empty()) {
+    return false;
+  }
+
+  std::array<uint32_t, MAX_STACK_SIZE> stack;
+  size_t stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const auto& node = nodes[stack[--stack_size]];
+    const auto& bounds = node.child_bounds;
+
+    for (uint32_t lane = 0; lane < node.child_count; lane++) {
+      glm::vec3 bounds_min =
+          glm::vec3(bounds.min_x[lane], bounds.min_y[lane], bounds.min_z[lane]);
+      glm::vec3 bounds_max =
+          glm::vec3(bounds.max_x[lane], bounds.max_y[lane], bounds.max_z[lane]);
+
+      auto child_sphere = transformBoundingSphere(
+          {(bounds_min + bounds_max) * 0.5f,
+           glm::length(bounds_max - bounds_min) * 0.5f},
+          matrix);
+      if (!isSphereInCone(child_sphere, apex, axis, half_angle)) {
+        continue;
+      }
+
+      if (node.block_counts[lane] == 0) {
+        stack[stack_size++] = node.children[lane];
+        continue;
+      }
+
+      uint32_t first_block = node.children[lane];
+      for (uint32_t block_index = first_block;
+           block_index < first_block + node.block_counts[lane];
+           block_index++) {
+        const auto& block = triangle_blocks[block_index];
+
+        for (int triangle_lane = 0; triangle_lane < LANE_COUNT;
+             triangle_lane++) {
+          if (triangle_indices[block_index * LANE_COUNT + triangle_lane] ==
+              NO_TRIANGLE) {
+            continue;
+          }
+
+          glm::vec3 v0 = glm::vec3(block.v0_x[triangle_lane],
+                                   block.v0_y[triangle_lane],
+                                   block.v0_z[triangle_lane]);
+          glm::vec3 v1 = v0 + glm::vec3(block.edge1_x[triangle_lane],
+                                        block.edge1_y[triangle_lane],
+                                        block.edge1_z[triangle_lane]);
+          glm::vec3 v2 = v0 + glm::vec3(block.edge2_x[triangle_lane],
+                                        block.edge2_y[triangle_lane],
+                                        block.edge2_z[triangle_lane]);
+
+          v0 = glm::vec3(matrix * glm::vec4(v0, 1.0f));
+          v1 = glm::vec3(matrix * glm::vec4(v1, 1.0f));
+          v2 = glm::vec3(matrix * glm::vec4(v2, 1.0f));
+
+          glm::vec3 center = (v0 + v1 + v2) / 3.0f;
+          float radius = std::sqrt(std::max(
+              {glm::dot(v0 - center, v0 - center),
+               glm::dot(v1 - center, v1 - center),
+               glm::dot(v2 - center, v2 - center)}));
+
+          if (isSphereInCone({center, radius}, apex, axis, half_angle)) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+void buildBinaryNode(BvhBuilder& builder, uint32_t begin, uint32_t end,
+                     uint32_t depth) {
+  auto& binary_nodes = builder.binary_nodes;
+  auto& sorted_triangles = builder.sorted_triangles;
+
+  uint32_t node_index = binary_nodes.size();
+  binary_nodes.push_back({});
+
+  Aabb bounds;
+  Aabb centroid_bounds;
+  for (uint32_t i = begin; i < end; i++) {
+    bounds.grow(builder.triangle_bounds[sorted_triangles[i]]);
+    centroid_bounds.grow(builder.centroids[sorted_triangles[i]]);
+  }
+
+  uint32_t triangle_count = end - begin;
+  binary_nodes[node_index] = {bounds, begin, triangle_count};
+
+  // One block is tested as fast as one triangle, so splitting it never pays
+  if (triangle_count <= LANE_COUNT || depth >= MAX_BVH_DEPTH) {
+    return;
+  }
+
+  // Binned SAH, counting triangle blocks rather than triangles, with the
+  // costs of a block test and of a traversal step taken as equal
+  float best_cost = std::numeric_limits<float>::infinity();
+  int best_axis = -1;
+  uint32_t best_split = 0;
+
+  for (int axis = 0; axis < 3; axis++) {
+    float extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+    if (extent <= 0.0f) {
+      continue;
+    }
+
+    float bin_scale = BIN_COUNT / extent;
+    std::array<Aabb, BIN_COUNT> bin_bounds;
+    std::array<uint32_t, BIN_COUNT> bin_counts = {};
+
+    for (uint32_t i = begin; i < end; i++) {
+      auto triangle_index = sorted_triangles[i];
+      uint32_t bin = std::min(
+          BIN_COUNT - 1,
+          static_cast<uint32_t>(
+              (builder.centroids[triangle_index][axis] -
+               centroid_bounds.min[axis]) *
+              bin_scale));
+      bin_counts[bin]++;
+      bin_bounds[bin].grow(builder.triangle_bounds[triangle_index]);
+    }
+
+    // Sweep from the right, then evaluate every split from the left
+    std::array<float, BIN_COUNT - 1> right_areas;
+    std::array<uint32_t, BIN_COUNT - 1> right_counts;
+    Aabb right_bounds;
+    uint32_t right_count = 0;
+    for (uint32_t bin = BIN_COUNT - 1; bin > 0; bin--) {
+      right_bounds.grow(bin_bounds[bin]);
+      right_count += bin_counts[bin];
+      right_areas[bin - 1] = right_bounds.getArea();
+      right_counts[bin - 1] = right_count;
+    }
+
+    Aabb left_bounds;
+    uint32_t left_count = 0;
+    for (uint32_t bin = 0; bin < BIN_COUNT - 1; bin++) {
+      left_bounds.grow(bin_bounds[bin]);
+      left_count += bin_counts[bin];
+      if (left_count == 0 || right_counts[bin] == 0) {
+        continue;
+      }
+
+      float cost = getBlockCount(left_count) * left_bounds.getArea() +
+                   getBlockCount(right_counts[bin]) * right_areas[bin];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_split = bin + 1;
+      }
+    }
+  }
+
+  // Every centroid is at the same point, so no split can separate them
+  if (best_axis < 0) {
+    return;
+  }
+
+  float leaf_cost = getBlockCount(triangle_count) * bounds.getArea();
+  float split_cost = bounds.getArea() + best_cost;
+  if (triangle_count <= MAX_LEAF_TRIANGLES && split_cost >= leaf_cost) {
+    return;
+  }
+
+  // Same binning as above, so both sides are known to be non-empty
+  float axis_min = centroid_bounds.min[best_axis];
+  float bin_scale = BIN_COUNT / (centroid_bounds.max[best_axis] - axis_min);
+  auto middle = std::partition(
+      sorted_triangles.begin() + begin, sorted_triangles.begin() + end,
+      [&](uint32_t triangle_index) {
+        uint32_t bin = std::min(
+            BIN_COUNT - 1,
+            static_cast<uint32_t>(
+                (builder.centroids[triangle_index][best_axis] - axis_min) *
+                bin_scale));
+        return bin < best_split;
+      });
+  uint32_t middle_index = middle - sorted_triangles.begin();
+
+  buildBinaryNode(builder, begin, middle_index, depth + 1);
+  uint32_t right_index = binary_nodes.size();
+  buildBinaryNode(builder, middle_index, end, depth + 1);
+
+  binary_nodes[node_index].first_index = right_index;
+  binary_nodes[node_index].triangle_count = 0;
+}
+
+// Pulls the grandchildren of the binary node up until it has four children,
+// opening the largest inner child first. Returns the index of the new node.
+uint32_t collapseNode(BvhBuilder& builder, uint32_t binary_index,
+                      std::vector<BvhNode>& nodes,
+                      std::vector<ray_kernels::TriangleBlock>& triangle_blocks,
+                      std::vector<uint32_t>& triangle_indices) {
+  const auto& binary_nodes = builder.binary_nodes;
+
+  std::array<uint32_t, LANE_COUNT> binary_children;
+  uint32_t child_count = 0;
+
+  // A leaf root becomes the only child of the root
+  if (binary_nodes[binary_index].triangle_count > 0) {
+    binary_children[child_count++] = binary_index;
+  } else {
+    binary_children[child_count++] = binary_index + 1;
+    binary_children[child_count++] = binary_nodes[binary_index].first_index;
+  }
+
+  while (child_count < LANE_COUNT) {
+    int largest_child = -1;
+    float largest_area = -1.0f;
+    for (uint32_t i = 0; i < child_count; i++) {
+      const auto& child = binary_nodes[binary_children[i]];
+      if (child.triangle_count == 0 && child.bounds.getArea() > largest_area) {
+        largest_child = i;
+        largest_area = child.bounds.getArea();
+      }
+    }
+
+    if (largest_child < 0) {
+      break;
+    }
+
+    uint32_t opened_index = binary_children[largest_child];
+    binary_children[largest_child] = opened_index + 1;
+    binary_children[child_count++] = binary_nodes[opened_index].first_index;
+  }
+
+  uint32_t node_index = nodes.size();
+  nodes.push_back({});
+
+  BvhNode node = {};
+  node.child_count = child_count;
+  auto& bounds = node.child_bounds;
+  for (uint32_t lane = 0; lane < LANE_COUNT; lane++) {
+    // Unused lanes are masked out by child_count
+    Aabb child_bounds;
+    if (lane < child_count) {
+      child_bounds = binary_nodes[binary_children[lane]].bounds;
+    }
+    bounds.min_x[lane] = child_bounds.min.x;
+    bounds.min_y[lane] = child_bounds.min.y;
+    bounds.min_z[lane] = child_bounds.min.z;
+    bounds.max_x[lane] = child_bounds.max.x;
+    bounds.max_y[lane] = child_bounds.max.y;
+    bounds.max_z[lane] = child_bounds.max.z;
+  }
+
+  for (uint32_t lane = 0; lane < child_count; lane++) {
+    const auto& child = binary_nodes[binary_children[lane]];
+
+    if (child.triangle_count > 0) {
+      node.children[lane] =
+          addLeafBlocks(builder, child, triangle_blocks, triangle_indices);
+      node.block_counts[lane] = getBlockCount(child.triangle_count);
+    } else {
+      node.children[lane] = collapseNode(builder, binary_children[lane], nodes,
+                                         triangle_blocks, triangle_indices);
+      node.block_counts[lane] = 0;
+    }
+  }
+
+  nodes[node_index] = node;
+  return node_index;
+}
+
+// Copies the triangles of a binary leaf into blocks. Returns the index of the
+// first block.
+uint32_t addLeafBlocks(const BvhBuilder& builder,
+                       const BinaryNode& binary_node,
+                       std::vector<ray_kernels::TriangleBlock>& triangle_blocks,
+                       std::vector<uint32_t>& triangle_indices) {
+  const auto& geometry_view = builder.geometry_view;
+  const auto& vertices = geometry_view.vertices;
+
+  uint32_t first_block = triangle_blocks.size();
+
+  for (uint32_t i = 0; i < getBlockCount(binary_node.triangle_count); i++) {
+    // Padding lanes are degenerate triangles, which never hit
+    ray_kernels::TriangleBlock block = {};
+
+    for (uint32_t lane = 0; lane < LANE_COUNT; lane++) {
+      uint32_t leaf_offset = i * LANE_COUNT + lane;
+      if (leaf_offset >= binary_node.triangle_count) {
+        triangle_indices.push_back(NO_TRIANGLE);
+        continue;
+      }
+
+      uint32_t triangle_index =
+          builder.sorted_triangles[binary_node.first_index + leaf_offset];
+      triangle_indices.push_back(triangle_index);
+
+      auto get_position = [&](uint32_t corner) {
+        return vertices[geometry_view.getIndex(triangle_index * 3 + corner)]
+            .position;
+      };
+      glm::vec3 v0 = get_position(0);
+      glm::vec3 edge1 = get_position(1) - v0;
+      glm::vec3 edge2 = get_position(2) - v0;
+
+      block.v0_x[lane] = v0.x;
+      block.v0_y[lane] = v0.y;
+      block.v0_z[lane] = v0.z;
+      block.edge1_x[lane] = edge1.x;
+      block.edge1_y[lane] = edge1.y;
+      block.edge1_z[lane] = edge1.z;
+      block.edge2_x[lane] = edge2.x;
+      block.edge2_y[lane] = edge2.y;
+      block.edge2_z[lane] = edge2.z;
+    }
+
+    triangle_blocks.push_back(block);
+  }
+
+  return first_block;
+}
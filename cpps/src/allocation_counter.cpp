@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./allocation_counter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace allocation_counter {
+
+std::atomic<size_t> allocation_count = 0;
+std::atomic<size_t> live_bytes = 0;
+std::atomic<size_t> peak_bytes = 0;
+
+bool isCounting() {
+#ifdef SIENNA_ALLOCATION_COUNTER
+  return true;
+#else
+  return false;
+#endif
+}
+
+size_t getAllocationCount() {
+  return allocation_count.load(std::memory_order_relaxed);
+}
+
+size_t getLiveBytes() { return live_bytes.load(std::memory_order_relaxed); }
+
+size_t getPeakBytes() { return peak_bytes.load(std::memory_order_relaxed); }
+
+void resetPeakBytes() {
+  peak_bytes.store(live_bytes.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+}
+
+// Every allocation keeps its size in a header in front of it, as large as the
+// alignment of the allocation so that the memory after it stays aligned
+size_t getHeaderSize(size_t alignment_bytes) {
+  return std::max(alignment_bytes, alignof(std::max_align_t));
+}
+
+void* countAllocation(void* block, size_t header_size, size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  std::memcpy(block, &size, sizeof(size));
+
+  size_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+  size_t peak = peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+
+  return static_cast<char*>(block) + header_size;
+}
+
+void freeAllocation(void* pointer, size_t header_size) {
+  if (!pointer) {
+    return;
+  }
+
+  auto* block = static_cast<char*>(pointer) - header_size;
+  size_t size;
+  std::memcpy(&size, block, sizeof(size));
+  live_bytes.fetch_sub(size, std::memory_order_relaxed);
+  std::free(block);
+}
+
+}  // namespace allocation_counter
+
+#ifdef SIENNA_ALLOCATION_COUNTER
+
+// Replacing these is enough to see every new expression: the array and
+// nothrow forms call them by default
+
+void* operator new(size_t size) {
+  size_t header_size = allocation_counter::getHeaderSize(0);
+
+  if (void* block = std::malloc(header_size + size)) {
+    return allocation_counter::countAllocation(block, header_size, size);
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  size_t alignment_bytes = static_cast<size_t>(alignment);
+  size_t header_size = allocation_counter::getHeaderSize(alignment_bytes);
+
+  // aligned_alloc needs the size to be a multiple of the alignment
+  size_t aligned_size = (header_size + size + alignment_bytes - 1) /
+                        alignment_bytes * alignment_bytes;
+
+  if (void* block = std::aligned_alloc(alignment_bytes, aligned_size)) {
+    return allocation_counter::countAllocation(block, header_size, size);
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+  allocation_counter::freeAllocation(pointer,
+                                     allocation_counter::getHeaderSize(0));
+}
+
+void operator delete(void* pointer, size_t /*size*/) noexcept {
+  operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept {
+  allocation_counter::freeAllocation(
+      pointer,
+      allocation_counter::getHeaderSize(static_cast<size_t>(alignment)));
+}
+
+void operator delete(void* pointer, size_t /*size*/,
+                     std::align_val_t alignment) noexcept {
+  operator delete(pointer, alignment);
+}
+
+#endif  // SIENNA_ALLOCATION_COUNTER
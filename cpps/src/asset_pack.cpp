@@ -0,0 +1,459 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./asset_pack.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "./constants.h"
+#include "./mapped_file.h"
+
+namespace asset_pack {
+
+static_assert(std::is_trivially_copyable_v<Vertex>);
+static_assert(std::is_trivially_copyable_v<BvhNode>);
+static_assert(std::is_trivially_copyable_v<ray_kernels::TriangleBlock>);
+static_assert(std::is_trivially_copyable_v<Meshlet>);
+static_assert(alignof(BvhNode) <= ARRAY_ALIGNMENT &&
+              alignof(ray_kernels::TriangleBlock) <= ARRAY_ALIGNMENT &&
+              alignof(Meshlet) <= ARRAY_ALIGNMENT);
+static_assert(sizeof(PackHeader) == 24 && sizeof(PackSection) == 24);
+static_assert(sizeof(PackTransform) == 40 && sizeof(PackPaintable) == 16);
+static_assert(sizeof(PackPart) == 120 && sizeof(Meshlet) == 56);
+
+namespace {
+
+constexpr size_t PAINTED_MAP_BYTES_PER_PIXEL = 8;
+
+size_t getPaintedMapBytes(uint64_t painted_map_size) {
+  return painted_map_size * painted_map_size * PAINTED_MAP_BYTES_PER_PIXEL;
+}
+
+// 0 leaves the size to the importer. Baked maps need a size.
+bool isValidPaintedMapSize(int64_t painted_map_size, bool is_baked) {
+  if (painted_map_size == 0) {
+    return !is_baked;
+  }
+  return painted_map_size >= MIN_PAINTED_MAP_SIZE &&
+         painted_map_size <= MAX_PAINTED_MAP_SIZE;
+}
+
+size_t alignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+// Pads `section` to ARRAY_ALIGNMENT and appends `size` bytes of `data`,
+// returning their offset
+uint64_t appendArray(std::vector<char>& section, const void* data,
+                     size_t size) {
+  section.resize(alignUp(section.size(), ARRAY_ALIGNMENT), 0);
+  uint64_t offset = section.size();
+  const auto* bytes = static_cast<const char*>(data);
+  section.insert(section.end(), bytes, bytes + size);
+  return offset;
+}
+
+template <typename T>
+uint64_t appendArray(std::vector<char>& section, std::span<const T> array) {
+  return appendArray(section, array.data(), array.size_bytes());
+}
+
+// Tables are packed, unlike the arrays
+template <typename T>
+void appendTableEntry(std::vector<char>& section, const T& value) {
+  const auto* bytes = reinterpret_cast<const char*>(&value);
+  section.insert(section.end(), bytes, bytes + sizeof(T));
+}
+
+struct AlignedBlock {
+  alignas(SECTION_ALIGNMENT) char bytes[SECTION_ALIGNMENT];
+};
+
+}  // namespace
+
+AssetPack::AssetPack(std::span<const char> bytes,
+                     std::shared_ptr<const void> storage)
+    : bytes(bytes), storage(std::move(storage)) {
+  if (reinterpret_cast<uintptr_t>(bytes.data()) % ARRAY_ALIGNMENT != 0) {
+    throw std::runtime_error("Misaligned asset pack");
+  }
+
+  PackHeader header;
+  if (bytes.size() < sizeof(header)) {
+    throw std::runtime_error("Truncated asset pack");
+  }
+  std::memcpy(&header, bytes.data(), sizeof(header));
+
+  if (header.magic != MAGIC) {
+    throw std::runtime_error("Not an asset pack");
+  } else if (header.version != VERSION) {
+    throw std::runtime_error("Unsupported asset pack version " +
+                             std::to_string(header.version));
+  } else if (header.file_size != bytes.size() ||
+             header.section_count >
+                 (bytes.size() - sizeof(header)) / sizeof(PackSection)) {
+    throw std::runtime_error("Truncated asset pack");
+  }
+
+  const auto* section_table =
+      reinterpret_cast<const PackSection*>(bytes.data() + sizeof(header));
+  for (uint32_t i = 0; i < header.section_count; i++) {
+    const auto& section = section_table[i];
+    auto type_index = static_cast<size_t>(section.type);
+
+    if (type_index >= std::size(sections) ||
+        section.offset % SECTION_ALIGNMENT != 0 ||
+        section.offset > bytes.size() ||
+        section.size > bytes.size() - section.offset) {
+      throw std::runtime_error("Invalid asset pack section");
+    }
+    sections[type_index] = bytes.subspan(section.offset, section.size);
+  }
+
+  paintables = getTable<PackPaintable>(SectionType::PAINTABLES);
+  parts = getTable<PackPart>(SectionType::PARTS);
+  transforms = getTable<PackTransform>(SectionType::TRANSFORMS);
+
+  for (const auto& paintable : paintables) {
+    if (paintable.transform_index >= transforms.size() ||
+        paintable.first_part > parts.size() ||
+        paintable.part_count > parts.size() - paintable.first_part) {
+      throw std::runtime_error("Invalid asset pack paintable");
+    }
+  }
+
+  // Every array a part refers to is checked once here, so that the
+  // accessors can hand out spans without checking again
+  auto strings = sections[static_cast<size_t>(SectionType::STRINGS)];
+  for (size_t part_index = 0; part_index < parts.size(); part_index++) {
+    const auto& part = parts[part_index];
+
+    if (part.transform_index >= transforms.size() ||
+        part.name_offset > strings.size() ||
+        part.name_size > strings.size() - part.name_offset ||
+        part.index_count % 3 != 0 ||
+        (part.index_size != sizeof(uint16_t) &&
+         part.index_size != sizeof(uint32_t))) {
+      throw std::runtime_error("Invalid asset pack part");
+    }
+
+    // 16 bit indices must not reach 0xFFFF, the primitive restart index, see
+    // getIndexSize
+    if (part.index_size == sizeof(uint16_t) &&
+        part.vertex_count > UINT16_MAX) {
+      throw std::runtime_error("Invalid asset pack index size");
+    }
+
+    // Picking and BVH building read vertices by index on the CPU
+    auto geometry_view = getGeometryView(part_index);
+    for (size_t i = 0; i < geometry_view.index_count; i++) {
+      if (geometry_view.getIndex(i) >= geometry_view.vertices.size()) {
+        throw std::runtime_error("Invalid asset pack index");
+      }
+    }
+
+    if (part.bvh_node_count > 0 &&
+        part.bvh_triangle_count != part.index_count / 3) {
+      throw std::runtime_error("Invalid asset pack BVH");
+    }
+    getBvhData(part_index);
+    getMeshlets(part_index);
+
+    // Textures of this size get created for the part
+    if (!isValidPaintedMapSize(part.painted_map_size,
+                               part.painted_map_offset != NO_PAINTED_MAP)) {
+      throw std::runtime_error("Invalid asset pack painted map");
+    }
+    getPaintedMap(part_index);
+  }
+}
+
+std::shared_ptr<const AssetPack> AssetPack::open(const std::string& path) {
+  auto mapped_file = std::make_shared<MappedFile>(path);
+  return std::make_shared<AssetPack>(mapped_file->getBytes(), mapped_file);
+}
+
+std::shared_ptr<const AssetPack> AssetPack::fromBytes(
+    std::vector<char>&& bytes) {
+  if (reinterpret_cast<uintptr_t>(bytes.data()) % ARRAY_ALIGNMENT == 0) {
+    auto storage = std::make_shared<std::vector<char>>(std::move(bytes));
+    return std::make_shared<AssetPack>(*storage, storage);
+  }
+
+  auto storage = std::make_shared<std::vector<AlignedBlock>>(
+      alignUp(bytes.size(), SECTION_ALIGNMENT) / SECTION_ALIGNMENT);
+  std::memcpy(storage->data(), bytes.data(), bytes.size());
+  return std::make_shared<AssetPack>(
+      std::span<const char>(storage->data()->bytes, bytes.size()), storage);
+}
+
+const PackTransform& AssetPack::getTransform(uint32_t transform_index) const {
+  return transforms[transform_index];
+}
+
+std::string_view AssetPack::getPartName(size_t part_index) const {
+  const auto& part = parts[part_index];
+  auto strings = sections[static_cast<size_t>(SectionType::STRINGS)];
+  return std::string_view(strings.data() + part.name_offset, part.name_size);
+}
+
+GeometryView AssetPack::getGeometryView(size_t part_index) const {
+  const auto& part = parts[part_index];
+
+  GeometryView geometry_view;
+  geometry_view.vertices = getArray<Vertex>(
+      SectionType::VERTICES, part.vertex_offset, part.vertex_count);
+  geometry_view.index_count = part.index_count;
+  geometry_view.index_size = part.index_size;
+  if (part.index_size == sizeof(uint16_t)) {
+    geometry_view.indices =
+        getArray<uint16_t>(SectionType::INDICES, part.index_offset,
+                           part.index_count)
+            .data();
+  } else {
+    geometry_view.indices =
+        getArray<uint32_t>(SectionType::INDICES, part.index_offset,
+                           part.index_count)
+            .data();
+  }
+
+  return geometry_view;
+}
+
+std::optional<TriangleBvhData> AssetPack::getBvhData(
+    size_t part_index) const {
+  const auto& part = parts[part_index];
+  if (part.bvh_node_count == 0) {
+    return std::nullopt;
+  }
+
+  return TriangleBvhData{
+      .nodes = getArray<BvhNode>(SectionType::BVH_NODES, part.bvh_node_offset,
+                                 part.bvh_node_count),
+      .triangle_blocks = getArray<ray_kernels::TriangleBlock>(
+          SectionType::BVH_TRIANGLE_BLOCKS, part.bvh_triangle_block_offset,
+          part.bvh_triangle_block_count),
+      .triangle_indices = getArray<uint32_t>(
+          SectionType::BVH_TRIANGLE_INDICES, part.bvh_triangle_index_offset,
+          part.bvh_triangle_block_count * ray_kernels::LANE_COUNT),
+      .triangle_count = part.bvh_triangle_count,
+  };
+}
+
+std::span<const Meshlet> AssetPack::getMeshlets(size_t part_index) const {
+  const auto& part = parts[part_index];
+  return getArray<Meshlet>(SectionType::MESHLETS, part.meshlet_offset,
+                           part.meshlet_count);
+}
+
+std::span<const char> AssetPack::getPaintedMap(size_t part_index) const {
+  const auto& part = parts[part_index];
+  if (part.painted_map_offset == NO_PAINTED_MAP) {
+    return {};
+  }
+
+  return getArray<char>(SectionType::PAINTED_MAPS, part.painted_map_offset,
+                        getPaintedMapBytes(part.painted_map_size));
+}
+
+template <typename T>
+std::span<const T> AssetPack::getArray(SectionType type, uint64_t offset,
+                                       uint64_t count) const {
+  auto section = sections[static_cast<size_t>(type)];
+
+  if (offset % ARRAY_ALIGNMENT != 0 || offset > section.size() ||
+      count > (section.size() - offset) / sizeof(T)) {
+    throw std::runtime_error("Asset pack array out of bounds");
+  }
+
+  return std::span<const T>(
+      reinterpret_cast<const T*>(section.data() + offset), count);
+}
+
+template <typename T>
+std::span<const T> AssetPack::getTable(SectionType type) const {
+  auto section = sections[static_cast<size_t>(type)];
+  if (section.size() % sizeof(T) != 0) {
+    throw std::runtime_error("Invalid asset pack table");
+  }
+
+  return getArray<T>(type, 0, section.size() / sizeof(T));
+}
+
+std::vector<char> buildAssetPack(
+    const std::vector<PaintableSource>& paintables) {
+  constexpr auto SECTION_COUNT = static_cast<size_t>(SectionType::COUNT);
+  std::vector<char> sections[SECTION_COUNT];
+  auto section = [&sections](SectionType type) -> std::vector<char>& {
+    return sections[static_cast<size_t>(type)];
+  };
+
+  uint32_t part_count = 0;
+  uint32_t transform_count = 0;
+
+  for (const auto& paintable_source : paintables) {
+    PackPaintable paintable = {
+        .transform_index = transform_count++,
+        .first_part = part_count,
+        .part_count = static_cast<uint32_t>(paintable_source.parts.size()),
+        .reserved = 0,
+    };
+    appendTableEntry(section(SectionType::PAINTABLES), paintable);
+    appendTableEntry(section(SectionType::TRANSFORMS),
+                     paintable_source.transform);
+
+    for (const auto& part_source : paintable_source.parts) {
+      const auto& geometry = part_source.geometry;
+      PackPart part = {};
+
+      part.transform_index = transform_count++;
+      appendTableEntry(section(SectionType::TRANSFORMS),
+                       part_source.transform);
+
+      auto& strings = section(SectionType::STRINGS);
+      part.name_offset = static_cast<uint32_t>(strings.size());
+      part.name_size = static_cast<uint32_t>(part_source.name.size());
+      strings.insert(strings.end(), part_source.name.begin(),
+                     part_source.name.end());
+
+      part.vertex_count = geometry.vertices.size();
+      part.vertex_offset =
+          appendArray(section(SectionType::VERTICES), geometry.vertices);
+
+      part.index_count = geometry.index_count;
+      part.index_size = std::min(getIndexSize(geometry.vertices.size()),
+                                 geometry.index_size);
+      if (part.index_size == geometry.index_size) {
+        part.index_offset = appendArray(section(SectionType::INDICES),
+                                        geometry.indices,
+                                        geometry.getIndexBytes());
+      } else {
+        std::vector<uint16_t> short_indices(geometry.index_count);
+        for (size_t i = 0; i < short_indices.size(); i++) {
+          short_indices[i] = static_cast<uint16_t>(geometry.getIndex(i));
+        }
+        part.index_offset = appendArray(
+            section(SectionType::INDICES),
+            std::span<const uint16_t>(short_indices));
+      }
+
+      if (part_source.bvh) {
+        auto bvh_data = part_source.bvh->getData();
+        part.bvh_node_count = static_cast<uint32_t>(bvh_data.nodes.size());
+        part.bvh_node_offset =
+            appendArray(section(SectionType::BVH_NODES), bvh_data.nodes);
+        part.bvh_triangle_block_count = bvh_data.triangle_blocks.size();
+        part.bvh_triangle_block_offset =
+            appendArray(section(SectionType::BVH_TRIANGLE_BLOCKS),
+                        bvh_data.triangle_blocks);
+        part.bvh_triangle_index_offset =
+            appendArray(section(SectionType::BVH_TRIANGLE_INDICES),
+                        bvh_data.triangle_indices);
+        part.bvh_triangle_count = bvh_data.triangle_count;
+      }
+
+      if (part_source.meshlets) {
+        auto meshlets = part_source.meshlets->getMeshlets();
+        part.meshlet_count = meshlets.size();
+        part.meshlet_offset =
+            appendArray(section(SectionType::MESHLETS), meshlets);
+      }
+
+      if (!isValidPaintedMapSize(part_source.painted_map_size,
+                                 !part_source.painted_map.empty())) {
+        throw std::invalid_argument("Invalid painted map size for " +
+                                    part_source.name);
+      }
+      part.painted_map_size =
+          static_cast<uint32_t>(part_source.painted_map_size);
+      part.painted_map_offset = NO_PAINTED_MAP;
+      if (!part_source.painted_map.empty()) {
+        if (part_source.painted_map.size() !=
+            getPaintedMapBytes(part.painted_map_size)) {
+          throw std::invalid_argument("Painted map of " + part_source.name +
+                                      " does not match its size");
+        }
+        part.painted_map_offset = appendArray(
+            section(SectionType::PAINTED_MAPS), part_source.painted_map);
+      }
+
+      appendTableEntry(section(SectionType::PARTS), part);
+      part_count++;
+    }
+  }
+
+  size_t offset = alignUp(sizeof(PackHeader) + sizeof(PackSection) *
+                                                   SECTION_COUNT,
+                          SECTION_ALIGNMENT);
+  PackSection section_table[SECTION_COUNT];
+  for (size_t i = 0; i < SECTION_COUNT; i++) {
+    section_table[i] = {
+        .type = static_cast<SectionType>(i),
+        .reserved = 0,
+        .offset = offset,
+        .size = sections[i].size(),
+    };
+    offset = alignUp(offset + sections[i].size(), SECTION_ALIGNMENT);
+  }
+
+  PackHeader header = {
+      .magic = MAGIC,
+      .version = VERSION,
+      .section_count = SECTION_COUNT,
+      .reserved = 0,
+      .file_size = offset,
+  };
+
+  std::vector<char> bytes(offset, 0);
+  std::memcpy(bytes.data(), &header, sizeof(header));
+  std::memcpy(bytes.data() + sizeof(header), section_table,
+              sizeof(section_table));
+  for (size_t i = 0; i < SECTION_COUNT; i++) {
+    std::copy(sections[i].begin(), sections[i].end(),
+              bytes.begin() + section_table[i].offset);
+  }
+
+  return bytes;
+}
+
+bool isAssetPackFile(std::string_view file_name) {
+  auto extension_begin = file_name.rfind('.');
+  if (extension_begin == std::string_view::npos) {
+    return false;
+  }
+
+  std::string extension(file_name.substr(extension_begin + 1));
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+
+  return extension == "snpk";
+}
+
+}  // namespace asset_pack
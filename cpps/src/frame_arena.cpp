@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./frame_arena.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "./constants.h"
+
+namespace frame_arena {
+
+std::unique_ptr<std::byte[]> block;
+size_t block_size = 0;
+size_t block_offset = 0;
+
+std::vector<std::unique_ptr<std::byte[]>> overflow_blocks;
+size_t overflow_size = 0;
+
+void reset() {
+  if (!overflow_blocks.empty()) {
+    block_size = std::max(block_size * 2, block_size + overflow_size);
+    block = std::make_unique<std::byte[]>(block_size);
+
+    overflow_blocks.clear();
+    overflow_size = 0;
+  }
+
+  block_offset = 0;
+}
+
+void* allocate(size_t size, size_t alignment) {
+  if (!block) {
+    block_size = FRAME_ARENA_INITIAL_BYTES;
+    block = std::make_unique<std::byte[]>(block_size);
+  }
+
+  size_t aligned_offset = (block_offset + alignment - 1) & ~(alignment - 1);
+  if (aligned_offset + size <= block_size) {
+    block_offset = aligned_offset + size;
+    return block.get() + aligned_offset;
+  }
+
+  // new[] aligns to alignof(std::max_align_t), which covers every type the
+  // arena is used for
+  overflow_blocks.push_back(std::make_unique<std::byte[]>(size));
+  overflow_size += size + alignment;
+  return overflow_blocks.back().get();
+}
+
+size_t getCapacityBytes() { return block_size + overflow_size; }
+
+}  // namespace frame_arena
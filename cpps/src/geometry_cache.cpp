@@ -0,0 +1,310 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./geometry_cache.h"
+
+#include <emscripten.h>
+#include <emscripten/bind.h>
+#include <emscripten/val.h>
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "./constants.h"
+#include "./mesh_optimizer.h"
+
+namespace geometry_cache {
+
+struct CacheEntry {
+  SharedGeometryComponent geometry;
+  unsigned long last_used_frame;
+  size_t hit_count;
+  double generate_ms;
+};
+
+typedef std::tuple<GeometryPreset, int, int> PresetKey;
+typedef std::pair<const asset_pack::AssetPack*, size_t> PackKey;
+
+unsigned long current_frame = 0;
+std::map<PresetKey, CacheEntry> preset_entries;
+std::unordered_multimap<uint64_t, CacheEntry> content_entries;
+std::map<PackKey, CacheEntry> pack_entries;
+
+size_t hit_count = 0;
+size_t miss_count = 0;
+double expired_ms_avoided = 0.0;
+
+size_t getGeometryBytes(const GeometryView& geometry_view) {
+  return geometry_view.vertices.size_bytes() + geometry_view.getIndexBytes();
+}
+
+double getMsAvoided(const CacheEntry& entry) {
+  return entry.hit_count *
+         (entry.generate_ms + entry.geometry.gr_geometry_component->upload_ms);
+}
+
+// FNV-1a over the raw vertex and index data
+uint64_t hashGeometry(const GeometryComponent& geometry_component) {
+  uint64_t hash = 14695981039346656037ull;
+
+  auto hash_bytes = [&hash](const void* data, size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+  };
+
+  hash_bytes(geometry_component.vertices.data(),
+             geometry_component.vertices.size() * sizeof(Vertex));
+  hash_bytes(geometry_component.indices.data(),
+             geometry_component.indices.size() * sizeof(unsigned int));
+
+  return hash;
+}
+
+bool isSameGeometry(const GeometryComponent& a, const GeometryComponent& b) {
+  return a.vertices.size() == b.vertices.size() && a.indices == b.indices &&
+         std::memcmp(a.vertices.data(), b.vertices.data(),
+                     a.vertices.size() * sizeof(Vertex)) == 0;
+}
+
+SharedGeometryComponent hit(CacheEntry& entry) {
+  hit_count++;
+  entry.hit_count++;
+  entry.last_used_frame = current_frame;
+
+  return entry.geometry;
+}
+
+CacheEntry createEntry(std::shared_ptr<GeometryComponent> geometry_component,
+                       std::shared_ptr<const void> storage,
+                       const GeometryView& view,
+                       std::shared_ptr<TriangleBvh> bvh,
+                       std::shared_ptr<MeshletSet> meshlets,
+                       double generate_ms) {
+  miss_count++;
+
+  return {
+      .geometry = {.geometry_component = geometry_component,
+                   .storage = storage,
+                   .view = view,
+                   .gr_geometry_component =
+                       std::make_shared<GrGeometryComponent>(),
+                   .bvh = bvh,
+                   .meshlets = meshlets},
+      .last_used_frame = current_frame,
+      .hit_count = 0,
+      .generate_ms = generate_ms,
+  };
+}
+
+SharedGeometryComponent acquire(GeometryPreset preset, int width_segments,
+                                int height_segments) {
+  PresetKey key = {preset, width_segments, height_segments};
+
+  auto it = preset_entries.find(key);
+  if (it != preset_entries.end()) {
+    return hit(it->second);
+  }
+
+  double generate_start_ms = emscripten_get_now();
+  auto geometry_component = std::make_shared<GeometryComponent>(
+      preset, width_segments, height_segments);
+  mesh_optimizer::optimizeMesh(*geometry_component);
+  auto bvh = std::make_shared<TriangleBvh>(*geometry_component);
+  auto meshlets = std::make_shared<MeshletSet>(*geometry_component);
+  double generate_ms = emscripten_get_now() - generate_start_ms;
+
+  auto entry = createEntry(geometry_component, nullptr, *geometry_component,
+                           bvh, meshlets, generate_ms);
+  preset_entries.emplace(key, entry);
+
+  return entry.geometry;
+}
+
+BuiltGeometry build(GeometryComponent&& geometry_component) {
+  // Imported geometry is built by the caller, so only the optimization, BVH
+  // and meshlets are timed
+  double generate_start_ms = emscripten_get_now();
+  auto shared_geometry_component =
+      std::make_shared<GeometryComponent>(std::move(geometry_component));
+  mesh_optimizer::optimizeMesh(*shared_geometry_component);
+  auto bvh = std::make_shared<TriangleBvh>(*shared_geometry_component);
+  auto meshlets = std::make_shared<MeshletSet>(*shared_geometry_component);
+
+  return {
+      .geometry_component = shared_geometry_component,
+      .bvh = bvh,
+      .meshlets = meshlets,
+      // Optimizing is deterministic, so the same content hashes the same
+      .hash = hashGeometry(*shared_geometry_component),
+      .generate_ms = emscripten_get_now() - generate_start_ms,
+  };
+}
+
+SharedGeometryComponent acquire(BuiltGeometry&& built_geometry) {
+  auto [begin, end] = content_entries.equal_range(built_geometry.hash);
+  for (auto it = begin; it != end; ++it) {
+    if (isSameGeometry(*it->second.geometry.geometry_component,
+                       *built_geometry.geometry_component)) {
+      return hit(it->second);
+    }
+  }
+
+  auto entry = createEntry(
+      built_geometry.geometry_component, nullptr,
+      *built_geometry.geometry_component, std::move(built_geometry.bvh),
+      std::move(built_geometry.meshlets), built_geometry.generate_ms);
+  content_entries.emplace(built_geometry.hash, entry);
+
+  return entry.geometry;
+}
+
+SharedGeometryComponent acquire(
+    std::shared_ptr<const asset_pack::AssetPack> asset_pack,
+    size_t part_index) {
+  PackKey key = {asset_pack.get(), part_index};
+
+  auto it = pack_entries.find(key);
+  if (it != pack_entries.end()) {
+    return hit(it->second);
+  }
+
+  // Only the BVH and meshlets are timed, whether they are loaded or built.
+  // Packs are optimized by the converter, since their vertices and indices
+  // are read in place.
+  double generate_start_ms = emscripten_get_now();
+  auto view = asset_pack->getGeometryView(part_index);
+  auto bvh_data = asset_pack->getBvhData(part_index);
+  auto bvh = bvh_data ? std::make_shared<TriangleBvh>(*bvh_data)
+                      : std::make_shared<TriangleBvh>(view);
+  auto stored_meshlets = asset_pack->getMeshlets(part_index);
+  auto meshlets = !stored_meshlets.empty()
+                      ? std::make_shared<MeshletSet>(stored_meshlets, view)
+                      : std::make_shared<MeshletSet>(view);
+  double generate_ms = emscripten_get_now() - generate_start_ms;
+
+  auto entry =
+      createEntry(nullptr, asset_pack, view, bvh, meshlets, generate_ms);
+  pack_entries.emplace(key, entry);
+
+  return entry.geometry;
+}
+
+// Drops the entries nobody else references that pass `is_expired`
+template <typename Map, typename Predicate>
+void dropUnused(Map& entries, Predicate is_expired) {
+  for (auto it = entries.begin(); it != entries.end();) {
+    auto& entry = it->second;
+
+    if (entry.geometry.gr_geometry_component.use_count() > 1) {
+      entry.last_used_frame = current_frame;
+      ++it;
+    } else if (is_expired(entry)) {
+      expired_ms_avoided += getMsAvoided(entry);
+      it = entries.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void collect() {
+  current_frame++;
+
+  auto is_expired = [](const CacheEntry& entry) {
+    return current_frame - entry.last_used_frame >=
+           GEOMETRY_CACHE_EXPIRY_FRAMES;
+  };
+
+  dropUnused(preset_entries, is_expired);
+  dropUnused(content_entries, is_expired);
+  dropUnused(pack_entries, is_expired);
+}
+
+void trim() {
+  auto is_expired = [](const CacheEntry& /*entry*/) { return true; };
+
+  dropUnused(preset_entries, is_expired);
+  dropUnused(content_entries, is_expired);
+  dropUnused(pack_entries, is_expired);
+}
+
+GeometryCacheStats getStats() {
+  GeometryCacheStats stats = {
+      .entry_count = preset_entries.size() + content_entries.size() +
+                     pack_entries.size(),
+      .hit_count = hit_count,
+      .miss_count = miss_count,
+      .gpu_bytes_saved = 0,
+      .ms_avoided = expired_ms_avoided,
+  };
+
+  auto add_entry = [&stats](const CacheEntry& entry) {
+    // One reference is held by the cache itself
+    auto user_count = entry.geometry.gr_geometry_component.use_count() - 1;
+    if (user_count > 1) {
+      stats.gpu_bytes_saved +=
+          (user_count - 1) * getGeometryBytes(entry.geometry.view);
+    }
+    stats.ms_avoided += getMsAvoided(entry);
+  };
+
+  for (const auto& [key, entry] : preset_entries) {
+    add_entry(entry);
+  }
+  for (const auto& [key, entry] : content_entries) {
+    add_entry(entry);
+  }
+  for (const auto& [key, entry] : pack_entries) {
+    add_entry(entry);
+  }
+
+  return stats;
+}
+
+emscripten::val getGeometryCacheStats() {
+  auto stats = getStats();
+
+  auto stats_object = emscripten::val::object();
+  stats_object.set("entryCount", static_cast<double>(stats.entry_count));
+  stats_object.set("hitCount", static_cast<double>(stats.hit_count));
+  stats_object.set("missCount", static_cast<double>(stats.miss_count));
+  stats_object.set("gpuBytesSaved",
+                   static_cast<double>(stats.gpu_bytes_saved));
+  stats_object.set("msAvoided", stats.ms_avoided);
+
+  return stats_object;
+}
+
+EMSCRIPTEN_BINDINGS(geometry_cache) {
+  emscripten::function("getGeometryCacheStats", &getGeometryCacheStats);
+}
+
+}  // namespace geometry_cache
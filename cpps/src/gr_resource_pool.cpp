@@ -0,0 +1,270 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./gr_resource_pool.h"
+
+#include <GLES3/gl3.h>
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "./constants.h"
+#include "./gr_resource_registry.h"
+
+namespace gr_resource_pool {
+
+const char* pool_owner = "GrResourcePool";
+
+template <typename Key, typename Resource>
+class ResourcePool {
+ public:
+  std::optional<Resource> acquire(const Key& key) {
+    auto it = idle_entries.find(key);
+
+    if (it == idle_entries.end() || it->second.empty()) {
+      return std::nullopt;
+    }
+
+    auto resource = it->second.back().resource;
+    it->second.pop_back();
+
+    return resource;
+  }
+
+  void release(const Key& key, const Resource& resource,
+               unsigned long frame) {
+    pending_entries.push_back({key, {resource, frame}});
+  }
+
+  template <typename Deleter>
+  void collect(unsigned long frame, Deleter deleter) {
+    auto pending_end = std::partition(
+        pending_entries.begin(), pending_entries.end(),
+        [frame](const auto& pending_entry) {
+          return frame - pending_entry.second.frame <
+                 GR_RESOURCE_RELEASE_DELAY_FRAMES;
+        });
+
+    for (auto it = pending_end; it != pending_entries.end(); ++it) {
+      idle_entries[it->first].push_back({it->second.resource, frame});
+    }
+    pending_entries.erase(pending_end, pending_entries.end());
+
+    for (auto& [key, entries] : idle_entries) {
+      std::erase_if(entries, [frame, &key, &deleter](const auto& entry) {
+        if (frame - entry.frame < GR_RESOURCE_POOL_EXPIRY_FRAMES) {
+          return false;
+        }
+
+        deleter(key, entry.resource);
+        return true;
+      });
+    }
+  }
+
+  template <typename Deleter>
+  void trim(Deleter deleter) {
+    for (auto& [key, entries] : idle_entries) {
+      for (const auto& entry : entries) {
+        deleter(key, entry.resource);
+      }
+      entries.clear();
+    }
+
+    // Deleting objects that may still be in use is safe, only recycling
+    // them is not
+    for (const auto& [key, entry] : pending_entries) {
+      deleter(key, entry.resource);
+    }
+    pending_entries.clear();
+  }
+
+ private:
+  struct Entry {
+    Resource resource;
+    unsigned long frame;
+  };
+
+  std::map<Key, std::vector<Entry>> idle_entries;
+  std::vector<std::pair<Key, Entry>> pending_entries;
+};
+
+typedef std::tuple<TextureType, int, int, int> TextureKey;
+typedef std::pair<size_t, size_t> GeometryKey;
+
+unsigned long current_frame = 0;
+ResourcePool<TextureKey, unsigned int> texture_pool;
+ResourcePool<unsigned int, unsigned int> framebuffer_pool;
+ResourcePool<GeometryKey, GrPooledGeometry> geometry_pool;
+ResourcePool<int, unsigned int> uniform_buffer_pool;
+
+void deleteTexture(const TextureKey& /*key*/, unsigned int texture_id) {
+  // The framebuffer is useless without its texture
+  auto framebuffer_id = framebuffer_pool.acquire(texture_id);
+  if (framebuffer_id.has_value()) {
+    gr_resource_registry::unregisterResource(GrResourceCategory::FRAMEBUFFER,
+                                             framebuffer_id.value());
+    glDeleteFramebuffers(1, &framebuffer_id.value());
+  }
+
+  gr_resource_registry::unregisterResource(GrResourceCategory::TEXTURE,
+                                           texture_id);
+  glDeleteTextures(1, &texture_id);
+}
+
+void deleteFramebuffer(unsigned int /*texture_id*/,
+                       unsigned int framebuffer_id) {
+  gr_resource_registry::unregisterResource(GrResourceCategory::FRAMEBUFFER,
+                                           framebuffer_id);
+  glDeleteFramebuffers(1, &framebuffer_id);
+}
+
+void deleteGeometry(const GeometryKey& /*key*/,
+                    const GrPooledGeometry& geometry) {
+  gr_resource_registry::unregisterResource(GrResourceCategory::VERTEX_ARRAY,
+                                           geometry.vao_id);
+  gr_resource_registry::unregisterResource(GrResourceCategory::VERTEX_BUFFER,
+                                           geometry.vbo_id);
+  gr_resource_registry::unregisterResource(GrResourceCategory::INDEX_BUFFER,
+                                           geometry.ebo_id);
+  glDeleteVertexArrays(1, &geometry.vao_id);
+  glDeleteBuffers(1, &geometry.vbo_id);
+  glDeleteBuffers(1, &geometry.ebo_id);
+}
+
+void deleteUniformBuffer(int /*key*/, unsigned int uniform_buffer_id) {
+  gr_resource_registry::unregisterResource(GrResourceCategory::UNIFORM_BUFFER,
+                                           uniform_buffer_id);
+  glDeleteBuffers(1, &uniform_buffer_id);
+}
+
+void collect() {
+  current_frame++;
+
+  // Textures go first, so that they can take their framebuffers with them
+  texture_pool.collect(current_frame, deleteTexture);
+  framebuffer_pool.collect(current_frame, deleteFramebuffer);
+  geometry_pool.collect(current_frame, deleteGeometry);
+  uniform_buffer_pool.collect(current_frame, deleteUniformBuffer);
+}
+
+void trim() {
+  texture_pool.trim(deleteTexture);
+  framebuffer_pool.trim(deleteFramebuffer);
+  geometry_pool.trim(deleteGeometry);
+  uniform_buffer_pool.trim(deleteUniformBuffer);
+}
+
+size_t getIdleBytes() {
+  return gr_resource_registry::getOwnerBytes(pool_owner);
+}
+
+std::optional<unsigned int> acquireTexture(TextureType texture_type, int width,
+                                           int height, int level_count) {
+  auto texture_id =
+      texture_pool.acquire({texture_type, width, height, level_count});
+
+  if (texture_id.has_value()) {
+    gr_resource_registry::assignResource(GrResourceCategory::TEXTURE,
+                                         texture_id.value());
+  }
+
+  return texture_id;
+}
+
+void releaseTexture(unsigned int texture_id, TextureType texture_type,
+                    int width, int height, int level_count) {
+  gr_resource_registry::assignResource(GrResourceCategory::TEXTURE, texture_id,
+                                       pool_owner);
+  texture_pool.release({texture_type, width, height, level_count}, texture_id,
+                       current_frame);
+}
+
+std::optional<unsigned int> acquireFramebuffer(unsigned int texture_id) {
+  auto framebuffer_id = framebuffer_pool.acquire(texture_id);
+
+  if (framebuffer_id.has_value()) {
+    gr_resource_registry::assignResource(GrResourceCategory::FRAMEBUFFER,
+                                         framebuffer_id.value());
+  }
+
+  return framebuffer_id;
+}
+
+void releaseFramebuffer(unsigned int framebuffer_id, unsigned int texture_id) {
+  gr_resource_registry::assignResource(GrResourceCategory::FRAMEBUFFER,
+                                       framebuffer_id, pool_owner);
+  framebuffer_pool.release(texture_id, framebuffer_id, current_frame);
+}
+
+std::optional<GrPooledGeometry> acquireGeometry(size_t vertex_buffer_size,
+                                                size_t index_buffer_size) {
+  auto geometry =
+      geometry_pool.acquire({vertex_buffer_size, index_buffer_size});
+
+  if (geometry.has_value()) {
+    gr_resource_registry::assignResource(GrResourceCategory::VERTEX_ARRAY,
+                                         geometry.value().vao_id);
+    gr_resource_registry::assignResource(GrResourceCategory::VERTEX_BUFFER,
+                                         geometry.value().vbo_id);
+    gr_resource_registry::assignResource(GrResourceCategory::INDEX_BUFFER,
+                                         geometry.value().ebo_id);
+  }
+
+  return geometry;
+}
+
+void releaseGeometry(const GrPooledGeometry& geometry,
+                     size_t vertex_buffer_size, size_t index_buffer_size) {
+  gr_resource_registry::assignResource(GrResourceCategory::VERTEX_ARRAY,
+                                       geometry.vao_id, pool_owner);
+  gr_resource_registry::assignResource(GrResourceCategory::VERTEX_BUFFER,
+                                       geometry.vbo_id, pool_owner);
+  gr_resource_registry::assignResource(GrResourceCategory::INDEX_BUFFER,
+                                       geometry.ebo_id, pool_owner);
+  geometry_pool.release({vertex_buffer_size, index_buffer_size}, geometry,
+                        current_frame);
+}
+
+std::optional<unsigned int> acquireUniformBuffer() {
+  auto uniform_buffer_id = uniform_buffer_pool.acquire(0);
+
+  if (uniform_buffer_id.has_value()) {
+    gr_resource_registry::assignResource(GrResourceCategory::UNIFORM_BUFFER,
+                                         uniform_buffer_id.value());
+  }
+
+  return uniform_buffer_id;
+}
+
+void releaseUniformBuffer(unsigned int uniform_buffer_id) {
+  gr_resource_registry::assignResource(GrResourceCategory::UNIFORM_BUFFER,
+                                       uniform_buffer_id, pool_owner);
+  uniform_buffer_pool.release(0, uniform_buffer_id, current_frame);
+}
+
+}  // namespace gr_resource_pool
@@ -0,0 +1,208 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./gr_resource_registry.h"
+
+#include <emscripten/bind.h>
+#include <emscripten/val.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+namespace gr_resource_registry {
+
+struct ResourceRecord {
+  std::string owner;
+  size_t bytes;
+};
+
+// WebGL 2.0 on desktop browsers usually tolerates far more, but mobile devices
+// start losing the context somewhere around here
+const size_t default_budget_bytes = 1024 * 1024 * 1024;
+
+std::unordered_map<uint64_t, ResourceRecord> resource_records;
+std::unordered_map<std::string, size_t> owner_bytes_map;
+GrResourceCategoryStats category_stats[GR_RESOURCE_CATEGORY_COUNT] = {};
+size_t live_bytes = 0;
+size_t peak_bytes = 0;
+size_t budget_bytes = default_budget_bytes;
+GrMemoryBudgetPolicy budget_policy = GrMemoryBudgetPolicy::LOG;
+const char* current_owner = "Unknown";
+
+uint64_t getResourceKey(GrResourceCategory category, unsigned int gl_id) {
+  return (static_cast<uint64_t>(category) << 32) | gl_id;
+}
+
+void registerResource(GrResourceCategory category, unsigned int gl_id,
+                      size_t bytes) {
+  auto key = getResourceKey(category, gl_id);
+
+  if (resource_records.contains(key)) {
+    throw std::runtime_error("GL resource is already registered");
+  }
+
+  resource_records[key] = {.owner = current_owner, .bytes = 0};
+  category_stats[static_cast<int>(category)].count++;
+
+  resizeResource(category, gl_id, bytes);
+}
+
+void resizeResource(GrResourceCategory category, unsigned int gl_id,
+                    size_t bytes) {
+  auto it = resource_records.find(getResourceKey(category, gl_id));
+
+  if (it == resource_records.end()) {
+    throw std::runtime_error("GL resource is not registered");
+  }
+
+  auto& record = it->second;
+  auto& stats = category_stats[static_cast<int>(category)];
+
+  stats.bytes = stats.bytes - record.bytes + bytes;
+  owner_bytes_map[record.owner] =
+      owner_bytes_map[record.owner] - record.bytes + bytes;
+  live_bytes = live_bytes - record.bytes + bytes;
+  peak_bytes = std::max(peak_bytes, live_bytes);
+
+  record.bytes = bytes;
+}
+
+void unregisterResource(GrResourceCategory category, unsigned int gl_id) {
+  auto it = resource_records.find(getResourceKey(category, gl_id));
+
+  if (it == resource_records.end()) {
+    return;
+  }
+
+  resizeResource(category, gl_id, 0);
+  category_stats[static_cast<int>(category)].count--;
+  resource_records.erase(it);
+}
+
+void assignResource(GrResourceCategory category, unsigned int gl_id,
+                    const char* owner) {
+  auto it = resource_records.find(getResourceKey(category, gl_id));
+
+  if (it == resource_records.end()) {
+    throw std::runtime_error("GL resource is not registered");
+  }
+
+  auto& record = it->second;
+
+  owner_bytes_map[record.owner] -= record.bytes;
+  record.owner = owner != nullptr ? owner : current_owner;
+  owner_bytes_map[record.owner] += record.bytes;
+}
+
+size_t getLiveBytes() { return live_bytes; }
+
+size_t getPeakBytes() { return peak_bytes; }
+
+void resetPeakBytes() { peak_bytes = live_bytes; }
+
+GrResourceCategoryStats getCategoryStats(GrResourceCategory category) {
+  return category_stats[static_cast<int>(category)];
+}
+
+size_t getOwnerBytes(const std::string& owner) {
+  auto it = owner_bytes_map.find(owner);
+  return it == owner_bytes_map.end() ? 0 : it->second;
+}
+
+const std::unordered_map<std::string, size_t>& getOwnerBytesMap() {
+  return owner_bytes_map;
+}
+
+size_t getBudgetBytes() { return budget_bytes; }
+
+GrMemoryBudgetPolicy getBudgetPolicy() { return budget_policy; }
+
+void setBudget(size_t new_budget_bytes, GrMemoryBudgetPolicy policy) {
+  budget_bytes = new_budget_bytes;
+  budget_policy = policy;
+}
+
+OwnerScope::OwnerScope(const char* owner) : prev_owner(current_owner) {
+  current_owner = owner;
+}
+
+OwnerScope::~OwnerScope() { current_owner = prev_owner; }
+
+emscripten::val getGrMemoryStats() {
+  const char* category_names[GR_RESOURCE_CATEGORY_COUNT] = {
+      "texture",      "framebuffer", "vertexArray",
+      "vertexBuffer", "indexBuffer", "uniformBuffer",
+  };
+
+  auto categories = emscripten::val::object();
+  for (int i = 0; i < GR_RESOURCE_CATEGORY_COUNT; i++) {
+    auto category = emscripten::val::object();
+    category.set("count", static_cast<double>(category_stats[i].count));
+    category.set("bytes", static_cast<double>(category_stats[i].bytes));
+    categories.set(category_names[i], category);
+  }
+
+  auto owners = emscripten::val::object();
+  for (const auto& [owner, bytes] : owner_bytes_map) {
+    owners.set(owner, static_cast<double>(bytes));
+  }
+
+  auto stats = emscripten::val::object();
+  stats.set("liveBytes", static_cast<double>(live_bytes));
+  stats.set("peakBytes", static_cast<double>(peak_bytes));
+  stats.set("budgetBytes", static_cast<double>(budget_bytes));
+  stats.set("budgetPolicy", static_cast<int>(budget_policy));
+  stats.set("categories", categories);
+  stats.set("owners", owners);
+
+  return stats;
+}
+
+void setGrMemoryBudget(double new_budget_bytes, int policy) {
+  if (!std::isfinite(new_budget_bytes) || new_budget_bytes < 0.0) {
+    throw std::invalid_argument("Budget must be a non-negative byte count");
+  }
+  if (policy < static_cast<int>(GrMemoryBudgetPolicy::LOG) ||
+      policy > static_cast<int>(GrMemoryBudgetPolicy::REFUSE)) {
+    throw std::invalid_argument("Invalid GPU memory budget policy");
+  }
+
+  // Budgets beyond the address space are not limiting anything
+  size_t max_bytes = std::numeric_limits<size_t>::max();
+  setBudget(new_budget_bytes >= static_cast<double>(max_bytes)
+                ? max_bytes
+                : static_cast<size_t>(new_budget_bytes),
+            static_cast<GrMemoryBudgetPolicy>(policy));
+}
+
+EMSCRIPTEN_BINDINGS(gr_resource_registry) {
+  emscripten::function("getGrMemoryStats", &getGrMemoryStats);
+  emscripten::function("setGrMemoryBudget", &setGrMemoryBudget);
+  emscripten::function("resetGrMemoryPeak", &resetPeakBytes);
+}
+
+}  // namespace gr_resource_registry
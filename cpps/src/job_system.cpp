@@ -0,0 +1,273 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./job_system.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace job_system {
+
+// Emscripten only supports std::thread when compiled with -pthread
+#if defined(TARGET_EMSCRIPTEN) && !defined(__EMSCRIPTEN_PTHREADS__)
+const bool has_threads = false;
+#else
+const bool has_threads = true;
+#endif
+
+class JobQueue {
+ public:
+  void pushBack(std::function<void()> job) {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(std::move(job));
+  }
+
+  std::optional<std::function<void()>> popBack() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobs.empty()) {
+      return std::nullopt;
+    }
+    auto job = std::move(jobs.back());
+    jobs.pop_back();
+    return job;
+  }
+
+  std::optional<std::function<void()>> popFront() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (jobs.empty()) {
+      return std::nullopt;
+    }
+    auto job = std::move(jobs.front());
+    jobs.pop_front();
+    return job;
+  }
+
+ private:
+  std::mutex mutex;
+  std::deque<std::function<void()>> jobs;
+};
+
+class WorkerPool {
+ public:
+  ~WorkerPool() { stop(); }
+
+  void start(size_t worker_count) {
+    is_stopping = false;
+
+    // The last queue takes jobs submitted from outside the workers
+    for (size_t i = 0; i <= worker_count; i++) {
+      queues.push_back(std::make_unique<JobQueue>());
+    }
+    for (size_t i = 0; i < worker_count; i++) {
+      workers.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      is_stopping = true;
+    }
+    sleep_condition.notify_all();
+
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    workers.clear();
+    queues.clear();
+  }
+
+  void push(std::function<void()> job) {
+    size_t queue_index =
+        current_worker_index >= 0 ? current_worker_index : workers.size();
+    queues[queue_index]->pushBack(std::move(job));
+
+    pending_job_count++;
+    {
+      // Pairs with the check in work(), so the wake up cannot be missed
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    sleep_condition.notify_one();
+  }
+
+  void pushBackground(std::function<void()> job) {
+    background_queue.pushBack(std::move(job));
+
+    background_job_count++;
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    sleep_condition.notify_one();
+  }
+
+  bool runPendingJob() {
+    auto job = takeJob();
+    if (!job.has_value()) {
+      return false;
+    }
+
+    pending_job_count--;
+    job.value()();
+    return true;
+  }
+
+  std::vector<std::thread> workers;
+
+ private:
+  void work(size_t worker_index) {
+    current_worker_index = worker_index;
+
+    while (true) {
+      if (runPendingJob() || runBackgroundJob()) {
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      sleep_condition.wait(lock, [this] {
+        return is_stopping || pending_job_count > 0 ||
+               background_job_count > 0;
+      });
+
+      // Queued jobs are finished before stopping
+      if (is_stopping && pending_job_count == 0 &&
+          background_job_count == 0) {
+        return;
+      }
+    }
+  }
+
+  // Only called between jobs, never while waiting on a JobGroup
+  bool runBackgroundJob() {
+    auto job = background_queue.popFront();
+    if (!job.has_value()) {
+      return false;
+    }
+
+    background_job_count--;
+    job.value()();
+    return true;
+  }
+
+  std::optional<std::function<void()>> takeJob() {
+    size_t queue_count = queues.size();
+    size_t own_index =
+        current_worker_index >= 0 ? current_worker_index : queue_count - 1;
+
+    auto job = queues[own_index]->popBack();
+    if (job.has_value()) {
+      return job;
+    }
+
+    for (size_t i = 1; i < queue_count; i++) {
+      job = queues[(own_index + i) % queue_count]->popFront();
+      if (job.has_value()) {
+        return job;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  static thread_local int current_worker_index;
+
+  std::vector<std::unique_ptr<JobQueue>> queues;
+  std::atomic<size_t> pending_job_count = 0;
+  JobQueue background_queue;
+  std::atomic<size_t> background_job_count = 0;
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_condition;
+  bool is_stopping = false;
+};
+
+thread_local int WorkerPool::current_worker_index = -1;
+
+WorkerPool worker_pool;
+
+void init(size_t max_worker_count) {
+  if (!has_threads || !worker_pool.workers.empty()) {
+    return;
+  }
+
+  size_t hardware_thread_count = std::thread::hardware_concurrency();
+  size_t worker_count = std::min(
+      max_worker_count,
+      hardware_thread_count > 1 ? hardware_thread_count - 1 : size_t(0));
+
+  if (worker_count > 0) {
+    worker_pool.start(worker_count);
+  }
+}
+
+void shutdown() { worker_pool.stop(); }
+
+size_t getWorkerCount() { return worker_pool.workers.size(); }
+
+void submit(std::function<void()> job) {
+  if (worker_pool.workers.empty()) {
+    job();
+    return;
+  }
+
+  worker_pool.push(std::move(job));
+}
+
+void submitBackground(std::function<void()> job) {
+  if (worker_pool.workers.empty()) {
+    job();
+    return;
+  }
+
+  worker_pool.pushBackground(std::move(job));
+}
+
+bool runPendingJob() {
+  if (worker_pool.workers.empty()) {
+    return false;
+  }
+
+  return worker_pool.runPendingJob();
+}
+
+void JobGroup::run(std::function<void()> job) {
+  pending_count++;
+  submit([this, job = std::move(job)] {
+    job();
+    pending_count--;
+  });
+}
+
+void JobGroup::wait() {
+  while (pending_count > 0) {
+    if (!runPendingJob()) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+}  // namespace job_system
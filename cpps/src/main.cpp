@@ -24,21 +24,33 @@
 
 #include <GLES3/gl3.h>
 #include <emscripten.h>
+#include <emscripten/bind.h>
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "./Entity/PaintableEntity.h"
 #include "./RootManager.h"
+#include "./constants.h"
+#include "./frame_arena.h"
+#include "./geometry_cache.h"
+#include "./gr_resource_pool.h"
+#include "./job_system.h"
 #include "./system/client_sync_system.h"
+#include "./system/cull_system.h"
 #include "./system/gr_sync_system.h"
 #include "./system/input_sync_system.h"
 #include "./system/manage_system.h"
 #include "./system/paint_system.h"
+#include "./system/pick_system.h"
 #include "./system/render_system.h"
+#include "./system/stress_system.h"
 #include "./system/transform_system.h"
+#include "./system_scheduler.h"
 
 static std::function<void(float, float)> static_main_loop;
+static RootManager* static_root_manager = nullptr;
 static double start_time = emscripten_get_now();
 static double prev_time = start_time;
 
@@ -54,8 +66,629 @@ void renderFrame() {
   prev_time = current_time;
 }
 
+void updatePaintableGeometries(
+    std::reference_wrapper<PaintableEntity> paintable_entity) {
+  for (auto [shared_geometry_component] :
+       paintable_entity.get()
+           .part_registry->query<SharedGeometryComponent>()) {
+    // Shared geometry may already be uploaded by another part
+    if (shared_geometry_component.gr_geometry_component->vao_id != 0) {
+      continue;
+    }
+
+    gr_sync_system::updateGeometry(
+        shared_geometry_component.view,
+        std::ref(*shared_geometry_component.gr_geometry_component));
+  }
+}
+
+void paintParts(std::reference_wrapper<GrGlobalEntity> gr_global_entity,
+                std::reference_wrapper<BrushEntity> brush_entity,
+                std::reference_wrapper<EntityRegistry> part_registry) {
+  for (auto [shared_geometry_component, gr_model_uniform_component,
+             meshlet_selection_component, gr_paint_framed_texture_component,
+             gr_painted_ping_pong_texture_component] :
+       part_registry.get()
+           .query<SharedGeometryComponent, GrUniformComponent,
+                  MeshletSelectionComponent, GrFramedTextureComponent,
+                  GrPingPongTextureComponent>()) {
+    // Blending an empty paint map would leave the painted map as it is
+    if (meshlet_selection_component.decal_ranges.empty()) {
+      continue;
+    }
+
+    paint_system::paint(
+        std::ref(*shared_geometry_component.gr_geometry_component),
+        std::ref(*gr_global_entity.get().gr_shader_manager_component),
+        std::ref(*brush_entity.get().gr_brush_uniform_component),
+        std::ref(gr_model_uniform_component),
+        std::ref(*gr_global_entity.get().gr_time_uniform_component),
+        std::ref(*brush_entity.get().gr_brush_depth_framed_texture_component),
+        std::ref(meshlet_selection_component),
+        std::ref(gr_paint_framed_texture_component));
+    paint_system::updatePaintedMap(
+        std::ref(*gr_global_entity.get().gr_quad_geometry_component),
+        std::ref(*gr_global_entity.get().gr_shader_manager_component),
+        std::ref(gr_paint_framed_texture_component),
+        std::ref(meshlet_selection_component),
+        std::ref(gr_painted_ping_pong_texture_component));
+    paint_system::updatePaintedMipmaps(
+        std::ref(*gr_global_entity.get().gr_quad_geometry_component),
+        std::ref(*gr_global_entity.get().gr_shader_manager_component),
+        std::ref(gr_painted_ping_pong_texture_component));
+  }
+}
+
+// Spraying into empty space skips the brush depth and paint passes
+bool isPaintingModel(std::reference_wrapper<RootManager> root_manager) {
+  return input_sync_system::isPointerDown(std::ref(
+             *root_manager.get().client_input_entity->input_component)) &&
+         root_manager.get().brush_entity->pick_component->is_cone_hit;
+}
+
+void addSystems(std::reference_wrapper<SystemScheduler> scheduler,
+                std::reference_wrapper<RootManager> root_manager) {
+  // Entities are looked up when a system runs, since some of them are replaced
+  // by earlier systems of the frame
+  auto& manager = root_manager.get();
+
+  scheduler.get().add({
+      .name = "clientSync",
+      .reads = {},
+      .writes = getResourceIds<InputComponent, EventComponent>(),
+      .thread = SystemThread::CONTEXT,
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            client_sync_system::syncInput(
+                std::ref(*manager.client_input_entity->input_component));
+            client_sync_system::consumeEvent(
+                std::ref(*manager.client_input_entity->event_component));
+          },
+  });
+
+  scheduler.get().add({
+      .name = "resetModel",
+      .reads = {},
+      .writes = getResourceIds<EventComponent, MeshImportComponent,
+                               ModelSwitchComponent, TransformHierarchy>(),
+      .thread = SystemThread::CONTEXT,
+      .is_active =
+          [&manager] {
+            return manage_system::isChangeModel(
+                std::ref(*manager.client_input_entity->event_component));
+          },
+      .run =
+          [&manager, root_manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            manage_system::resetModel(
+                std::ref(*manager.client_input_entity->event_component),
+                root_manager);
+          },
+  });
+
+  scheduler.get().add({
+      .name = "importMesh",
+      .reads = getResourceIds<ProfileComponent>(),
+      .writes = getResourceIds<EventComponent, MeshImportComponent,
+                               ModelSwitchComponent, TransformHierarchy>(),
+      .thread = SystemThread::CONTEXT,
+      .is_active =
+          [&manager] {
+            return manage_system::isImportMesh(
+                std::ref(*manager.client_input_entity->event_component));
+          },
+      .run =
+          [&manager, root_manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            manage_system::importMesh(
+                std::ref(*manager.client_input_entity->event_component),
+                std::ref(*manager.stress_test_entity->profile_component),
+                root_manager);
+          },
+  });
+
+  scheduler.get().add({
+      .name = "stepMeshImport",
+      .reads = getResourceIds<ProfileComponent>(),
+      .writes = getResourceIds<MeshImportComponent, ModelSwitchComponent,
+                               TransformHierarchy>(),
+      .thread = SystemThread::CONTEXT,
+      .is_active =
+          [&manager] {
+            return manage_system::isMeshImporting(std::ref(
+                *manager.model_switch_entity->mesh_import_component));
+          },
+      .run =
+          [&manager, root_manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            manage_system::stepMeshImport(
+                std::ref(*manager.stress_test_entity->profile_component),
+                root_manager);
+          },
+  });
+
+  scheduler.get().add({
+      .name = "modelSwitch",
+      .reads = getResourceIds<ProfileComponent>(),
+      .writes = getResourceIds<ModelSwitchComponent, PaintableEntity,
+                               TransformHierarchy>(),
+      .thread = SystemThread::CONTEXT,
+      .is_active =
+          [&manager] {
+            return manage_system::isModelSwitching(std::ref(
+                *manager.model_switch_entity->model_switch_component));
+          },
+      .run =
+          [&manager, root_manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            manage_system::stepModelSwitch(
+                std::ref(*manager.stress_test_entity->profile_component),
+                root_manager);
+          },
+  });
+
+  scheduler.get().add({
+      .name = "stressControl",
+      .reads = {},
+      .writes = getResourceIds<EventComponent, StressTestComponent,
+                               ProfileComponent, PaintableEntity,
+                               MeshImportComponent, TransformHierarchy>(),
+      .thread = SystemThread::CONTEXT,
+      .run =
+          [&manager, root_manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            auto& stress_test_entity = *manager.stress_test_entity;
+            auto& event_component =
+                *manager.client_input_entity->event_component;
+
+            if (stress_system::isStressTestRequested(
+                    std::ref(event_component))) {
+              stress_system::startStressTest(
+                  std::ref(event_component),
+                  std::ref(*stress_test_entity.stress_test_component),
+                  std::ref(*stress_test_entity.profile_component));
+            }
+
+            if (stress_system::isStressTestRunning(
+                    std::ref(*stress_test_entity.stress_test_component)) &&
+                stress_system::prepareCase(
+                    std::ref(*stress_test_entity.stress_test_component),
+                    std::ref(*stress_test_entity.profile_component),
+                    root_manager)) {
+              for (auto& paintable_entity : manager.paintable_entities) {
+                updatePaintableGeometries(std::ref(*paintable_entity));
+              }
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "scriptedStroke",
+      .reads = getResourceIds<StressTestComponent, RenderConfigComponent>(),
+      .writes = getResourceIds<InputComponent>(),
+      .thread = SystemThread::ANY,
+      .is_active =
+          [&manager] {
+            return stress_system::isStressTestRunning(std::ref(
+                *manager.stress_test_entity->stress_test_component));
+          },
+      .run =
+          [&manager](float elapsed_ms, float /*delta_ms*/) {
+            stress_system::driveScriptedStroke(
+                elapsed_ms,
+                std::ref(*manager.config_entity->render_config_component),
+                std::ref(*manager.client_input_entity->input_component));
+          },
+  });
+
+  scheduler.get().add({
+      .name = "resetPaint",
+      .reads = getResourceIds<RenderConfigComponent, PaintableEntity>(),
+      .writes = getResourceIds<EventComponent>(),
+      .thread = SystemThread::CONTEXT,
+      .is_active =
+          [&manager] {
+            return manage_system::isResetPaintTrue(
+                std::ref(*manager.client_input_entity->event_component));
+          },
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            for (auto& paintable_entity : manager.paintable_entities) {
+              manage_system::resetPainted(
+                  std::ref(*manager.client_input_entity->event_component),
+                  std::ref(*manager.config_entity->render_config_component),
+                  std::ref(*paintable_entity->part_registry));
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "resetPosition",
+      .reads = getResourceIds<PaintableEntity>(),
+      .writes = getResourceIds<EventComponent, CameraComponent,
+                               TransformComponent>(),
+      .thread = SystemThread::ANY,
+      .is_active =
+          [&manager] {
+            return manage_system::isResetPositionTrue(
+                std::ref(*manager.client_input_entity->event_component));
+          },
+      .run =
+          [&manager, root_manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            manage_system::resetPosition(
+                std::ref(*manager.client_input_entity->event_component),
+                std::ref(*manager.camera_entity->camera_component),
+                root_manager);
+          },
+  });
+
+  scheduler.get().add({
+      .name = "viewport",
+      .reads = {},
+      .writes = getResourceIds<EventComponent, RenderConfigComponent,
+                               CameraComponent>(),
+      .thread = SystemThread::CONTEXT,
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            render_system::adjustViewportSize(
+                std::ref(*manager.client_input_entity->event_component),
+                std::ref(*manager.config_entity->render_config_component),
+                std::ref(*manager.camera_entity->camera_component));
+          },
+  });
+
+  scheduler.get().add({
+      .name = "transformCamera",
+      .reads = getResourceIds<InputComponent>(),
+      .writes = getResourceIds<CameraComponent>(),
+      .thread = SystemThread::ANY,
+      .run =
+          [&manager](float /*elapsed_ms*/, float delta_ms) {
+            transform_system::transformCamera(
+                delta_ms,
+                std::ref(*manager.client_input_entity->input_component),
+                std::ref(*manager.camera_entity->camera_component));
+          },
+  });
+
+  scheduler.get().add({
+      .name = "transformScene",
+      .reads = getResourceIds<InputComponent, CameraComponent>(),
+      .writes = getResourceIds<TransformComponent>(),
+      .thread = SystemThread::ANY,
+      .run =
+          [&manager](float /*elapsed_ms*/, float delta_ms) {
+            transform_system::transformScene(
+                delta_ms,
+                std::ref(*manager.client_input_entity->input_component),
+                std::ref(*manager.camera_entity->camera_component),
+                std::ref(*manager.scene_entity->transform_component));
+          },
+  });
+
+  scheduler.get().add({
+      .name = "updateTransforms",
+      .reads = getResourceIds<PaintableEntity>(),
+      .writes = getResourceIds<TransformComponent, TransformHierarchy>(),
+      .thread = SystemThread::ANY,
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            auto& transform_hierarchy =
+                *manager.scene_entity->transform_hierarchy;
+
+            transform_system::syncTransformNode(
+                std::ref(*manager.scene_entity->transform_component),
+                std::ref(transform_hierarchy));
+            for (auto& paintable_entity : manager.paintable_entities) {
+              transform_system::syncTransformNode(
+                  std::ref(*paintable_entity->transform_component),
+                  std::ref(transform_hierarchy));
+            }
+
+            transform_system::updateWorldMatrices(
+                std::ref(transform_hierarchy));
+          },
+  });
+
+  scheduler.get().add({
+      .name = "syncBrush",
+      .reads = getResourceIds<InputComponent>(),
+      .writes = getResourceIds<BrushComponent>(),
+      .thread = SystemThread::ANY,
+      .is_active =
+          [&manager] {
+            return input_sync_system::isPointerDown(
+                std::ref(*manager.client_input_entity->input_component));
+          },
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            input_sync_system::syncBrush(
+                std::ref(*manager.client_input_entity->input_component),
+                std::ref(*manager.brush_entity->brush_component));
+          },
+  });
+
+  // The brush follows the pointer even when it is up, so that picking tells
+  // whether the pointer is over the model
+  scheduler.get().add({
+      .name = "transformBrush",
+      .reads = getResourceIds<InputComponent, RenderConfigComponent,
+                              CameraComponent>(),
+      .writes = getResourceIds<BrushComponent>(),
+      .thread = SystemThread::ANY,
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            transform_system::transformBrush(
+                std::ref(*manager.client_input_entity->input_component),
+                std::ref(*manager.config_entity->render_config_component),
+                std::ref(*manager.camera_entity->camera_component),
+                std::ref(*manager.brush_entity->brush_component));
+          },
+  });
+
+  scheduler.get().add({
+      .name = "cullByBrush",
+      .reads = getResourceIds<InputComponent, BrushComponent,
+                              TransformComponent, TransformHierarchy,
+                              PaintableEntity>(),
+      .writes = getResourceIds<BoundsComponent>(),
+      .thread = SystemThread::ANY,
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            for (auto& paintable_entity : manager.paintable_entities) {
+              cull_system::cullByBrush(
+                  std::ref(*manager.brush_entity->brush_component),
+                  std::ref(*manager.scene_entity->transform_hierarchy),
+                  std::ref(*paintable_entity->transform_component),
+                  std::ref(*paintable_entity->bounds_component));
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "pickByBrush",
+      .reads = getResourceIds<BrushComponent, TransformHierarchy,
+                              PaintableEntity>(),
+      .writes = getResourceIds<BoundsComponent, PickComponent>(),
+      // Queries the part registries
+      .thread = SystemThread::CONTEXT,
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            auto& pick_component = *manager.brush_entity->pick_component;
+            pick_component.reset();
+
+            for (size_t i = 0; i < manager.paintable_entities.size(); i++) {
+              auto& paintable_entity = *manager.paintable_entities[i];
+              pick_system::pickByBrush(
+                  std::ref(*manager.brush_entity->brush_component),
+                  std::ref(*manager.scene_entity->transform_hierarchy), i,
+                  std::ref(*paintable_entity.part_registry),
+                  std::ref(*paintable_entity.bounds_component),
+                  std::ref(pick_component));
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "selectMeshlets",
+      .reads = getResourceIds<BrushComponent, BoundsComponent,
+                              TransformHierarchy, PaintableEntity>(),
+      .writes = getResourceIds<MeshletSelectionComponent>(),
+      // Queries the part registries
+      .thread = SystemThread::CONTEXT,
+      .is_active = [&manager] { return isPaintingModel(manager); },
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            for (auto& paintable_entity : manager.paintable_entities) {
+              if (paintable_entity->bounds_component->is_under_brush) {
+                cull_system::selectMeshletsByBrush(
+                    std::ref(*manager.brush_entity->brush_component),
+                    std::ref(*manager.scene_entity->transform_hierarchy),
+                    std::ref(*paintable_entity->part_registry));
+              }
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "globalUniforms",
+      .reads = getResourceIds<RenderConfigComponent, CameraComponent,
+                              LightingComponent>(),
+      .writes = getResourceIds<GrUniformComponent>(),
+      .thread = SystemThread::CONTEXT,
+      .run =
+          [&manager](float elapsed_ms, float delta_ms) {
+            gr_sync_system::updateCameraUniform(
+                std::ref(*manager.config_entity->render_config_component),
+                std::ref(*manager.camera_entity->camera_component),
+                std::ref(*manager.camera_entity->gr_camera_uniform_component));
+            gr_sync_system::updateTimeUniform(
+                elapsed_ms, delta_ms,
+                std::ref(*manager.gr_global_entity->gr_time_uniform_component));
+            gr_sync_system::updateLightingUniform(
+                std::ref(*manager.lighting_entity->lighting_component),
+                std::ref(
+                    *manager.lighting_entity->gr_lighting_uniform_component));
+          },
+  });
+
+  scheduler.get().add({
+      .name = "brushDepth",
+      .reads = getResourceIds<BrushComponent, InputComponent,
+                              RenderConfigComponent, BoundsComponent,
+                              PickComponent, MeshletSelectionComponent,
+                              TransformHierarchy, PaintableEntity>(),
+      .writes = getResourceIds<GrUniformComponent>(),
+      .thread = SystemThread::CONTEXT,
+      .is_active = [&manager] { return isPaintingModel(manager); },
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            auto& gr_global_entity = *manager.gr_global_entity;
+            auto& brush_entity = *manager.brush_entity;
+
+            gr_sync_system::updateBrushUniform(
+                std::ref(*brush_entity.brush_component),
+                std::ref(*brush_entity.gr_brush_uniform_component));
+
+            // One depth map for the whole scene, so that paintables occlude
+            // each other. Paintables outside of the brush cone cannot.
+            auto& gr_brush_depth_framed_texture_component =
+                *brush_entity.gr_brush_depth_framed_texture_component;
+            paint_system::clearBrushDepth(
+                std::ref(gr_brush_depth_framed_texture_component));
+
+            for (auto& paintable_entity : manager.paintable_entities) {
+              if (!paintable_entity->bounds_component->is_under_brush) {
+                continue;
+              }
+
+              if (manager.config_entity->render_config_component
+                      ->is_instancing_enabled) {
+                paint_system::updateBrushDepthInstanced(
+                    std::ref(*gr_global_entity.gr_shader_manager_component),
+                    std::ref(*brush_entity.gr_brush_uniform_component),
+                    std::ref(gr_brush_depth_framed_texture_component),
+                    std::ref(*gr_global_entity.gr_instance_uniform_component),
+                    std::ref(*paintable_entity->instance_batches_view));
+              } else {
+                paint_system::updateBrushDepth(
+                    std::ref(*gr_global_entity.gr_shader_manager_component),
+                    std::ref(*brush_entity.gr_brush_uniform_component),
+                    std::ref(gr_brush_depth_framed_texture_component),
+                    std::ref(*paintable_entity->part_registry));
+              }
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "paint",
+      .reads = getResourceIds<InputComponent, BoundsComponent,
+                              PickComponent, MeshletSelectionComponent,
+                              PaintableEntity>(),
+      .writes = getResourceIds<GrUniformComponent>(),
+      .thread = SystemThread::CONTEXT,
+      .is_active = [&manager] { return isPaintingModel(manager); },
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            for (auto& paintable_entity : manager.paintable_entities) {
+              if (paintable_entity->bounds_component->is_under_brush) {
+                paintParts(std::ref(*manager.gr_global_entity),
+                           std::ref(*manager.brush_entity),
+                           std::ref(*paintable_entity->part_registry));
+              }
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "transformUniforms",
+      .reads = getResourceIds<TransformHierarchy, PaintableEntity>(),
+      .writes = getResourceIds<GrUniformComponent>(),
+      .thread = SystemThread::CONTEXT,
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            for (auto& paintable_entity : manager.paintable_entities) {
+              gr_sync_system::updateTransformUniforms(
+                  std::ref(*manager.scene_entity->transform_hierarchy),
+                  std::ref(*paintable_entity->part_registry));
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "render",
+      .reads = getResourceIds<RenderConfigComponent, TransformHierarchy,
+                              PaintableEntity>(),
+      .writes = getResourceIds<GrUniformComponent>(),
+      .thread = SystemThread::CONTEXT,
+      .run =
+          [&manager](float /*elapsed_ms*/, float /*delta_ms*/) {
+            auto& gr_global_entity = *manager.gr_global_entity;
+            auto& render_config_component =
+                *manager.config_entity->render_config_component;
+
+            render_system::clearCanvas(std::ref(render_config_component));
+
+            for (auto& paintable_entity : manager.paintable_entities) {
+              if (render_config_component.is_instancing_enabled) {
+                render_system::renderInstanced(
+                    std::ref(*paintable_entity->material_component),
+                    std::ref(*gr_global_entity.gr_shader_manager_component),
+                    std::ref(
+                        *manager.camera_entity->gr_camera_uniform_component),
+                    std::ref(*manager.lighting_entity
+                                  ->gr_lighting_uniform_component),
+                    std::ref(*gr_global_entity.gr_instance_uniform_component),
+                    std::ref(*paintable_entity->instance_batches_view));
+              } else {
+                render_system::render(
+                    std::ref(*paintable_entity->material_component),
+                    std::ref(*gr_global_entity.gr_shader_manager_component),
+                    std::ref(
+                        *manager.camera_entity->gr_camera_uniform_component),
+                    std::ref(*manager.lighting_entity
+                                  ->gr_lighting_uniform_component),
+                    std::ref(*paintable_entity->part_registry));
+              }
+            }
+          },
+  });
+
+  scheduler.get().add({
+      .name = "collectResources",
+      .reads = {},
+      .writes = {},
+      .thread = SystemThread::CONTEXT,
+      .run =
+          [](float /*elapsed_ms*/, float /*delta_ms*/) {
+            geometry_cache::collect();
+            gr_resource_pool::collect();
+          },
+  });
+}
+
+emscripten::val getPointerHit() {
+  if (static_root_manager == nullptr) {
+    return emscripten::val::null();
+  }
+
+  return pick_system::getPointerHitValue(
+      std::ref(*static_root_manager->brush_entity->pick_component));
+}
+
+emscripten::val getLighting() {
+  if (static_root_manager == nullptr) {
+    return emscripten::val::null();
+  }
+
+  return client_sync_system::getLightingValue(
+      std::ref(*static_root_manager->lighting_entity->lighting_component));
+}
+
+void setLighting(emscripten::val lighting) {
+  if (static_root_manager == nullptr) {
+    return;
+  }
+
+  client_sync_system::setLighting(
+      lighting,
+      std::ref(*static_root_manager->lighting_entity->lighting_component));
+}
+
+void resetLighting() {
+  if (static_root_manager == nullptr) {
+    return;
+  }
+
+  static_root_manager->lighting_entity->lighting_component->reset();
+}
+
+EMSCRIPTEN_BINDINGS(main) {
+  emscripten::function("getPointerHit", &getPointerHit);
+  emscripten::function("getLighting", &getLighting);
+  emscripten::function("setLighting", &setLighting);
+  emscripten::function("resetLighting", &resetLighting);
+}
+
 int main() {
   render_system::initContext();
+  job_system::init(MAX_JOB_WORKER_COUNT);
 
   auto root_manager = std::make_unique<RootManager>();
 
@@ -64,133 +697,37 @@ int main() {
       std::ref(
           *root_manager.get()->gr_global_entity->gr_quad_geometry_component));
 
-  for (const auto& paintable_part :
-       root_manager.get()->paintable_entity->paintable_part_entities) {
-    gr_sync_system::updateGeometry(
-        std::ref(*paintable_part->geometry_component),
-        std::ref(*paintable_part->gr_geometry_component));
+  for (auto& paintable_entity : root_manager->paintable_entities) {
+    updatePaintableGeometries(std::ref(*paintable_entity));
   }
 
-  auto main_loop = [root_manager = std::ref(*root_manager)](float elapsed_ms,
-                                                            float delta_ms) {
-    auto client_input_entity =
-        std::ref(*root_manager.get().client_input_entity);
-
-    client_sync_system::syncInput(
-        std::ref(*client_input_entity.get().input_component));
-    client_sync_system::consumeEvent(
-        std::ref(*client_input_entity.get().event_component));
-
-    if (manage_system::isChangeModel(
-            std::ref(*client_input_entity.get().event_component))) {
-      manage_system::resetModel(
-          std::ref(*client_input_entity.get().event_component), root_manager);
-      for (const auto& paintable_part :
-           root_manager.get().paintable_entity->paintable_part_entities) {
-        gr_sync_system::updateGeometry(
-            std::ref(*paintable_part->geometry_component),
-            std::ref(*paintable_part->gr_geometry_component));
-      }
-    }
+  auto scheduler = std::make_unique<SystemScheduler>();
+  addSystems(std::ref(*scheduler), std::ref(*root_manager));
+  scheduler->build();
 
-    auto config_entity = std::ref(*root_manager.get().config_entity);
-    auto gr_global_entity = std::ref(*root_manager.get().gr_global_entity);
-    auto camera_entity = std::ref(*root_manager.get().camera_entity);
-    auto brush_entity = std::ref(*root_manager.get().brush_entity);
-    auto paintable_entity = std::ref(*root_manager.get().paintable_entity);
-    auto render_items_view = std::ref(*root_manager.get().render_items_view);
-    auto painted_textures_view =
-        std::ref(*root_manager.get().painted_textures_view);
-    auto transform_updating_view =
-        std::ref(*root_manager.get().transform_updating_view);
-    auto gr_model_geometries_view =
-        std::ref(*root_manager.get().gr_model_geometries_view);
-
-    if (manage_system::isResetPaintTrue(
-            std::ref(*client_input_entity.get().event_component))) {
-      manage_system::resetPainted(
-          std::ref(*client_input_entity.get().event_component),
-          std::ref(*config_entity.get().render_config_component),
-          painted_textures_view);
-    }
+  auto main_loop = [root_manager = std::ref(*root_manager),
+                    scheduler = std::ref(*scheduler)](float elapsed_ms,
+                                                      float delta_ms) {
+    frame_arena::reset();
 
-    if (manage_system::isResetPositionTrue(
-            std::ref(*client_input_entity.get().event_component))) {
-      manage_system::resetPosition(
-          std::ref(*client_input_entity.get().event_component),
-          std::ref(*camera_entity.get().camera_component),
-          std::ref(*paintable_entity.get().transform_component));
-    }
+    auto stress_test_entity = std::ref(*root_manager.get().stress_test_entity);
+    auto profile_component =
+        std::ref(*stress_test_entity.get().profile_component);
 
-    render_system::adjustViewportSize(
-        std::ref(*client_input_entity.get().event_component),
-        std::ref(*config_entity.get().render_config_component),
-        std::ref(*camera_entity.get().camera_component));
-
-    transform_system::transformCamera(
-        delta_ms, std::ref(*client_input_entity.get().input_component),
-        std::ref(*camera_entity.get().camera_component));
-    transform_system::transformPaintable(
-        delta_ms, std::ref(*client_input_entity.get().input_component),
-        std::ref(*camera_entity.get().camera_component),
-        std::ref(*paintable_entity.get().transform_component));
-
-    gr_sync_system::updateCameraUniform(
-        std::ref(*config_entity.get().render_config_component),
-        std::ref(*camera_entity.get().camera_component),
-        std::ref(*camera_entity.get().gr_camera_uniform_component));
-    gr_sync_system::updateTimeUniform(
-        elapsed_ms, delta_ms,
-        std::ref(*gr_global_entity.get().gr_time_uniform_component));
-
-        if (input_sync_system::isPointerDown(
-            std::ref(*client_input_entity.get().input_component))) {
-      input_sync_system::syncBrush(
-          std::ref(*client_input_entity.get().input_component),
-          std::ref(*brush_entity.get().brush_component));
-
-      gr_sync_system::updateBrushUniform(
-          std::ref(*brush_entity.get().brush_component),
-          std::ref(*client_input_entity.get().input_component),
-          std::ref(*config_entity.get().render_config_component),
-          std::ref(*camera_entity.get().camera_component),
-          std::ref(*brush_entity.get().gr_brush_uniform_component));
-
-      paint_system::updateBrushDepth(
-          std::ref(*gr_global_entity.get().gr_shader_manager_component),
-          std::ref(*brush_entity.get().gr_brush_uniform_component),
-          std::ref(*brush_entity.get().gr_brush_depth_framed_texture_component),
-          gr_model_geometries_view);
-
-      for (auto& paintable_part :
-           paintable_entity.get().paintable_part_entities) {
-        paint_system::paint(
-            std::ref(*paintable_part->gr_geometry_component),
-            std::ref(*gr_global_entity.get().gr_shader_manager_component),
-            std::ref(*brush_entity.get().gr_brush_uniform_component),
-            std::ref(*paintable_part->gr_transform_uniform_component),
-            std::ref(*gr_global_entity.get().gr_time_uniform_component),
-            std::ref(
-                *brush_entity.get().gr_brush_depth_framed_texture_component),
-            std::ref(*paintable_part->gr_paint_framed_texture_component));
-        paint_system::updatePaintedMap(
-            std::ref(*gr_global_entity.get().gr_quad_geometry_component),
-            std::ref(*gr_global_entity.get().gr_shader_manager_component),
-            std::ref(*paintable_part->gr_paint_framed_texture_component),
-            std::ref(*paintable_part->gr_painted_ping_pong_texture_component));
-      }
-    }
-
-    gr_sync_system::updateTransformUniforms(transform_updating_view);
+    scheduler.get().run(elapsed_ms, delta_ms, profile_component);
 
-    render_system::render(
-        std::ref(*config_entity.get().render_config_component),
-        std::ref(*paintable_entity.get().material_component),
-        std::ref(*gr_global_entity.get().gr_shader_manager_component),
-        render_items_view);
+    // Reads the samples recorded by the scheduler, so it runs after every
+    // system
+    if (stress_system::isStressTestRunning(
+            std::ref(*stress_test_entity.get().stress_test_component))) {
+      stress_system::recordFrame(
+          std::ref(*stress_test_entity.get().stress_test_component),
+          profile_component);
+    }
   };
 
   static_main_loop = main_loop;
+  static_root_manager = root_manager.get();
 
   emscripten_set_main_loop(renderFrame, 0, 1);
 
@@ -0,0 +1,1356 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./mesh_import.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "./job_system.h"
+
+namespace mesh_import {
+
+namespace {
+
+// Large enough to amortize a job, small enough to spread a 10 MB file over
+// every worker
+constexpr size_t OBJ_CHUNK_BYTES = 256 * 1024;
+
+// Material of faces before the first `usemtl`, and of glTF primitives
+// without one
+constexpr std::string_view DEFAULT_MATERIAL_NAME = "default";
+
+// Zero-based indices of a face corner, -1 when the attribute is missing
+struct ObjCorner {
+  int32_t position;
+  int32_t tex_coord;
+  int32_t normal;
+
+  bool operator==(const ObjCorner&) const = default;
+};
+
+struct ObjChunk {
+  const char* begin;
+  const char* end;
+
+  size_t position_count = 0;
+  size_t tex_coord_count = 0;
+  size_t normal_count = 0;
+  size_t triangle_count = 0;
+  // `usemtl` names in the order they appear, and their material indices
+  std::vector<std::string_view> material_names;
+  std::vector<uint32_t> material_indices;
+
+  // Filled in between the passes, from the chunks before this one
+  size_t position_offset = 0;
+  size_t tex_coord_offset = 0;
+  size_t normal_offset = 0;
+  size_t triangle_offset = 0;
+  uint32_t start_material_index = 0;
+};
+
+// Everything the chunks parse into, at the offsets of each chunk
+struct ObjData {
+  std::vector<glm::vec3> positions;
+  std::vector<glm::vec2> tex_coords;
+  std::vector<glm::vec3> normals;
+  std::vector<ObjCorner> corners;
+  std::vector<uint32_t> triangle_materials;
+};
+
+const char* findLineEnd(const char* cursor, const char* end) {
+  const auto* line_end =
+      static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+  return line_end ? line_end : end;
+}
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+void skipSpaces(const char*& cursor, const char* end) {
+  while (cursor < end && isSpace(*cursor)) {
+    cursor++;
+  }
+}
+
+std::string_view readToken(const char*& cursor, const char* end) {
+  skipSpaces(cursor, end);
+  const char* token_begin = cursor;
+  while (cursor < end && !isSpace(*cursor)) {
+    cursor++;
+  }
+  return std::string_view(token_begin, cursor - token_begin);
+}
+
+// Trailing spaces and carriage returns are not part of a name
+std::string_view readRestOfLine(const char* cursor, const char* end) {
+  skipSpaces(cursor, end);
+  while (end > cursor && isSpace(end[-1])) {
+    end--;
+  }
+  return std::string_view(cursor, end - cursor);
+}
+
+// Parses a decimal number without the locale lookups of strtod. Mantissa
+// digits beyond 19 only shift the exponent, which keeps float precision and
+// integers exact up to 2^53.
+bool parseNumber(const char*& cursor, const char* end, double& value) {
+  skipSpaces(cursor, end);
+
+  bool negative = false;
+  if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+    negative = *cursor == '-';
+    cursor++;
+  }
+
+  uint64_t mantissa = 0;
+  int exponent = 0;
+  int digit_count = 0;
+  bool has_digits = false;
+
+  for (; cursor < end && std::isdigit(static_cast<unsigned char>(*cursor));
+       cursor++) {
+    has_digits = true;
+    if (digit_count < 19) {
+      mantissa = mantissa * 10 + (*cursor - '0');
+      digit_count += mantissa != 0;
+    } else {
+      exponent++;
+    }
+  }
+
+  if (cursor < end && *cursor == '.') {
+    cursor++;
+    for (; cursor < end && std::isdigit(static_cast<unsigned char>(*cursor));
+         cursor++) {
+      has_digits = true;
+      if (digit_count < 19) {
+        mantissa = mantissa * 10 + (*cursor - '0');
+        digit_count += mantissa != 0;
+        exponent--;
+      }
+    }
+  }
+
+  if (!has_digits) {
+    return false;
+  }
+
+  if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+    cursor++;
+    bool negative_exponent = false;
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+      negative_exponent = *cursor == '-';
+      cursor++;
+    }
+
+    int written_exponent = 0;
+    bool has_exponent_digits = false;
+    for (; cursor < end && std::isdigit(static_cast<unsigned char>(*cursor));
+         cursor++) {
+      has_exponent_digits = true;
+      written_exponent = std::min(written_exponent * 10 + (*cursor - '0'), 999);
+    }
+    if (!has_exponent_digits) {
+      return false;
+    }
+
+    exponent += negative_exponent ? -written_exponent : written_exponent;
+  }
+
+  static constexpr double POWERS_OF_TEN[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  auto result = static_cast<double>(mantissa);
+  if (exponent >= 0 && exponent <= 22) {
+    result *= POWERS_OF_TEN[exponent];
+  } else if (exponent < 0 && exponent >= -22) {
+    result /= POWERS_OF_TEN[-exponent];
+  } else {
+    result *= std::pow(10.0, exponent);
+  }
+
+  value = negative ? -result : result;
+  return true;
+}
+
+bool parseFloat(const char*& cursor, const char* end, float& value) {
+  double number = 0.0;
+  if (!parseNumber(cursor, end, number)) {
+    return false;
+  }
+  value = static_cast<float>(number);
+  return true;
+}
+
+bool parseInt(const char*& cursor, const char* end, int64_t& value) {
+  bool negative = false;
+  if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+    negative = *cursor == '-';
+    cursor++;
+  }
+
+  if (cursor >= end || !std::isdigit(static_cast<unsigned char>(*cursor))) {
+    return false;
+  }
+
+  int64_t result = 0;
+  for (; cursor < end && std::isdigit(static_cast<unsigned char>(*cursor));
+       cursor++) {
+    result = std::min<int64_t>(result * 10 + (*cursor - '0'), INT32_MAX);
+  }
+
+  value = negative ? -result : result;
+  return true;
+}
+
+// Turns a one-based or negative, relative OBJ index into a zero-based one
+int32_t resolveObjIndex(int64_t index, size_t defined_count,
+                        size_t total_count) {
+  int64_t resolved =
+      index > 0 ? index - 1 : static_cast<int64_t>(defined_count) + index;
+
+  if (index == 0 || resolved < 0 ||
+      resolved >= static_cast<int64_t>(total_count)) {
+    throw std::runtime_error("OBJ face index out of range");
+  }
+
+  return static_cast<int32_t>(resolved);
+}
+
+// Counts what the chunk defines, so that the second pass can write straight
+// into the arrays of the whole file
+void countObjChunk(ObjChunk& chunk) {
+  for (const char* line = chunk.begin; line < chunk.end;) {
+    const char* line_end = findLineEnd(line, chunk.end);
+    const char* cursor = line;
+    auto keyword = readToken(cursor, line_end);
+
+    if (keyword == "v") {
+      chunk.position_count++;
+    } else if (keyword == "vt") {
+      chunk.tex_coord_count++;
+    } else if (keyword == "vn") {
+      chunk.normal_count++;
+    } else if (keyword == "f") {
+      size_t corner_count = 0;
+      while (!readToken(cursor, line_end).empty()) {
+        corner_count++;
+      }
+      if (corner_count < 3) {
+        throw std::runtime_error("OBJ face with fewer than 3 corners");
+      }
+      chunk.triangle_count += corner_count - 2;
+    } else if (keyword == "usemtl") {
+      chunk.material_names.push_back(readRestOfLine(cursor, line_end));
+    }
+
+    line = line_end + 1;
+  }
+}
+
+ObjCorner parseObjCorner(std::string_view token, size_t position_index,
+                         size_t tex_coord_index, size_t normal_index,
+                         const ObjData& data) {
+  const char* cursor = token.data();
+  const char* end = token.data() + token.size();
+  ObjCorner corner = {-1, -1, -1};
+  int64_t index = 0;
+
+  if (!parseInt(cursor, end, index)) {
+    throw std::runtime_error("Malformed OBJ face");
+  }
+  corner.position =
+      resolveObjIndex(index, position_index, data.positions.size());
+
+  if (cursor < end && *cursor == '/') {
+    cursor++;
+    // v//vn has no texture coordinates
+    if (cursor < end && *cursor != '/') {
+      if (!parseInt(cursor, end, index)) {
+        throw std::runtime_error("Malformed OBJ face");
+      }
+      corner.tex_coord =
+          resolveObjIndex(index, tex_coord_index, data.tex_coords.size());
+    }
+
+    if (cursor < end && *cursor == '/') {
+      cursor++;
+      if (!parseInt(cursor, end, index)) {
+        throw std::runtime_error("Malformed OBJ face");
+      }
+      corner.normal = resolveObjIndex(index, normal_index, data.normals.size());
+    }
+  }
+
+  if (cursor != end) {
+    throw std::runtime_error("Malformed OBJ face");
+  }
+
+  return corner;
+}
+
+void parseObjChunk(const ObjChunk& chunk, ObjData& data) {
+  size_t position_index = chunk.position_offset;
+  size_t tex_coord_index = chunk.tex_coord_offset;
+  size_t normal_index = chunk.normal_offset;
+  size_t triangle_index = chunk.triangle_offset;
+  size_t material_switch_index = 0;
+  uint32_t material_index = chunk.start_material_index;
+
+  for (const char* line = chunk.begin; line < chunk.end;) {
+    const char* line_end = findLineEnd(line, chunk.end);
+    const char* cursor = line;
+    auto keyword = readToken(cursor, line_end);
+
+    if (keyword == "v") {
+      auto& position = data.positions[position_index++];
+      if (!parseFloat(cursor, line_end, position.x) ||
+          !parseFloat(cursor, line_end, position.y) ||
+          !parseFloat(cursor, line_end, position.z)) {
+        throw std::runtime_error("Malformed OBJ vertex");
+      }
+    } else if (keyword == "vt") {
+      auto& tex_coords = data.tex_coords[tex_coord_index++];
+      if (!parseFloat(cursor, line_end, tex_coords.x)) {
+        throw std::runtime_error("Malformed OBJ texture coordinates");
+      }
+      // The second coordinate is optional
+      if (!parseFloat(cursor, line_end, tex_coords.y)) {
+        tex_coords.y = 0.0f;
+      }
+    } else if (keyword == "vn") {
+      auto& normal = data.normals[normal_index++];
+      if (!parseFloat(cursor, line_end, normal.x) ||
+          !parseFloat(cursor, line_end, normal.y) ||
+          !parseFloat(cursor, line_end, normal.z)) {
+        throw std::runtime_error("Malformed OBJ normal");
+      }
+    } else if (keyword == "f") {
+      ObjCorner first_corner;
+      ObjCorner previous_corner;
+      size_t corner_count = 0;
+
+      for (auto token = readToken(cursor, line_end); !token.empty();
+           token = readToken(cursor, line_end)) {
+        auto corner = parseObjCorner(token, position_index, tex_coord_index,
+                                     normal_index, data);
+
+        if (corner_count == 0) {
+          first_corner = corner;
+        } else if (corner_count >= 2) {
+          data.corners[triangle_index * 3] = first_corner;
+          data.corners[triangle_index * 3 + 1] = previous_corner;
+          data.corners[triangle_index * 3 + 2] = corner;
+          data.triangle_materials[triangle_index] = material_index;
+          triangle_index++;
+        }
+
+        previous_corner = corner;
+        corner_count++;
+      }
+    } else if (keyword == "usemtl") {
+      material_index = chunk.material_indices[material_switch_index++];
+    }
+
+    line = line_end + 1;
+  }
+}
+
+// Splits `bytes` at line breaks into chunks of about OBJ_CHUNK_BYTES
+std::vector<ObjChunk> splitObjChunks(std::span<const char> bytes) {
+  std::vector<ObjChunk> chunks;
+  const char* end = bytes.data() + bytes.size();
+
+  for (const char* begin = bytes.data(); begin < end;) {
+    const char* chunk_end =
+        end - begin > static_cast<ptrdiff_t>(OBJ_CHUNK_BYTES)
+            ? findLineEnd(begin + OBJ_CHUNK_BYTES, end)
+            : end;
+    chunk_end = std::min(chunk_end + 1, end);
+
+    chunks.push_back({
+        .begin = begin,
+        .end = chunk_end,
+        .material_names = {},
+        .material_indices = {},
+    });
+    begin = chunk_end;
+  }
+
+  return chunks;
+}
+
+// Runs `function` on every item on the job_system workers. Exceptions are
+// caught per item and the first one is rethrown once all items are done.
+template <typename Item, typename Function>
+void forEachInParallel(std::vector<Item>& items, Function&& function) {
+  std::vector<std::exception_ptr> errors(items.size());
+
+  job_system::parallelFor(
+      0, items.size(), 1, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t i = chunk_begin; i < chunk_end; i++) {
+          try {
+            function(items[i]);
+          } catch (...) {
+            errors[i] = std::current_exception();
+          }
+        }
+      });
+
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+// Area weighted face normals, accumulated into every vertex whose normal is
+// flagged as missing
+void computeMissingNormals(GeometryComponent& geometry_component,
+                           const std::vector<bool>& is_normal_missing) {
+  std::vector<glm::vec3> normals(geometry_component.vertices.size(),
+                                 glm::vec3(0.0f));
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    glm::vec3 face_normal =
+        glm::cross(vertices[indices[i + 1]].position -
+                       vertices[indices[i]].position,
+                   vertices[indices[i + 2]].position -
+                       vertices[indices[i]].position);
+    for (size_t j = 0; j < 3; j++) {
+      normals[indices[i + j]] += face_normal;
+    }
+  }
+
+  for (size_t i = 0; i < normals.size(); i++) {
+    if (is_normal_missing[i]) {
+      float length = glm::length(normals[i]);
+      geometry_component.vertices[i].normal = packNormal(
+          length > 0.0f ? normals[i] / length : glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+  }
+}
+
+// Turns the triangles of one material into a geometry, sharing a vertex
+// between corners with the same position, texture coordinates and normal.
+// Vertices are found through a list per position: corners sharing a position
+// rarely differ in the rest, so the lists stay short, and the lookup needs far
+// less memory than a hash table over every corner.
+GeometryComponent buildObjGeometry(const ObjData& data,
+                                   std::span<const uint32_t> triangles) {
+  constexpr uint32_t NO_VERTEX = UINT32_MAX;
+
+  GeometryComponent geometry_component;
+  auto& vertices = geometry_component.vertices;
+  auto& indices = geometry_component.indices;
+  indices.reserve(triangles.size() * 3);
+
+  std::vector<uint32_t> position_vertices(data.positions.size(), NO_VERTEX);
+  // Per vertex: the corner it was made from, and the next vertex with the
+  // same position
+  std::vector<ObjCorner> vertex_corners;
+  std::vector<uint32_t> next_vertices;
+  bool has_missing_normals = false;
+
+  for (uint32_t triangle : triangles) {
+    for (size_t i = 0; i < 3; i++) {
+      const auto& corner = data.corners[static_cast<size_t>(triangle) * 3 + i];
+
+      uint32_t vertex = position_vertices[corner.position];
+      while (vertex != NO_VERTEX && vertex_corners[vertex] != corner) {
+        vertex = next_vertices[vertex];
+      }
+
+      if (vertex == NO_VERTEX) {
+        vertex = static_cast<uint32_t>(vertices.size());
+
+        glm::vec3 normal = corner.normal >= 0 ? data.normals[corner.normal]
+                                              : glm::vec3(0.0f, 1.0f, 0.0f);
+        float normal_length = glm::length(normal);
+        glm::vec2 tex_coords = corner.tex_coord >= 0
+                                   ? data.tex_coords[corner.tex_coord]
+                                   : glm::vec2(0.0f);
+
+        vertices.push_back({
+            data.positions[corner.position],
+            packNormal(normal_length > 0.0f ? normal / normal_length
+                                            : glm::vec3(0.0f, 1.0f, 0.0f)),
+            packTexCoords(tex_coords),
+        });
+        vertex_corners.push_back(corner);
+        next_vertices.push_back(position_vertices[corner.position]);
+        position_vertices[corner.position] = vertex;
+        has_missing_normals |= corner.normal < 0;
+      }
+
+      indices.push_back(vertex);
+    }
+  }
+
+  if (has_missing_normals) {
+    std::vector<bool> is_normal_missing(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+      is_normal_missing[i] = vertex_corners[i].normal < 0;
+    }
+    computeMissingNormals(geometry_component, is_normal_missing);
+  }
+
+  return geometry_component;
+}
+
+// Minimal JSON reader for the glTF chunk. Strings are views into the file and
+// keep their escapes, which names in practice do not have.
+class JsonValue {
+ public:
+  enum class Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+  Type type = Type::NUL;
+  bool boolean = false;
+  double number = 0.0;
+  std::string_view string;
+  std::vector<JsonValue> elements;
+  std::vector<std::pair<std::string_view, JsonValue>> members;
+
+  const JsonValue* find(std::string_view key) const {
+    for (const auto& [member_key, value] : members) {
+      if (member_key == key) {
+        return &value;
+      }
+    }
+    return nullptr;
+  }
+
+  const JsonValue& at(std::string_view key) const {
+    const auto* value = find(key);
+    if (!value) {
+      throw std::runtime_error("glTF is missing \"" + std::string(key) + "\"");
+    }
+    return *value;
+  }
+
+  const JsonValue& at(size_t index) const {
+    if (type != Type::ARRAY || index >= elements.size()) {
+      throw std::runtime_error("glTF index out of range");
+    }
+    return elements[index];
+  }
+
+  size_t getIndex(std::string_view key) const {
+    // Beyond 2^53, doubles no longer hold every integer
+    return getSize(key, 9007199254740992.0);
+  }
+
+  // Integer within [0, max_value] at `key`, checked before it is converted,
+  // since the values of untrusted files may not fit
+  size_t getSize(std::string_view key, double max_value) const {
+    const auto& value = at(key);
+    if (value.type != Type::NUMBER || !(value.number >= 0.0) ||
+        value.number != std::floor(value.number) ||
+        value.number > max_value) {
+      throw std::runtime_error("glTF \"" + std::string(key) +
+                               "\" is not an index");
+    }
+    return static_cast<size_t>(value.number);
+  }
+
+  double getNumber(std::string_view key, double default_value) const {
+    const auto* value = find(key);
+    return value && value->type == Type::NUMBER ? value->number
+                                                : default_value;
+  }
+};
+
+class JsonParser {
+ public:
+  JsonParser(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+  JsonValue parse() {
+    auto value = parseValue(0);
+    skipWhitespace();
+    // The JSON chunk is padded with spaces, so nothing else may follow
+    if (cursor != end) {
+      throw std::runtime_error("Malformed glTF JSON");
+    }
+    return value;
+  }
+
+ private:
+  static constexpr int MAX_DEPTH = 64;
+
+  const char* cursor;
+  const char* end;
+
+  void skipWhitespace() {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t' ||
+                            *cursor == '\n' || *cursor == '\r')) {
+      cursor++;
+    }
+  }
+
+  void expect(char c) {
+    skipWhitespace();
+    if (cursor >= end || *cursor != c) {
+      throw std::runtime_error("Malformed glTF JSON");
+    }
+    cursor++;
+  }
+
+  bool consumeSeparator() {
+    skipWhitespace();
+    if (cursor < end && *cursor == ',') {
+      cursor++;
+      return true;
+    }
+    return false;
+  }
+
+  bool consumeLiteral(std::string_view literal) {
+    if (static_cast<size_t>(end - cursor) >= literal.size() &&
+        std::string_view(cursor, literal.size()) == literal) {
+      cursor += literal.size();
+      return true;
+    }
+    return false;
+  }
+
+  std::string_view parseString() {
+    expect('"');
+    const char* string_begin = cursor;
+    while (cursor < end && *cursor != '"') {
+      cursor += *cursor == '\\' ? 2 : 1;
+    }
+    if (cursor >= end) {
+      throw std::runtime_error("Malformed glTF JSON");
+    }
+    return std::string_view(string_begin, cursor++ - string_begin);
+  }
+
+  JsonValue parseValue(int depth) {
+    if (depth > MAX_DEPTH) {
+      throw std::runtime_error("glTF JSON is nested too deeply");
+    }
+
+    skipWhitespace();
+    if (cursor >= end) {
+      throw std::runtime_error("Malformed glTF JSON");
+    }
+
+    JsonValue value;
+
+    if (*cursor == '{') {
+      value.type = JsonValue::Type::OBJECT;
+      cursor++;
+      skipWhitespace();
+      if (cursor < end && *cursor == '}') {
+        cursor++;
+        return value;
+      }
+      while (true) {
+        auto key = parseString();
+        expect(':');
+        value.members.emplace_back(key, parseValue(depth + 1));
+        if (!consumeSeparator()) {
+          break;
+        }
+      }
+      expect('}');
+    } else if (*cursor == '[') {
+      value.type = JsonValue::Type::ARRAY;
+      cursor++;
+      skipWhitespace();
+      if (cursor < end && *cursor == ']') {
+        cursor++;
+        return value;
+      }
+      while (true) {
+        value.elements.push_back(parseValue(depth + 1));
+        if (!consumeSeparator()) {
+          break;
+        }
+      }
+      expect(']');
+    } else if (*cursor == '"') {
+      value.type = JsonValue::Type::STRING;
+      value.string = parseString();
+    } else if (consumeLiteral("true")) {
+      value.type = JsonValue::Type::BOOLEAN;
+      value.boolean = true;
+    } else if (consumeLiteral("false")) {
+      value.type = JsonValue::Type::BOOLEAN;
+    } else if (consumeLiteral("null")) {
+      value.type = JsonValue::Type::NUL;
+    } else {
+      if (!parseNumber(cursor, end, value.number)) {
+        throw std::runtime_error("Malformed glTF JSON");
+      }
+      value.type = JsonValue::Type::NUMBER;
+    }
+
+    return value;
+  }
+};
+
+// Strided view of accessor data inside the binary chunk
+struct GltfAccessor {
+  const char* data;
+  size_t count;
+  size_t stride;
+  int component_type;
+  int component_count;
+  bool normalized;
+};
+
+constexpr int GLTF_UNSIGNED_BYTE = 5121;
+constexpr int GLTF_UNSIGNED_SHORT = 5123;
+constexpr int GLTF_UNSIGNED_INT = 5125;
+constexpr int GLTF_FLOAT = 5126;
+constexpr int GLTF_TRIANGLES = 4;
+
+size_t getGltfComponentSize(int component_type) {
+  switch (component_type) {
+    case 5120:
+    case GLTF_UNSIGNED_BYTE:
+      return 1;
+    case 5122:
+    case GLTF_UNSIGNED_SHORT:
+      return 2;
+    case GLTF_UNSIGNED_INT:
+    case GLTF_FLOAT:
+      return 4;
+    default:
+      throw std::runtime_error("Invalid glTF component type");
+  }
+}
+
+int getGltfComponentCount(std::string_view type) {
+  if (type == "SCALAR") {
+    return 1;
+  } else if (type == "VEC2") {
+    return 2;
+  } else if (type == "VEC3") {
+    return 3;
+  } else if (type == "VEC4") {
+    return 4;
+  }
+  throw std::runtime_error("Unsupported glTF accessor type");
+}
+
+GltfAccessor getGltfAccessor(const JsonValue& gltf, size_t accessor_index,
+                             std::span<const char> binary_chunk) {
+  const auto& accessor = gltf.at("accessors").at(accessor_index);
+  if (accessor.find("sparse") || !accessor.find("bufferView")) {
+    throw std::runtime_error("Sparse glTF accessors are not supported");
+  }
+
+  const auto& buffer_view =
+      gltf.at("bufferViews").at(accessor.getIndex("bufferView"));
+  if (buffer_view.getIndex("buffer") != 0 ||
+      gltf.at("buffers").at(0).find("uri")) {
+    throw std::runtime_error("External glTF buffers are not supported");
+  }
+
+  // Every size is at most the chunk's, so that the checks below cannot
+  // overflow
+  auto chunk_size = static_cast<double>(binary_chunk.size());
+  auto get_size = [chunk_size](const JsonValue& object, std::string_view key,
+                               size_t default_value) {
+    return object.find(key) ? object.getSize(key, chunk_size) : default_value;
+  };
+
+  GltfAccessor view = {
+      .data = nullptr,
+      .count = accessor.getSize("count", chunk_size),
+      .stride = 0,
+      .component_type = static_cast<int>(accessor.getIndex("componentType")),
+      .component_count = getGltfComponentCount(accessor.at("type").string),
+      .normalized = false,
+  };
+  const auto* normalized = accessor.find("normalized");
+  view.normalized = normalized && normalized->boolean;
+
+  size_t element_size =
+      getGltfComponentSize(view.component_type) * view.component_count;
+  view.stride = get_size(buffer_view, "byteStride", element_size);
+
+  size_t view_offset = get_size(buffer_view, "byteOffset", 0);
+  size_t view_length = buffer_view.getSize("byteLength", chunk_size);
+  size_t accessor_offset = get_size(accessor, "byteOffset", 0);
+
+  if (view_length > binary_chunk.size() - view_offset ||
+      view.stride < element_size ||
+      (view.count > 0 &&
+       (accessor_offset > view_length ||
+        element_size > view_length - accessor_offset ||
+        view.count - 1 >
+            (view_length - accessor_offset - element_size) / view.stride))) {
+    throw std::runtime_error("glTF accessor out of range");
+  }
+
+  view.data = binary_chunk.data() + view_offset + accessor_offset;
+  return view;
+}
+
+template <typename T>
+T readGltfComponent(const char* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+glm::vec3 readGltfVec3(const GltfAccessor& accessor, size_t index) {
+  if (accessor.component_type != GLTF_FLOAT || accessor.component_count != 3) {
+    throw std::runtime_error("glTF positions and normals must be float VEC3");
+  }
+  glm::vec3 value;
+  std::memcpy(&value, accessor.data + index * accessor.stride, sizeof(value));
+  return value;
+}
+
+glm::vec2 readGltfTexCoords(const GltfAccessor& accessor, size_t index) {
+  const char* data = accessor.data + index * accessor.stride;
+
+  if (accessor.component_count != 2) {
+    throw std::runtime_error("glTF texture coordinates must be VEC2");
+  }
+
+  switch (accessor.component_type) {
+    case GLTF_FLOAT:
+      return glm::vec2(readGltfComponent<float>(data),
+                       readGltfComponent<float>(data + 4));
+    case GLTF_UNSIGNED_BYTE:
+      return glm::vec2(readGltfComponent<uint8_t>(data),
+                       readGltfComponent<uint8_t>(data + 1)) /
+             255.0f;
+    case GLTF_UNSIGNED_SHORT:
+      return glm::vec2(readGltfComponent<uint16_t>(data),
+                       readGltfComponent<uint16_t>(data + 2)) /
+             65535.0f;
+    default:
+      throw std::runtime_error("Unsupported glTF texture coordinate type");
+  }
+}
+
+uint32_t readGltfIndex(const GltfAccessor& accessor, size_t index) {
+  const char* data = accessor.data + index * accessor.stride;
+
+  switch (accessor.component_type) {
+    case GLTF_UNSIGNED_BYTE:
+      return readGltfComponent<uint8_t>(data);
+    case GLTF_UNSIGNED_SHORT:
+      return readGltfComponent<uint16_t>(data);
+    case GLTF_UNSIGNED_INT:
+      return readGltfComponent<uint32_t>(data);
+    default:
+      throw std::runtime_error("Invalid glTF index type");
+  }
+}
+
+glm::mat4 getGltfNodeMatrix(const JsonValue& node) {
+  if (const auto* matrix = node.find("matrix")) {
+    glm::mat4 result;
+    for (int i = 0; i < 16; i++) {
+      glm::value_ptr(result)[i] =
+          static_cast<float>(matrix->at(static_cast<size_t>(i)).number);
+    }
+    return result;
+  }
+
+  glm::vec3 translation(0.0f);
+  glm::quat rotation(1.0f, 0.0f, 0.0f, 0.0f);
+  glm::vec3 scale(1.0f);
+
+  if (const auto* values = node.find("translation")) {
+    translation = glm::vec3(values->at(0).number, values->at(1).number,
+                            values->at(2).number);
+  }
+  // glTF stores quaternions as x, y, z, w
+  if (const auto* values = node.find("rotation")) {
+    rotation = glm::quat(values->at(3).number, values->at(0).number,
+                         values->at(1).number, values->at(2).number);
+  }
+  if (const auto* values = node.find("scale")) {
+    scale = glm::vec3(values->at(0).number, values->at(1).number,
+                      values->at(2).number);
+  }
+
+  return glm::translate(glm::mat4(1.0f), translation) *
+         glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+}
+
+std::string getGltfMaterialName(const JsonValue& gltf,
+                                int64_t material_index) {
+  if (material_index < 0) {
+    return std::string(DEFAULT_MATERIAL_NAME);
+  }
+
+  const auto& material =
+      gltf.at("materials").at(static_cast<size_t>(material_index));
+  if (const auto* name = material.find("name")) {
+    return std::string(name->string);
+  }
+  return "material_" + std::to_string(material_index);
+}
+
+constexpr uint32_t NO_GLTF_VERTEX = UINT32_MAX;
+
+// A triangle primitive placed by a node, and where it goes in its part
+struct GltfPrimitiveInstance {
+  const JsonValue* primitive;
+  glm::mat4 matrix;
+  size_t part_index;
+  size_t index_count;
+  // Part vertex of every accessor vertex, NO_GLTF_VERTEX for vertices the
+  // primitive does not use. Primitives often share one vertex accessor.
+  std::vector<uint32_t> vertex_remap;
+  size_t vertex_count = 0;
+  size_t vertex_offset = 0;
+  size_t index_offset = 0;
+};
+
+void collectGltfNode(const JsonValue& gltf, size_t node_index,
+                     const glm::mat4& parent_matrix, int depth,
+                     std::vector<std::pair<size_t, glm::mat4>>& meshes) {
+  if (depth > 64) {
+    throw std::runtime_error("glTF node hierarchy is too deep");
+  }
+
+  const auto& node = gltf.at("nodes").at(node_index);
+  glm::mat4 matrix = parent_matrix * getGltfNodeMatrix(node);
+
+  if (node.find("mesh")) {
+    meshes.emplace_back(node.getIndex("mesh"), matrix);
+  }
+
+  if (const auto* children = node.find("children")) {
+    for (const auto& child : children->elements) {
+      collectGltfNode(gltf, static_cast<size_t>(child.number), matrix,
+                      depth + 1, meshes);
+    }
+  }
+}
+
+// Meshes with the node matrices placing them. Files without scenes list
+// every mesh once, untransformed.
+std::vector<std::pair<size_t, glm::mat4>> collectGltfMeshes(
+    const JsonValue& gltf) {
+  std::vector<std::pair<size_t, glm::mat4>> meshes;
+  const auto* scenes = gltf.find("scenes");
+
+  if (!scenes || scenes->elements.empty()) {
+    const auto* gltf_meshes = gltf.find("meshes");
+    for (size_t i = 0; gltf_meshes && i < gltf_meshes->elements.size(); i++) {
+      meshes.emplace_back(i, glm::mat4(1.0f));
+    }
+    return meshes;
+  }
+
+  const auto& scene =
+      scenes->at(static_cast<size_t>(gltf.getNumber("scene", 0.0)));
+  if (const auto* nodes = scene.find("nodes")) {
+    for (const auto& node : nodes->elements) {
+      collectGltfNode(gltf, static_cast<size_t>(node.number), glm::mat4(1.0f),
+                      0, meshes);
+    }
+  }
+
+  return meshes;
+}
+
+std::optional<GltfAccessor> findGltfIndexAccessor(
+    const JsonValue& gltf, std::span<const char> binary_chunk,
+    const JsonValue& primitive) {
+  if (!primitive.find("indices")) {
+    return std::nullopt;
+  }
+  return getGltfAccessor(gltf, primitive.getIndex("indices"), binary_chunk);
+}
+
+// Numbers the vertices the primitive uses, in accessor order, so that only
+// those are copied into its part
+void mapGltfPrimitiveVertices(const JsonValue& gltf,
+                              std::span<const char> binary_chunk,
+                              GltfPrimitiveInstance& instance) {
+  auto positions = getGltfAccessor(
+      gltf, instance.primitive->at("attributes").getIndex("POSITION"),
+      binary_chunk);
+  auto index_accessor =
+      findGltfIndexAccessor(gltf, binary_chunk, *instance.primitive);
+
+  if (!index_accessor) {
+    instance.vertex_remap.resize(instance.index_count);
+    for (size_t i = 0; i < instance.index_count; i++) {
+      instance.vertex_remap[i] = static_cast<uint32_t>(i);
+    }
+    instance.vertex_count = instance.index_count;
+    return;
+  }
+
+  instance.vertex_remap.assign(positions.count, NO_GLTF_VERTEX);
+  for (size_t i = 0; i < instance.index_count; i++) {
+    uint32_t index = readGltfIndex(*index_accessor, i);
+    if (index >= positions.count) {
+      throw std::runtime_error("glTF index out of range");
+    }
+    instance.vertex_remap[index] = 0;
+  }
+
+  for (auto& vertex : instance.vertex_remap) {
+    if (vertex != NO_GLTF_VERTEX) {
+      vertex = static_cast<uint32_t>(instance.vertex_count++);
+    }
+  }
+}
+
+void convertGltfPrimitive(const JsonValue& gltf,
+                          std::span<const char> binary_chunk,
+                          const GltfPrimitiveInstance& instance,
+                          GeometryComponent& geometry_component) {
+  const auto& attributes = instance.primitive->at("attributes");
+  auto positions =
+      getGltfAccessor(gltf, attributes.getIndex("POSITION"), binary_chunk);
+
+  std::optional<GltfAccessor> normals;
+  if (attributes.find("NORMAL")) {
+    normals =
+        getGltfAccessor(gltf, attributes.getIndex("NORMAL"), binary_chunk);
+  }
+  std::optional<GltfAccessor> tex_coords;
+  if (attributes.find("TEXCOORD_0")) {
+    tex_coords =
+        getGltfAccessor(gltf, attributes.getIndex("TEXCOORD_0"), binary_chunk);
+  }
+
+  glm::mat3 normal_matrix =
+      glm::transpose(glm::inverse(glm::mat3(instance.matrix)));
+  // Mirroring nodes flip the winding, which is undone to keep faces front
+  // facing
+  bool is_mirrored = glm::determinant(glm::mat3(instance.matrix)) < 0.0f;
+
+  auto* vertices = geometry_component.vertices.data() + instance.vertex_offset;
+  for (size_t i = 0; i < instance.vertex_remap.size(); i++) {
+    uint32_t vertex = instance.vertex_remap[i];
+    if (vertex == NO_GLTF_VERTEX) {
+      continue;
+    }
+
+    glm::vec3 normal = normals && i < normals->count
+                           ? normal_matrix * readGltfVec3(*normals, i)
+                           : glm::vec3(0.0f, 1.0f, 0.0f);
+    float normal_length = glm::length(normal);
+
+    vertices[vertex] = {
+        glm::vec3(instance.matrix *
+                  glm::vec4(readGltfVec3(positions, i), 1.0f)),
+        packNormal(normal_length > 0.0f ? normal / normal_length
+                                        : glm::vec3(0.0f, 1.0f, 0.0f)),
+        packTexCoords(tex_coords && i < tex_coords->count
+                          ? readGltfTexCoords(*tex_coords, i)
+                          : glm::vec2(0.0f)),
+    };
+  }
+
+  auto* indices = geometry_component.indices.data() + instance.index_offset;
+  auto index_accessor =
+      findGltfIndexAccessor(gltf, binary_chunk, *instance.primitive);
+
+  for (size_t i = 0; i < instance.index_count; i++) {
+    size_t corner = is_mirrored ? i - i % 3 + 2 - i % 3 : i;
+    uint32_t index = index_accessor ? readGltfIndex(*index_accessor, corner)
+                                    : static_cast<uint32_t>(corner);
+    indices[i] = static_cast<uint32_t>(instance.vertex_offset) +
+                 instance.vertex_remap[index];
+  }
+
+  if (!normals) {
+    // Smooths within the primitive only, so that primitives sharing a part
+    // keep their own normals
+    GeometryComponent primitive_geometry;
+    primitive_geometry.vertices.assign(vertices,
+                                       vertices + instance.vertex_count);
+    primitive_geometry.indices.assign(indices, indices + instance.index_count);
+    for (auto& index : primitive_geometry.indices) {
+      index -= static_cast<uint32_t>(instance.vertex_offset);
+    }
+
+    computeMissingNormals(primitive_geometry,
+                          std::vector<bool>(instance.vertex_count, true));
+    std::copy(primitive_geometry.vertices.begin(),
+              primitive_geometry.vertices.end(), vertices);
+  }
+}
+
+}  // namespace
+
+MeshFormat getMeshFormat(std::string_view file_name) {
+  auto extension_begin = file_name.rfind('.');
+  std::string extension(extension_begin == std::string_view::npos
+                            ? std::string_view()
+                            : file_name.substr(extension_begin + 1));
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+
+  if (extension == "obj") {
+    return MeshFormat::OBJ;
+  } else if (extension == "glb") {
+    return MeshFormat::GLB;
+  }
+
+  throw std::runtime_error("Unsupported mesh file: " + std::string(file_name));
+}
+
+std::vector<ImportedPart> importObj(std::span<const char> bytes) {
+  auto chunks = splitObjChunks(bytes);
+
+  forEachInParallel(chunks, countObjChunk);
+
+  // Offsets of each chunk into the arrays of the whole file, and the material
+  // each chunk starts with
+  std::vector<std::string_view> material_names = {DEFAULT_MATERIAL_NAME};
+  std::unordered_map<std::string_view, uint32_t> material_indices = {
+      {DEFAULT_MATERIAL_NAME, 0}};
+  ObjChunk totals = {};
+  uint32_t material_index = 0;
+
+  for (auto& chunk : chunks) {
+    chunk.position_offset = totals.position_count;
+    chunk.tex_coord_offset = totals.tex_coord_count;
+    chunk.normal_offset = totals.normal_count;
+    chunk.triangle_offset = totals.triangle_count;
+    chunk.start_material_index = material_index;
+
+    totals.position_count += chunk.position_count;
+    totals.tex_coord_count += chunk.tex_coord_count;
+    totals.normal_count += chunk.normal_count;
+    totals.triangle_count += chunk.triangle_count;
+
+    for (auto name : chunk.material_names) {
+      auto [it, is_new] = material_indices.try_emplace(
+          name, static_cast<uint32_t>(material_names.size()));
+      if (is_new) {
+        material_names.push_back(name);
+      }
+      material_index = it->second;
+      chunk.material_indices.push_back(material_index);
+    }
+  }
+
+  if (totals.triangle_count == 0) {
+    throw std::runtime_error("OBJ has no faces");
+  }
+  if (totals.triangle_count > UINT32_MAX / 3) {
+    throw std::runtime_error("OBJ has too many faces");
+  }
+
+  ObjData data;
+  data.positions.resize(totals.position_count);
+  data.tex_coords.resize(totals.tex_coord_count);
+  data.normals.resize(totals.normal_count);
+  data.corners.resize(totals.triangle_count * 3);
+  data.triangle_materials.resize(totals.triangle_count);
+
+  forEachInParallel(
+      chunks, [&data](const ObjChunk& chunk) { parseObjChunk(chunk, data); });
+
+  // Sorts triangles by material with a counting sort, keeping file order
+  std::vector<size_t> material_offsets(material_names.size() + 1, 0);
+  for (uint32_t triangle_material : data.triangle_materials) {
+    material_offsets[triangle_material + 1]++;
+  }
+  for (size_t i = 1; i < material_offsets.size(); i++) {
+    material_offsets[i] += material_offsets[i - 1];
+  }
+
+  std::vector<uint32_t> sorted_triangles(totals.triangle_count);
+  {
+    auto next_offsets = material_offsets;
+    for (size_t i = 0; i < data.triangle_materials.size(); i++) {
+      sorted_triangles[next_offsets[data.triangle_materials[i]]++] =
+          static_cast<uint32_t>(i);
+    }
+  }
+  // Only the corners are needed from here on
+  data.triangle_materials = std::vector<uint32_t>();
+
+  std::vector<ImportedPart> parts;
+  std::vector<std::span<const uint32_t>> part_triangles;
+  for (size_t i = 0; i < material_names.size(); i++) {
+    if (material_offsets[i + 1] > material_offsets[i]) {
+      parts.push_back({
+          .material_name = std::string(material_names[i]),
+          .geometry_component = GeometryComponent(),
+      });
+      part_triangles.push_back(
+          std::span<const uint32_t>(sorted_triangles)
+              .subspan(material_offsets[i],
+                       material_offsets[i + 1] - material_offsets[i]));
+    }
+  }
+
+  forEachInParallel(parts, [&](ImportedPart& part) {
+    part.geometry_component =
+        buildObjGeometry(data, part_triangles[&part - parts.data()]);
+  });
+
+  return parts;
+}
+
+std::vector<ImportedPart> importGlb(std::span<const char> bytes) {
+  constexpr uint32_t GLB_MAGIC = 0x46546C67;       // "glTF"
+  constexpr uint32_t JSON_CHUNK_TYPE = 0x4E4F534A;  // "JSON"
+  constexpr uint32_t BINARY_CHUNK_TYPE = 0x004E4942;  // "BIN\0"
+
+  if (bytes.size() < 20 ||
+      readGltfComponent<uint32_t>(bytes.data()) != GLB_MAGIC ||
+      readGltfComponent<uint32_t>(bytes.data() + 4) != 2) {
+    throw std::runtime_error("Not a glTF 2.0 binary file");
+  }
+
+  std::span<const char> json_chunk;
+  std::span<const char> binary_chunk;
+  size_t length = std::min<size_t>(
+      readGltfComponent<uint32_t>(bytes.data() + 8), bytes.size());
+
+  for (size_t offset = 12; offset + 8 <= length;) {
+    size_t chunk_length = readGltfComponent<uint32_t>(bytes.data() + offset);
+    uint32_t chunk_type =
+        readGltfComponent<uint32_t>(bytes.data() + offset + 4);
+    if (offset + 8 + chunk_length > length) {
+      throw std::runtime_error("Truncated glTF chunk");
+    }
+
+    auto chunk = bytes.subspan(offset + 8, chunk_length);
+    if (chunk_type == JSON_CHUNK_TYPE && json_chunk.empty()) {
+      json_chunk = chunk;
+    } else if (chunk_type == BINARY_CHUNK_TYPE && binary_chunk.empty()) {
+      binary_chunk = chunk;
+    }
+
+    offset += 8 + chunk_length;
+  }
+
+  if (json_chunk.empty()) {
+    throw std::runtime_error("glTF has no JSON chunk");
+  }
+
+  auto gltf =
+      JsonParser(json_chunk.data(), json_chunk.data() + json_chunk.size())
+          .parse();
+
+  std::vector<ImportedPart> parts;
+  std::unordered_map<int64_t, size_t> part_indices;
+  std::vector<GltfPrimitiveInstance> instances;
+
+  for (const auto& [mesh_index, matrix] : collectGltfMeshes(gltf)) {
+    for (const auto& primitive :
+         gltf.at("meshes").at(mesh_index).at("primitives").elements) {
+      if (primitive.getNumber("mode", GLTF_TRIANGLES) != GLTF_TRIANGLES) {
+        continue;
+      }
+
+      auto index_accessor =
+          findGltfIndexAccessor(gltf, binary_chunk, primitive);
+      size_t index_count =
+          index_accessor
+              ? index_accessor->count
+              : getGltfAccessor(gltf,
+                                primitive.at("attributes").getIndex("POSITION"),
+                                binary_chunk)
+                    .count;
+
+      auto material_index =
+          static_cast<int64_t>(primitive.getNumber("material", -1.0));
+      auto [it, is_new] =
+          part_indices.try_emplace(material_index, parts.size());
+      if (is_new) {
+        parts.push_back({
+            .material_name = getGltfMaterialName(gltf, material_index),
+            .geometry_component = GeometryComponent(),
+        });
+      }
+
+      instances.push_back({
+          .primitive = &primitive,
+          .matrix = matrix,
+          .part_index = it->second,
+          .index_count = index_count - index_count % 3,
+          .vertex_remap = {},
+      });
+    }
+  }
+
+  if (instances.empty()) {
+    throw std::runtime_error("glTF has no triangle primitives");
+  }
+
+  forEachInParallel(instances, [&](GltfPrimitiveInstance& instance) {
+    mapGltfPrimitiveVertices(gltf, binary_chunk, instance);
+  });
+
+  // Lays out every primitive in its material's part, so that primitives can
+  // then be converted independently
+  for (auto& instance : instances) {
+    auto& geometry_component = parts[instance.part_index].geometry_component;
+    instance.vertex_offset = geometry_component.vertices.size();
+    instance.index_offset = geometry_component.indices.size();
+
+    geometry_component.vertices.resize(instance.vertex_offset +
+                                       instance.vertex_count);
+    geometry_component.indices.resize(instance.index_offset +
+                                      instance.index_count);
+  }
+
+  forEachInParallel(instances, [&](const GltfPrimitiveInstance& instance) {
+    convertGltfPrimitive(gltf, binary_chunk, instance,
+                         parts[instance.part_index].geometry_component);
+  });
+
+  return parts;
+}
+
+std::vector<ImportedPart> importMesh(std::span<const char> bytes,
+                                     MeshFormat format) {
+  if (format == MeshFormat::OBJ) {
+    return importObj(bytes);
+  } else if (format == MeshFormat::GLB) {
+    return importGlb(bytes);
+  }
+
+  throw std::invalid_argument("Invalid mesh format");
+}
+
+}  // namespace mesh_import
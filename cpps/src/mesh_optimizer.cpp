@@ -0,0 +1,400 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "./MeshletSet.h"
+#include "./job_system.h"
+
+namespace mesh_optimizer {
+
+namespace {
+
+// Slots of the table numbering the vertices of a meshlet, at most half full
+constexpr size_t LOCAL_VERTEX_SLOTS = 1024;
+static_assert(LOCAL_VERTEX_SLOTS >= MESHLET_TRIANGLE_COUNT * 3 * 2);
+constexpr uint32_t NO_VERTEX = UINT32_MAX;
+
+// Meshlets are sorted by how far out they face in steps of this fraction of
+// the mesh radius, so that meshlets within a step keep their spatial order
+// and the brush still selects them in few ranges
+constexpr float OVERDRAW_KEY_STEP = 0.25f;
+
+// Scratch memory of one worker, reused across the meshlets it reorders
+struct MeshletScratch {
+  std::array<std::pair<unsigned int, uint32_t>, LOCAL_VERTEX_SLOTS> slots;
+  // Local vertex of every corner, and global vertex of every local vertex
+  std::vector<uint32_t> corners;
+  std::vector<unsigned int> vertices;
+  std::vector<uint32_t> vertex_offsets;
+  std::vector<uint32_t> vertex_triangles;
+  std::vector<uint32_t> live_counts;
+  std::vector<uint32_t> cache_times;
+  std::vector<uint8_t> is_emitted;
+  std::vector<uint32_t> dead_ends;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> order;
+  std::vector<uint32_t> cluster_begins;
+  std::vector<std::pair<float, uint32_t>> cluster_keys;
+  std::vector<glm::vec3> normals;
+};
+
+// Numbers the vertices of `triangle_count` triangles from 0 in order of first
+// use, into `scratch.corners` and `scratch.vertices`
+void mapLocalVertices(const unsigned int* indices, size_t triangle_count,
+                      MeshletScratch& scratch) {
+  scratch.slots.fill({0, NO_VERTEX});
+  scratch.vertices.clear();
+  scratch.corners.resize(triangle_count * 3);
+
+  for (size_t i = 0; i < triangle_count * 3; i++) {
+    size_t slot = (indices[i] * 2654435761u) & (LOCAL_VERTEX_SLOTS - 1);
+    while (scratch.slots[slot].second != NO_VERTEX &&
+           scratch.slots[slot].first != indices[i]) {
+      slot = (slot + 1) & (LOCAL_VERTEX_SLOTS - 1);
+    }
+    if (scratch.slots[slot].second == NO_VERTEX) {
+      scratch.slots[slot] = {indices[i],
+                             static_cast<uint32_t>(scratch.vertices.size())};
+      scratch.vertices.push_back(indices[i]);
+    }
+    scratch.corners[i] = scratch.slots[slot].second;
+  }
+}
+
+// Tipsify over local vertices: fans around the vertex whose triangles are
+// most likely to still hit the cache, and when none is left, restarts from
+// the most recently used vertex with triangles left. Writes the triangle
+// order to `scratch.order`.
+void orderForVertexCache(size_t triangle_count, MeshletScratch& scratch) {
+  const auto& corners = scratch.corners;
+  size_t vertex_count = scratch.vertices.size();
+  uint32_t cache_size = static_cast<uint32_t>(VERTEX_CACHE_SIZE);
+
+  auto& vertex_offsets = scratch.vertex_offsets;
+  vertex_offsets.assign(vertex_count + 1, 0);
+  for (auto corner : corners) {
+    vertex_offsets[corner + 1]++;
+  }
+  for (size_t i = 1; i <= vertex_count; i++) {
+    vertex_offsets[i] += vertex_offsets[i - 1];
+  }
+
+  // Triangles left around each vertex, which first serve as cursors to list
+  // the triangles around each vertex
+  auto& live_counts = scratch.live_counts;
+  live_counts.assign(vertex_offsets.begin(), vertex_offsets.end() - 1);
+  auto& vertex_triangles = scratch.vertex_triangles;
+  vertex_triangles.resize(corners.size());
+  for (size_t i = 0; i < corners.size(); i++) {
+    vertex_triangles[live_counts[corners[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+  for (size_t i = 0; i < vertex_count; i++) {
+    live_counts[i] = vertex_offsets[i + 1] - vertex_offsets[i];
+  }
+
+  // A vertex is cached while fewer than `cache_size` misses followed its own
+  auto& cache_times = scratch.cache_times;
+  cache_times.assign(vertex_count, 0);
+  uint32_t time = cache_size + 1;
+  scratch.is_emitted.assign(triangle_count, false);
+  scratch.dead_ends.clear();
+  scratch.order.clear();
+
+  uint32_t next_vertex = 0;
+  int64_t fan_vertex = 0;
+  while (fan_vertex >= 0) {
+    scratch.candidates.clear();
+    for (uint32_t i = vertex_offsets[fan_vertex];
+         i < vertex_offsets[fan_vertex + 1]; i++) {
+      uint32_t triangle = vertex_triangles[i];
+      if (scratch.is_emitted[triangle]) {
+        continue;
+      }
+      scratch.is_emitted[triangle] = true;
+      scratch.order.push_back(triangle);
+
+      for (int corner = 0; corner < 3; corner++) {
+        uint32_t vertex = corners[triangle * 3 + corner];
+        scratch.dead_ends.push_back(vertex);
+        scratch.candidates.push_back(vertex);
+        live_counts[vertex]--;
+        if (time - cache_times[vertex] > cache_size) {
+          cache_times[vertex] = time;
+          time++;
+        }
+      }
+    }
+
+    // Prefers the oldest cached vertex whose remaining triangles still fit
+    // in the cache before it is evicted
+    fan_vertex = -1;
+    int64_t best_priority = -1;
+    for (auto vertex : scratch.candidates) {
+      if (live_counts[vertex] == 0) {
+        continue;
+      }
+      int64_t priority = 0;
+      if (time - cache_times[vertex] + 2 * live_counts[vertex] <= cache_size) {
+        priority = time - cache_times[vertex];
+      }
+      if (priority > best_priority) {
+        best_priority = priority;
+        fan_vertex = vertex;
+      }
+    }
+
+    while (fan_vertex < 0 && !scratch.dead_ends.empty()) {
+      uint32_t vertex = scratch.dead_ends.back();
+      scratch.dead_ends.pop_back();
+      if (live_counts[vertex] > 0) {
+        fan_vertex = vertex;
+      }
+    }
+    while (fan_vertex < 0 && next_vertex < vertex_count) {
+      if (live_counts[next_vertex] > 0) {
+        fan_vertex = next_vertex;
+      }
+      next_vertex++;
+    }
+  }
+}
+
+// How far out the triangles face: the distance from `mesh_center` to their
+// center along their average normal. Meshes drawn with the depth test shade
+// fewer fragments when triangles facing out, which tend to cover the others,
+// are drawn first.
+float getOverdrawKey(std::span<const uint32_t> triangles,
+                     const std::vector<Vertex>& vertices,
+                     const MeshletScratch& scratch,
+                     const glm::vec3& mesh_center) {
+  glm::vec3 center_sum(0.0f);
+  glm::vec3 normal_sum(0.0f);
+  for (auto triangle : triangles) {
+    for (int corner = 0; corner < 3; corner++) {
+      uint32_t vertex = scratch.corners[triangle * 3 + corner];
+      center_sum += vertices[scratch.vertices[vertex]].position;
+      normal_sum += scratch.normals[vertex];
+    }
+  }
+
+  float normal_length = glm::length(normal_sum);
+  if (normal_length == 0.0f) {
+    return 0.0f;
+  }
+  glm::vec3 center = center_sum / (3.0f * triangles.size());
+  return glm::dot(center - mesh_center, normal_sum / normal_length);
+}
+
+// Cuts `scratch.order` where a triangle misses the cache with all of its
+// vertices, where reordering the pieces costs little more than what the
+// cache already lost, and sorts the pieces by decreasing overdraw key.
+// Returns the overdraw key of the whole meshlet.
+float orderForOverdraw(const std::vector<Vertex>& vertices,
+                       const glm::vec3& mesh_center,
+                       MeshletScratch& scratch) {
+  const auto& corners = scratch.corners;
+  auto& order = scratch.order;
+  uint32_t cache_size = static_cast<uint32_t>(VERTEX_CACHE_SIZE);
+
+  auto& cache_times = scratch.cache_times;
+  cache_times.assign(scratch.vertices.size(), 0);
+  uint32_t time = cache_size + 1;
+
+  scratch.cluster_begins.clear();
+  for (size_t i = 0; i < order.size(); i++) {
+    int miss_count = 0;
+    for (int corner = 0; corner < 3; corner++) {
+      uint32_t vertex = corners[order[i] * 3 + corner];
+      if (time - cache_times[vertex] > cache_size) {
+        cache_times[vertex] = time;
+        time++;
+        miss_count++;
+      }
+    }
+    if (miss_count == 3 || i == 0) {
+      scratch.cluster_begins.push_back(static_cast<uint32_t>(i));
+    }
+  }
+  size_t cluster_count = scratch.cluster_begins.size();
+  scratch.cluster_begins.push_back(static_cast<uint32_t>(order.size()));
+
+  scratch.normals.resize(scratch.vertices.size());
+  for (size_t i = 0; i < scratch.vertices.size(); i++) {
+    scratch.normals[i] = unpackNormal(vertices[scratch.vertices[i]].normal);
+  }
+  float meshlet_key = getOverdrawKey(order, vertices, scratch, mesh_center);
+  if (cluster_count < 2) {
+    return meshlet_key;
+  }
+
+  scratch.cluster_keys.resize(cluster_count);
+  for (size_t cluster = 0; cluster < cluster_count; cluster++) {
+    auto triangles = std::span<const uint32_t>(order).subspan(
+        scratch.cluster_begins[cluster],
+        scratch.cluster_begins[cluster + 1] - scratch.cluster_begins[cluster]);
+    scratch.cluster_keys[cluster] = {
+        -getOverdrawKey(triangles, vertices, scratch, mesh_center),
+        static_cast<uint32_t>(cluster)};
+  }
+  std::stable_sort(
+      scratch.cluster_keys.begin(), scratch.cluster_keys.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  // Pieces go through `candidates`, which is free by now
+  auto& sorted_order = scratch.candidates;
+  sorted_order.clear();
+  for (const auto& [key, cluster] : scratch.cluster_keys) {
+    sorted_order.insert(sorted_order.end(),
+                        order.begin() + scratch.cluster_begins[cluster],
+                        order.begin() + scratch.cluster_begins[cluster + 1]);
+  }
+  order.swap(sorted_order);
+
+  return meshlet_key;
+}
+
+// Renumbers the vertices in the order the indices first use them
+void remapVertexFetch(GeometryComponent& geometry_component) {
+  auto& vertices = geometry_component.vertices;
+  auto& indices = geometry_component.indices;
+
+  constexpr auto unused = std::numeric_limits<unsigned int>::max();
+  std::vector<unsigned int> remap(vertices.size(), unused);
+  std::vector<Vertex> remapped_vertices;
+  remapped_vertices.reserve(vertices.size());
+
+  for (auto& index : indices) {
+    if (remap[index] == unused) {
+      remap[index] = static_cast<unsigned int>(remapped_vertices.size());
+      remapped_vertices.push_back(vertices[index]);
+    }
+    index = remap[index];
+  }
+
+  vertices = std::move(remapped_vertices);
+}
+
+}  // namespace
+
+float getAcmr(const GeometryView& geometry_view, size_t cache_size) {
+  size_t triangle_count = geometry_view.index_count / 3;
+  if (triangle_count == 0) {
+    return 0.0f;
+  }
+
+  std::vector<size_t> cache_times(geometry_view.vertices.size(), 0);
+  size_t time = cache_size + 1;
+  size_t miss_count = 0;
+  for (size_t i = 0; i < triangle_count * 3; i++) {
+    uint32_t vertex = geometry_view.getIndex(i);
+    if (time - cache_times[vertex] > cache_size) {
+      cache_times[vertex] = time;
+      time++;
+      miss_count++;
+    }
+  }
+
+  return static_cast<float>(miss_count) / triangle_count;
+}
+
+MeshOptimizerStats optimizeMesh(GeometryComponent& geometry_component) {
+  MeshOptimizerStats stats = {
+      .acmr_before = getAcmr(geometry_component),
+      .acmr_after = 0.0f,
+      .vertex_count_before = geometry_component.vertices.size(),
+      .vertex_count_after = 0,
+  };
+
+  clusterTriangles(geometry_component);
+
+  const auto& vertices = geometry_component.vertices;
+  auto& indices = geometry_component.indices;
+  size_t triangle_count = indices.size() / 3;
+  size_t meshlet_count =
+      (triangle_count + MESHLET_TRIANGLE_COUNT - 1) / MESHLET_TRIANGLE_COUNT;
+  auto bounds = getBoundingSphere(geometry_component);
+
+  std::vector<unsigned int> meshlet_indices(indices.size());
+  std::vector<std::pair<float, uint32_t>> meshlet_keys(meshlet_count);
+  job_system::parallelFor(
+      0, meshlet_count, 16, [&](size_t chunk_begin, size_t chunk_end) {
+        MeshletScratch scratch;
+        for (size_t meshlet = chunk_begin; meshlet < chunk_end; meshlet++) {
+          size_t first_index = meshlet * MESHLET_TRIANGLE_COUNT * 3;
+          size_t meshlet_triangle_count = std::min(
+              MESHLET_TRIANGLE_COUNT, triangle_count - first_index / 3);
+          const unsigned int* source = indices.data() + first_index;
+
+          mapLocalVertices(source, meshlet_triangle_count, scratch);
+          orderForVertexCache(meshlet_triangle_count, scratch);
+          float key = orderForOverdraw(vertices, bounds.center, scratch);
+
+          for (size_t i = 0; i < meshlet_triangle_count; i++) {
+            std::copy_n(source + scratch.order[i] * 3, 3,
+                        meshlet_indices.begin() + first_index + i * 3);
+          }
+          float key_step = OVERDRAW_KEY_STEP * bounds.radius;
+          meshlet_keys[meshlet] = {
+              key_step > 0.0f ? -std::floor(key / key_step) : 0.0f,
+              static_cast<uint32_t>(meshlet)};
+        }
+      });
+
+  // Meshlets are runs of MESHLET_TRIANGLE_COUNT triangles, so a shorter last
+  // meshlet stays last
+  size_t sorted_count =
+      triangle_count % MESHLET_TRIANGLE_COUNT == 0 ? meshlet_count
+                                                   : meshlet_count - 1;
+  std::stable_sort(
+      meshlet_keys.begin(), meshlet_keys.begin() + sorted_count,
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  auto index_it = indices.begin();
+  for (const auto& [key, meshlet] : meshlet_keys) {
+    size_t first_index = meshlet * MESHLET_TRIANGLE_COUNT * 3;
+    size_t index_count =
+        std::min(MESHLET_TRIANGLE_COUNT * 3, triangle_count * 3 - first_index);
+    index_it = std::copy_n(meshlet_indices.begin() + first_index, index_count,
+                           index_it);
+  }
+
+  remapVertexFetch(geometry_component);
+
+  stats.acmr_after = getAcmr(geometry_component);
+  stats.vertex_count_after = geometry_component.vertices.size();
+
+  return stats;
+}
+
+}  // namespace mesh_optimizer
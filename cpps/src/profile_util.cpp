@@ -0,0 +1,58 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./profile_util.h"
+
+#include <GLES3/gl3.h>
+#include <emscripten.h>
+
+ProfileScope::ProfileScope(
+    std::reference_wrapper<ProfileComponent> profile_component,
+    const char* name)
+    : profile_component(profile_component),
+      name(name),
+      is_recording(profile_component.get().is_enabled),
+      start_ms(0.0) {
+  if (!is_recording) {
+    return;
+  }
+
+  if (profile_component.get().sync_gpu) {
+    glFinish();
+  }
+
+  start_ms = emscripten_get_now();
+}
+
+ProfileScope::~ProfileScope() {
+  if (!is_recording) {
+    return;
+  }
+
+  if (profile_component.get().sync_gpu) {
+    glFinish();
+  }
+
+  profile_component.get().record(name, emscripten_get_now() - start_ms);
+}
@@ -26,14 +26,17 @@
 
 #include <GLES3/gl3.h>
 
-void drawGrComponents(
+#include <cstdint>
+#include <cstdio>
+
+unsigned int bindGrComponents(
     ShaderType shader_type,
     std::reference_wrapper<GrShaderManagerComponent>
         gr_shader_manager_component,
     std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
-    const std::vector<std::reference_wrapper<GrUniformComponent>>&
+    std::span<const std::reference_wrapper<GrUniformComponent>>
         gr_uniform_components,
-    const std::vector<std::reference_wrapper<GrTextureComponent>>&
+    std::span<const std::reference_wrapper<GrTextureComponent>>
         gr_texture_components) {
   GLuint shader_program_id =
       gr_shader_manager_component.get().getShaderProgramId(shader_type);
@@ -64,6 +67,131 @@ void drawGrComponents(
     texture_unit++;
   }
 
+  return shader_program_id;
+}
+
+void drawGrComponents(
+    ShaderType shader_type,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
+    std::span<const std::reference_wrapper<GrUniformComponent>>
+        gr_uniform_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_texture_components) {
+  bindGrComponents(shader_type, gr_shader_manager_component,
+                   gr_geometry_component, gr_uniform_components,
+                   gr_texture_components);
+
   glDrawElements(GL_TRIANGLES, gr_geometry_component.get().vertex_count,
-                 GL_UNSIGNED_INT, 0);
+                 gr_geometry_component.get().index_type, 0);
+}
+
+// Binds the instance textures on top of bindGrComponents
+void bindGrComponentsInstanced(
+    ShaderType shader_type,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
+    std::span<const std::reference_wrapper<GrUniformComponent>>
+        gr_uniform_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_texture_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_instance_texture_components) {
+  GLuint shader_program_id = bindGrComponents(
+      shader_type, gr_shader_manager_component, gr_geometry_component,
+      gr_uniform_components, gr_texture_components);
+
+  int texture_unit = gr_texture_components.size();
+  for (size_t i = 0; i < gr_instance_texture_components.size(); i++) {
+    const auto& gr_texture_component = gr_instance_texture_components[i];
+    char uniform_name[128];
+    snprintf(uniform_name, sizeof(uniform_name), "%s[%zu]",
+             gr_texture_component.get().name.c_str(), i);
+
+    glUniform1i(glGetUniformLocation(shader_program_id, uniform_name),
+                texture_unit);
+    glActiveTexture(GL_TEXTURE0 + texture_unit);
+    glBindTexture(GL_TEXTURE_2D, gr_texture_component.get().texture_id);
+    texture_unit++;
+  }
+}
+
+// Offset of the first index of `range` in the index buffer
+const void* getIndexOffset(const GrGeometryComponent& gr_geometry_component,
+                           const MeshletRange& range) {
+  size_t index_size =
+      gr_geometry_component.index_type == GL_UNSIGNED_SHORT ? 2 : 4;
+  return reinterpret_cast<const void*>(
+      static_cast<uintptr_t>(range.first_index * index_size));
+}
+
+void drawGrComponentsInstanced(
+    ShaderType shader_type,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
+    std::span<const std::reference_wrapper<GrUniformComponent>>
+        gr_uniform_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_texture_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_instance_texture_components,
+    int instance_count) {
+  bindGrComponentsInstanced(shader_type, gr_shader_manager_component,
+                            gr_geometry_component, gr_uniform_components,
+                            gr_texture_components,
+                            gr_instance_texture_components);
+
+  glDrawElementsInstanced(GL_TRIANGLES,
+                          gr_geometry_component.get().vertex_count,
+                          gr_geometry_component.get().index_type, 0,
+                          instance_count);
+}
+
+void drawGrComponentRanges(
+    ShaderType shader_type,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
+    std::span<const std::reference_wrapper<GrUniformComponent>>
+        gr_uniform_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_texture_components,
+    std::span<const MeshletRange> index_ranges) {
+  bindGrComponents(shader_type, gr_shader_manager_component,
+                   gr_geometry_component, gr_uniform_components,
+                   gr_texture_components);
+
+  for (const auto& range : index_ranges) {
+    glDrawElements(GL_TRIANGLES, range.index_count,
+                   gr_geometry_component.get().index_type,
+                   getIndexOffset(gr_geometry_component, range));
+  }
+}
+
+void drawGrComponentRangesInstanced(
+    ShaderType shader_type,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrGeometryComponent> gr_geometry_component,
+    std::span<const std::reference_wrapper<GrUniformComponent>>
+        gr_uniform_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_texture_components,
+    std::span<const std::reference_wrapper<GrTextureComponent>>
+        gr_instance_texture_components,
+    int instance_count, std::span<const MeshletRange> index_ranges) {
+  bindGrComponentsInstanced(shader_type, gr_shader_manager_component,
+                            gr_geometry_component, gr_uniform_components,
+                            gr_texture_components,
+                            gr_instance_texture_components);
+
+  for (const auto& range : index_ranges) {
+    glDrawElementsInstanced(GL_TRIANGLES, range.index_count,
+                            gr_geometry_component.get().index_type,
+                            getIndexOffset(gr_geometry_component, range),
+                            instance_count);
+  }
 }
@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./stress_scene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/constants.hpp>
+#include <stdexcept>
+
+namespace stress_scene {
+
+std::vector<PartPlacement> getPartPlacements(StressLayout layout,
+                                             int part_count) {
+  if (part_count <= 0) {
+    throw std::invalid_argument("part_count must be greater than 0");
+  }
+
+  std::vector<PartPlacement> placements;
+  placements.reserve(part_count);
+
+  if (layout == StressLayout::GRID) {
+    int columns =
+        static_cast<int>(std::ceil(std::sqrt(static_cast<float>(part_count))));
+    int rows = (part_count + columns - 1) / columns;
+    float cell_size = 1.0f / columns;
+    float grid_height = rows * cell_size;
+
+    for (int i = 0; i < part_count; ++i) {
+      int column = i % columns;
+      int row = i / columns;
+
+      placements.push_back({
+          .scale = glm::vec3(cell_size * 0.9f),
+          .rotation = glm::quat(glm::vec3(0.0f)),
+          .translation =
+              glm::vec3((column + 0.5f) * cell_size - 0.5f,
+                        (row + 0.5f) * cell_size - grid_height * 0.5f, 0.0f),
+      });
+    }
+  } else if (layout == StressLayout::RING) {
+    float radius = 0.5f;
+    float angle_step = glm::two_pi<float>() / part_count;
+    float part_size =
+        std::min(0.8f, 2.0f * radius * std::tan(angle_step / 2.0f));
+
+    for (int i = 0; i < part_count; ++i) {
+      float angle = angle_step * i;
+
+      placements.push_back({
+          .scale = glm::vec3(part_size),
+          .rotation = glm::quat(glm::vec3(0.0f, angle, 0.0f)),
+          .translation = glm::vec3(radius * std::sin(angle), 0.0f,
+                                   radius * std::cos(angle)),
+      });
+    }
+  } else {
+    throw std::invalid_argument("Invalid stress layout");
+  }
+
+  return placements;
+}
+
+void driveScriptedStroke(float elapsed_ms, const glm::ivec2& canvas_size,
+                         InputComponent& input_component) {
+  float angle = glm::two_pi<float>() *
+                std::fmod(elapsed_ms, STROKE_PERIOD_MS) / STROKE_PERIOD_MS;
+  float radius = 0.25f * std::min(canvas_size.x, canvas_size.y);
+
+  input_component.is_pointer_down = true;
+  input_component.pointer_position.x =
+      canvas_size.x * 0.5f + radius * std::cos(angle);
+  input_component.pointer_position.y =
+      canvas_size.y * 0.5f + radius * std::sin(angle);
+
+  input_component.brush_input.air_pressure = 2.0f;
+  input_component.brush_input.nozzle_fov = glm::radians(15.0f);
+  input_component.brush_input.paint_color =
+      glm::vec3(0.5f + 0.5f * std::cos(angle), 0.5f, 0.5f);
+}
+
+}  // namespace stress_scene
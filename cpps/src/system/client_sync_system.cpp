@@ -26,10 +26,44 @@
 
 #include <emscripten/val.h>
 
+#include <cstdint>
+#include <cstdio>
 #include <glm/glm.hpp>
+#include <string>
+
+#include "./constants.h"
 
 namespace client_sync_system {
 
+emscripten::val getVec3Value(const glm::vec3& vector) {
+  auto value = emscripten::val::array();
+  for (int i = 0; i < 3; i++) {
+    value.call<void>("push", vector[i]);
+  }
+
+  return value;
+}
+
+glm::vec3 getVec3(const emscripten::val& value) {
+  return glm::vec3(value[0].as<float>(), value[1].as<float>(),
+                   value[2].as<float>());
+}
+
+// Sets `target` from `object[key]` if it is defined
+void setIfDefined(const emscripten::val& object, const char* key,
+                  glm::vec3& target) {
+  if (object[key] != emscripten::val::undefined()) {
+    target = getVec3(object[key]);
+  }
+}
+
+void setIfDefined(const emscripten::val& object, const char* key,
+                  float& target) {
+  if (object[key] != emscripten::val::undefined()) {
+    target = object[key].as<float>();
+  }
+}
+
 void syncInput(std::reference_wrapper<InputComponent> input_component) {
   emscripten::val client_input_component =
       emscripten::val::global("clientInputComponent");
@@ -104,6 +138,124 @@ void consumeEvent(std::reference_wrapper<EventComponent> event_component) {
     event_component.get().reset_position = std::monostate();
     client_event_component.set("resetPosition", emscripten::val::undefined());
   }
+
+  if (client_event_component["runStressTest"] != emscripten::val::undefined()) {
+    event_component.get().run_stress_test = std::monostate();
+    client_event_component.set("runStressTest", emscripten::val::undefined());
+  }
+
+  if (client_event_component["importMesh"] != emscripten::val::undefined()) {
+    emscripten::val import_mesh = client_event_component["importMesh"];
+    emscripten::val file_bytes = import_mesh["bytes"];
+    auto& import_mesh_event = event_component.get().import_mesh.emplace();
+
+    import_mesh_event.file_name = import_mesh["fileName"].as<std::string>();
+    // Copies the whole Uint8Array into WASM memory at once
+    import_mesh_event.bytes.resize(file_bytes["length"].as<size_t>());
+    emscripten::val(emscripten::typed_memory_view(
+                        import_mesh_event.bytes.size(),
+                        reinterpret_cast<const uint8_t*>(
+                            import_mesh_event.bytes.data())))
+        .call<void>("set", file_bytes);
+
+    client_event_component.set("importMesh", emscripten::val::undefined());
+  }
+}
+
+emscripten::val getLightingValue(
+    std::reference_wrapper<LightingComponent> lighting_component) {
+  const auto& lighting = lighting_component.get();
+
+  auto ambient = emscripten::val::object();
+  ambient.set("color", getVec3Value(lighting.ambient_color));
+  ambient.set("intensity", lighting.ambient_intensity);
+
+  auto lights = emscripten::val::array();
+  for (const auto& light : lighting.lights) {
+    auto light_value = emscripten::val::object();
+    light_value.set("color", getVec3Value(light.color));
+    light_value.set("intensity", light.intensity);
+    if (light.type == LightType::DIRECTIONAL) {
+      light_value.set("type", std::string("directional"));
+      light_value.set("direction", getVec3Value(light.direction));
+    } else {
+      light_value.set("type", std::string("point"));
+      light_value.set("position", getVec3Value(light.position));
+      light_value.set("quadraticAttenuation", light.quadratic_attenuation);
+    }
+    lights.call<void>("push", light_value);
+  }
+
+  auto material = emscripten::val::object();
+  material.set("color", getVec3Value(lighting.material_color));
+  material.set("diffuse", lighting.material_diffuse);
+  material.set("specular", lighting.material_specular);
+  material.set("shininess", lighting.material_shininess);
+
+  auto lighting_value = emscripten::val::object();
+  lighting_value.set("ambient", ambient);
+  lighting_value.set("lights", lights);
+  lighting_value.set("material", material);
+
+  return lighting_value;
+}
+
+void setLighting(const emscripten::val& lighting,
+                 std::reference_wrapper<LightingComponent> lighting_component) {
+  auto& component = lighting_component.get();
+
+  if (lighting["ambient"] != emscripten::val::undefined()) {
+    setIfDefined(lighting["ambient"], "color", component.ambient_color);
+    setIfDefined(lighting["ambient"], "intensity", component.ambient_intensity);
+  }
+
+  if (lighting["lights"] != emscripten::val::undefined()) {
+    const auto& light_values = lighting["lights"];
+    size_t light_count = light_values["length"].as<size_t>();
+    if (light_count > MAX_LIGHTS) {
+      printf("[lighting] only the first %d of %zu lights are used\n",
+             MAX_LIGHTS, light_count);
+    }
+
+    component.lights.clear();
+    for (size_t i = 0; i < light_count; i++) {
+      const auto& light_value = light_values[i];
+      auto type = light_value["type"].as<std::string>();
+      if (type != "directional" && type != "point") {
+        printf("[lighting] skipped light %zu of unknown type '%s'\n", i,
+               type.c_str());
+        continue;
+      }
+
+      Light light = {
+          .type = type == "directional" ? LightType::DIRECTIONAL
+                                        : LightType::POINT,
+          .color = glm::vec3(1.0f),
+          .intensity = 1.0f,
+          .direction = glm::vec3(0.0f, -1.0f, 0.0f),
+          .position = glm::vec3(0.0f),
+          .quadratic_attenuation = 0.0f,
+      };
+      setIfDefined(light_value, "color", light.color);
+      setIfDefined(light_value, "intensity", light.intensity);
+      setIfDefined(light_value, "direction", light.direction);
+      setIfDefined(light_value, "position", light.position);
+      setIfDefined(light_value, "quadraticAttenuation",
+                   light.quadratic_attenuation);
+
+      component.lights.push_back(light);
+    }
+  }
+
+  if (lighting["material"] != emscripten::val::undefined()) {
+    const auto& material = lighting["material"];
+    setIfDefined(material, "color", component.material_color);
+    setIfDefined(material, "diffuse", component.material_diffuse);
+    setIfDefined(material, "specular", component.material_specular);
+    setIfDefined(material, "shininess", component.material_shininess);
+  }
+
+  component.needs_update = true;
 }
 
 }  // namespace client_sync_system
@@ -0,0 +1,94 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./system/cull_system.h"
+
+#include <cmath>
+
+#include "./Component/MeshletSelectionComponent.h"
+#include "./Component/SharedGeometryComponent.h"
+#include "./Component/TransformNodeComponent.h"
+#include "./constants.h"
+#include "./math_util.h"
+
+namespace cull_system {
+
+void cullByBrush(
+    std::reference_wrapper<BrushComponent> brush_component,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    std::reference_wrapper<TransformComponent> transform_component,
+    std::reference_wrapper<BoundsComponent> bounds_component) {
+  const auto& sphere = bounds_component.get().sphere;
+  if (!sphere.has_value()) {
+    bounds_component.get().is_under_brush = false;
+    return;
+  }
+
+  auto world_sphere = transformBoundingSphere(
+      sphere.value(), transform_hierarchy.get().getWorldMatrix(
+                          transform_component.get().node));
+
+  float half_angle = getFrustumConeHalfAngle(brush_component.get().nozzle_fov);
+
+  bounds_component.get().is_under_brush =
+      isSphereInCone(world_sphere, brush_component.get().position,
+                     brush_component.get().direction, half_angle);
+}
+
+// Fragments outside of the unit circle of the brush projection are discarded,
+// so the brush paints within the cone inscribed in its frustum. The cone is
+// widened by a brush depth texel, so that the depth map is complete wherever
+// it is sampled.
+float getPaintConeHalfAngle(float nozzle_fov) {
+  return std::atan(std::tan(nozzle_fov / 2.0f) *
+                   (1.0f + 2.0f / BRUSH_DEPTH_TEXTURE_WIDTH));
+}
+
+void selectMeshletsByBrush(
+    std::reference_wrapper<BrushComponent> brush_component,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    std::reference_wrapper<EntityRegistry> part_registry) {
+  float half_angle = getPaintConeHalfAngle(brush_component.get().nozzle_fov);
+
+  for (auto [transform_node_component, shared_geometry_component,
+             meshlet_selection_component] :
+       part_registry.get()
+           .query<TransformNodeComponent, SharedGeometryComponent,
+                  MeshletSelectionComponent>()) {
+    meshlet_selection_component.depth_ranges.clear();
+    meshlet_selection_component.decal_ranges.clear();
+    meshlet_selection_component.decal_uv_rects.clear();
+
+    shared_geometry_component.meshlets->selectInCone(
+        shared_geometry_component.view,
+        transform_hierarchy.get().getWorldMatrix(
+            transform_node_component.node),
+        brush_component.get().position, brush_component.get().direction,
+        half_angle, meshlet_selection_component.depth_ranges,
+        meshlet_selection_component.decal_ranges,
+        meshlet_selection_component.decal_uv_rects);
+  }
+}
+
+}  // namespace cull_system
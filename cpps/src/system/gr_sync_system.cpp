@@ -25,117 +25,223 @@
 #include "./system/gr_sync_system.h"
 
 #include <GLES3/gl3.h>
+#include <emscripten.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <glm/gtc/matrix_transform.hpp>
+#include <vector>
 
+#include "./frame_arena.h"
+#include "./gr_resource_registry.h"
 #include "./math_util.h"
+#include "./mesh_optimizer.h"
 #include "./shader/core.h"
 
 namespace gr_sync_system {
 
 void updateGeometry(
-    std::reference_wrapper<GeometryComponent> geometry_component,
+    const GeometryView& geometry_view,
     std::reference_wrapper<GrGeometryComponent> gr_geometry_component) {
-  auto& vertices = geometry_component.get().vertices;
-  auto& indices = geometry_component.get().indices;
+  const auto& vertices = geometry_view.vertices;
 
-  gr_geometry_component.get().vertex_count = indices.size();
+  double upload_start_ms = emscripten_get_now();
+
+  gr_geometry_component.get().vertex_count = geometry_view.index_count;
+
+  size_t index_size =
+      std::min(getIndexSize(vertices.size()), geometry_view.index_size);
+  size_t vertex_buffer_size = vertices.size() * sizeof(Vertex);
+  size_t index_buffer_size = geometry_view.index_count * index_size;
+  bool is_same_size = gr_geometry_component.get().allocate(vertex_buffer_size,
+                                                           index_buffer_size);
 
   GLuint vao_id = gr_geometry_component.get().vao_id;
   GLuint vbo_id = gr_geometry_component.get().vbo_id;
   GLuint ebo_id = gr_geometry_component.get().ebo_id;
 
-  std::vector<float> raw_vertices = std::vector<float>(vertices.size() * 8);
-  for (int i = 0; i < vertices.size(); i++) {
-    raw_vertices[i * 8] = vertices[i].position.x;
-    raw_vertices[i * 8 + 1] = vertices[i].position.y;
-    raw_vertices[i * 8 + 2] = vertices[i].position.z;
-    raw_vertices[i * 8 + 3] = vertices[i].normal.x;
-    raw_vertices[i * 8 + 4] = vertices[i].normal.y;
-    raw_vertices[i * 8 + 5] = vertices[i].normal.z;
-    raw_vertices[i * 8 + 6] = vertices[i].tex_coords.x;
-    raw_vertices[i * 8 + 7] = vertices[i].tex_coords.y;
+  // Vertices are uploaded as they are stored, without an interleaved copy
+  static_assert(sizeof(Vertex) == 20);
+  static_assert(offsetof(Vertex, normal) == 12);
+  static_assert(offsetof(Vertex, tex_coords) == 16);
+
+  // Indices are uploaded as they are stored too, unless 32 bit indices have
+  // to be narrowed to 16 bits, which getIndexSize only allows below 0xFFFF.
+  // Asset packs store them narrowed already, and are checked the same way on
+  // load.
+  const void* index_data = geometry_view.indices;
+  std::vector<uint16_t> short_indices;
+  if (index_size != geometry_view.index_size) {
+    short_indices.resize(geometry_view.index_count);
+    for (size_t i = 0; i < short_indices.size(); i++) {
+      short_indices[i] = static_cast<uint16_t>(geometry_view.getIndex(i));
+    }
+    index_data = short_indices.data();
   }
+  gr_geometry_component.get().index_type =
+      index_size == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
   // Bind the Vertex Array Object first, then bind and set vertex buffer(s), and
   // then configure vertex attributes(s).
   glBindVertexArray(vao_id);
 
   glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
-  glBufferData(GL_ARRAY_BUFFER, raw_vertices.size() * 4, raw_vertices.data(),
-               GL_STATIC_DRAW);
-
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_id);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * 4, indices.data(),
-               GL_STATIC_DRAW);
+
+  // Buffers of the same size are overwritten instead of reallocated
+  if (is_same_size) {
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertex_buffer_size,
+                    vertices.data());
+    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, index_buffer_size, index_data);
+  } else {
+    glBufferData(GL_ARRAY_BUFFER, vertex_buffer_size, vertices.data(),
+                 GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_buffer_size, index_data,
+                 GL_STATIC_DRAW);
+
+    gr_geometry_component.get().vertex_buffer_size = vertex_buffer_size;
+    gr_geometry_component.get().index_buffer_size = index_buffer_size;
+    gr_resource_registry::resizeResource(GrResourceCategory::VERTEX_BUFFER,
+                                         vbo_id, vertex_buffer_size);
+    gr_resource_registry::resizeResource(GrResourceCategory::INDEX_BUFFER,
+                                         ebo_id, index_buffer_size);
+  }
 
   // Position attribute
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, position));
   glEnableVertexAttribArray(0);
 
-  // Normal attribute
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
-                        (void*)(4 * 3));
+  // Normal attribute, octahedral encoded, see getNormal of vertex_block
+  glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, normal));
   glEnableVertexAttribArray(1);
 
   // Texture Coordinate attribute
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
-                        (void*)(4 * (3 + 3)));
+  glVertexAttribPointer(2, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, tex_coords));
   glEnableVertexAttribArray(2);
 
   // Unbind buffers safely
   glBindVertexArray(0);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  gr_geometry_component.get().upload_ms =
+      emscripten_get_now() - upload_start_ms;
 }
 
 void updateGeometry(
     GeometryPreset geometry_preset,
     std::reference_wrapper<GrGeometryComponent> gr_geometry_component) {
   auto geometry_component = GeometryComponent(geometry_preset);
+  mesh_optimizer::optimizeMesh(geometry_component);
 
-  updateGeometry(std::ref(geometry_component), gr_geometry_component);
+  updateGeometry(geometry_component, gr_geometry_component);
 }
 
 void updateTransformUniforms(
-    std::reference_wrapper<TransformUpdatingView> transform_updating_view) {
-  const auto& parent_transform_component =
-      transform_updating_view.get().parent_transform_component;
-  const auto& children_transforms =
-      transform_updating_view.get().children_transforms;
-
-  auto parent_needs_update = parent_transform_component.get().needs_update;
-  const auto& parent_model_matrix =
-      getTransformMatrix(parent_transform_component.get().scale,
-                         parent_transform_component.get().rotation,
-                         parent_transform_component.get().translation);
-
-  for (auto& child_transform : children_transforms) {
-    auto& child_transform_component = child_transform.transform_component;
-    auto& gr_uniform_component = child_transform.gr_uniform_component;
-
-    if (!parent_transform_component.get().needs_update &&
-        !child_transform_component.get().needs_update) {
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    std::reference_wrapper<EntityRegistry> part_registry) {
+  struct ModelUniformData {
+    glm::mat4 model_matrix;
+    glm::mat3x4 normal_matrix;
+  };
+
+  for (auto [transform_node_component, gr_uniform_component] :
+       part_registry.get()
+           .query<TransformNodeComponent, GrUniformComponent>()) {
+    auto node = transform_node_component.node;
+    auto world_version = transform_hierarchy.get().getWorldVersion(node);
+    if (world_version == transform_node_component.uploaded_world_version) {
       continue;
     }
 
-    const auto& model_matrix =
-        parent_model_matrix *
-        getTransformMatrix(child_transform_component.get().scale,
-                           child_transform_component.get().rotation,
-                           child_transform_component.get().translation);
+    glm::mat4 model_matrix = transform_hierarchy.get().getWorldMatrix(node);
+    ModelUniformData model_uniform_data = {
+        .model_matrix = model_matrix,
+        .normal_matrix = getNormalMatrix(model_matrix),
+    };
 
-    glBindBuffer(GL_UNIFORM_BUFFER,
-                 gr_uniform_component.get().uniform_buffer_id);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(model_matrix), &model_matrix,
-                 GL_STATIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, gr_uniform_component.uniform_buffer_id);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(model_uniform_data),
+                 &model_uniform_data, GL_STATIC_DRAW);
+    gr_resource_registry::resizeResource(GrResourceCategory::UNIFORM_BUFFER,
+                                         gr_uniform_component.uniform_buffer_id,
+                                         sizeof(model_uniform_data));
 
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-    child_transform_component.get().needs_update = false;
+    transform_node_component.uploaded_world_version = world_version;
   }
 }
 
+void updateInstanceUniform(
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+    std::reference_wrapper<EntityRegistry> part_registry,
+    const InstanceBatch& instance_batch,
+    std::reference_wrapper<GrUniformComponent> gr_uniform_component) {
+  // World matrices are already composed, so this is only a gather
+  const auto& part_handles = instance_batch.part_handles;
+  auto model_matrices =
+      frame_arena::FrameVector<glm::mat4>(part_handles.size());
+  auto normal_matrices =
+      frame_arena::FrameVector<glm::mat3x4>(part_handles.size());
+  for (auto part_handle : part_handles) {
+    const auto& model_matrix = transform_hierarchy.get().getWorldMatrix(
+        part_registry.get().get<TransformNodeComponent>(part_handle).node);
+    model_matrices.push_back(model_matrix);
+    normal_matrices.push_back(getNormalMatrix(model_matrix));
+  }
+
+  // The whole block has to be backed by the buffer, even if the batch only
+  // uses the first few matrices. Reallocating also spares waiting on the
+  // previous batch still reading the buffer.
+  size_t normal_matrices_offset = sizeof(glm::mat4) * MAX_INSTANCES_PER_DRAW;
+  size_t uniform_buffer_size =
+      normal_matrices_offset + sizeof(glm::mat3x4) * MAX_INSTANCES_PER_DRAW;
+
+  glBindBuffer(GL_UNIFORM_BUFFER, gr_uniform_component.get().uniform_buffer_id);
+  glBufferData(GL_UNIFORM_BUFFER, uniform_buffer_size, nullptr,
+               GL_DYNAMIC_DRAW);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0,
+                  sizeof(glm::mat4) * model_matrices.size(),
+                  model_matrices.data());
+  glBufferSubData(GL_UNIFORM_BUFFER, normal_matrices_offset,
+                  sizeof(glm::mat3x4) * normal_matrices.size(),
+                  normal_matrices.data());
+  gr_resource_registry::resizeResource(
+      GrResourceCategory::UNIFORM_BUFFER,
+      gr_uniform_component.get().uniform_buffer_id, uniform_buffer_size);
+
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void updatePaintedMap(std::span<const char> painted_map,
+                      std::reference_wrapper<GrPingPongTextureComponent>
+                          gr_painted_ping_pong_texture_component) {
+  auto current_framed_texture =
+      gr_painted_ping_pong_texture_component.get().getCurrentFramedTexture();
+  int width = current_framed_texture.get().width;
+  int height = current_framed_texture.get().height;
+
+  if (painted_map.size() != static_cast<size_t>(width) * height *
+                                getTextureBytesPerPixel(TextureType::RGBA16)) {
+    return;
+  }
+
+  glBindTexture(GL_TEXTURE_2D, current_framed_texture.get().texture_id);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA,
+                  GL_HALF_FLOAT, painted_map.data());
+  glGenerateMipmap(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // The whole map is copied to the other texture by the next blend
+  gr_painted_ping_pong_texture_component.get().markDirty(
+      UvRect{glm::vec2(0.0f), glm::vec2(1.0f)});
+}
+
 void updateCameraUniform(
     std::reference_wrapper<RenderConfigComponent> render_config_component,
     std::reference_wrapper<CameraComponent> camera_component,
@@ -173,6 +279,10 @@ void updateCameraUniform(
   glBindBuffer(GL_UNIFORM_BUFFER, gr_uniform_component.get().uniform_buffer_id);
   glBufferData(GL_UNIFORM_BUFFER, sizeof(camera_uniform_data),
                &camera_uniform_data, GL_STATIC_DRAW);
+  gr_resource_registry::resizeResource(
+      GrResourceCategory::UNIFORM_BUFFER,
+      gr_uniform_component.get().uniform_buffer_id,
+      sizeof(camera_uniform_data));
 
   glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
@@ -181,13 +291,7 @@ void updateCameraUniform(
 
 void updateBrushUniform(
     std::reference_wrapper<BrushComponent> brush_component,
-    std::reference_wrapper<InputComponent> input_component,
-    std::reference_wrapper<RenderConfigComponent> render_config_component,
-    std::reference_wrapper<CameraComponent> camera_component,
     std::reference_wrapper<GrUniformComponent> gr_uniform_component) {
-  const auto& pointer_position = input_component.get().pointer_position;
-  const auto& canvas_size = render_config_component.get().canvas_size;
-
   struct BrushUniformData {
     float air_pressure;
     alignas(16) glm::vec3 paint_color;
@@ -200,24 +304,9 @@ void updateBrushUniform(
   glm::mat4 projection_matrix =
       glm::perspective(brush_component.get().nozzle_fov, 1.0f, 0.01f, 1000.0f);
 
-  auto eye_position = getPositionOnSphere(camera_component.get().radius,
-                                          camera_component.get().phi,
-                                          camera_component.get().theta);
-
-  auto camera_up =
-      getUpOnSphere(camera_component.get().phi, camera_component.get().theta);
-
-  auto camera_view_matrix =
-      glm::lookAt(eye_position, glm::vec3(0.0f), camera_up);
-
-  auto ray_direction = getRayDirectionFromScreen(
-      glm::vec2(pointer_position.x, pointer_position.y), glm::vec2(canvas_size),
-      camera_component.get().fovy, camera_view_matrix);
-
-  auto brush_position = eye_position + ray_direction * glm::vec3(0.1);
-
-  auto brush_view_matrix =
-      getRayViewMatrix(brush_position, camera_up, ray_direction);
+  auto brush_view_matrix = getRayViewMatrix(brush_component.get().position,
+                                            brush_component.get().up,
+                                            brush_component.get().direction);
 
   BrushUniformData brush_uniform_data = {
       .air_pressure = brush_component.get().air_pressure,
@@ -225,12 +314,15 @@ void updateBrushUniform(
       .nozzle_fov = brush_component.get().nozzle_fov,
       .view_matrix = brush_view_matrix,
       .projection_matrix = projection_matrix,
-      .position = brush_position,
+      .position = brush_component.get().position,
   };
 
   glBindBuffer(GL_UNIFORM_BUFFER, gr_uniform_component.get().uniform_buffer_id);
   glBufferData(GL_UNIFORM_BUFFER, sizeof(brush_uniform_data),
                &brush_uniform_data, GL_STATIC_DRAW);
+  gr_resource_registry::resizeResource(
+      GrResourceCategory::UNIFORM_BUFFER,
+      gr_uniform_component.get().uniform_buffer_id, sizeof(brush_uniform_data));
 
   glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
@@ -251,8 +343,75 @@ void updateTimeUniform(
   glBindBuffer(GL_UNIFORM_BUFFER, gr_uniform_component.get().uniform_buffer_id);
   glBufferData(GL_UNIFORM_BUFFER, sizeof(time_uniform_data), &time_uniform_data,
                GL_STATIC_DRAW);
+  gr_resource_registry::resizeResource(
+      GrResourceCategory::UNIFORM_BUFFER,
+      gr_uniform_component.get().uniform_buffer_id, sizeof(time_uniform_data));
+
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void updateLightingUniform(
+    std::reference_wrapper<LightingComponent> lighting_component,
+    std::reference_wrapper<GrUniformComponent> gr_uniform_component) {
+  if (!lighting_component.get().needs_update) {
+    return;
+  }
+
+  struct LightUniformData {
+    glm::vec4 vector;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+  };
+
+  struct LightingUniformData {
+    glm::vec3 ambient;
+    int light_count;
+    glm::vec3 material_color;
+    float shininess;
+    LightUniformData lights[MAX_LIGHTS];
+  };
+
+  const auto& lighting = lighting_component.get();
+
+  // The material is folded into the lights, so that shading a fragment only
+  // scales them by its color and how much it faces each light
+  LightingUniformData lighting_uniform_data = {
+      .ambient = lighting.ambient_color * lighting.ambient_intensity *
+                 lighting.material_diffuse,
+      .light_count = static_cast<int>(
+          std::min(lighting.lights.size(), static_cast<size_t>(MAX_LIGHTS))),
+      .material_color = lighting.material_color,
+      .shininess = lighting.material_shininess,
+      .lights = {},
+  };
+
+  for (int i = 0; i < lighting_uniform_data.light_count; i++) {
+    const auto& light = lighting.lights[i];
+    auto color = light.color * light.intensity;
+
+    lighting_uniform_data.lights[i] = {
+        .vector = light.type == LightType::DIRECTIONAL
+                      ? glm::vec4(glm::normalize(-light.direction), 0.0f)
+                      : glm::vec4(light.position, 1.0f),
+        .diffuse = glm::vec4(color * lighting.material_diffuse,
+                             light.type == LightType::POINT
+                                 ? light.quadratic_attenuation
+                                 : 0.0f),
+        .specular = glm::vec4(color * lighting.material_specular, 0.0f),
+    };
+  }
+
+  glBindBuffer(GL_UNIFORM_BUFFER, gr_uniform_component.get().uniform_buffer_id);
+  glBufferData(GL_UNIFORM_BUFFER, sizeof(lighting_uniform_data),
+               &lighting_uniform_data, GL_STATIC_DRAW);
+  gr_resource_registry::resizeResource(
+      GrResourceCategory::UNIFORM_BUFFER,
+      gr_uniform_component.get().uniform_buffer_id,
+      sizeof(lighting_uniform_data));
 
   glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  lighting_component.get().needs_update = false;
 }
 
 }  // namespace gr_sync_system
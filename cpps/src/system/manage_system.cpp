@@ -25,23 +25,37 @@
 #include "./system/manage_system.h"
 
 #include <GLES3/gl3.h>
+#include <emscripten.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./asset_pack.h"
+#include "./geometry_cache.h"
+#include "./gr_resource_registry.h"
+#include "./job_system.h"
+#include "./mesh_import.h"
+#include "./mesh_optimizer.h"
+#include "./system/gr_sync_system.h"
+#include "./uv_atlas.h"
 
 namespace manage_system {
 
 void resetPainted(
     std::reference_wrapper<EventComponent> event_component,
     std::reference_wrapper<RenderConfigComponent> render_config_component,
-    std::reference_wrapper<PaintedTexturesView> painted_textures_view) {
-  for (const auto& gr_painted_component :
-       painted_textures_view.get().paintable_gr_ping_pong_textures) {
-    const auto& gr_painted_texture =
-        gr_painted_component.get().getCurrentFramedTexture();
-
-    glBindFramebuffer(GL_FRAMEBUFFER, gr_painted_texture.get().framebuffer_id);
-    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    std::reference_wrapper<EntityRegistry> part_registry) {
+  for (auto [gr_painted_component] :
+       part_registry.get().query<GrPingPongTextureComponent>()) {
+    // Both textures, with their mips, which are then up to date
+    gr_painted_component.ping_framed_texture_component->clear();
+    gr_painted_component.pong_framed_texture_component->clear();
+    gr_painted_component.clearDirty();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glClearColor(render_config_component.get().clear_color.r,
                  render_config_component.get().clear_color.g,
                  render_config_component.get().clear_color.b, 1.0f);
@@ -56,13 +70,24 @@ void resetModel(std::reference_wrapper<EventComponent> event_component,
 
   switch (model_preset) {
     case ModelOptions::CUBE:
-      root_manager.get().resetPaintable(PaintablePreset::CUBE);
+      root_manager.get().beginPaintableSwitch(
+          getPaintableDescriptors(PaintablePreset::CUBE));
       break;
     case ModelOptions::PLANE:
-      root_manager.get().resetPaintable(PaintablePreset::PLANE);
+      root_manager.get().beginPaintableSwitch(
+          getPaintableDescriptors(PaintablePreset::PLANE));
       break;
     case ModelOptions::SPHERE:
-      root_manager.get().resetPaintable(PaintablePreset::SPHERE);
+      root_manager.get().beginPaintableSwitch(
+          getPaintableDescriptors(PaintablePreset::SPHERE));
+      break;
+    case ModelOptions::STRESS:
+      root_manager.get().beginPaintableSwitch(
+          getPaintableDescriptors(PaintablePreset::STRESS));
+      break;
+    case ModelOptions::CAR:
+      root_manager.get().beginPaintableSwitch(
+          getPaintableDescriptors(PaintablePreset::CAR));
       break;
     default:
       std::runtime_error("Invalid model preset");
@@ -71,12 +96,328 @@ void resetModel(std::reference_wrapper<EventComponent> event_component,
   event_component.get().update_model = std::nullopt;
 }
 
+void logPartUvReport(const std::string& part_name,
+                     const uv_atlas::PartUvReport& report) {
+  auto to_megabytes = [](int painted_map_size) {
+    return uv_atlas::getPaintedMapBytes(painted_map_size) / (1024.0 * 1024.0);
+  };
+
+  if (!report.is_repacked) {
+    printf("[import] %s: UVs kept, %.1f%% used, painted maps %d px %.1f MB\n",
+           part_name.c_str(), report.utilization * 100.0f,
+           report.painted_map_size, to_megabytes(report.painted_map_size));
+  } else if (report.original_painted_map_size == 0) {
+    printf("[import] %s: UVs missing, packed %zu charts, %.1f%% used, painted "
+           "maps %d px %.1f MB\n",
+           part_name.c_str(), report.chart_count, report.utilization * 100.0f,
+           report.painted_map_size, to_megabytes(report.painted_map_size));
+  } else {
+    printf("[import] %s: UVs repacked into %zu charts, %.1f%% -> %.1f%% used, "
+           "painted maps %d px %.1f MB -> %d px %.1f MB\n",
+           part_name.c_str(), report.chart_count,
+           report.original_utilization * 100.0f, report.utilization * 100.0f,
+           report.original_painted_map_size,
+           to_megabytes(report.original_painted_map_size),
+           report.painted_map_size, to_megabytes(report.painted_map_size));
+  }
+}
+
+void importMesh(std::reference_wrapper<EventComponent> event_component,
+                std::reference_wrapper<ProfileComponent> profile_component,
+                std::reference_wrapper<RootManager> root_manager) {
+  auto& mesh_import_component =
+      *root_manager.get().model_switch_entity->mesh_import_component;
+
+  // The file waits for the running step, which cannot be interrupted
+  if (mesh_import_component.is_step_running) {
+    mesh_import_component.is_canceled = true;
+    return;
+  }
+
+  auto import_mesh_event = std::move(event_component.get().import_mesh.value());
+  event_component.get().import_mesh = std::nullopt;
+
+  // Drops the model being switched to or imported, the file being picked last
+  root_manager.get().cancelPaintableSwitch();
+
+  if (!asset_pack::isAssetPackFile(import_mesh_event.file_name)) {
+    mesh_import_component.file_name = std::move(import_mesh_event.file_name);
+    mesh_import_component.bytes = std::move(import_mesh_event.bytes);
+    mesh_import_component.stage = MeshImportStage::PARSE;
+    return;
+  }
+
+  try {
+    // Geometry stays in the fetched bytes, which the pack takes over
+    double load_start_ms = emscripten_get_now();
+    auto asset_pack =
+        asset_pack::AssetPack::fromBytes(std::move(import_mesh_event.bytes));
+    auto descriptors = getAssetPackPaintableDescriptors(asset_pack);
+    double load_ms = emscripten_get_now() - load_start_ms;
+
+    if (profile_component.get().is_enabled) {
+      printf("[import] %s: %zu paintables, %zu parts, %.1f KB, load %.1f ms\n",
+             import_mesh_event.file_name.c_str(), descriptors.size(),
+             asset_pack->getParts().size(), asset_pack->getSize() / 1024.0,
+             load_ms);
+    }
+
+    root_manager.get().beginPaintableSwitch(std::move(descriptors));
+  } catch (const std::exception& exception) {
+    printf("[import] %s failed: %s\n", import_mesh_event.file_name.c_str(),
+           exception.what());
+  }
+}
+
+// Runs the next step of the import, on any thread. Only touches
+// `mesh_import_component`.
+void runMeshImportStep(MeshImportComponent& mesh_import_component) {
+  auto& parts = mesh_import_component.parts;
+  auto& part_index = mesh_import_component.next_part_index;
+
+  try {
+    if (mesh_import_component.stage == MeshImportStage::PARSE) {
+      double parse_start_ms = emscripten_get_now();
+      parts = mesh_import::importMesh(
+          mesh_import_component.bytes,
+          mesh_import::getMeshFormat(mesh_import_component.file_name));
+      mesh_import_component.parse_ms = emscripten_get_now() - parse_start_ms;
+
+      // The file is not needed anymore, and the BVHs built next need memory
+      mesh_import_component.bytes = std::vector<char>();
+
+      for (const auto& part : parts) {
+        mesh_import_component.triangle_count +=
+            part.geometry_component.indices.size() / 3;
+      }
+      mesh_import_component.texel_density =
+          uv_atlas::getImportTexelDensity(parts, MESH_TEXEL_DENSITY);
+
+      mesh_import_component.stage = MeshImportStage::PACK_UVS;
+      part_index = 0;
+    } else if (mesh_import_component.stage == MeshImportStage::PACK_UVS) {
+      if (part_index < parts.size()) {
+        auto& part = parts[part_index];
+
+        double atlas_start_ms = emscripten_get_now();
+        mesh_import_component.uv_reports.push_back(uv_atlas::packImportedPart(
+            part, mesh_import_component.texel_density));
+        mesh_import_component.atlas_ms +=
+            emscripten_get_now() - atlas_start_ms;
+
+        mesh_import_component.miss_count_before +=
+            mesh_optimizer::getAcmr(part.geometry_component) *
+            (part.geometry_component.indices.size() / 3);
+        part_index++;
+      }
+
+      if (part_index >= parts.size()) {
+        mesh_import_component.stage = MeshImportStage::BUILD_GEOMETRY;
+        part_index = 0;
+      }
+    } else if (mesh_import_component.stage ==
+               MeshImportStage::BUILD_GEOMETRY) {
+      if (part_index < parts.size()) {
+        double bvh_start_ms = emscripten_get_now();
+        mesh_import_component.geometries.push_back(geometry_cache::build(
+            std::move(parts[part_index].geometry_component)));
+        mesh_import_component.bvh_ms += emscripten_get_now() - bvh_start_ms;
+        part_index++;
+      }
+
+      if (part_index >= parts.size()) {
+        mesh_import_component.stage = MeshImportStage::SWITCH;
+      }
+    }
+  } catch (const std::exception& exception) {
+    mesh_import_component.error = exception.what();
+  }
+}
+
+// Hands the imported model to the model switch, on the main thread
+void switchToMeshImport(
+    std::reference_wrapper<ProfileComponent> profile_component,
+    std::reference_wrapper<RootManager> root_manager) {
+  auto& mesh_import_component =
+      *root_manager.get().model_switch_entity->mesh_import_component;
+  const auto& parts = mesh_import_component.parts;
+  bool is_logged = profile_component.get().is_enabled;
+
+  for (size_t i = 0; is_logged && i < parts.size(); i++) {
+    logPartUvReport(parts[i].material_name,
+                    mesh_import_component.uv_reports[i]);
+  }
+
+  PaintableDescriptor descriptor;
+  try {
+    descriptor = getMeshPaintableDescriptor(
+        parts, std::move(mesh_import_component.geometries));
+  } catch (const std::exception& exception) {
+    printf("[import] %s failed: %s\n",
+           mesh_import_component.file_name.c_str(), exception.what());
+    mesh_import_component.reset();
+    return;
+  }
+
+  if (is_logged) {
+    double miss_count_after = 0.0;
+    for (const auto& part_descriptor : descriptor.part_descriptors) {
+      const auto& view = part_descriptor.geometry.view;
+      miss_count_after +=
+          mesh_optimizer::getAcmr(view) * (view.index_count / 3);
+    }
+
+    size_t triangle_count = mesh_import_component.triangle_count;
+    printf(
+        "[import] %s: %zu parts, %zu triangles, parse %.1f ms, UV atlas "
+        "%.1f ms, optimize and BVH %.1f ms, ACMR %.3f -> %.3f, over %d "
+        "frames\n",
+        mesh_import_component.file_name.c_str(), parts.size(), triangle_count,
+        mesh_import_component.parse_ms, mesh_import_component.atlas_ms,
+        mesh_import_component.bvh_ms,
+        mesh_import_component.miss_count_before / triangle_count,
+        miss_count_after / triangle_count, mesh_import_component.frame_count);
+  }
+
+  // Done before the switch, which would otherwise cancel the import
+  mesh_import_component.reset();
+  root_manager.get().beginPaintableSwitch({std::move(descriptor)});
+}
+
+void stepMeshImport(std::reference_wrapper<ProfileComponent> profile_component,
+                    std::reference_wrapper<RootManager> root_manager) {
+  auto& mesh_import_component =
+      *root_manager.get().model_switch_entity->mesh_import_component;
+
+  // A worker is still on the previous step
+  if (mesh_import_component.is_step_running) {
+    return;
+  }
+
+  mesh_import_component.frame_count++;
+  double slice_start_ms = emscripten_get_now();
+
+  // Without workers, steps run right away, so as many as fit the budget run
+  // this frame. Otherwise the frame goes on once the step is submitted.
+  do {
+    if (mesh_import_component.is_canceled) {
+      mesh_import_component.reset();
+      return;
+    }
+
+    if (!mesh_import_component.error.empty()) {
+      printf("[import] %s failed: %s\n",
+             mesh_import_component.file_name.c_str(),
+             mesh_import_component.error.c_str());
+      mesh_import_component.reset();
+      return;
+    }
+
+    if (mesh_import_component.stage == MeshImportStage::SWITCH) {
+      switchToMeshImport(profile_component, root_manager);
+      return;
+    }
+
+    mesh_import_component.is_step_running = true;
+    job_system::submitBackground([&mesh_import_component] {
+      runMeshImportStep(mesh_import_component);
+      mesh_import_component.is_step_running = false;
+    });
+  } while (!mesh_import_component.is_step_running &&
+           emscripten_get_now() - slice_start_ms <
+               mesh_import_component.frame_budget_ms);
+}
+
+void stepModelSwitch(std::reference_wrapper<ProfileComponent> profile_component,
+                     std::reference_wrapper<RootManager> root_manager) {
+  auto& model_switch_entity = *root_manager.get().model_switch_entity;
+  auto& model_switch_component = *model_switch_entity.model_switch_component;
+  const auto& descriptors = model_switch_component.descriptors;
+  auto& paintable_index = model_switch_component.next_paintable_index;
+  auto& part_index = model_switch_component.next_part_index;
+
+  gr_resource_registry::OwnerScope owner_scope("PaintableEntity");
+
+  double slice_start_ms = emscripten_get_now();
+  double slice_ms = 0.0;
+
+  do {
+    const auto& part_descriptors =
+        descriptors[paintable_index].part_descriptors;
+
+    if (part_index < part_descriptors.size()) {
+      auto& pending_paintable_entity =
+          *model_switch_entity.pending_paintable_entities[paintable_index];
+
+      auto part_handle =
+          addPaintablePart(std::ref(pending_paintable_entity),
+                           part_descriptors[part_index]);
+      auto& shared_geometry_component =
+          pending_paintable_entity.part_registry
+              ->get<SharedGeometryComponent>(part_handle);
+      // Shared geometry may already be uploaded by another part
+      if (shared_geometry_component.gr_geometry_component->vao_id == 0) {
+        gr_sync_system::updateGeometry(
+            shared_geometry_component.view,
+            std::ref(*shared_geometry_component.gr_geometry_component));
+      }
+
+      const auto& baked_painted_map =
+          part_descriptors[part_index].baked_painted_map;
+      if (!baked_painted_map.empty()) {
+        gr_sync_system::updatePaintedMap(
+            baked_painted_map,
+            std::ref(pending_paintable_entity.part_registry
+                         ->get<GrPingPongTextureComponent>(part_handle)));
+      }
+
+      part_index++;
+    }
+
+    if (part_index >= part_descriptors.size()) {
+      paintable_index++;
+      part_index = 0;
+    }
+
+    slice_ms = emscripten_get_now() - slice_start_ms;
+  } while (paintable_index < descriptors.size() &&
+           slice_ms < model_switch_component.frame_budget_ms);
+
+  model_switch_component.frame_count++;
+  model_switch_component.work_ms += slice_ms;
+  model_switch_component.max_slice_ms =
+      std::max(model_switch_component.max_slice_ms, slice_ms);
+
+  if (paintable_index < descriptors.size()) {
+    return;
+  }
+
+  if (profile_component.get().is_enabled) {
+    printf("[manage] model switch took %d frames, %.2f ms of work (max %.2f "
+           "ms/frame)\n",
+           model_switch_component.frame_count, model_switch_component.work_ms,
+           model_switch_component.max_slice_ms);
+
+    auto geometry_cache_stats = geometry_cache::getStats();
+    printf("[manage] geometry cache: %zu hits, %zu misses, %.1f KB shared, "
+           "%.2f ms avoided\n",
+           geometry_cache_stats.hit_count, geometry_cache_stats.miss_count,
+           geometry_cache_stats.gpu_bytes_saved / 1024.0,
+           geometry_cache_stats.ms_avoided);
+  }
+
+  root_manager.get().swapPaintable();
+}
+
 void resetPosition(
     std::reference_wrapper<EventComponent> event_component,
     std::reference_wrapper<CameraComponent> camera_component,
-    std::reference_wrapper<TransformComponent> transform_component) {
+    std::reference_wrapper<RootManager> root_manager) {
   camera_component.get().reset();
-  transform_component.get().reset();
+  root_manager.get().scene_entity->transform_component->reset();
+  for (auto& paintable_entity : root_manager.get().paintable_entities) {
+    paintable_entity->transform_component->reset();
+  }
 
   event_component.get().reset_position = std::nullopt;
 }
@@ -26,37 +26,101 @@
 
 #include <GLES3/gl3.h>
 
-#include <vector>
+#include <array>
 
 #include "./render_util.h"
+#include "./system/gr_sync_system.h"
 
 namespace paint_system {
 
-void updateBrushDepth(
-    std::reference_wrapper<GrShaderManagerComponent>
-        gr_shader_manager_component,
-    std::reference_wrapper<GrUniformComponent> gr_brush_uniform_component,
-    std::reference_wrapper<GrFramedTextureComponent>
-        gr_brush_depth_framed_texture_component,
-    std::reference_wrapper<GrModelGeometriesView> gr_model_geometries_view) {
+void bindBrushDepth(std::reference_wrapper<GrFramedTextureComponent>
+                        gr_brush_depth_framed_texture_component) {
   glBindFramebuffer(
       GL_FRAMEBUFFER,
       gr_brush_depth_framed_texture_component.get().framebuffer_id);
   glViewport(0, 0, gr_brush_depth_framed_texture_component.get().width,
              gr_brush_depth_framed_texture_component.get().height);
+}
+
+void clearBrushDepth(std::reference_wrapper<GrFramedTextureComponent>
+                         gr_brush_depth_framed_texture_component) {
+  bindBrushDepth(gr_brush_depth_framed_texture_component);
   glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
 
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  for (const auto& gr_model_geometry :
-       gr_model_geometries_view.get().gr_model_geometries) {
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void updateBrushDepth(
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrUniformComponent> gr_brush_uniform_component,
+    std::reference_wrapper<GrFramedTextureComponent>
+        gr_brush_depth_framed_texture_component,
+    std::reference_wrapper<EntityRegistry> part_registry) {
+  bindBrushDepth(gr_brush_depth_framed_texture_component);
+
+  for (auto [shared_geometry_component, gr_model_uniform_component,
+             meshlet_selection_component] :
+       part_registry.get()
+           .query<SharedGeometryComponent, GrUniformComponent,
+                  MeshletSelectionComponent>()) {
+    const auto& depth_ranges = meshlet_selection_component.depth_ranges;
+    if (depth_ranges.empty()) {
+      continue;
+    }
+
     auto gr_uniform_components =
-        std::vector<std::reference_wrapper<GrUniformComponent>>{
-            gr_brush_uniform_component, gr_model_geometry.gr_uniform_component};
+        std::array<std::reference_wrapper<GrUniformComponent>, 2>{
+            gr_brush_uniform_component, std::ref(gr_model_uniform_component)};
 
-    drawGrComponents(ShaderType::BRUSH_DEPTH, gr_shader_manager_component,
-                     gr_model_geometry.gr_geometry_component,
-                     gr_uniform_components, {});
+    drawGrComponentRanges(
+        ShaderType::BRUSH_DEPTH, gr_shader_manager_component,
+        std::ref(*shared_geometry_component.gr_geometry_component),
+        gr_uniform_components, {}, depth_ranges.get());
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void updateBrushDepthInstanced(
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrUniformComponent> gr_brush_uniform_component,
+    std::reference_wrapper<GrFramedTextureComponent>
+        gr_brush_depth_framed_texture_component,
+    std::reference_wrapper<GrUniformComponent> gr_instance_uniform_component,
+    std::reference_wrapper<InstanceBatchesView> instance_batches_view) {
+  bindBrushDepth(gr_brush_depth_framed_texture_component);
+
+  auto gr_uniform_components =
+      std::array<std::reference_wrapper<GrUniformComponent>, 2>{
+          gr_brush_uniform_component, gr_instance_uniform_component};
+
+  for (const auto& depth_batch :
+       instance_batches_view.get().depth_batches.batches) {
+    MeshletRanges depth_ranges;
+    for (auto part_handle : depth_batch.part_handles) {
+      depth_ranges.merge(
+          instance_batches_view.get()
+              .part_registry.get()
+              .get<MeshletSelectionComponent>(part_handle)
+              .depth_ranges);
+    }
+    if (depth_ranges.empty()) {
+      continue;
+    }
+
+    gr_sync_system::updateInstanceUniform(
+        instance_batches_view.get().transform_hierarchy,
+        instance_batches_view.get().part_registry, depth_batch,
+        gr_instance_uniform_component);
+
+    drawGrComponentRangesInstanced(
+        ShaderType::BRUSH_DEPTH_INSTANCED, gr_shader_manager_component,
+        depth_batch.gr_geometry_component, gr_uniform_components, {}, {},
+        depth_batch.part_handles.size(), depth_ranges.get());
   }
 
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -70,14 +134,16 @@ void paint(
     std::reference_wrapper<GrUniformComponent> gr_model_uniform_component,
     std::reference_wrapper<GrUniformComponent> gr_time_uniform_component,
     std::reference_wrapper<GrTextureComponent> gr_brush_depth_texture_component,
+    std::reference_wrapper<MeshletSelectionComponent>
+        meshlet_selection_component,
     std::reference_wrapper<GrFramedTextureComponent>
         gr_paint_framed_texture_component) {
   auto gr_uniform_components =
-      std::vector<std::reference_wrapper<GrUniformComponent>>{
+      std::array<std::reference_wrapper<GrUniformComponent>, 3>{
           gr_brush_uniform_component, gr_model_uniform_component,
           gr_time_uniform_component};
   auto gr_texture_components =
-      std::vector<std::reference_wrapper<GrTextureComponent>>{
+      std::array<std::reference_wrapper<GrTextureComponent>, 1>{
           gr_brush_depth_texture_component};
 
   glBindFramebuffer(GL_FRAMEBUFFER,
@@ -88,9 +154,10 @@ void paint(
 
   glClear(GL_COLOR_BUFFER_BIT);
 
-  drawGrComponents(ShaderType::BRUSH_DECAL, gr_shader_manager_component,
-                   gr_geometry_component, gr_uniform_components,
-                   gr_texture_components);
+  drawGrComponentRanges(ShaderType::BRUSH_DECAL, gr_shader_manager_component,
+                        gr_geometry_component, gr_uniform_components,
+                        gr_texture_components,
+                        meshlet_selection_component.get().decal_ranges.get());
 
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
@@ -100,9 +167,13 @@ void updatePaintedMap(
     std::reference_wrapper<GrShaderManagerComponent>
         gr_shader_manager_component,
     std::reference_wrapper<GrTextureComponent> gr_paint_texture_component,
+    std::reference_wrapper<MeshletSelectionComponent>
+        meshlet_selection_component,
     std::reference_wrapper<GrPingPongTextureComponent>
         gr_painted_ping_pong_texture_component) {
   gr_painted_ping_pong_texture_component.get().switchTexture();
+  gr_painted_ping_pong_texture_component.get().markDirty(
+      meshlet_selection_component.get().decal_uv_rects);
 
   auto prev_framed_texture =
       gr_painted_ping_pong_texture_component.get().getPrevFramedTexture();
@@ -110,7 +181,7 @@ void updatePaintedMap(
       gr_painted_ping_pong_texture_component.get().getCurrentFramedTexture();
 
   auto gr_texture_components =
-      std::vector<std::reference_wrapper<GrTextureComponent>>{
+      std::array<std::reference_wrapper<GrTextureComponent>, 2>{
           gr_paint_texture_component, prev_framed_texture};
 
   glBindFramebuffer(GL_FRAMEBUFFER,
@@ -127,4 +198,61 @@ void updatePaintedMap(
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
+void updatePaintedMipmaps(
+    std::reference_wrapper<GrGeometryComponent> gr_quad_geometry_component,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrPingPongTextureComponent>
+        gr_painted_ping_pong_texture_component) {
+  auto& dirty_uv_rects =
+      gr_painted_ping_pong_texture_component.get().getCurrentDirtyUvRects();
+  if (dirty_uv_rects.empty()) {
+    return;
+  }
+
+  auto current_framed_texture =
+      gr_painted_ping_pong_texture_component.get().getCurrentFramedTexture();
+  auto& texture = current_framed_texture.get();
+  auto size = glm::ivec2(texture.width, texture.height);
+
+  auto gr_texture_components =
+      std::array<std::reference_wrapper<GrTextureComponent>, 1>{
+          current_framed_texture};
+
+  glBindFramebuffer(GL_FRAMEBUFFER, texture.framebuffer_id);
+
+  for (int level = 1; level < texture.level_count; level++) {
+    // Only the level read from is sampleable, so that drawing into the next
+    // one is not a feedback loop. Drawing rebinds the texture, hence binding
+    // it for each level.
+    glBindTexture(GL_TEXTURE_2D, texture.texture_id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level - 1);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           texture.texture_id, level);
+
+    TexelRects texel_rects;
+    size_t texel_rect_count =
+        getDirtyTexelRects(dirty_uv_rects, size, level, texel_rects);
+    for (size_t i = 0; i < texel_rect_count; i++) {
+      const auto& texel_rect = texel_rects[i];
+      glViewport(texel_rect.min.x, texel_rect.min.y,
+                 texel_rect.max.x - texel_rect.min.x,
+                 texel_rect.max.y - texel_rect.min.y);
+      drawGrComponents(ShaderType::PAINTED_MIPMAP, gr_shader_manager_component,
+                       gr_quad_geometry_component, {}, gr_texture_components);
+    }
+  }
+
+  glBindTexture(GL_TEXTURE_2D, texture.texture_id);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.level_count - 1);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         texture.texture_id, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  dirty_uv_rects.clear();
+}
+
 }  // namespace paint_system
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./system/pick_system.h"
+
+#include <limits>
+
+#include "./Component/SharedGeometryComponent.h"
+#include "./Component/TransformNodeComponent.h"
+#include "./math_util.h"
+
+namespace pick_system {
+
+glm::vec2 getHitUv(const GeometryView& geometry_view, uint32_t triangle_index,
+                   const glm::vec3& barycentrics);
+
+void pickByBrush(std::reference_wrapper<BrushComponent> brush_component,
+                 std::reference_wrapper<TransformHierarchy> transform_hierarchy,
+                 size_t paintable_index,
+                 std::reference_wrapper<EntityRegistry> part_registry,
+                 std::reference_wrapper<BoundsComponent> bounds_component,
+                 std::reference_wrapper<PickComponent> pick_component) {
+  // The ray runs along the axis of the cone, so neither can hit anything
+  // outside of the bounds
+  if (!bounds_component.get().is_under_brush) {
+    return;
+  }
+
+  const auto& ray_origin = brush_component.get().position;
+  const auto& ray_direction = brush_component.get().direction;
+  float half_angle = getFrustumConeHalfAngle(brush_component.get().nozzle_fov);
+
+  bool is_cone_hit = false;
+  auto& pointer_hit = pick_component.get().pointer_hit;
+
+  auto part_query =
+      part_registry.get()
+          .query<TransformNodeComponent, SharedGeometryComponent>();
+  part_query.each(
+      [&](EntityHandle part_handle,
+          TransformNodeComponent& transform_node_component,
+          SharedGeometryComponent& shared_geometry_component) {
+        const auto& bvh = *shared_geometry_component.bvh;
+        const auto& model_matrix = transform_hierarchy.get().getWorldMatrix(
+            transform_node_component.node);
+
+        if (!is_cone_hit) {
+          is_cone_hit = bvh.intersectsCone(model_matrix, ray_origin,
+                                           ray_direction, half_angle);
+        }
+
+        // Without normalizing the direction, distances stay in world units
+        auto inverse_model_matrix = glm::inverse(model_matrix);
+        auto part_ray_origin =
+            glm::vec3(inverse_model_matrix * glm::vec4(ray_origin, 1.0f));
+        auto part_ray_direction =
+            glm::vec3(inverse_model_matrix * glm::vec4(ray_direction, 0.0f));
+
+        auto hit = bvh.intersectRay(
+            part_ray_origin, part_ray_direction,
+            pointer_hit.has_value() ? pointer_hit->distance
+                                    : std::numeric_limits<float>::infinity());
+        if (!hit.has_value()) {
+          return;
+        }
+
+        auto barycentrics = glm::vec3(1.0f - hit->u - hit->v, hit->u, hit->v);
+        pointer_hit = PickHit{
+            .paintable_index = paintable_index,
+            .part_handle = part_handle,
+            .distance = hit->distance,
+            .barycentrics = barycentrics,
+            .uv = getHitUv(shared_geometry_component.view,
+                           hit->triangle_index, barycentrics),
+        };
+      });
+
+  bounds_component.get().is_under_brush = is_cone_hit;
+  pick_component.get().is_cone_hit |= is_cone_hit;
+}
+
+#ifdef TARGET_EMSCRIPTEN
+emscripten::val getPointerHitValue(
+    std::reference_wrapper<PickComponent> pick_component) {
+  const auto& pointer_hit = pick_component.get().pointer_hit;
+  if (!pointer_hit.has_value()) {
+    return emscripten::val::null();
+  }
+
+  auto barycentrics = emscripten::val::array();
+  for (int i = 0; i < 3; i++) {
+    barycentrics.call<void>("push", pointer_hit->barycentrics[i]);
+  }
+
+  auto uv = emscripten::val::array();
+  uv.call<void>("push", pointer_hit->uv.x);
+  uv.call<void>("push", pointer_hit->uv.y);
+
+  auto hit = emscripten::val::object();
+  hit.set("paintableIndex", static_cast<double>(pointer_hit->paintable_index));
+  hit.set("partIndex", pointer_hit->part_handle.index);
+  hit.set("distance", pointer_hit->distance);
+  hit.set("barycentrics", barycentrics);
+  hit.set("uv", uv);
+
+  return hit;
+}
+#endif
+
+glm::vec2 getHitUv(const GeometryView& geometry_view, uint32_t triangle_index,
+                   const glm::vec3& barycentrics) {
+  const auto& vertices = geometry_view.vertices;
+
+  glm::vec2 uv = glm::vec2(0.0f);
+  for (int corner = 0; corner < 3; corner++) {
+    uv += unpackTexCoords(
+              vertices[geometry_view.getIndex(triangle_index * 3 + corner)]
+                  .tex_coords) *
+          barycentrics[corner];
+  }
+
+  return uv;
+}
+
+}  // namespace pick_system
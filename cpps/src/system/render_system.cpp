@@ -27,7 +27,11 @@
 #include <GLES3/gl3.h>  // OpenGL ES 3.0 for WebGL 2.0
 #include <emscripten/html5.h>
 
+#include <array>
+
+#include "./frame_arena.h"
 #include "./render_util.h"
+#include "./system/gr_sync_system.h"
 
 namespace render_system {
 
@@ -67,12 +71,8 @@ void adjustViewportSize(
   }
 }
 
-void render(
-    std::reference_wrapper<RenderConfigComponent> render_config_component,
-    std::reference_wrapper<MaterialComponent> material_component,
-    std::reference_wrapper<GrShaderManagerComponent>
-        gr_shader_manager_component,
-    std::reference_wrapper<RenderItemsView> render_items_view) {
+void clearCanvas(
+    std::reference_wrapper<RenderConfigComponent> render_config_component) {
   glViewport(0, 0, render_config_component.get().canvas_size.x,
              render_config_component.get().canvas_size.y);
 
@@ -80,29 +80,79 @@ void render(
   glClearColor(clear_color.r, clear_color.g, clear_color.b, clear_color.a);
 
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
 
+void render(
+    std::reference_wrapper<MaterialComponent> material_component,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrUniformComponent> gr_camera_uniform_component,
+    std::reference_wrapper<GrUniformComponent> gr_lighting_uniform_component,
+    std::reference_wrapper<EntityRegistry> part_registry) {
   auto shader_type = material_component.get().shader_type;
 
-  for (const auto& render_item : render_items_view.get().render_items) {
-    const auto& gr_geometry_component = render_item.gr_geometry_component;
-    const auto& gr_uniform_components = render_item.gr_uniform_components;
-    const auto& gr_texture_components = render_item.gr_texture_components;
-    const auto& gr_texture_components_ping_pong =
-        render_item.gr_ping_pong_texture_components;
-
-    auto merged_gr_textures =
-        std::vector<std::reference_wrapper<GrTextureComponent>>();
-    merged_gr_textures.insert(merged_gr_textures.end(),
-                              gr_texture_components.begin(),
-                              gr_texture_components.end());
-
-    for (const auto& gr_texture : gr_texture_components_ping_pong) {
-      merged_gr_textures.push_back(gr_texture.get().getCurrentFramedTexture());
+  for (auto [shared_geometry_component, gr_model_uniform_component,
+             gr_painted_ping_pong_texture_component] :
+       part_registry.get()
+           .query<SharedGeometryComponent, GrUniformComponent,
+                  GrPingPongTextureComponent>()) {
+    auto gr_uniform_components =
+        std::array<std::reference_wrapper<GrUniformComponent>, 3>{
+            gr_camera_uniform_component, gr_lighting_uniform_component,
+            std::ref(gr_model_uniform_component)};
+    auto gr_texture_components =
+        std::array<std::reference_wrapper<GrTextureComponent>, 1>{
+            gr_painted_ping_pong_texture_component.getCurrentFramedTexture()};
+
+    drawGrComponents(
+        shader_type, gr_shader_manager_component,
+        std::ref(*shared_geometry_component.gr_geometry_component),
+        gr_uniform_components, gr_texture_components);
+  }
+}
+
+void renderInstanced(
+    std::reference_wrapper<MaterialComponent> material_component,
+    std::reference_wrapper<GrShaderManagerComponent>
+        gr_shader_manager_component,
+    std::reference_wrapper<GrUniformComponent> gr_camera_uniform_component,
+    std::reference_wrapper<GrUniformComponent> gr_lighting_uniform_component,
+    std::reference_wrapper<GrUniformComponent> gr_instance_uniform_component,
+    std::reference_wrapper<InstanceBatchesView> instance_batches_view) {
+  auto shader_type =
+      getInstancedShaderType(material_component.get().shader_type);
+  auto gr_uniform_components =
+      std::array<std::reference_wrapper<GrUniformComponent>, 3>{
+          gr_camera_uniform_component, gr_lighting_uniform_component,
+          gr_instance_uniform_component};
+
+  for (const auto& render_batch :
+       instance_batches_view.get().render_batches.batches) {
+    if (render_batch.part_handles.empty()) {
+      continue;
+    }
+
+    gr_sync_system::updateInstanceUniform(
+        instance_batches_view.get().transform_hierarchy,
+        instance_batches_view.get().part_registry, render_batch,
+        gr_instance_uniform_component);
+
+    auto gr_painted_textures =
+        frame_arena::FrameVector<std::reference_wrapper<GrTextureComponent>>(
+            render_batch.part_handles.size());
+    for (const auto& part_handle : render_batch.part_handles) {
+      gr_painted_textures.push_back(
+          instance_batches_view.get()
+              .part_registry.get()
+              .get<GrPingPongTextureComponent>(part_handle)
+              .getCurrentFramedTexture());
     }
 
-    drawGrComponents(shader_type, gr_shader_manager_component,
-                     gr_geometry_component, gr_uniform_components,
-                     merged_gr_textures);
+    drawGrComponentsInstanced(shader_type, gr_shader_manager_component,
+                              render_batch.gr_geometry_component,
+                              gr_uniform_components, {},
+                              gr_painted_textures.span(),
+                              render_batch.part_handles.size());
   }
 }
 
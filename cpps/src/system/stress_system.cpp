@@ -0,0 +1,243 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./system/stress_system.h"
+
+#include <emscripten.h>
+
+#include <cstdio>
+#include <string>
+
+#include "./allocation_counter.h"
+#include "./gr_resource_registry.h"
+#include "./ray_kernels.h"
+#include "./stress_scene.h"
+
+namespace stress_system {
+
+StressPresetOptions getStressPresetOptions(
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    const StressTestCase& test_case);
+void finishStressTest(
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    std::reference_wrapper<ProfileComponent> profile_component);
+std::string getAllocationText(const StressTestResult& result);
+
+void startStressTest(
+    std::reference_wrapper<EventComponent> event_component,
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    std::reference_wrapper<ProfileComponent> profile_component) {
+  auto& stress_test = stress_test_component.get();
+
+  if (!stress_test.is_running) {
+    stress_test.is_running = true;
+    stress_test.current_case_index = 0;
+    stress_test.current_frame = 0;
+    stress_test.results.clear();
+
+    profile_component.get().is_enabled = false;
+    profile_component.get().sync_gpu = true;
+    profile_component.get().reset();
+
+    // Tells the runs of the SIMD and scalar flavors apart
+    printf(
+        "[stress] start: %zu cases, %d warmup + %d measured frames each, %s "
+        "build\n",
+        stress_test.cases.size(), stress_test.warmup_frames,
+        stress_test.measured_frames, ray_kernels::BACKEND_NAME);
+    if (!allocation_counter::isCounting()) {
+      printf(
+          "[stress] heap allocations are not counted, build with the stress "
+          "preset to check them\n");
+    }
+  }
+
+  event_component.get().run_stress_test = std::nullopt;
+}
+
+bool prepareCase(
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    std::reference_wrapper<ProfileComponent> profile_component,
+    std::reference_wrapper<RootManager> root_manager) {
+  auto& stress_test = stress_test_component.get();
+
+  if (stress_test.current_frame != 0) {
+    return false;
+  }
+
+  while (stress_test.current_case_index < stress_test.cases.size()) {
+    const auto& test_case = stress_test.cases[stress_test.current_case_index];
+    size_t case_bytes = estimatePaintableBytes(getStressPaintableDescriptors(
+        getStressPresetOptions(stress_test_component, test_case)));
+
+    if (case_bytes <= stress_test.max_case_bytes) {
+      break;
+    }
+
+    printf(
+        "[stress] skip: parts=%d map=%d camera=%.1f (%.1f MB over the "
+        "limit)\n",
+        test_case.part_count, test_case.painted_map_size,
+        test_case.camera_radius, case_bytes / (1024.0 * 1024.0));
+    stress_test.current_case_index++;
+  }
+
+  if (stress_test.current_case_index >= stress_test.cases.size()) {
+    finishStressTest(stress_test_component, profile_component);
+    root_manager.get().resetPaintable(PaintablePreset::CUBE);
+    root_manager.get().camera_entity->camera_component->reset();
+    return true;
+  }
+
+  const auto& test_case = stress_test.cases[stress_test.current_case_index];
+
+  gr_resource_registry::resetPeakBytes();
+  root_manager.get().resetPaintable(
+      getStressPresetOptions(stress_test_component, test_case));
+
+  auto& camera_component = *root_manager.get().camera_entity->camera_component;
+  camera_component.radius = test_case.camera_radius;
+  camera_component.needs_update = true;
+
+  return true;
+}
+
+void driveScriptedStroke(
+    float elapsed_ms,
+    std::reference_wrapper<RenderConfigComponent> render_config_component,
+    std::reference_wrapper<InputComponent> input_component) {
+  stress_scene::driveScriptedStroke(elapsed_ms,
+                                    render_config_component.get().canvas_size,
+                                    input_component.get());
+}
+
+void recordFrame(
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    std::reference_wrapper<ProfileComponent> profile_component) {
+  auto& stress_test = stress_test_component.get();
+  auto& profile = profile_component.get();
+
+  stress_test.current_frame++;
+
+  if (stress_test.current_frame == stress_test.warmup_frames) {
+    profile.reset();
+    profile.is_enabled = true;
+    stress_test.case_start_ms = emscripten_get_now();
+    stress_test.case_start_allocation_count =
+        allocation_counter::getAllocationCount();
+    return;
+  }
+
+  if (stress_test.current_frame <
+      stress_test.warmup_frames + stress_test.measured_frames) {
+    return;
+  }
+
+  // Counted before building the report below, which allocates
+  size_t allocation_count = allocation_counter::getAllocationCount() -
+                            stress_test.case_start_allocation_count;
+
+  const auto& test_case = stress_test.cases[stress_test.current_case_index];
+
+  StressTestResult result = {
+      .test_case = test_case,
+      .frame_ms = (emscripten_get_now() - stress_test.case_start_ms) /
+                  stress_test.measured_frames,
+      .gr_live_bytes = gr_resource_registry::getLiveBytes(),
+      .gr_peak_bytes = gr_resource_registry::getPeakBytes(),
+      .allocation_count = allocation_count,
+      .system_report = {},
+  };
+
+  char line[128];
+  for (const auto& sample : profile.samples) {
+    snprintf(line, sizeof(line), " %s=%.3f(max %.3f)", sample.name,
+             sample.total_ms / stress_test.measured_frames, sample.max_ms);
+    result.system_report += line;
+  }
+
+  printf(
+      "[stress] parts=%d map=%d camera=%.1f frame=%.3fms gpu=%.1fMB "
+      "peak=%.1fMB allocs=%s |%s\n",
+      test_case.part_count, test_case.painted_map_size,
+      test_case.camera_radius, result.frame_ms,
+      result.gr_live_bytes / (1024.0 * 1024.0),
+      result.gr_peak_bytes / (1024.0 * 1024.0),
+      getAllocationText(result).c_str(), result.system_report.c_str());
+
+  if (result.allocation_count > 0) {
+    printf("[stress] FAIL: %zu heap allocations in %d steady frames\n",
+           result.allocation_count, stress_test.measured_frames);
+  }
+
+  stress_test.results.push_back(result);
+
+  profile.is_enabled = false;
+  stress_test.current_case_index++;
+  stress_test.current_frame = 0;
+}
+
+void finishStressTest(
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    std::reference_wrapper<ProfileComponent> profile_component) {
+  auto& stress_test = stress_test_component.get();
+
+  printf("[stress] done\n");
+  printf(
+      "[stress] parts,painted_map_size,camera_radius,frame_ms,gpu_mb,"
+      "gpu_peak_mb,allocations\n");
+  for (const auto& result : stress_test.results) {
+    printf("[stress] %d,%d,%.1f,%.3f,%.1f,%.1f,%s\n",
+           result.test_case.part_count, result.test_case.painted_map_size,
+           result.test_case.camera_radius, result.frame_ms,
+           result.gr_live_bytes / (1024.0 * 1024.0),
+           result.gr_peak_bytes / (1024.0 * 1024.0),
+           getAllocationText(result).c_str());
+  }
+
+  stress_test.is_running = false;
+  profile_component.get().is_enabled = false;
+  profile_component.get().sync_gpu = false;
+}
+
+StressPresetOptions getStressPresetOptions(
+    std::reference_wrapper<StressTestComponent> stress_test_component,
+    const StressTestCase& test_case) {
+  return {
+      .part_count = test_case.part_count,
+      .geometry_segments = stress_test_component.get().geometry_segments,
+      .painted_map_size = test_case.painted_map_size,
+      .layout = stress_test_component.get().layout,
+  };
+}
+
+// A dash in builds not counting allocations, rather than a misleading 0
+std::string getAllocationText(const StressTestResult& result) {
+  if (!allocation_counter::isCounting()) {
+    return "-";
+  }
+  return std::to_string(result.allocation_count);
+}
+
+}  // namespace stress_system
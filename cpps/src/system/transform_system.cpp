@@ -59,7 +59,7 @@ void transformCamera(float delta_ms,
   }
 }
 
-void transformPaintable(
+void transformScene(
     float delta_ms, std::reference_wrapper<InputComponent> input_component,
     std::reference_wrapper<CameraComponent> camera_component,
     std::reference_wrapper<TransformComponent> transform_component) {
@@ -109,6 +109,54 @@ void transformPaintable(
   }
 }
 
+void transformBrush(
+    std::reference_wrapper<InputComponent> input_component,
+    std::reference_wrapper<RenderConfigComponent> render_config_component,
+    std::reference_wrapper<CameraComponent> camera_component,
+    std::reference_wrapper<BrushComponent> brush_component) {
+  const auto& pointer_position = input_component.get().pointer_position;
+  const auto& canvas_size = render_config_component.get().canvas_size;
+
+  auto eye_position = getPositionOnSphere(camera_component.get().radius,
+                                          camera_component.get().phi,
+                                          camera_component.get().theta);
+
+  auto camera_up =
+      getUpOnSphere(camera_component.get().phi, camera_component.get().theta);
+
+  auto camera_view_matrix =
+      glm::lookAt(eye_position, glm::vec3(0.0f), camera_up);
+
+  auto ray_direction = getRayDirectionFromScreen(
+      glm::vec2(pointer_position.x, pointer_position.y), glm::vec2(canvas_size),
+      camera_component.get().fovy, camera_view_matrix);
+
+  brush_component.get().position =
+      eye_position + ray_direction * glm::vec3(0.1);
+  brush_component.get().direction = ray_direction;
+  brush_component.get().up = camera_up;
+}
+
+void syncTransformNode(
+    std::reference_wrapper<TransformComponent> transform_component,
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy) {
+  if (!transform_component.get().needs_update) {
+    return;
+  }
+
+  transform_hierarchy.get().setLocal(transform_component.get().node,
+                                     transform_component.get().scale,
+                                     transform_component.get().rotation,
+                                     transform_component.get().translation);
+
+  transform_component.get().needs_update = false;
+}
+
+void updateWorldMatrices(
+    std::reference_wrapper<TransformHierarchy> transform_hierarchy) {
+  transform_hierarchy.get().update();
+}
+
 float modulateRotation(float angle) {
   float range = -glm::two_pi<float>();
 
@@ -0,0 +1,232 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./system_scheduler.h"
+
+#include <GLES3/gl3.h>
+#include <emscripten.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+#include "./job_system.h"
+
+bool hasCommonResource(const std::vector<size_t>& resource_ids,
+                       const std::vector<size_t>& other_resource_ids) {
+  return std::any_of(resource_ids.begin(), resource_ids.end(),
+                     [&other_resource_ids](size_t resource_id) {
+                       return std::find(other_resource_ids.begin(),
+                                        other_resource_ids.end(),
+                                        resource_id) !=
+                              other_resource_ids.end();
+                     });
+}
+
+bool hasConflict(const SystemDescriptor& system,
+                 const SystemDescriptor& other_system) {
+  if (system.thread == SystemThread::CONTEXT &&
+      other_system.thread == SystemThread::CONTEXT) {
+    return true;
+  }
+
+  return hasCommonResource(system.writes, other_system.reads) ||
+         hasCommonResource(system.writes, other_system.writes) ||
+         hasCommonResource(system.reads, other_system.writes);
+}
+
+void SystemScheduler::add(SystemDescriptor system_descriptor) {
+  if (is_built) {
+    throw std::runtime_error("Cannot add systems after building the graph");
+  }
+
+  nodes.push_back({
+      .descriptor = std::move(system_descriptor),
+      .dependents = {},
+      .ready_dependents = {},
+  });
+}
+
+void SystemScheduler::build() {
+  for (size_t i = 0; i < nodes.size(); i++) {
+    for (size_t j = i + 1; j < nodes.size(); j++) {
+      if (hasConflict(nodes[i].descriptor, nodes[j].descriptor)) {
+        nodes[i].dependents.push_back(j);
+        nodes[j].dependency_count++;
+      }
+    }
+  }
+
+  for (auto& node : nodes) {
+    node.ready_dependents.reserve(node.dependents.size());
+  }
+  context_queue.reserve(nodes.size());
+
+  is_built = true;
+}
+
+void SystemScheduler::run(
+    float elapsed_ms, float delta_ms,
+    std::reference_wrapper<ProfileComponent> profile_component) {
+  if (!is_built) {
+    throw std::runtime_error("SystemScheduler::build was not called");
+  }
+
+  auto& profile = profile_component.get();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& node : nodes) {
+      node.remaining_dependency_count = node.dependency_count;
+    }
+    context_queue.clear();
+    context_queue_head = 0;
+    queued_job_count = 0;
+    remaining_count = nodes.size();
+    frame_elapsed_ms = elapsed_ms;
+    frame_delta_ms = delta_ms;
+    sync_gpu = profile.is_enabled && profile.sync_gpu;
+  }
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (nodes[i].dependency_count == 0) {
+      dispatch(i);
+    }
+  }
+
+  while (true) {
+    size_t node_index;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      condition.wait(lock, [this] {
+        return context_queue_head < context_queue.size() ||
+               queued_job_count > 0 || remaining_count == 0;
+      });
+      if (remaining_count == 0) {
+        break;
+      }
+      if (context_queue_head == context_queue.size()) {
+        lock.unlock();
+        // Runs ANY systems meanwhile, so they keep going while the workers
+        // are busy, e.g. with a background job
+        if (!job_system::runPendingJob()) {
+          std::this_thread::yield();
+        }
+        continue;
+      }
+      node_index = context_queue[context_queue_head++];
+    }
+
+    runNode(node_index);
+  }
+
+  if (!profile.is_enabled) {
+    return;
+  }
+
+  for (const auto& node : nodes) {
+    if (!node.is_skipped) {
+      profile.record(node.descriptor.name, node.elapsed_ms);
+    }
+  }
+}
+
+void SystemScheduler::dispatch(size_t node_index) {
+  // Without workers, ANY systems run on the calling thread too
+  if (nodes[node_index].descriptor.thread == SystemThread::CONTEXT ||
+      job_system::getWorkerCount() == 0) {
+    std::lock_guard<std::mutex> lock(mutex);
+    context_queue.push_back(node_index);
+    // Notifying under the lock keeps run from returning, and the scheduler
+    // from being destroyed, while a worker still uses the condition
+    condition.notify_one();
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued_job_count++;
+    condition.notify_one();
+  }
+  job_system::submit([this, node_index] { runNode(node_index); });
+}
+
+void SystemScheduler::runNode(size_t node_index) {
+  auto& node = nodes[node_index];
+  const auto& descriptor = node.descriptor;
+
+  if (descriptor.thread == SystemThread::ANY &&
+      job_system::getWorkerCount() > 0) {
+    std::lock_guard<std::mutex> lock(mutex);
+    queued_job_count--;
+  }
+
+  node.is_skipped = descriptor.is_active && !descriptor.is_active();
+
+  if (!node.is_skipped) {
+    // Include the GL work of the system, as ProfileScope does
+    bool is_gpu_synced = sync_gpu && descriptor.thread == SystemThread::CONTEXT;
+    if (is_gpu_synced) {
+      glFinish();
+    }
+
+    double start_ms = emscripten_get_now();
+    descriptor.run(frame_elapsed_ms, frame_delta_ms);
+
+    if (is_gpu_synced) {
+      glFinish();
+    }
+    node.elapsed_ms = emscripten_get_now() - start_ms;
+  }
+
+  completeNode(node_index);
+}
+
+void SystemScheduler::completeNode(size_t node_index) {
+  // Only the thread completing the node touches its ready_dependents
+  auto& ready_node_indices = nodes[node_index].ready_dependents;
+  ready_node_indices.clear();
+  size_t ready_count = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto dependent_index : nodes[node_index].dependents) {
+      if (--nodes[dependent_index].remaining_dependency_count == 0) {
+        ready_node_indices.push_back(dependent_index);
+      }
+    }
+
+    ready_count = ready_node_indices.size();
+
+    if (--remaining_count == 0) {
+      condition.notify_all();
+    }
+  }
+
+  // Once the lock is released, run may return and the scheduler be destroyed
+  // unless a ready node is still to be dispatched. So the scheduler is not
+  // touched after the last dispatch, or at all if no node got ready.
+  for (size_t i = 0; i < ready_count; i++) {
+    dispatch(ready_node_indices[i]);
+  }
+}
@@ -0,0 +1,923 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "./uv_atlas.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
+#include "./Component/GrTextureComponent.h"
+#include "./job_system.h"
+#include "./math_util.h"
+
+namespace uv_atlas {
+
+namespace {
+
+constexpr uint32_t NO_FACE = UINT32_MAX;
+constexpr uint32_t NO_CHART = UINT32_MAX;
+
+// Planar projection shrinks a face tilted by 45 degrees to 71% of its length
+// across the tilt, which keeps the texel density of a chart close to even
+constexpr float CHART_MAX_ANGLE_COS = 0.7071f;
+
+// Original UVs with more overlapping texels than this are replaced
+constexpr float MAX_UV_OVERLAP = 0.01f;
+constexpr int UV_LAYOUT_RESOLUTION = 512;
+
+// First and last texel of each row, or an empty span
+struct TexelSpan {
+  int begin;
+  int end;
+};
+
+// Texels of a chart at some density and orientation. `spans` are the texels
+// the faces touch, `padded_spans` the texels no other chart may touch. Holes
+// within a row count as covered.
+struct ChartMask {
+  int width;
+  int height;
+  // Offset of the chart within the mask, which is the padding
+  int padding;
+  std::vector<TexelSpan> spans;
+  std::vector<TexelSpan> padded_spans;
+};
+
+struct Chart {
+  std::vector<uint32_t> faces;
+  glm::vec3 normal;
+
+  // Range of the chart's vertices in the atlas, see splitChartVertices
+  size_t vertex_begin;
+  size_t vertex_end;
+  // Size of the projected chart in units of length, and area of its faces
+  glm::vec2 size;
+  float area;
+
+  // Rows of texels the chart covers, and the same rows grown by the padding,
+  // as rasterized for the current texel density
+  ChartMask mask;
+  ChartMask rotated_mask;
+
+  // Corner of the mask in the atlas, in texels
+  int x;
+  int y;
+  // Turned by 90 degrees
+  bool is_rotated;
+};
+
+struct PositionHash {
+  size_t operator()(const glm::vec3& position) const {
+    uint32_t bits[3];
+    std::memcpy(bits, &position, sizeof(bits));
+    return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^
+           (bits[2] * 83492791u);
+  }
+};
+
+// Id of the position of every vertex, shared by vertices that only differ in
+// their normal or texture coordinates
+std::vector<uint32_t> weldPositions(const std::vector<Vertex>& vertices) {
+  std::unordered_map<glm::vec3, uint32_t, PositionHash> position_ids;
+  position_ids.reserve(vertices.size());
+
+  std::vector<uint32_t> vertex_position_ids(vertices.size());
+  for (size_t i = 0; i < vertices.size(); i++) {
+    // Adding zero turns -0 into 0, which compares equal but hashes apart
+    auto position = vertices[i].position + glm::vec3(0.0f);
+    auto [it, is_new] = position_ids.emplace(
+        position, static_cast<uint32_t>(position_ids.size()));
+    vertex_position_ids[i] = it->second;
+  }
+
+  return vertex_position_ids;
+}
+
+// Face across each edge of each face, or NO_FACE at borders and at edges
+// shared by more than two faces
+std::vector<uint32_t> findNeighbors(
+    const std::vector<unsigned int>& indices,
+    const std::vector<uint32_t>& vertex_position_ids) {
+  struct EdgeEntry {
+    uint64_t key;
+    uint32_t corner;
+  };
+
+  std::vector<EdgeEntry> edges(indices.size());
+  job_system::parallelFor(
+      0, indices.size() / 3, 4096, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t face = chunk_begin; face < chunk_end; face++) {
+          for (size_t corner = face * 3; corner < face * 3 + 3; corner++) {
+            size_t next_corner = corner % 3 == 2 ? corner - 2 : corner + 1;
+            uint64_t a = vertex_position_ids[indices[corner]];
+            uint64_t b = vertex_position_ids[indices[next_corner]];
+            edges[corner] = {
+                .key = a == b ? UINT64_MAX
+                              : (std::min(a, b) << 32) | std::max(a, b),
+                .corner = static_cast<uint32_t>(corner),
+            };
+          }
+        }
+      });
+
+  std::sort(edges.begin(), edges.end(),
+            [](const EdgeEntry& a, const EdgeEntry& b) {
+              return a.key < b.key;
+            });
+
+  std::vector<uint32_t> neighbors(indices.size(), NO_FACE);
+  for (size_t begin = 0, end = 0; begin < edges.size(); begin = end) {
+    end = begin + 1;
+    while (end < edges.size() && edges[end].key == edges[begin].key) {
+      end++;
+    }
+
+    if (end - begin == 2 && edges[begin].key != UINT64_MAX) {
+      neighbors[edges[begin].corner] = edges[begin + 1].corner / 3;
+      neighbors[edges[begin + 1].corner] = edges[begin].corner / 3;
+    }
+  }
+
+  return neighbors;
+}
+
+// Grows charts from seed faces in order, adding neighbors within
+// CHART_MAX_ANGLE_COS of the average normal so far. Faces that end up facing
+// away from the final average normal, which the projection would flip, are
+// handed to later charts. Degenerate faces join any neighbor.
+std::vector<Chart> growCharts(const std::vector<glm::vec3>& face_normals,
+                              const std::vector<uint32_t>& neighbors) {
+  size_t face_count = face_normals.size();
+  std::vector<uint32_t> face_charts(face_count, NO_CHART);
+  std::vector<uint32_t> ejected_faces;
+  std::vector<Chart> charts;
+
+  auto grow = [&](uint32_t seed) {
+    auto chart_index = static_cast<uint32_t>(charts.size());
+    auto& chart = charts.emplace_back();
+    glm::vec3 normal_sum = face_normals[seed];
+
+    face_charts[seed] = chart_index;
+    chart.faces.push_back(seed);
+
+    for (size_t head = 0; head < chart.faces.size(); head++) {
+      uint32_t face = chart.faces[head];
+      float normal_sum_length = glm::length(normal_sum);
+      glm::vec3 chart_normal = normal_sum_length > 0.0f
+                                   ? normal_sum / normal_sum_length
+                                   : glm::vec3(0.0f);
+
+      for (uint32_t corner = face * 3; corner < face * 3 + 3; corner++) {
+        uint32_t neighbor = neighbors[corner];
+        if (neighbor == NO_FACE || face_charts[neighbor] != NO_CHART) {
+          continue;
+        }
+
+        // Face normals are scaled by twice the face area
+        const auto& neighbor_normal = face_normals[neighbor];
+        if (glm::dot(neighbor_normal, chart_normal) <
+            CHART_MAX_ANGLE_COS * glm::length(neighbor_normal)) {
+          continue;
+        }
+
+        face_charts[neighbor] = chart_index;
+        normal_sum += neighbor_normal;
+        chart.faces.push_back(neighbor);
+      }
+    }
+
+    float normal_sum_length = glm::length(normal_sum);
+    chart.normal = normal_sum_length > 0.0f ? normal_sum / normal_sum_length
+                                            : glm::vec3(0.0f, 0.0f, 1.0f);
+
+    auto facing_away = std::remove_if(
+        chart.faces.begin() + 1, chart.faces.end(), [&](uint32_t face) {
+          const auto& face_normal = face_normals[face];
+          return glm::dot(face_normal, chart.normal) <= 0.0f &&
+                 glm::dot(face_normal, face_normal) > 0.0f;
+        });
+    for (auto it = facing_away; it != chart.faces.end(); ++it) {
+      face_charts[*it] = NO_CHART;
+      ejected_faces.push_back(*it);
+    }
+    chart.faces.erase(facing_away, chart.faces.end());
+  };
+
+  // Degenerate faces have no normal to grow a chart around
+  for (uint32_t face = 0; face < face_count; face++) {
+    const auto& face_normal = face_normals[face];
+    if (face_charts[face] == NO_CHART &&
+        glm::dot(face_normal, face_normal) > 0.0f) {
+      grow(face);
+    }
+  }
+  for (size_t i = 0; i < ejected_faces.size(); i++) {
+    if (face_charts[ejected_faces[i]] == NO_CHART) {
+      grow(ejected_faces[i]);
+    }
+  }
+  for (uint32_t face = 0; face < face_count; face++) {
+    if (face_charts[face] == NO_CHART) {
+      grow(face);
+    }
+  }
+
+  return charts;
+}
+
+float cross2d(const glm::vec2& a, const glm::vec2& b) {
+  return a.x * b.y - a.y * b.x;
+}
+
+// Counterclockwise hull of `points`, by Andrew's monotone chain
+std::vector<glm::vec2> getConvexHull(std::vector<glm::vec2> points) {
+  std::sort(points.begin(), points.end(),
+            [](const glm::vec2& a, const glm::vec2& b) {
+              return a.x < b.x || (a.x == b.x && a.y < b.y);
+            });
+  if (points.size() < 3) {
+    return points;
+  }
+
+  std::vector<glm::vec2> hull(points.size() * 2);
+  size_t hull_size = 0;
+  auto add_point = [&](const glm::vec2& point, size_t min_size) {
+    while (hull_size >= min_size &&
+           cross2d(hull[hull_size - 1] - hull[hull_size - 2],
+                   point - hull[hull_size - 2]) <= 0.0f) {
+      hull_size--;
+    }
+    hull[hull_size++] = point;
+  };
+
+  for (const auto& point : points) {
+    add_point(point, 2);
+  }
+  size_t lower_size = hull_size + 1;
+  for (size_t i = points.size() - 1; i-- > 0;) {
+    add_point(points[i], lower_size);
+  }
+
+  hull.resize(hull_size - 1);
+  return hull;
+}
+
+// Gives every chart its own copy of the vertices of its faces, in chart
+// order, writing the indices of the atlas and returning the source vertex of
+// every atlas vertex
+std::vector<uint32_t> splitChartVertices(
+    std::vector<Chart>& charts, const std::vector<unsigned int>& indices,
+    size_t vertex_count, std::vector<unsigned int>& atlas_indices) {
+  // Chart that last copied each source vertex, and where to
+  std::vector<uint32_t> vertex_charts(vertex_count, NO_CHART);
+  std::vector<uint32_t> vertex_copies(vertex_count);
+  std::vector<uint32_t> source_vertices;
+  source_vertices.reserve(vertex_count);
+
+  for (uint32_t chart_index = 0; chart_index < charts.size(); chart_index++) {
+    auto& chart = charts[chart_index];
+    chart.vertex_begin = source_vertices.size();
+
+    for (uint32_t face : chart.faces) {
+      for (uint32_t corner = face * 3; corner < face * 3 + 3; corner++) {
+        uint32_t vertex = indices[corner];
+        if (vertex_charts[vertex] != chart_index) {
+          vertex_charts[vertex] = chart_index;
+          vertex_copies[vertex] = static_cast<uint32_t>(source_vertices.size());
+          source_vertices.push_back(vertex);
+        }
+        atlas_indices[corner] = vertex_copies[vertex];
+      }
+    }
+
+    chart.vertex_end = source_vertices.size();
+  }
+
+  return source_vertices;
+}
+
+// Projects the chart onto the plane of its normal, then rotates it to the
+// smallest bounding rectangle, which has a side along an edge of the convex
+// hull. Rotations keep the winding of the faces. Positions are written to the
+// chart's range of `positions`, with the rectangle's corner at the origin.
+void parameterizeChart(Chart& chart, const std::vector<Vertex>& vertices,
+                       const std::vector<uint32_t>& source_vertices,
+                       const std::vector<unsigned int>& atlas_indices,
+                       std::vector<glm::vec2>& positions) {
+  const auto& normal = chart.normal;
+  glm::vec3 tangent = glm::normalize(glm::cross(
+      normal, std::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f)
+                                        : glm::vec3(0.0f, 1.0f, 0.0f)));
+  glm::vec3 bitangent = glm::cross(normal, tangent);
+
+  auto chart_positions =
+      std::span(positions).subspan(chart.vertex_begin,
+                                   chart.vertex_end - chart.vertex_begin);
+  for (size_t i = 0; i < chart_positions.size(); i++) {
+    const auto& position =
+        vertices[source_vertices[chart.vertex_begin + i]].position;
+    chart_positions[i] =
+        glm::vec2(glm::dot(position, tangent), glm::dot(position, bitangent));
+  }
+
+  auto hull = getConvexHull(
+      std::vector<glm::vec2>(chart_positions.begin(), chart_positions.end()));
+  glm::vec2 best_axis = glm::vec2(1.0f, 0.0f);
+  float best_area = std::numeric_limits<float>::max();
+  for (size_t i = 0; i < hull.size(); i++) {
+    glm::vec2 edge = hull[(i + 1) % hull.size()] - hull[i];
+    float edge_length = glm::length(edge);
+    if (edge_length <= 0.0f) {
+      continue;
+    }
+
+    glm::vec2 axis = edge / edge_length;
+    glm::vec2 min_corner = glm::vec2(std::numeric_limits<float>::max());
+    glm::vec2 max_corner = glm::vec2(std::numeric_limits<float>::lowest());
+    for (const auto& point : hull) {
+      glm::vec2 rotated =
+          glm::vec2(glm::dot(point, axis), cross2d(axis, point));
+      min_corner = glm::min(min_corner, rotated);
+      max_corner = glm::max(max_corner, rotated);
+    }
+
+    glm::vec2 size = max_corner - min_corner;
+    if (size.x * size.y < best_area) {
+      best_area = size.x * size.y;
+      best_axis = axis;
+    }
+  }
+
+  glm::vec2 min_corner = glm::vec2(std::numeric_limits<float>::max());
+  glm::vec2 max_corner = glm::vec2(std::numeric_limits<float>::lowest());
+  for (auto& position : chart_positions) {
+    position = glm::vec2(glm::dot(position, best_axis),
+                         cross2d(best_axis, position));
+    min_corner = glm::min(min_corner, position);
+    max_corner = glm::max(max_corner, position);
+  }
+  for (auto& position : chart_positions) {
+    position -= min_corner;
+  }
+  chart.size = chart_positions.empty() ? glm::vec2(0.0f)
+                                       : max_corner - min_corner;
+
+  chart.area = 0.0f;
+  for (uint32_t face : chart.faces) {
+    const auto& a = positions[atlas_indices[face * 3]];
+    const auto& b = positions[atlas_indices[face * 3 + 1]];
+    const auto& c = positions[atlas_indices[face * 3 + 2]];
+    chart.area += 0.5f * std::abs(cross2d(b - a, c - a));
+  }
+}
+
+// Position of a chart vertex in its mask, in texels
+glm::vec2 getMaskPosition(const Chart& chart, const glm::vec2& position,
+                          float texel_density, bool is_rotated,
+                          int padding) {
+  // Turning by 90 degrees keeps the winding
+  glm::vec2 texel_position =
+      is_rotated ? glm::vec2(position.y, chart.size.x - position.x)
+                 : position;
+  return texel_position * texel_density + static_cast<float>(padding);
+}
+
+// Rasterizes the rows of texels the faces touch, conservatively, then grows
+// them by the padding
+ChartMask rasterizeChart(const Chart& chart,
+                         const std::vector<glm::vec2>& positions,
+                         const std::vector<unsigned int>& atlas_indices,
+                         float texel_density, bool is_rotated, int padding) {
+  glm::vec2 size = is_rotated ? glm::vec2(chart.size.y, chart.size.x)
+                              : chart.size;
+
+  ChartMask mask;
+  mask.padding = padding;
+  mask.width =
+      static_cast<int>(std::ceil(size.x * texel_density)) + 1 + padding * 2;
+  mask.height =
+      static_cast<int>(std::ceil(size.y * texel_density)) + 1 + padding * 2;
+  mask.spans.assign(mask.height, {mask.width, -1});
+
+  auto add_texels = [&mask](int row, float x0, float x1) {
+    auto& span = mask.spans[std::clamp(row, 0, mask.height - 1)];
+    span.begin = std::min(
+        span.begin, std::clamp(static_cast<int>(x0), 0, mask.width - 1));
+    span.end = std::max(
+        span.end, std::clamp(static_cast<int>(x1), 0, mask.width - 1));
+  };
+
+  for (uint32_t face : chart.faces) {
+    glm::vec2 corners[3];
+    for (int k = 0; k < 3; k++) {
+      const auto& position = positions[atlas_indices[face * 3 + k]];
+      corners[k] = getMaskPosition(chart, position, texel_density, is_rotated,
+                                   padding);
+    }
+
+    float min_y = std::min({corners[0].y, corners[1].y, corners[2].y});
+    float max_y = std::max({corners[0].y, corners[1].y, corners[2].y});
+    for (int row = static_cast<int>(min_y); row <= static_cast<int>(max_y);
+         row++) {
+      // Extent of the face within the row, from the corners inside it and
+      // the edges crossing its borders
+      float row_min = static_cast<float>(row);
+      float row_max = row_min + 1.0f;
+      float x0 = std::numeric_limits<float>::max();
+      float x1 = std::numeric_limits<float>::lowest();
+
+      for (int k = 0; k < 3; k++) {
+        const auto& a = corners[k];
+        const auto& b = corners[(k + 1) % 3];
+        if (a.y >= row_min && a.y <= row_max) {
+          x0 = std::min(x0, a.x);
+          x1 = std::max(x1, a.x);
+        }
+        for (float border : {row_min, row_max}) {
+          if ((a.y - border) * (b.y - border) < 0.0f) {
+            float x = a.x + (b.x - a.x) * (border - a.y) / (b.y - a.y);
+            x0 = std::min(x0, x);
+            x1 = std::max(x1, x);
+          }
+        }
+      }
+
+      if (x0 <= x1) {
+        add_texels(row, x0, x1);
+      }
+    }
+  }
+
+  mask.padded_spans.assign(mask.height, {mask.width, -1});
+  for (int row = 0; row < mask.height; row++) {
+    const auto& span = mask.spans[row];
+    if (span.begin > span.end) {
+      continue;
+    }
+
+    for (int padded_row = std::max(0, row - padding);
+         padded_row <= std::min(mask.height - 1, row + padding);
+         padded_row++) {
+      auto& padded_span = mask.padded_spans[padded_row];
+      padded_span.begin =
+          std::min(padded_span.begin, std::max(0, span.begin - padding));
+      padded_span.end = std::max(padded_span.end,
+                                 std::min(mask.width - 1, span.end + padding));
+    }
+  }
+
+  return mask;
+}
+
+// Which texels of the atlas are taken, one bit per texel
+class AtlasBitmap {
+ public:
+  explicit AtlasBitmap(int size)
+      : size(size),
+        words_per_row((size + 63) / 64),
+        words(static_cast<size_t>(words_per_row) * size, 0) {}
+
+  // Last taken texel of the row within [begin, end], or -1
+  int findLastTaken(int row, int begin, int end) const {
+    const uint64_t* row_words =
+        &words[static_cast<size_t>(row) * words_per_row];
+
+    for (int word = end / 64; word >= begin / 64; word--) {
+      uint64_t bits = row_words[word];
+      if (word == end / 64) {
+        bits &= ~uint64_t(0) >> (63 - end % 64);
+      }
+      if (word == begin / 64) {
+        bits &= ~uint64_t(0) << (begin % 64);
+      }
+      if (bits != 0) {
+        return word * 64 + 63 - std::countl_zero(bits);
+      }
+    }
+
+    return -1;
+  }
+
+  void take(int row, int begin, int end) {
+    uint64_t* row_words = &words[static_cast<size_t>(row) * words_per_row];
+
+    for (int word = begin / 64; word <= end / 64; word++) {
+      uint64_t bits = ~uint64_t(0);
+      if (word == end / 64) {
+        bits &= ~uint64_t(0) >> (63 - end % 64);
+      }
+      if (word == begin / 64) {
+        bits &= ~uint64_t(0) << (begin % 64);
+      }
+      row_words[word] |= bits;
+    }
+  }
+
+  // Lowest, then leftmost corner where the padded mask touches no taken
+  // texel. A blocked row tells how far right the mask has to move at least,
+  // which skips most positions.
+  std::optional<glm::ivec2> findPlace(const ChartMask& mask) const {
+    for (int y = 0; y + mask.height <= size; y++) {
+      int x = 0;
+      while (x + mask.width <= size) {
+        bool is_blocked = false;
+
+        for (int row = 0; row < mask.height; row++) {
+          const auto& span = mask.padded_spans[row];
+          if (span.begin > span.end) {
+            continue;
+          }
+
+          int taken = findLastTaken(y + row, x + span.begin, x + span.end);
+          if (taken >= 0) {
+            x = taken - span.begin + 1;
+            is_blocked = true;
+            break;
+          }
+        }
+
+        if (!is_blocked) {
+          return glm::ivec2(x, y);
+        }
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  void place(const ChartMask& mask, const glm::ivec2& corner) {
+    for (int row = 0; row < mask.height; row++) {
+      const auto& span = mask.spans[row];
+      if (span.begin <= span.end) {
+        take(corner.y + row, corner.x + span.begin, corner.x + span.end);
+      }
+    }
+  }
+
+ private:
+  int size;
+  int words_per_row;
+  std::vector<uint64_t> words;
+};
+
+// Places the charts, largest first, into a square of `size` texels, each in
+// the orientation that lands it lowest. Returns false if they do not fit.
+bool packCharts(std::vector<Chart>& charts,
+                const std::vector<uint32_t>& order, int size) {
+  AtlasBitmap bitmap(size);
+
+  for (uint32_t chart_index : order) {
+    auto& chart = charts[chart_index];
+
+    auto place = bitmap.findPlace(chart.mask);
+    auto rotated_place = bitmap.findPlace(chart.rotated_mask);
+    if (!place && !rotated_place) {
+      return false;
+    }
+
+    chart.is_rotated = !place || (rotated_place &&
+                                  (rotated_place->y < place->y ||
+                                   (rotated_place->y == place->y &&
+                                    rotated_place->x < place->x)));
+    auto corner = chart.is_rotated ? *rotated_place : *place;
+    chart.x = corner.x;
+    chart.y = corner.y;
+    bitmap.place(chart.is_rotated ? chart.rotated_mask : chart.mask, corner);
+  }
+
+  return true;
+}
+
+int getPaintedMapSize(float texel_density, float surface_area,
+                      float uv_area) {
+  return static_cast<int>(
+      std::ceil(texel_density * std::sqrt(surface_area / uv_area)));
+}
+
+}  // namespace
+
+PartUvReport packImportedPart(mesh_import::ImportedPart& part,
+                              float texel_density) {
+  auto& geometry_component = part.geometry_component;
+  auto layout = measureUvLayout(geometry_component, UV_LAYOUT_RESOLUTION);
+
+  PartUvReport report = {
+      .is_repacked = false,
+      .chart_count = 0,
+      .original_utilization = layout.utilization,
+      .original_painted_map_size =
+          layout.uv_area > 0.0f
+              ? getPaintedMapSize(texel_density, layout.surface_area,
+                                  layout.uv_area)
+              : 0,
+      .utilization = layout.utilization,
+      .painted_map_size = DEFAULT_PAINTED_MAP_SIZE,
+  };
+  if (report.original_painted_map_size > 0) {
+    report.painted_map_size = report.original_painted_map_size;
+  }
+
+  // Keeps the original UVs if the atlas fails, e.g. with more charts than the
+  // largest map holds
+  std::optional<UvAtlas> atlas;
+  try {
+    atlas = buildUvAtlas(geometry_component,
+                         {.texel_density = texel_density});
+  } catch (const std::exception&) {
+  }
+
+  bool is_original_valid = report.original_painted_map_size > 0 &&
+                           layout.overlap <= MAX_UV_OVERLAP;
+  if (atlas && (!is_original_valid || report.original_painted_map_size >
+                                          atlas->stats.painted_map_size)) {
+    geometry_component = std::move(atlas->geometry_component);
+    report.is_repacked = true;
+    report.chart_count = atlas->stats.chart_count;
+    report.utilization = atlas->stats.utilization;
+    report.painted_map_size = atlas->stats.painted_map_size;
+  }
+
+  report.painted_map_size = std::clamp(
+      report.painted_map_size, MIN_PAINTED_MAP_SIZE, MAX_PAINTED_MAP_SIZE);
+  part.painted_map_size = report.painted_map_size;
+
+  return report;
+}
+
+UvAtlas buildUvAtlas(const GeometryComponent& geometry_component,
+                     const UvAtlasOptions& options) {
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+  size_t face_count = indices.size() / 3;
+
+  std::vector<glm::vec3> face_normals(face_count);
+  job_system::parallelFor(
+      0, face_count, 4096, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t face = chunk_begin; face < chunk_end; face++) {
+          const auto& a = vertices[indices[face * 3]].position;
+          const auto& b = vertices[indices[face * 3 + 1]].position;
+          const auto& c = vertices[indices[face * 3 + 2]].position;
+          face_normals[face] = glm::cross(b - a, c - a);
+        }
+      });
+
+  auto neighbors = findNeighbors(indices, weldPositions(vertices));
+  auto charts = growCharts(face_normals, neighbors);
+
+  UvAtlas atlas;
+  auto& atlas_vertices = atlas.geometry_component.vertices;
+  auto& atlas_indices = atlas.geometry_component.indices;
+  atlas_indices.resize(indices.size());
+  auto source_vertices =
+      splitChartVertices(charts, indices, vertices.size(), atlas_indices);
+
+  std::vector<glm::vec2> positions(source_vertices.size());
+  job_system::parallelFor(
+      0, charts.size(), 16, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t i = chunk_begin; i < chunk_end; i++) {
+          parameterizeChart(charts[i], vertices, source_vertices,
+                            atlas_indices, positions);
+        }
+      });
+
+  std::vector<uint32_t> order(charts.size());
+  for (uint32_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&charts](uint32_t a, uint32_t b) {
+    return charts[a].size.x * charts[a].size.y >
+           charts[b].size.x * charts[b].size.y;
+  });
+
+  // Grows the map until the charts fit, and lowers the density if they do not
+  // fit in the largest map
+  float texel_density = options.texel_density;
+  int size = 0;
+  for (;;) {
+    job_system::parallelFor(
+        0, charts.size(), 16, [&](size_t chunk_begin, size_t chunk_end) {
+          for (size_t i = chunk_begin; i < chunk_end; i++) {
+            charts[i].mask =
+                rasterizeChart(charts[i], positions, atlas_indices,
+                               texel_density, false, options.padding);
+            charts[i].rotated_mask =
+                rasterizeChart(charts[i], positions, atlas_indices,
+                               texel_density, true, options.padding);
+          }
+        });
+
+    size_t mask_area = 0;
+    int max_side = 0;
+    for (const auto& chart : charts) {
+      for (const auto& span : chart.mask.spans) {
+        mask_area += std::max(span.end - span.begin + 1, 0);
+      }
+      max_side = std::max(
+          max_side, std::min(std::max(chart.mask.width, chart.mask.height),
+                             std::max(chart.rotated_mask.width,
+                                      chart.rotated_mask.height)));
+    }
+
+    size = std::max(
+        static_cast<int>(std::ceil(std::sqrt(static_cast<double>(mask_area)))),
+        max_side);
+    while (size <= options.max_painted_map_size &&
+           !packCharts(charts, order, size)) {
+      size += std::max(1, size / 32);
+    }
+    if (size <= options.max_painted_map_size) {
+      break;
+    }
+
+    texel_density *= 0.9f;
+    if (texel_density < options.texel_density * 1e-4f) {
+      throw std::runtime_error("Too many UV charts to pack");
+    }
+  }
+
+  atlas_vertices.resize(source_vertices.size());
+  job_system::parallelFor(
+      0, charts.size(), 16, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t i = chunk_begin; i < chunk_end; i++) {
+          const auto& chart = charts[i];
+          glm::vec2 corner = glm::vec2(chart.x, chart.y);
+
+          for (size_t j = chart.vertex_begin; j < chart.vertex_end; j++) {
+            auto vertex = vertices[source_vertices[j]];
+            vertex.tex_coords = packTexCoords(
+                (corner + getMaskPosition(chart, positions[j], texel_density,
+                                          chart.is_rotated, options.padding)) /
+                static_cast<float>(size));
+            atlas_vertices[j] = vertex;
+          }
+        }
+      });
+
+  float uv_area = 0.0f;
+  for (const auto& chart : charts) {
+    uv_area += chart.area;
+  }
+
+  atlas.stats = {
+      .chart_count = charts.size(),
+      .painted_map_size = size,
+      .texel_density = texel_density,
+      .utilization = uv_area * texel_density * texel_density /
+                     (static_cast<float>(size) * size),
+  };
+
+  return atlas;
+}
+
+UvLayoutStats measureUvLayout(const GeometryComponent& geometry_component,
+                              int resolution) {
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+
+  // Number of triangles covering each texel center, up to 2
+  std::vector<uint8_t> coverage(static_cast<size_t>(resolution) * resolution,
+                                0);
+  UvLayoutStats stats = {};
+
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    const auto& a = vertices[indices[i]];
+    const auto& b = vertices[indices[i + 1]];
+    const auto& c = vertices[indices[i + 2]];
+    stats.surface_area += 0.5f * glm::length(glm::cross(
+                                     b.position - a.position,
+                                     c.position - a.position));
+
+    glm::vec2 p0 =
+        unpackTexCoords(a.tex_coords) * static_cast<float>(resolution);
+    glm::vec2 p1 =
+        unpackTexCoords(b.tex_coords) * static_cast<float>(resolution);
+    glm::vec2 p2 =
+        unpackTexCoords(c.tex_coords) * static_cast<float>(resolution);
+    float double_area = cross2d(p1 - p0, p2 - p0);
+    if (double_area == 0.0f) {
+      continue;
+    }
+    // Mirrored triangles cover texels all the same
+    if (double_area < 0.0f) {
+      std::swap(p1, p2);
+      double_area = -double_area;
+    }
+    stats.uv_area += 0.5f * double_area / (static_cast<float>(resolution) *
+                                           resolution);
+
+    // Texel centers on an edge belong to the triangle on its top or left
+    // side only, so that neighbors do not count as overlapping
+    auto is_covered = [](const glm::vec2& from, const glm::vec2& to,
+                         const glm::vec2& point) {
+      float side = cross2d(to - from, point - from);
+      return side > 0.0f ||
+             (side == 0.0f && (to.y < from.y ||
+                               (to.y == from.y && to.x < from.x)));
+    };
+
+    glm::vec2 min_corner = glm::min(p0, glm::min(p1, p2));
+    glm::vec2 max_corner = glm::max(p0, glm::max(p1, p2));
+    int min_x = std::max(0, static_cast<int>(std::ceil(min_corner.x - 0.5f)));
+    int min_y = std::max(0, static_cast<int>(std::ceil(min_corner.y - 0.5f)));
+    int max_x = std::min(resolution - 1,
+                         static_cast<int>(std::floor(max_corner.x - 0.5f)));
+    int max_y = std::min(resolution - 1,
+                         static_cast<int>(std::floor(max_corner.y - 0.5f)));
+
+    for (int y = min_y; y <= max_y; y++) {
+      for (int x = min_x; x <= max_x; x++) {
+        glm::vec2 center = glm::vec2(x + 0.5f, y + 0.5f);
+        if (is_covered(p0, p1, center) && is_covered(p1, p2, center) &&
+            is_covered(p2, p0, center)) {
+          auto& count = coverage[static_cast<size_t>(y) * resolution + x];
+          count = std::min(count + 1, 2);
+        }
+      }
+    }
+  }
+
+  size_t covered_count = 0;
+  size_t overlap_count = 0;
+  for (uint8_t count : coverage) {
+    covered_count += count > 0;
+    overlap_count += count > 1;
+  }
+  stats.utilization =
+      static_cast<float>(covered_count) / static_cast<float>(coverage.size());
+  stats.overlap = covered_count > 0 ? static_cast<float>(overlap_count) /
+                                          static_cast<float>(covered_count)
+                                    : 0.0f;
+
+  return stats;
+}
+
+float getImportTexelDensity(const std::vector<mesh_import::ImportedPart>& parts,
+                            float texel_density) {
+  // Same scale as getMeshPaintableDescriptor
+  std::optional<BoundingSphere> bounds;
+  for (const auto& part : parts) {
+    auto part_bounds = getBoundingSphere(part.geometry_component);
+    bounds = bounds ? mergeBoundingSpheres(*bounds, part_bounds) : part_bounds;
+  }
+  if (bounds && bounds->radius > 0.0f) {
+    texel_density *= 0.5f / bounds->radius;
+  }
+
+  return texel_density;
+}
+
+std::vector<PartUvReport> packImportedParts(
+    std::vector<mesh_import::ImportedPart>& parts, float texel_density) {
+  texel_density = getImportTexelDensity(parts, texel_density);
+
+  std::vector<PartUvReport> reports(parts.size());
+  job_system::parallelFor(
+      0, parts.size(), 1, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t i = chunk_begin; i < chunk_end; i++) {
+          reports[i] = packImportedPart(parts[i], texel_density);
+        }
+      });
+
+  return reports;
+}
+
+size_t getPaintedMapBytes(int painted_map_size) {
+  return getTextureBytes(TextureType::RGBA16, painted_map_size,
+                         painted_map_size, 1) +
+         2 * getTextureBytes(
+                 TextureType::RGBA16, painted_map_size, painted_map_size,
+                 getMipLevelCount(painted_map_size, painted_map_size));
+}
+
+}  // namespace uv_atlas
@@ -0,0 +1,246 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Converts an OBJ or glTF file into an asset pack, normalized like an import
+// in the browser, then compares the startup cost of both: parsing the source
+// and building its BVHs, against opening the pack and loading its BVHs. Build
+// natively, see the README.
+//
+//   asset_pack_converter input.(obj|glb) output.snpk [--painted-map-size N]
+//       [--no-bvh] [--painted-map PART FILE]...
+//
+// UVs are repacked like on import, which also picks the painted map size of
+// every part unless --painted-map-size is given. A painted map FILE holds the
+// raw RGBA half floats of a square map of that size, baked into the part named
+// PART.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./MeshletSet.h"
+#include "./TriangleBvh.h"
+#include "./asset_pack.h"
+#include "./constants.h"
+#include "./job_system.h"
+#include "./mapped_file.h"
+#include "./math_util.h"
+#include "./mesh_import.h"
+#include "./mesh_optimizer.h"
+#include "./uv_atlas.h"
+
+struct ConverterOptions {
+  std::string input_path;
+  std::string output_path;
+  // 0 keeps the size picked for the UVs
+  int painted_map_size = 0;
+  bool with_bvh = true;
+  // Painted map file by part name
+  std::map<std::string, std::string> painted_map_paths;
+};
+
+double getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+ConverterOptions parseOptions(int argc, char** argv) {
+  ConverterOptions options;
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; i++) {
+    std::string argument = argv[i];
+
+    if (argument == "--painted-map-size" && i + 1 < argc) {
+      options.painted_map_size = std::atoi(argv[++i]);
+    } else if (argument == "--no-bvh") {
+      options.with_bvh = false;
+    } else if (argument == "--painted-map" && i + 2 < argc) {
+      options.painted_map_paths[argv[i + 1]] = argv[i + 2];
+      i += 2;
+    } else if (argument.starts_with("--")) {
+      throw std::invalid_argument("Unknown option " + argument);
+    } else {
+      paths.push_back(argument);
+    }
+  }
+
+  if (paths.size() != 2 || options.painted_map_size < 0) {
+    throw std::invalid_argument(
+        "Usage: asset_pack_converter input.(obj|glb) output.snpk "
+        "[--painted-map-size N] [--no-bvh] [--painted-map PART FILE]...");
+  }
+  options.input_path = paths[0];
+  options.output_path = paths[1];
+
+  return options;
+}
+
+asset_pack::PackTransform getPackTransform(const glm::vec3& scale,
+                                           const glm::vec3& translation) {
+  return {
+      .scale = {scale.x, scale.y, scale.z},
+      .rotation = {0.0f, 0.0f, 0.0f, 1.0f},
+      .translation = {translation.x, translation.y, translation.z},
+  };
+}
+
+int main(int argc, char** argv) {
+  try {
+    auto options = parseOptions(argc, argv);
+
+    job_system::init(std::thread::hardware_concurrency());
+
+    // What an import costs in the browser at every startup
+    MappedFile source_file(options.input_path);
+    auto source_start = std::chrono::steady_clock::now();
+    auto parts = mesh_import::importMesh(
+        source_file.getBytes(),
+        mesh_import::getMeshFormat(options.input_path));
+    auto uv_reports =
+        uv_atlas::packImportedParts(parts, MESH_TEXEL_DENSITY);
+
+    std::vector<std::unique_ptr<TriangleBvh>> bvhs;
+    std::vector<std::unique_ptr<MeshletSet>> meshlet_sets;
+    std::vector<mesh_optimizer::MeshOptimizerStats> optimizer_stats;
+    std::optional<BoundingSphere> bounds;
+    for (auto& part : parts) {
+      auto part_bounds = getBoundingSphere(part.geometry_component);
+      bounds =
+          bounds ? mergeBoundingSpheres(*bounds, part_bounds) : part_bounds;
+      // Packs are read in place, so they store the geometry optimized
+      optimizer_stats.push_back(
+          mesh_optimizer::optimizeMesh(part.geometry_component));
+      bvhs.push_back(std::make_unique<TriangleBvh>(part.geometry_component));
+      meshlet_sets.push_back(
+          std::make_unique<MeshletSet>(part.geometry_component));
+    }
+    double source_ms = getElapsedMs(source_start);
+
+    // Same size as the SPHERE preset, see getMeshPaintableDescriptor
+    asset_pack::PaintableSource paintable = {
+        .transform = getPackTransform(glm::vec3(1.0f), glm::vec3(0.0f)),
+        .parts = {},
+    };
+    if (bounds && bounds->radius > 0.0f) {
+      auto scale = glm::vec3(0.5f / bounds->radius);
+      paintable.transform = getPackTransform(scale, -bounds->center * scale);
+    }
+
+    std::vector<std::unique_ptr<MappedFile>> painted_map_files;
+    for (size_t i = 0; i < parts.size(); i++) {
+      asset_pack::PartSource part_source = {
+          .name = parts[i].material_name,
+          .geometry = parts[i].geometry_component,
+          .bvh = options.with_bvh ? bvhs[i].get() : nullptr,
+          .meshlets = meshlet_sets[i].get(),
+          .transform = getPackTransform(glm::vec3(1.0f), glm::vec3(0.0f)),
+          .painted_map_size = options.painted_map_size > 0
+                                  ? options.painted_map_size
+                                  : parts[i].painted_map_size,
+          .painted_map = {},
+      };
+
+      const auto& uv_report = uv_reports[i];
+      std::printf("%s: %s, %.1f%% -> %.1f%% used, painted maps %d -> %d px, "
+                  "ACMR %.3f -> %.3f\n",
+                  part_source.name.c_str(),
+                  uv_report.is_repacked ? "UVs repacked" : "UVs kept",
+                  uv_report.original_utilization * 100.0f,
+                  uv_report.utilization * 100.0f,
+                  uv_report.original_painted_map_size,
+                  uv_report.painted_map_size, optimizer_stats[i].acmr_before,
+                  optimizer_stats[i].acmr_after);
+
+      auto it = options.painted_map_paths.find(part_source.name);
+      if (it != options.painted_map_paths.end()) {
+        painted_map_files.push_back(std::make_unique<MappedFile>(it->second));
+        part_source.painted_map = painted_map_files.back()->getBytes();
+        options.painted_map_paths.erase(it);
+      }
+
+      paintable.parts.push_back(std::move(part_source));
+    }
+
+    if (!options.painted_map_paths.empty()) {
+      throw std::invalid_argument("No part named " +
+                                  options.painted_map_paths.begin()->first);
+    }
+
+    auto bytes = asset_pack::buildAssetPack({paintable});
+
+    FILE* file = std::fopen(options.output_path.c_str(), "wb");
+    if (!file || std::fwrite(bytes.data(), 1, bytes.size(), file) !=
+                     bytes.size()) {
+      if (file) {
+        std::fclose(file);
+      }
+      throw std::runtime_error("Failed to write " + options.output_path);
+    }
+    std::fclose(file);
+
+    // What loading the pack costs instead. The file was just written, so its
+    // pages are cached like those of the source.
+    auto pack_start = std::chrono::steady_clock::now();
+    auto asset_pack = asset_pack::AssetPack::open(options.output_path);
+    size_t triangle_count = 0;
+    for (size_t i = 0; i < asset_pack->getParts().size(); i++) {
+      auto bvh_data = asset_pack->getBvhData(i);
+      auto bvh = bvh_data ? TriangleBvh(*bvh_data)
+                          : TriangleBvh(asset_pack->getGeometryView(i));
+      MeshletSet meshlet_set(asset_pack->getMeshlets(i),
+                             asset_pack->getGeometryView(i));
+      triangle_count += bvh.getTriangleCount();
+    }
+    double pack_ms = getElapsedMs(pack_start);
+
+    job_system::shutdown();
+
+    std::printf("%s: %zu parts, %zu triangles\n", options.output_path.c_str(),
+                asset_pack->getParts().size(), triangle_count);
+    std::printf("source: %.1f MB, parse, UV atlas, optimize, BVH and meshlets "
+                "%.1f ms\n",
+                source_file.getBytes().size() / (1024.0 * 1024.0), source_ms);
+    std::printf("pack:   %.1f MB, open, BVH %s and meshlet load %.1f ms "
+                "(%.1fx faster)\n",
+                asset_pack->getSize() / (1024.0 * 1024.0),
+                options.with_bvh ? "load" : "build", pack_ms,
+                source_ms / pack_ms);
+  } catch (const std::exception& exception) {
+    std::fprintf(stderr, "%s\n", exception.what());
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,303 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Compares the paint maps the brush decal pass writes on the PLANE preset,
+// rasterized on the CPU like the GPU does in texture space, between the
+// brush projection divided per vertex, as it used to be, and per fragment.
+// Each case paints one frame from a brush pose and compares the intensities
+// against the per vertex projection on 128x128 segments, which gets closer to
+// the exact projection the finer the plane is tessellated. The PLANE preset
+// used to have 16x16 segments. The brush depth test is left out, as nothing
+// occludes the plane. Build natively, see the README.
+//
+//   brush_decal_comparison [output_dir]
+//
+// With an output directory, every paint map is also written as a PGM image,
+// scaled so that the strongest texel of its case is white.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <glm/gtc/matrix_transform.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./math_util.h"
+
+const int paint_map_size = 512;
+const float nozzle_fov = glm::radians(45.0f);
+const float air_pressure = 1.5f;
+const float time_delta_ms = 1000.0f / 60.0f;
+
+struct BrushPose {
+  const char* name;
+  glm::vec3 position;
+  glm::vec3 direction;
+};
+
+enum class Projection { PER_VERTEX, PER_FRAGMENT };
+
+struct PaintMap {
+  std::vector<float> intensities;
+  float max_intensity;
+};
+
+// The intensity brush_decal_fragment writes, from the fragment's interpolated
+// position, normal and projected position
+float getIntensity(const BrushPose& pose, const glm::vec3& position,
+                   const glm::vec3& normal,
+                   const glm::vec3& projected_position) {
+  float center_distance = glm::length(glm::vec2(projected_position));
+  if (center_distance - 1e-05f > 1.0f) {
+    return 0.0f;
+  }
+
+  float tan_half_fov = std::tan(nozzle_fov / 2.0f);
+  float distance = glm::length(position - pose.position);
+  float strength_coff = 0.05f * air_pressure /
+                        (tan_half_fov * tan_half_fov * distance * distance);
+  float normal_coff = std::max(
+      0.0f, glm::dot(glm::normalize(normal),
+                     glm::normalize(pose.position - position)));
+  float strength = strength_coff * normal_coff *
+                   (1.0f - glm::smoothstep(0.0f, 1.0f, center_distance));
+
+  return glm::clamp(strength * 2.0f / 1000.0f * time_delta_ms, 0.0f, 1.0f);
+}
+
+PaintMap paint(const GeometryComponent& geometry_component,
+               const BrushPose& pose, Projection projection) {
+  glm::mat4 brush_matrix =
+      glm::perspective(nozzle_fov, 1.0f, 0.01f, 1000.0f) *
+      getRayViewMatrix(pose.position, glm::vec3(0.0f, 1.0f, 0.0f),
+                       pose.direction);
+
+  auto project = [&brush_matrix](const glm::vec3& position)
+      -> std::optional<glm::vec3> {
+    glm::vec4 clip_position = brush_matrix * glm::vec4(position, 1.0f);
+    if (clip_position.w <= 0.0f) {
+      return std::nullopt;
+    }
+    return glm::vec3(clip_position) / clip_position.w;
+  };
+
+  PaintMap paint_map = {
+      .intensities =
+          std::vector<float>(paint_map_size * paint_map_size, 0.0f),
+      .max_intensity = 0.0f,
+  };
+
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    const Vertex* corners[3] = {&vertices[indices[i]],
+                                &vertices[indices[i + 1]],
+                                &vertices[indices[i + 2]]};
+    glm::vec2 uvs[3];
+    glm::vec3 normals[3];
+    glm::vec3 projected_positions[3];
+    for (int corner = 0; corner < 3; corner++) {
+      uvs[corner] = unpackTexCoords(corners[corner]->tex_coords) *
+                    static_cast<float>(paint_map_size);
+      normals[corner] = unpackNormal(corners[corner]->normal);
+      // Divided by w even behind the nozzle, like the vertex shader did
+      glm::vec4 clip_position =
+          brush_matrix * glm::vec4(corners[corner]->position, 1.0f);
+      projected_positions[corner] = glm::vec3(clip_position) / clip_position.w;
+    }
+
+    float area = (uvs[1].x - uvs[0].x) * (uvs[2].y - uvs[0].y) -
+                 (uvs[1].y - uvs[0].y) * (uvs[2].x - uvs[0].x);
+    if (area == 0.0f) {
+      continue;
+    }
+
+    glm::vec2 uv_min = glm::min(uvs[0], glm::min(uvs[1], uvs[2]));
+    glm::vec2 uv_max = glm::max(uvs[0], glm::max(uvs[1], uvs[2]));
+    int min_x = std::max(0, static_cast<int>(std::floor(uv_min.x)));
+    int min_y = std::max(0, static_cast<int>(std::floor(uv_min.y)));
+    int max_x = std::min(paint_map_size - 1,
+                         static_cast<int>(std::ceil(uv_max.x)));
+    int max_y = std::min(paint_map_size - 1,
+                         static_cast<int>(std::ceil(uv_max.y)));
+
+    for (int y = min_y; y <= max_y; y++) {
+      for (int x = min_x; x <= max_x; x++) {
+        glm::vec2 texel(x + 0.5f, y + 0.5f);
+        glm::vec3 weights;
+        for (int corner = 0; corner < 3; corner++) {
+          const auto& a = uvs[(corner + 1) % 3];
+          const auto& b = uvs[(corner + 2) % 3];
+          weights[corner] = ((a.x - texel.x) * (b.y - texel.y) -
+                             (a.y - texel.y) * (b.x - texel.x)) /
+                            area;
+        }
+        if (weights.x < 0.0f || weights.y < 0.0f || weights.z < 0.0f) {
+          continue;
+        }
+
+        auto interpolate = [&weights](const auto& values) {
+          return weights.x * values[0] + weights.y * values[1] +
+                 weights.z * values[2];
+        };
+        glm::vec3 position =
+            interpolate(std::array<glm::vec3, 3>{corners[0]->position,
+                                                 corners[1]->position,
+                                                 corners[2]->position});
+        glm::vec3 normal = interpolate(normals);
+
+        std::optional<glm::vec3> projected_position;
+        if (projection == Projection::PER_VERTEX) {
+          projected_position = interpolate(projected_positions);
+        } else {
+          projected_position = project(position);
+        }
+
+        float intensity =
+            projected_position
+                ? getIntensity(pose, position, normal, *projected_position)
+                : 0.0f;
+        paint_map.intensities[y * paint_map_size + x] = intensity;
+        paint_map.max_intensity = std::max(paint_map.max_intensity, intensity);
+      }
+    }
+  }
+
+  return paint_map;
+}
+
+void writePgm(const std::filesystem::path& path, const PaintMap& paint_map,
+              float max_intensity) {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+    return;
+  }
+
+  std::fprintf(file, "P5\n%d %d\n255\n", paint_map_size, paint_map_size);
+  std::vector<unsigned char> pixels(paint_map.intensities.size());
+  for (size_t i = 0; i < pixels.size(); i++) {
+    float value = max_intensity > 0.0f
+                      ? paint_map.intensities[i] / max_intensity
+                      : 0.0f;
+    pixels[i] = static_cast<unsigned char>(
+        std::lround(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
+  }
+  std::fwrite(pixels.data(), 1, pixels.size(), file);
+  std::fclose(file);
+}
+
+int main(int argc, char** argv) {
+  std::optional<std::filesystem::path> output_directory;
+  if (argc > 1) {
+    output_directory = argv[1];
+    std::filesystem::create_directories(*output_directory);
+  }
+
+  // The plane spans [-0.5, 0.5] on x and y, facing +z
+  auto get_pose = [](const char* name, const glm::vec3& target,
+                     float tilt_degrees, float distance) {
+    float tilt = glm::radians(tilt_degrees);
+    glm::vec3 offset =
+        distance * glm::vec3(std::sin(tilt), 0.0f, std::cos(tilt));
+    return BrushPose{name, target + offset, -glm::normalize(offset)};
+  };
+  std::vector<BrushPose> poses = {
+      get_pose("straight_near", glm::vec3(0.0f), 0.0f, 0.3f),
+      get_pose("straight_far", glm::vec3(0.1f, 0.2f, 0.0f), 0.0f, 1.0f),
+      get_pose("tilted_30", glm::vec3(0.1f, -0.1f, 0.0f), 30.0f, 0.5f),
+      get_pose("tilted_60", glm::vec3(-0.2f, 0.0f, 0.0f), 60.0f, 0.4f),
+      get_pose("grazing_75", glm::vec3(0.0f, 0.1f, 0.0f), 75.0f, 0.6f),
+  };
+
+  struct Variant {
+    const char* name;
+    int segments;
+    Projection projection;
+  };
+  const Variant baseline = {"vertex_128", 128, Projection::PER_VERTEX};
+  const std::vector<Variant> variants = {
+      {"fragment_1", 1, Projection::PER_FRAGMENT},
+      {"fragment_16", 16, Projection::PER_FRAGMENT},
+      {"vertex_16", 16, Projection::PER_VERTEX},
+      {"vertex_1", 1, Projection::PER_VERTEX},
+  };
+
+  // Differences are relative to the strongest texel of the baseline
+  std::printf("pose,variant,max_diff,mean_diff,texels_over_1_255,psnr_db\n");
+
+  for (const auto& pose : poses) {
+    auto baseline_map =
+        paint(GeometryComponent(GeometryPreset::PLANE, baseline.segments,
+                                baseline.segments),
+              pose, baseline.projection);
+    float peak = baseline_map.max_intensity;
+    if (output_directory) {
+      writePgm(*output_directory /
+                   (std::string(pose.name) + "_" + baseline.name + ".pgm"),
+               baseline_map, peak);
+    }
+
+    for (const auto& variant : variants) {
+      auto paint_map =
+          paint(GeometryComponent(GeometryPreset::PLANE, variant.segments,
+                                  variant.segments),
+                pose, variant.projection);
+      if (output_directory) {
+        writePgm(*output_directory /
+                     (std::string(pose.name) + "_" + variant.name + ".pgm"),
+                 paint_map, peak);
+      }
+
+      double max_diff = 0.0;
+      double diff_sum = 0.0;
+      double squared_diff_sum = 0.0;
+      size_t over_count = 0;
+      for (size_t i = 0; i < paint_map.intensities.size(); i++) {
+        double diff = std::abs(paint_map.intensities[i] -
+                               baseline_map.intensities[i]) /
+                      peak;
+        max_diff = std::max(max_diff, diff);
+        diff_sum += diff;
+        squared_diff_sum += diff * diff;
+        over_count += diff > 1.0 / 255.0;
+      }
+      double mean_squared_diff =
+          squared_diff_sum / paint_map.intensities.size();
+      double psnr = mean_squared_diff > 0.0
+                        ? -10.0 * std::log10(mean_squared_diff)
+                        : INFINITY;
+
+      std::printf("%s,%s,%.4f,%.6f,%zu,%.1f\n", pose.name, variant.name,
+                  max_diff, diff_sum / paint_map.intensities.size(),
+                  over_count, psnr);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures BVH build time and picking throughput on a 1M triangle sphere,
+// against testing every triangle. Build natively, see the README.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./TriangleBvh.h"
+#include "./job_system.h"
+#include "./math_util.h"
+
+const size_t ray_count = 1000000;
+const size_t brute_force_ray_count = 100;
+
+struct Ray {
+  glm::vec3 origin;
+  glm::vec3 direction;
+};
+
+double getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Rays from a sphere of radius 3 around the mesh, aimed at points within
+// `target_radius` of its center. The sphere has a radius of 0.5.
+std::vector<Ray> generateRays(size_t count, float target_radius) {
+  std::mt19937 random_engine(7);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+  auto random_direction = [&] {
+    glm::vec3 direction;
+    do {
+      direction = glm::vec3(distribution(random_engine),
+                            distribution(random_engine),
+                            distribution(random_engine));
+    } while (glm::length(direction) > 1.0f || glm::length(direction) < 0.01f);
+    return glm::normalize(direction);
+  };
+
+  std::vector<Ray> rays;
+  rays.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    glm::vec3 origin = random_direction() * 3.0f;
+    glm::vec3 target = random_direction() * target_radius *
+                       std::abs(distribution(random_engine));
+    rays.push_back({origin, glm::normalize(target - origin)});
+  }
+
+  return rays;
+}
+
+std::optional<float> intersectAll(const GeometryComponent& geometry_component,
+                                  const Ray& ray) {
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+
+  std::optional<float> nearest_distance;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    auto result = getRayIntersectionDistance(
+        ray.origin, ray.direction, vertices[indices[i]].position,
+        vertices[indices[i + 1]].position, vertices[indices[i + 2]].position);
+    if (result.has_value() && (!nearest_distance.has_value() ||
+                               result->distance < nearest_distance.value())) {
+      nearest_distance = result->distance;
+    }
+  }
+
+  return nearest_distance;
+}
+
+int main() {
+  job_system::init(0);
+
+  GeometryComponent geometry_component(GeometryPreset::SPHERE, 1024, 512);
+
+  auto build_start = std::chrono::steady_clock::now();
+  TriangleBvh bvh(geometry_component);
+  double build_ms = getElapsedMs(build_start);
+
+  printf("triangles: %zu, nodes: %zu, build: %.1f ms\n",
+         bvh.getTriangleCount(), bvh.getNodeCount(), build_ms);
+  printf("rays,hit_rate,bvh_rays_per_sec,brute_force_rays_per_sec,"
+         "mismatches\n");
+
+  // Mostly hitting rays, and rays of which about half miss the mesh
+  for (float target_radius : {0.45f, 1.0f}) {
+    auto rays = generateRays(ray_count, target_radius);
+
+    size_t hit_count = 0;
+    auto bvh_start = std::chrono::steady_clock::now();
+    for (const auto& ray : rays) {
+      hit_count += bvh.intersectRay(ray.origin, ray.direction).has_value();
+    }
+    double bvh_ms = getElapsedMs(bvh_start);
+
+    size_t mismatch_count = 0;
+    auto brute_force_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < brute_force_ray_count; i++) {
+      auto hit = bvh.intersectRay(rays[i].origin, rays[i].direction);
+      auto distance = intersectAll(geometry_component, rays[i]);
+      if (hit.has_value() != distance.has_value() ||
+          (hit.has_value() && hit->distance != distance.value())) {
+        mismatch_count++;
+      }
+    }
+    double brute_force_ms = getElapsedMs(brute_force_start);
+
+    printf("%zu,%.2f,%.0f,%.0f,%zu\n", rays.size(),
+           static_cast<double>(hit_count) / rays.size(),
+           rays.size() / (bvh_ms / 1000.0),
+           brute_force_ray_count / (brute_force_ms / 1000.0), mismatch_count);
+  }
+
+  job_system::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Times creating and iterating 10, 1k and 100k paintable parts in an
+// EntityRegistry, against the unique_ptr-per-component layout it replaced.
+// Build natively, see the README.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "./Component/BoundsComponent.h"
+#include "./Component/TransformComponent.h"
+#include "./EntityRegistry.h"
+
+const int iteration_count = 20;
+
+// Layout the paintable parts had before the registry, one heap allocation per
+// component
+struct PointerEntity {
+  std::unique_ptr<TransformComponent> transform_component;
+  std::unique_ptr<BoundsComponent> bounds_component;
+};
+
+double getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+void updateTransform(TransformComponent& transform_component,
+                     const BoundsComponent& bounds_component) {
+  if (bounds_component.is_under_brush) {
+    transform_component.translation += transform_component.scale * 0.001f;
+    transform_component.needs_update = true;
+  }
+}
+
+void runCase(size_t entity_count) {
+  EntityRegistry registry;
+
+  auto create_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < entity_count; i++) {
+    registry.create(TransformComponent(), BoundsComponent());
+  }
+  double create_ms = getElapsedMs(create_start);
+
+  auto query_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iteration_count; i++) {
+    for (auto [transform_component, bounds_component] :
+         registry.query<TransformComponent, BoundsComponent>()) {
+      updateTransform(transform_component, bounds_component);
+    }
+  }
+  double query_ms = getElapsedMs(query_start) / iteration_count;
+
+  std::vector<std::unique_ptr<PointerEntity>> pointer_entities;
+
+  auto pointer_create_start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < entity_count; i++) {
+    pointer_entities.push_back(std::make_unique<PointerEntity>(PointerEntity{
+        .transform_component = std::make_unique<TransformComponent>(),
+        .bounds_component = std::make_unique<BoundsComponent>(),
+    }));
+  }
+  double pointer_create_ms = getElapsedMs(pointer_create_start);
+
+  auto pointer_query_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iteration_count; i++) {
+    for (const auto& pointer_entity : pointer_entities) {
+      updateTransform(*pointer_entity->transform_component,
+                      *pointer_entity->bounds_component);
+    }
+  }
+  double pointer_query_ms = getElapsedMs(pointer_query_start) / iteration_count;
+
+  printf("%zu,%.3f,%.3f,%.4f,%.4f\n", entity_count, create_ms,
+         pointer_create_ms, query_ms, pointer_query_ms);
+}
+
+int main() {
+  printf("entities,create_ms,pointer_create_ms,query_ms,pointer_query_ms\n");
+
+  for (size_t entity_count : {10, 1000, 100000}) {
+    runCase(entity_count);
+  }
+
+  return 0;
+}
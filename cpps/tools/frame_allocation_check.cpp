@@ -0,0 +1,253 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Runs the CPU side of a painting frame natively, on the stress scene of 1 to
+// 1024 parts, while the brush follows the scripted stroke of the stress test:
+// brush transforms, culling, picking and meshlet selection, then what the
+// paint systems track before drawing, i.e. the depth ranges drawn per shared
+// geometry and the dirty rects of the painted maps and their mips. After a
+// warmup stroke, exits with 1 if any measured frame allocated on the heap, so
+// that it can gate changes. Build natively, see the README.
+//
+// Runs without job_system workers, like WASM builds without -pthread: with
+// workers, every job submitted allocates its std::function.
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+#include "./Component/BoundsComponent.h"
+#include "./Component/BrushComponent.h"
+#include "./Component/CameraComponent.h"
+#include "./Component/InputComponent.h"
+#include "./Component/MeshletSelectionComponent.h"
+#include "./Component/PickComponent.h"
+#include "./Component/RenderConfigComponent.h"
+#include "./Component/SharedGeometryComponent.h"
+#include "./Component/TransformComponent.h"
+#include "./Component/TransformNodeComponent.h"
+#include "./EntityRegistry.h"
+#include "./TransformHierarchy.h"
+#include "./UvRects.h"
+#include "./allocation_counter.h"
+#include "./job_system.h"
+#include "./mesh_optimizer.h"
+#include "./stress_scene.h"
+#include "./system/cull_system.h"
+#include "./system/input_sync_system.h"
+#include "./system/pick_system.h"
+#include "./system/transform_system.h"
+
+const float frame_ms = 16.0f;
+const int frames_per_stroke =
+    static_cast<int>(stress_scene::STROKE_PERIOD_MS / frame_ms);
+const int warmup_frames = frames_per_stroke;
+const int measured_frames = 2 * frames_per_stroke;
+const int painted_map_size = 1024;
+
+// Dirty rects of a part's painted map, as GrPingPongTextureComponent tracks
+// them without its textures
+struct PaintedMapComponent {
+  UvRects dirty_uv_rects;
+};
+
+// One paintable of the stress preset, whose parts share one geometry
+struct StressScene {
+  TransformHierarchy transform_hierarchy;
+  TransformComponent transform_component;
+  BoundsComponent bounds_component;
+  EntityRegistry part_registry;
+};
+
+// Like geometry_cache::acquire, without uploading
+SharedGeometryComponent createSharedGeometry() {
+  auto geometry_component =
+      std::make_shared<GeometryComponent>(GeometryPreset::SPHERE, 32, 16);
+  mesh_optimizer::optimizeMesh(*geometry_component);
+
+  SharedGeometryComponent shared_geometry_component;
+  shared_geometry_component.geometry_component = geometry_component;
+  shared_geometry_component.view = GeometryView(*geometry_component);
+  shared_geometry_component.bvh =
+      std::make_shared<TriangleBvh>(shared_geometry_component.view);
+  shared_geometry_component.meshlets =
+      std::make_shared<MeshletSet>(*geometry_component);
+  return shared_geometry_component;
+}
+
+// Parts of the GRID layout, like getStressPaintableDescriptors
+void addStressParts(StressScene& scene, int part_count,
+                    const SharedGeometryComponent& shared_geometry_component) {
+  scene.transform_component.node = scene.transform_hierarchy.create(
+      TransformHandle(), scene.transform_component.scale,
+      scene.transform_component.rotation,
+      scene.transform_component.translation);
+
+  for (const auto& placement :
+       stress_scene::getPartPlacements(StressLayout::GRID, part_count)) {
+    scene.part_registry.create(
+        TransformNodeComponent{
+            .node = scene.transform_hierarchy.create(
+                scene.transform_component.node, placement.scale,
+                placement.rotation, placement.translation),
+        },
+        SharedGeometryComponent(shared_geometry_component),
+        MeshletSelectionComponent(), PaintedMapComponent());
+
+    scene.bounds_component.merge(transformBoundingSphere(
+        getBoundingSphere(shared_geometry_component.view),
+        getTransformMatrix(placement.scale, placement.rotation,
+                           placement.translation)));
+  }
+}
+
+// What paint_system does besides drawing: updateBrushDepthInstanced merges
+// the depth ranges of the parts sharing a geometry, updatePaintedMap marks
+// the decal UV rects dirty, and updatePaintedMipmaps downsamples the dirty
+// texel rects of each mip. Returns the number of texel rects.
+size_t trackPaintedMaps(EntityRegistry& part_registry) {
+  MeshletRanges depth_ranges;
+  size_t texel_rect_count = 0;
+
+  for (auto [meshlet_selection_component, painted_map_component] :
+       part_registry.query<MeshletSelectionComponent, PaintedMapComponent>()) {
+    depth_ranges.merge(meshlet_selection_component.depth_ranges);
+
+    auto& dirty_uv_rects = painted_map_component.dirty_uv_rects;
+    dirty_uv_rects.merge(meshlet_selection_component.decal_uv_rects);
+    if (dirty_uv_rects.empty()) {
+      continue;
+    }
+
+    auto size = glm::ivec2(painted_map_size);
+    for (int level = 1; (painted_map_size >> level) > 0; level++) {
+      TexelRects texel_rects;
+      texel_rect_count +=
+          getDirtyTexelRects(dirty_uv_rects, size, level, texel_rects);
+    }
+    dirty_uv_rects.clear();
+  }
+
+  return texel_rect_count;
+}
+
+// Systems of main.cpp from updateTransforms to selectMeshlets, in order,
+// then the CPU side of painting. Returns the result of trackPaintedMaps.
+size_t runFrame(float elapsed_ms, StressScene& scene,
+              RenderConfigComponent& render_config_component,
+              CameraComponent& camera_component,
+              InputComponent& input_component,
+              BrushComponent& brush_component, PickComponent& pick_component) {
+  stress_scene::driveScriptedStroke(
+      elapsed_ms, render_config_component.canvas_size, input_component);
+
+  transform_system::syncTransformNode(std::ref(scene.transform_component),
+                                      std::ref(scene.transform_hierarchy));
+  transform_system::updateWorldMatrices(std::ref(scene.transform_hierarchy));
+
+  input_sync_system::syncBrush(std::ref(input_component),
+                               std::ref(brush_component));
+  transform_system::transformBrush(
+      std::ref(input_component), std::ref(render_config_component),
+      std::ref(camera_component), std::ref(brush_component));
+
+  cull_system::cullByBrush(
+      std::ref(brush_component), std::ref(scene.transform_hierarchy),
+      std::ref(scene.transform_component), std::ref(scene.bounds_component));
+
+  pick_component.reset();
+  pick_system::pickByBrush(std::ref(brush_component),
+                           std::ref(scene.transform_hierarchy), 0,
+                           std::ref(scene.part_registry),
+                           std::ref(scene.bounds_component),
+                           std::ref(pick_component));
+
+  if (!scene.bounds_component.is_under_brush) {
+    return 0;
+  }
+
+  cull_system::selectMeshletsByBrush(std::ref(brush_component),
+                                     std::ref(scene.transform_hierarchy),
+                                     std::ref(scene.part_registry));
+  return trackPaintedMaps(scene.part_registry);
+}
+
+int main() {
+  if (!allocation_counter::isCounting()) {
+    printf("Built without SIENNA_ALLOCATION_COUNTER\n");
+    return 1;
+  }
+
+  job_system::init(0);
+
+  auto shared_geometry_component = createSharedGeometry();
+
+  bool has_allocated = false;
+  printf("parts,measured_frames,cone_hit_frames,dirty_texel_rects,"
+         "allocations\n");
+
+  for (int part_count : {1, 16, 64, 256, 1024}) {
+    StressScene scene;
+    addStressParts(scene, part_count, shared_geometry_component);
+
+    RenderConfigComponent render_config_component(glm::vec4(0.0f));
+    render_config_component.canvas_size = glm::ivec2(1280, 720);
+    CameraComponent camera_component;
+    InputComponent input_component;
+    BrushComponent brush_component;
+    PickComponent pick_component;
+
+    float elapsed_ms = 0.0f;
+    for (int frame = 0; frame < warmup_frames; frame++) {
+      runFrame(elapsed_ms, scene, render_config_component, camera_component,
+               input_component, brush_component, pick_component);
+      elapsed_ms += frame_ms;
+    }
+
+    int cone_hit_frame_count = 0;
+    size_t texel_rect_count = 0;
+    size_t start_allocation_count = allocation_counter::getAllocationCount();
+    for (int frame = 0; frame < measured_frames; frame++) {
+      texel_rect_count += runFrame(elapsed_ms, scene, render_config_component,
+                                   camera_component, input_component,
+                                   brush_component, pick_component);
+      cone_hit_frame_count += pick_component.is_cone_hit ? 1 : 0;
+      elapsed_ms += frame_ms;
+    }
+    size_t allocation_count =
+        allocation_counter::getAllocationCount() - start_allocation_count;
+
+    printf("%d,%d,%d,%zu,%zu\n", part_count, measured_frames,
+           cone_hit_frame_count, texel_rect_count, allocation_count);
+    has_allocated |= allocation_count > 0;
+  }
+
+  job_system::shutdown();
+
+  if (has_allocated) {
+    printf("FAIL: steady frames allocated on the heap\n");
+    return 1;
+  }
+  return 0;
+}
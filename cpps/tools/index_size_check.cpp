@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Checks that 16 bit indices never reach 0xFFFF, which WebGL2 always takes
+// for the primitive restart index, at the limit of getIndexSize: geometries
+// of 65535 and 65536 vertices, once written to an asset pack and loaded
+// again. Also checks that a pack with 16 bit indices over more vertices is
+// refused. Exits with 1 on failure. Build natively, see the README.
+
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./asset_pack.h"
+
+bool failed = false;
+
+void check(bool condition, const char* message, size_t vertex_count) {
+  if (!condition) {
+    printf("FAIL: %s, %zu vertices\n", message, vertex_count);
+    failed = true;
+  }
+}
+
+// Triangles over every vertex, the last one included
+GeometryComponent createGeometry(size_t vertex_count) {
+  GeometryComponent geometry_component;
+  geometry_component.vertices.resize(vertex_count, Vertex{});
+  for (size_t i = 0; i + 2 < vertex_count; i++) {
+    geometry_component.indices.push_back(static_cast<unsigned int>(i));
+    geometry_component.indices.push_back(static_cast<unsigned int>(i + 1));
+    geometry_component.indices.push_back(static_cast<unsigned int>(i + 2));
+  }
+  return geometry_component;
+}
+
+std::vector<char> buildPack(const GeometryComponent& geometry_component) {
+  asset_pack::PackTransform transform = {
+      .scale = {1.0f, 1.0f, 1.0f},
+      .rotation = {0.0f, 0.0f, 0.0f, 1.0f},
+      .translation = {0.0f, 0.0f, 0.0f},
+  };
+
+  return asset_pack::buildAssetPack({{
+      .transform = transform,
+      .parts = {{
+          .name = "part",
+          .geometry = GeometryView(geometry_component),
+          .transform = transform,
+          .painted_map = {},
+      }},
+  }});
+}
+
+// The part of a pack with a single part, within `bytes`
+asset_pack::PackPart* findPart(std::vector<char>& bytes) {
+  asset_pack::PackHeader header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+
+  for (uint32_t i = 0; i < header.section_count; i++) {
+    auto* section = reinterpret_cast<asset_pack::PackSection*>(
+        bytes.data() + sizeof(header)) + i;
+    if (section->type == asset_pack::SectionType::PARTS) {
+      return reinterpret_cast<asset_pack::PackPart*>(bytes.data() +
+                                                     section->offset);
+    }
+  }
+  return nullptr;
+}
+
+void checkVertexCount(size_t vertex_count, size_t expected_index_size) {
+  check(getIndexSize(vertex_count) == expected_index_size, "getIndexSize",
+        vertex_count);
+
+  auto geometry_component = createGeometry(vertex_count);
+  std::shared_ptr<const asset_pack::AssetPack> pack;
+  try {
+    pack = asset_pack::AssetPack::fromBytes(buildPack(geometry_component));
+  } catch (const std::exception& exception) {
+    check(false, exception.what(), vertex_count);
+    return;
+  }
+  auto view = pack->getGeometryView(0);
+
+  check(view.index_size == expected_index_size, "stored index size",
+        vertex_count);
+  bool is_same = view.index_count == geometry_component.indices.size();
+  for (size_t i = 0; is_same && i < view.index_count; i++) {
+    is_same = view.getIndex(i) == geometry_component.indices[i];
+    check(view.index_size != sizeof(uint16_t) || view.getIndex(i) != 0xFFFF,
+          "primitive restart index stored", vertex_count);
+  }
+  check(is_same, "stored indices", vertex_count);
+}
+
+int main() {
+  checkVertexCount(65535, sizeof(uint16_t));
+  checkVertexCount(65536, sizeof(uint32_t));
+
+  // Narrowed by hand, like a pack written before the limit was fixed
+  auto bytes = buildPack(createGeometry(65536));
+  findPart(bytes)->index_size = sizeof(uint16_t);
+  try {
+    asset_pack::AssetPack::fromBytes(std::move(bytes));
+    check(false, "16 bit indices loaded", 65536);
+  } catch (const std::exception&) {
+  }
+
+  if (failed) {
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures how the job system scales from 1 to 16 threads on the CPU work it
+// parallelizes in the engine. Build natively, see the README.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <glm/gtc/quaternion.hpp>
+#include <thread>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./job_system.h"
+#include "./math_util.h"
+
+const int iteration_count = 10;
+const size_t transform_count = 1000000;
+
+template <typename Function>
+double measureMs(Function function) {
+  // Warm up, so that every thread count starts with touched memory
+  function();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iteration_count; i++) {
+    function();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         iteration_count;
+}
+
+int main() {
+  std::vector<glm::mat4> model_matrices(transform_count);
+
+  printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  printf("threads,workers,sphere_ms,transforms_ms\n");
+
+  for (size_t thread_count : {1, 2, 4, 8, 16}) {
+    job_system::shutdown();
+    job_system::init(thread_count - 1);
+
+    double sphere_ms = measureMs([] {
+      GeometryComponent geometry_component(GeometryPreset::SPHERE, 1024, 512);
+    });
+
+    double transforms_ms = measureMs([&model_matrices] {
+      job_system::parallelFor(
+          0, model_matrices.size(), 1024, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+              float angle = static_cast<float>(i) * 0.001f;
+              model_matrices[i] = getTransformMatrix(
+                  glm::vec3(1.0f),
+                  glm::angleAxis(angle, glm::vec3(0.0f, 1.0f, 0.0f)),
+                  glm::vec3(angle, 0.0f, 0.0f));
+            }
+          });
+    });
+
+    printf("%zu,%zu,%.3f,%.3f\n", thread_count, job_system::getWorkerCount(),
+           sphere_ms, transforms_ms);
+  }
+
+  job_system::shutdown();
+
+  return 0;
+}
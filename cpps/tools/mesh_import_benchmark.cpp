@@ -0,0 +1,254 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures the load time and peak memory of mesh_import on large OBJ and glTF
+// files, on one thread and on every hardware thread. Without arguments it
+// writes sphere meshes of 100k and 2M triangles, split into two materials, to
+// the temporary directory. Build natively, see the README.
+//
+//   mesh_import_benchmark [file.obj|file.glb ...]
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./allocation_counter.h"
+#include "./job_system.h"
+#include "./mapped_file.h"
+#include "./mesh_import.h"
+
+double getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+double toMegabytes(size_t bytes) {
+  return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+// The first half of the triangles gets material "upper", the rest "lower"
+void writeObj(const std::string& path,
+              const GeometryComponent& geometry_component) {
+  FILE* file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    throw std::runtime_error("Failed to write " + path);
+  }
+
+  for (const auto& vertex : geometry_component.vertices) {
+    glm::vec3 normal = unpackNormal(vertex.normal);
+    glm::vec2 tex_coords = unpackTexCoords(vertex.tex_coords);
+    std::fprintf(file, "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n",
+                 vertex.position.x, vertex.position.y, vertex.position.z,
+                 tex_coords.x, tex_coords.y, normal.x, normal.y, normal.z);
+  }
+
+  const auto& indices = geometry_component.indices;
+  size_t triangle_count = indices.size() / 3;
+  for (size_t i = 0; i < triangle_count; i++) {
+    if (i == 0 || i == triangle_count / 2) {
+      std::fprintf(file, "usemtl %s\n", i == 0 ? "upper" : "lower");
+    }
+    unsigned int a = indices[i * 3] + 1;
+    unsigned int b = indices[i * 3 + 1] + 1;
+    unsigned int c = indices[i * 3 + 2] + 1;
+    std::fprintf(file, "f %u/%u/%u %u/%u/%u %u/%u/%u\n", a, a, a, b, b, b, c,
+                 c, c);
+  }
+
+  std::fclose(file);
+}
+
+// Float positions, normals and texture coordinates shared by two indexed
+// primitives, one per material
+void writeGlb(const std::string& path,
+              const GeometryComponent& geometry_component) {
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+  size_t vertex_count = vertices.size();
+  size_t upper_index_count = indices.size() / 6 * 3;
+  size_t lower_index_count = indices.size() - upper_index_count;
+
+  std::vector<char> binary;
+  auto append = [&binary](const void* data, size_t size) {
+    const auto* bytes = static_cast<const char*>(data);
+    binary.insert(binary.end(), bytes, bytes + size);
+  };
+  for (const auto& vertex : vertices) {
+    append(&vertex.position, sizeof(glm::vec3));
+  }
+  for (const auto& vertex : vertices) {
+    glm::vec3 normal = unpackNormal(vertex.normal);
+    append(&normal, sizeof(normal));
+  }
+  for (const auto& vertex : vertices) {
+    glm::vec2 tex_coords = unpackTexCoords(vertex.tex_coords);
+    append(&tex_coords, sizeof(tex_coords));
+  }
+  append(indices.data(), indices.size() * sizeof(unsigned int));
+
+  size_t normal_offset = vertex_count * 12;
+  size_t tex_coord_offset = vertex_count * 24;
+  size_t index_offset = vertex_count * 32;
+
+  char json_buffer[4096];
+  int json_length = std::snprintf(
+      json_buffer, sizeof(json_buffer),
+      R"({"asset":{"version":"2.0"},"scene":0,"scenes":[{"nodes":[0]}],)"
+      R"("nodes":[{"mesh":0}],"materials":[{"name":"upper"},)"
+      R"({"name":"lower"}],"meshes":[{"primitives":[)"
+      R"({"attributes":{"POSITION":0,"NORMAL":1,"TEXCOORD_0":2},)"
+      R"("indices":3,"material":0},)"
+      R"({"attributes":{"POSITION":0,"NORMAL":1,"TEXCOORD_0":2},)"
+      R"("indices":4,"material":1}]}],"buffers":[{"byteLength":%zu}],)"
+      R"("bufferViews":[{"buffer":0,"byteOffset":0,"byteLength":%zu},)"
+      R"({"buffer":0,"byteOffset":%zu,"byteLength":%zu},)"
+      R"({"buffer":0,"byteOffset":%zu,"byteLength":%zu},)"
+      R"({"buffer":0,"byteOffset":%zu,"byteLength":%zu}],"accessors":[)"
+      R"({"bufferView":0,"componentType":5126,"count":%zu,"type":"VEC3"},)"
+      R"({"bufferView":1,"componentType":5126,"count":%zu,"type":"VEC3"},)"
+      R"({"bufferView":2,"componentType":5126,"count":%zu,"type":"VEC2"},)"
+      R"({"bufferView":3,"componentType":5125,"count":%zu,"type":"SCALAR"},)"
+      R"({"bufferView":3,"byteOffset":%zu,"componentType":5125,"count":%zu,)"
+      R"("type":"SCALAR"}]})",
+      binary.size(), normal_offset, normal_offset, normal_offset,
+      tex_coord_offset, vertex_count * 8, index_offset, indices.size() * 4,
+      vertex_count, vertex_count, vertex_count, upper_index_count,
+      upper_index_count * 4, lower_index_count);
+
+  // Chunks are padded to 4 bytes, the JSON with spaces
+  std::string json(json_buffer, json_length);
+  json.resize((json.size() + 3) / 4 * 4, ' ');
+  binary.resize((binary.size() + 3) / 4 * 4, '\0');
+
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file) {
+    throw std::runtime_error("Failed to write " + path);
+  }
+
+  uint32_t header[] = {0x46546C67, 2,
+                       static_cast<uint32_t>(12 + 8 + json.size() + 8 +
+                                             binary.size())};
+  uint32_t json_chunk_header[] = {static_cast<uint32_t>(json.size()),
+                                  0x4E4F534A};
+  uint32_t binary_chunk_header[] = {static_cast<uint32_t>(binary.size()),
+                                    0x004E4942};
+  std::fwrite(header, sizeof(header), 1, file);
+  std::fwrite(json_chunk_header, sizeof(json_chunk_header), 1, file);
+  std::fwrite(json.data(), json.size(), 1, file);
+  std::fwrite(binary_chunk_header, sizeof(binary_chunk_header), 1, file);
+  std::fwrite(binary.data(), binary.size(), 1, file);
+  std::fclose(file);
+}
+
+void benchmarkImport(const std::string& path, const char* threads) {
+  MappedFile mapped_file(path);
+  auto bytes = mapped_file.getBytes();
+  auto format = mesh_import::getMeshFormat(path);
+
+  // Faults the mapping in, so that the first run does not also measure disk
+  // reads
+  volatile char checksum = 0;
+  for (size_t i = 0; i < bytes.size(); i += 4096) {
+    checksum = checksum + bytes[i];
+  }
+
+  // Tells the peak of the import apart from the file mapping and from
+  // earlier imports
+  size_t start_bytes = allocation_counter::getLiveBytes();
+  allocation_counter::resetPeakBytes();
+
+  auto start = std::chrono::steady_clock::now();
+  auto parts = mesh_import::importMesh(bytes, format);
+  double import_ms = getElapsedMs(start);
+
+  size_t vertex_count = 0;
+  size_t triangle_count = 0;
+  size_t result_bytes = 0;
+  for (const auto& part : parts) {
+    vertex_count += part.geometry_component.vertices.size();
+    triangle_count += part.geometry_component.indices.size() / 3;
+    result_bytes +=
+        part.geometry_component.vertices.size() * sizeof(Vertex) +
+        part.geometry_component.indices.size() * sizeof(unsigned int);
+  }
+
+  std::printf("%s,%s,%.1f,%zu,%zu,%zu,%.1f,%.0f,%.1f,%.1f\n",
+              std::filesystem::path(path).filename().c_str(), threads,
+              toMegabytes(bytes.size()), parts.size(), vertex_count,
+              triangle_count, import_ms,
+              toMegabytes(bytes.size()) / (import_ms / 1000.0),
+              toMegabytes(allocation_counter::getPeakBytes() - start_bytes),
+              toMegabytes(result_bytes));
+}
+
+int main(int argc, char** argv) {
+  std::vector<std::string> paths(argv + 1, argv + argc);
+
+  if (paths.empty()) {
+    auto directory = std::filesystem::temp_directory_path();
+
+    // Spheres have two triangles per segment, the poles aside
+    for (auto [width_segments, height_segments] :
+         {std::pair(316, 158), std::pair(1448, 724)}) {
+      GeometryComponent geometry_component(GeometryPreset::SPHERE,
+                                           width_segments, height_segments);
+      auto name = "sphere_" +
+                  std::to_string(geometry_component.indices.size() / 3000) +
+                  "k";
+
+      paths.push_back(directory / (name + ".obj"));
+      writeObj(paths.back(), geometry_component);
+      paths.push_back(directory / (name + ".glb"));
+      writeGlb(paths.back(), geometry_component);
+    }
+  }
+
+  std::printf("file,threads,file_mb,parts,vertices,triangles,import_ms,"
+              "mb_per_sec,peak_heap_mb,result_mb\n");
+
+  for (const auto& path : paths) {
+    benchmarkImport(path, "1");
+  }
+
+  job_system::init(std::thread::hardware_concurrency());
+  auto threads = std::to_string(job_system::getWorkerCount() + 1);
+  for (const auto& path : paths) {
+    benchmarkImport(path, threads.c_str());
+  }
+  job_system::shutdown();
+
+  // Includes the mapped pages of the files, which the kernel can drop
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  std::printf("max resident set: %.1f MB\n", usage.ru_maxrss / 1024.0);
+
+  return 0;
+}
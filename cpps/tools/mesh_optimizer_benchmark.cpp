@@ -0,0 +1,240 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures mesh_optimizer on the presets, on a sphere folded by bumps that
+// occlude each other, and on OBJ or glTF files: the vertex cache miss ratio
+// (ACMR), the vertices fetched, the overdraw and the time taken. Overdraw is
+// the fragments that pass the depth test per covered pixel, rasterized on the
+// CPU from 14 directions around the mesh with depth test and no culling, like
+// the render pass. Build natively, see the README.
+//
+//   mesh_optimizer_benchmark [file.obj|file.glb ...]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./job_system.h"
+#include "./mapped_file.h"
+#include "./math_util.h"
+#include "./mesh_import.h"
+#include "./mesh_optimizer.h"
+
+const int overdraw_resolution = 256;
+
+double getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// The sphere preset with its radius modulated along both angles, and normals
+// recomputed from the triangles
+GeometryComponent generateBumpySphere(int segments) {
+  GeometryComponent geometry_component(GeometryPreset::SPHERE, segments,
+                                       segments / 2);
+  auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+
+  for (auto& vertex : vertices) {
+    glm::vec3 direction = glm::normalize(vertex.position);
+    float azimuth = std::atan2(direction.z, direction.x);
+    float polar = std::acos(glm::clamp(direction.y, -1.0f, 1.0f));
+    float bump = std::sin(8.0f * azimuth) * std::sin(8.0f * polar);
+    vertex.position = direction * 0.5f * (1.0f + 0.4f * bump);
+  }
+
+  std::vector<glm::vec3> normals(vertices.size(), glm::vec3(0.0f));
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    glm::vec3 face_normal = glm::cross(
+        vertices[indices[i + 1]].position - vertices[indices[i]].position,
+        vertices[indices[i + 2]].position - vertices[indices[i]].position);
+    for (size_t corner = 0; corner < 3; corner++) {
+      normals[indices[i + corner]] += face_normal;
+    }
+  }
+  for (size_t i = 0; i < vertices.size(); i++) {
+    float length = glm::length(normals[i]);
+    if (length > 0.0f) {
+      vertices[i].normal = packNormal(normals[i] / length);
+    }
+  }
+
+  return geometry_component;
+}
+
+// Fragments passing a less-than depth test per covered pixel, averaged over
+// orthographic views along the 6 axes and the 8 diagonals
+float measureOverdraw(const GeometryComponent& geometry_component) {
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+  auto bounds = getBoundingSphere(geometry_component);
+  if (bounds.radius <= 0.0f) {
+    return 0.0f;
+  }
+
+  std::vector<glm::vec3> directions;
+  for (int axis = 0; axis < 3; axis++) {
+    for (float sign : {-1.0f, 1.0f}) {
+      glm::vec3 direction(0.0f);
+      direction[axis] = sign;
+      directions.push_back(direction);
+    }
+  }
+  for (float x : {-1.0f, 1.0f}) {
+    for (float y : {-1.0f, 1.0f}) {
+      for (float z : {-1.0f, 1.0f}) {
+        directions.push_back(glm::normalize(glm::vec3(x, y, z)));
+      }
+    }
+  }
+
+  const int size = overdraw_resolution;
+  std::vector<float> depths(size * size);
+  std::vector<glm::vec3> projected(vertices.size());
+  size_t shaded_count = 0;
+  size_t covered_count = 0;
+
+  for (const auto& direction : directions) {
+    glm::vec3 up = std::abs(direction.y) < 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f)
+                                                : glm::vec3(1.0f, 0.0f, 0.0f);
+    glm::vec3 right = glm::normalize(glm::cross(up, direction));
+    up = glm::cross(direction, right);
+
+    // Pixels over x and y, depth increasing along the view direction
+    float scale = size / (2.0f * bounds.radius);
+    for (size_t i = 0; i < vertices.size(); i++) {
+      glm::vec3 offset = vertices[i].position - bounds.center;
+      projected[i] =
+          glm::vec3((glm::dot(offset, right) + bounds.radius) * scale,
+                    (glm::dot(offset, up) + bounds.radius) * scale,
+                    glm::dot(offset, direction));
+    }
+    std::fill(depths.begin(), depths.end(),
+              std::numeric_limits<float>::infinity());
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+      glm::vec3 a = projected[indices[i]];
+      glm::vec3 b = projected[indices[i + 1]];
+      glm::vec3 c = projected[indices[i + 2]];
+      float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+      if (area == 0.0f) {
+        continue;
+      }
+
+      int min_x = std::max(0, static_cast<int>(std::floor(
+                                  std::min({a.x, b.x, c.x}) - 0.5f)));
+      int max_x = std::min(size - 1, static_cast<int>(std::ceil(
+                                         std::max({a.x, b.x, c.x}) - 0.5f)));
+      int min_y = std::max(0, static_cast<int>(std::floor(
+                                  std::min({a.y, b.y, c.y}) - 0.5f)));
+      int max_y = std::min(size - 1, static_cast<int>(std::ceil(
+                                         std::max({a.y, b.y, c.y}) - 0.5f)));
+
+      for (int y = min_y; y <= max_y; y++) {
+        for (int x = min_x; x <= max_x; x++) {
+          glm::vec2 p(x + 0.5f, y + 0.5f);
+          float wa = ((b.x - p.x) * (c.y - p.y) - (b.y - p.y) * (c.x - p.x)) /
+                     area;
+          float wb = ((c.x - p.x) * (a.y - p.y) - (c.y - p.y) * (a.x - p.x)) /
+                     area;
+          float wc = 1.0f - wa - wb;
+          if (wa < 0.0f || wb < 0.0f || wc < 0.0f) {
+            continue;
+          }
+
+          float depth = wa * a.z + wb * b.z + wc * c.z;
+          float& stored_depth = depths[y * size + x];
+          if (depth < stored_depth) {
+            stored_depth = depth;
+            shaded_count++;
+          }
+        }
+      }
+    }
+
+    for (float depth : depths) {
+      covered_count += depth != std::numeric_limits<float>::infinity();
+    }
+  }
+
+  return covered_count > 0
+             ? static_cast<float>(shaded_count) / covered_count
+             : 0.0f;
+}
+
+void benchmarkOptimize(const std::string& name,
+                       GeometryComponent geometry_component) {
+  float overdraw_before = measureOverdraw(geometry_component);
+
+  auto start = std::chrono::steady_clock::now();
+  auto stats = mesh_optimizer::optimizeMesh(geometry_component);
+  double optimize_ms = getElapsedMs(start);
+
+  float overdraw_after = measureOverdraw(geometry_component);
+
+  std::printf("%s,%zu,%zu,%zu,%.3f,%.3f,%.3f,%.3f,%.1f\n", name.c_str(),
+              geometry_component.indices.size() / 3,
+              stats.vertex_count_before, stats.vertex_count_after,
+              stats.acmr_before, stats.acmr_after, overdraw_before,
+              overdraw_after, optimize_ms);
+}
+
+int main(int argc, char** argv) {
+  job_system::init(0);
+
+  std::printf("mesh,triangles,vertices_before,vertices_after,acmr_before,"
+              "acmr_after,overdraw_before,overdraw_after,optimize_ms\n");
+
+  if (argc == 1) {
+    benchmarkOptimize("plane_256", GeometryComponent(GeometryPreset::PLANE,
+                                                     256, 256));
+    for (int segments : {128, 512, 1024}) {
+      benchmarkOptimize(
+          "sphere_" + std::to_string(segments),
+          GeometryComponent(GeometryPreset::SPHERE, segments, segments / 2));
+    }
+    benchmarkOptimize("bumpy_sphere_512", generateBumpySphere(512));
+  }
+
+  for (int i = 1; i < argc; i++) {
+    MappedFile mapped_file(argv[i]);
+    auto parts = mesh_import::importMesh(mapped_file.getBytes(),
+                                         mesh_import::getMeshFormat(argv[i]));
+    auto file_name = std::filesystem::path(argv[i]).filename().string();
+    for (auto& part : parts) {
+      benchmarkOptimize(file_name + ":" + part.material_name,
+                        std::move(part.geometry_component));
+    }
+  }
+
+  job_system::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,201 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures how many triangles the brush passes draw once meshlets outside of
+// the brush cone, or facing away from it, are skipped, for spheres of 16k to
+// 1M triangles optimized like on load, and brushes at several distances.
+// Also checks against testing every vertex that no meshlet the brush can
+// paint is skipped. Build natively, see the README.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./MeshletSet.h"
+#include "./job_system.h"
+#include "./math_util.h"
+#include "./mesh_optimizer.h"
+
+const size_t pose_count = 200;
+const size_t checked_pose_count = 20;
+const float nozzle_fov = glm::radians(45.0f);
+
+struct BrushPose {
+  glm::vec3 position;
+  glm::vec3 direction;
+};
+
+double getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// Brushes at `distance` from the center of the sphere, which has a radius of
+// 0.5, aimed at points of its surface
+std::vector<BrushPose> generatePoses(size_t count, float distance) {
+  std::mt19937 random_engine(7);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+  auto random_direction = [&] {
+    glm::vec3 direction;
+    do {
+      direction = glm::vec3(distribution(random_engine),
+                            distribution(random_engine),
+                            distribution(random_engine));
+    } while (glm::length(direction) > 1.0f || glm::length(direction) < 0.01f);
+    return glm::normalize(direction);
+  };
+
+  std::vector<BrushPose> poses;
+  poses.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    glm::vec3 position = random_direction() * distance;
+    glm::vec3 target = glm::normalize(position + random_direction() * 0.2f) *
+                       0.5f;
+    poses.push_back({position, glm::normalize(target - position)});
+  }
+
+  return poses;
+}
+
+bool isInRanges(const MeshletRanges& ranges, size_t index) {
+  for (const auto& range : ranges.get()) {
+    if (index >= range.first_index &&
+        index < range.first_index + range.index_count) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Triangles with a vertex in the cone whose meshlets were skipped, while the
+// triangle plane or a vertex normal faces the brush
+size_t countMisses(const GeometryComponent& geometry_component,
+                   const BrushPose& pose, float half_angle,
+                   const MeshletRanges& depth_ranges,
+                   const MeshletRanges& decal_ranges) {
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+
+  size_t miss_count = 0;
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    const auto& a = vertices[indices[i]];
+    const auto& b = vertices[indices[i + 1]];
+    const auto& c = vertices[indices[i + 2]];
+    // The sphere has counterclockwise triangles
+    glm::vec3 face_normal =
+        glm::cross(b.position - a.position, c.position - a.position);
+
+    bool is_plane_facing = false;
+    bool is_normal_facing = false;
+    for (const auto* vertex : {&a, &b, &c}) {
+      glm::vec3 offset = vertex->position - pose.position;
+      if (glm::dot(glm::normalize(offset), pose.direction) >=
+          std::cos(half_angle)) {
+        is_plane_facing |= glm::dot(face_normal, offset) < 0.0f;
+        is_normal_facing |=
+            glm::dot(unpackNormal(vertex->normal), offset) < 0.0f;
+      }
+    }
+
+    if ((is_plane_facing && !isInRanges(depth_ranges, i)) ||
+        (is_normal_facing && !isInRanges(decal_ranges, i))) {
+      miss_count++;
+    }
+  }
+
+  return miss_count;
+}
+
+int main() {
+  job_system::init(0);
+
+  float half_angle = nozzle_fov / 2.0f;
+
+  printf("triangles,meshlets,build_ms,brush_distance,depth_triangles,"
+         "decal_triangles,draw_calls,select_us,misses\n");
+
+  for (int segments : {128, 512, 1024}) {
+    GeometryComponent geometry_component(GeometryPreset::SPHERE, segments,
+                                         segments / 2);
+    size_t triangle_count = geometry_component.indices.size() / 3;
+
+    auto build_start = std::chrono::steady_clock::now();
+    mesh_optimizer::optimizeMesh(geometry_component);
+    MeshletSet meshlet_set(geometry_component);
+    double build_ms = getElapsedMs(build_start);
+
+    for (float distance : {0.75f, 1.5f, 3.0f}) {
+      auto poses = generatePoses(pose_count, distance);
+
+      size_t depth_index_count = 0;
+      size_t decal_index_count = 0;
+      size_t draw_call_count = 0;
+      size_t miss_count = 0;
+      double select_ms = 0.0;
+
+      for (size_t i = 0; i < poses.size(); i++) {
+        MeshletRanges depth_ranges;
+        MeshletRanges decal_ranges;
+        UvRects decal_uv_rects;
+
+        auto select_start = std::chrono::steady_clock::now();
+        meshlet_set.selectInCone(geometry_component, glm::mat4(1.0f),
+                                 poses[i].position, poses[i].direction,
+                                 half_angle, depth_ranges, decal_ranges,
+                                 decal_uv_rects);
+        select_ms += getElapsedMs(select_start);
+
+        for (const auto& range : depth_ranges.get()) {
+          depth_index_count += range.index_count;
+        }
+        for (const auto& range : decal_ranges.get()) {
+          decal_index_count += range.index_count;
+        }
+        draw_call_count += depth_ranges.get().size() +
+                           decal_ranges.get().size();
+
+        if (i < checked_pose_count) {
+          miss_count += countMisses(geometry_component, poses[i],
+                                    half_angle, depth_ranges, decal_ranges);
+        }
+      }
+
+      printf("%zu,%zu,%.1f,%.2f,%.1f%%,%.1f%%,%.1f,%.1f,%zu\n",
+             triangle_count, meshlet_set.getMeshlets().size(), build_ms,
+             distance,
+             100.0 * depth_index_count / (3.0 * triangle_count * pose_count),
+             100.0 * decal_index_count / (3.0 * triangle_count * pose_count),
+             static_cast<double>(draw_call_count) / pose_count,
+             select_ms * 1000.0 / pose_count, miss_count);
+    }
+  }
+
+  job_system::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,354 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures how many mip texels are downsampled when only the dirty UV rects
+// of each brush frame are, against regenerating the whole mip chain, for
+// brushes of several nozzle fovs on the PLANE preset and on spheres of 8k and
+// 1M triangles. Each frame paints the decal ranges the brush selects into a
+// 1024x1024 painted map, rasterized on the CPU like the GPU does in texture
+// space, then downsamples the dirty rects level by level like
+// painted_mipmap_fragment. Checks that every painted texel is inside the
+// dirty rects, and that the mips end up the same as if the whole chain was
+// regenerated. Build natively, see the README.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "./Component/GeometryComponent.h"
+#include "./MeshletSet.h"
+#include "./UvRects.h"
+#include "./job_system.h"
+#include "./mesh_optimizer.h"
+
+const int painted_map_size = 1024;
+const size_t pose_count = 100;
+const float brush_distance = 0.5f;
+
+struct BrushPose {
+  glm::vec3 position;
+  glm::vec3 direction;
+};
+
+using MipChain = std::vector<std::vector<glm::vec4>>;
+
+double getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+MipChain createMipChain() {
+  MipChain mip_chain;
+  glm::ivec2 size(painted_map_size);
+  for (int level = 0;; level++) {
+    auto level_size = getMipSize(size, level);
+    mip_chain.emplace_back(level_size.x * level_size.y, glm::vec4(0.0f));
+    if (level_size == glm::ivec2(1)) {
+      break;
+    }
+  }
+
+  return mip_chain;
+}
+
+// Brushes aimed at vertices of the geometry, tilted up to 45 degrees from
+// their normals
+std::vector<BrushPose> generatePoses(
+    const GeometryComponent& geometry_component) {
+  std::mt19937 random_engine(7);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  std::uniform_int_distribution<size_t> vertex_distribution(
+      0, geometry_component.vertices.size() - 1);
+
+  std::vector<BrushPose> poses;
+  poses.reserve(pose_count);
+  for (size_t i = 0; i < pose_count; i++) {
+    const auto& vertex =
+        geometry_component.vertices[vertex_distribution(random_engine)];
+    glm::vec3 tilt(distribution(random_engine), distribution(random_engine),
+                   distribution(random_engine));
+    glm::vec3 offset = glm::normalize(unpackNormal(vertex.normal) +
+                                      0.5f * tilt) *
+                       brush_distance;
+    poses.push_back({vertex.position + offset, -glm::normalize(offset)});
+  }
+
+  return poses;
+}
+
+// Blends `color` into the texels of the decal ranges inside the brush cone
+// and facing the brush, like brush_decal_fragment and paint_blend_fragment.
+// Returns the number of texels written.
+size_t paint(const GeometryComponent& geometry_component,
+             const MeshletRanges& decal_ranges, const BrushPose& pose,
+             float half_angle, const glm::vec4& color,
+             std::vector<glm::vec4>& painted_map) {
+  const auto& vertices = geometry_component.vertices;
+  const auto& indices = geometry_component.indices;
+  float cos_half_angle = std::cos(half_angle);
+
+  size_t painted_count = 0;
+  for (const auto& range : decal_ranges.get()) {
+    for (uint32_t i = range.first_index;
+         i < range.first_index + range.index_count; i += 3) {
+      const Vertex* corners[3] = {&vertices[indices[i]],
+                                  &vertices[indices[i + 1]],
+                                  &vertices[indices[i + 2]]};
+      glm::vec2 uvs[3];
+      for (int corner = 0; corner < 3; corner++) {
+        uvs[corner] = unpackTexCoords(corners[corner]->tex_coords) *
+                      static_cast<float>(painted_map_size);
+      }
+
+      float area = (uvs[1].x - uvs[0].x) * (uvs[2].y - uvs[0].y) -
+                   (uvs[1].y - uvs[0].y) * (uvs[2].x - uvs[0].x);
+      if (area == 0.0f) {
+        continue;
+      }
+
+      glm::vec2 uv_min = glm::min(uvs[0], glm::min(uvs[1], uvs[2]));
+      glm::vec2 uv_max = glm::max(uvs[0], glm::max(uvs[1], uvs[2]));
+      int min_x = std::max(0, static_cast<int>(std::floor(uv_min.x)));
+      int min_y = std::max(0, static_cast<int>(std::floor(uv_min.y)));
+      int max_x = std::min(painted_map_size - 1,
+                           static_cast<int>(std::ceil(uv_max.x)));
+      int max_y = std::min(painted_map_size - 1,
+                           static_cast<int>(std::ceil(uv_max.y)));
+
+      for (int y = min_y; y <= max_y; y++) {
+        for (int x = min_x; x <= max_x; x++) {
+          glm::vec2 texel(x + 0.5f, y + 0.5f);
+          glm::vec3 weights;
+          for (int corner = 0; corner < 3; corner++) {
+            const auto& a = uvs[(corner + 1) % 3];
+            const auto& b = uvs[(corner + 2) % 3];
+            weights[corner] = ((a.x - texel.x) * (b.y - texel.y) -
+                               (a.y - texel.y) * (b.x - texel.x)) /
+                              area;
+          }
+          if (weights.x < 0.0f || weights.y < 0.0f || weights.z < 0.0f) {
+            continue;
+          }
+
+          glm::vec3 position = weights.x * corners[0]->position +
+                               weights.y * corners[1]->position +
+                               weights.z * corners[2]->position;
+          glm::vec3 normal = weights.x * unpackNormal(corners[0]->normal) +
+                             weights.y * unpackNormal(corners[1]->normal) +
+                             weights.z * unpackNormal(corners[2]->normal);
+          glm::vec3 offset = position - pose.position;
+          if (glm::dot(glm::normalize(offset), pose.direction) <
+                  cos_half_angle ||
+              glm::dot(normal, offset) >= 0.0f) {
+            continue;
+          }
+
+          auto& painted_texel = painted_map[y * painted_map_size + x];
+          painted_texel = glm::mix(painted_texel, color, 0.5f);
+          painted_count++;
+        }
+      }
+    }
+  }
+
+  return painted_count;
+}
+
+// Downsamples `rect` of mip `level - 1` into mip `level`, like
+// painted_mipmap_fragment. Returns the number of texels written.
+size_t downsample(MipChain& mip_chain, int level, const TexelRect& rect) {
+  glm::ivec2 size(painted_map_size);
+  glm::ivec2 source_size = getMipSize(size, level - 1);
+  glm::ivec2 target_size = getMipSize(size, level);
+  const auto& source = mip_chain[level - 1];
+  auto& target = mip_chain[level];
+
+  for (int y = rect.min.y; y < rect.max.y; y++) {
+    for (int x = rect.min.x; x < rect.max.x; x++) {
+      glm::vec4 sum(0.0f);
+      for (int i = 0; i < 4; i++) {
+        glm::ivec2 texel = glm::min(
+            glm::ivec2(x * 2 + (i & 1), y * 2 + (i >> 1)), source_size - 1);
+        const auto& color = source[texel.y * source_size.x + texel.x];
+        sum += glm::vec4(glm::vec3(color) * color.a, color.a);
+      }
+      target[y * target_size.x + x] = glm::vec4(
+          sum.a > 0.0f ? glm::vec3(sum) / sum.a : glm::vec3(0.0f),
+          sum.a * 0.25f);
+    }
+  }
+
+  return static_cast<size_t>(std::max(rect.getArea(), 0));
+}
+
+size_t downsampleDirty(MipChain& mip_chain, const UvRects& dirty_uv_rects) {
+  glm::ivec2 size(painted_map_size);
+  size_t texel_count = 0;
+  for (int level = 1; level < static_cast<int>(mip_chain.size()); level++) {
+    TexelRects texel_rects;
+    size_t texel_rect_count =
+        getDirtyTexelRects(dirty_uv_rects, size, level, texel_rects);
+    for (size_t i = 0; i < texel_rect_count; i++) {
+      texel_count += downsample(mip_chain, level, texel_rects[i]);
+    }
+  }
+  return texel_count;
+}
+
+size_t downsampleAll(MipChain& mip_chain) {
+  glm::ivec2 size(painted_map_size);
+  size_t texel_count = 0;
+  for (int level = 1; level < static_cast<int>(mip_chain.size()); level++) {
+    texel_count += downsample(mip_chain, level,
+                              {glm::ivec2(0), getMipSize(size, level)});
+  }
+  return texel_count;
+}
+
+// Painted texels outside every dirty texel rect of the first level
+size_t countMisses(const std::vector<glm::vec4>& painted_map,
+                   const std::vector<glm::vec4>& prev_painted_map,
+                   const UvRects& dirty_uv_rects) {
+  glm::ivec2 size(painted_map_size);
+  size_t miss_count = 0;
+  for (int y = 0; y < painted_map_size; y++) {
+    for (int x = 0; x < painted_map_size; x++) {
+      size_t i = y * painted_map_size + x;
+      if (painted_map[i] == prev_painted_map[i]) {
+        continue;
+      }
+
+      bool is_dirty = false;
+      for (const auto& uv_rect : dirty_uv_rects.get()) {
+        auto rect = getTexelRect(uv_rect, size, 0);
+        is_dirty |= x >= rect.min.x && x < rect.max.x && y >= rect.min.y &&
+                    y < rect.max.y;
+      }
+      miss_count += !is_dirty;
+    }
+  }
+  return miss_count;
+}
+
+int main() {
+  job_system::init(0);
+
+  struct GeometryCase {
+    const char* name;
+    GeometryPreset preset;
+    int segments;
+  };
+  const std::vector<GeometryCase> geometry_cases = {
+      {"plane", GeometryPreset::PLANE, 1},
+      {"sphere_8k", GeometryPreset::SPHERE, 64},
+      {"sphere_1m", GeometryPreset::SPHERE, 1024},
+  };
+
+  printf("geometry,nozzle_fov,painted_texels,dirty_rects,mip_texels,"
+         "mip_texels_per_painted,full_mip_texels,dirty_ms,full_ms,misses,"
+         "mip_max_diff\n");
+
+  for (const auto& geometry_case : geometry_cases) {
+    GeometryComponent geometry_component(
+        geometry_case.preset, geometry_case.segments,
+        std::max(1, geometry_case.segments / 2));
+    mesh_optimizer::optimizeMesh(geometry_component);
+    MeshletSet meshlet_set(geometry_component);
+    auto poses = generatePoses(geometry_component);
+
+    for (float nozzle_fov_degrees : {15.0f, 45.0f, 90.0f}) {
+      float half_angle = glm::radians(nozzle_fov_degrees) / 2.0f;
+      std::mt19937 random_engine(11);
+      std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+
+      auto mip_chain = createMipChain();
+      size_t painted_count = 0;
+      size_t dirty_rect_count = 0;
+      size_t mip_texel_count = 0;
+      size_t miss_count = 0;
+      double dirty_ms = 0.0;
+
+      for (const auto& pose : poses) {
+        MeshletRanges depth_ranges;
+        MeshletRanges decal_ranges;
+        UvRects decal_uv_rects;
+        meshlet_set.selectInCone(geometry_component, glm::mat4(1.0f),
+                                 pose.position, pose.direction, half_angle,
+                                 depth_ranges, decal_ranges, decal_uv_rects);
+
+        auto prev_painted_map = mip_chain[0];
+        glm::vec4 color(distribution(random_engine),
+                        distribution(random_engine),
+                        distribution(random_engine), 1.0f);
+        painted_count += paint(geometry_component, decal_ranges, pose,
+                               half_angle, color, mip_chain[0]);
+        miss_count +=
+            countMisses(mip_chain[0], prev_painted_map, decal_uv_rects);
+        dirty_rect_count += decal_uv_rects.get().size();
+
+        auto dirty_start = std::chrono::steady_clock::now();
+        mip_texel_count += downsampleDirty(mip_chain, decal_uv_rects);
+        dirty_ms += getElapsedMs(dirty_start);
+      }
+
+      // Regenerating the whole chain must not change the mips updated in
+      // place
+      auto full_mip_chain = mip_chain;
+      auto full_start = std::chrono::steady_clock::now();
+      size_t full_mip_texel_count = downsampleAll(full_mip_chain);
+      double full_ms = getElapsedMs(full_start);
+
+      float mip_max_diff = 0.0f;
+      for (size_t level = 1; level < mip_chain.size(); level++) {
+        for (size_t i = 0; i < mip_chain[level].size(); i++) {
+          glm::vec4 diff =
+              glm::abs(mip_chain[level][i] - full_mip_chain[level][i]);
+          mip_max_diff = std::max(
+              mip_max_diff,
+              std::max(std::max(diff.x, diff.y), std::max(diff.z, diff.w)));
+        }
+      }
+
+      printf("%s,%.0f,%.0f,%.1f,%.0f,%.2f,%zu,%.3f,%.3f,%zu,%g\n",
+             geometry_case.name, nozzle_fov_degrees,
+             static_cast<double>(painted_count) / pose_count,
+             static_cast<double>(dirty_rect_count) / pose_count,
+             static_cast<double>(mip_texel_count) / pose_count,
+             painted_count > 0
+                 ? static_cast<double>(mip_texel_count) / painted_count
+                 : 0.0,
+             full_mip_texel_count, dirty_ms / pose_count, full_ms, miss_count,
+             mip_max_diff);
+    }
+  }
+
+  job_system::shutdown();
+
+  return 0;
+}
@@ -0,0 +1,219 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 Seongho Park
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Compares the batch ray kernels against the scalar tests in math_util, for
+// both results and throughput. Build natively, see the README.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "./math_util.h"
+#include "./ray_kernels.h"
+
+const size_t ray_count = 4096;
+const size_t block_count = 1024;
+const int repeat_count = 8;
+
+struct Ray {
+  glm::vec3 origin;
+  glm::vec3 direction;
+  glm::vec3 inverse_direction;
+};
+
+struct Triangle {
+  glm::vec3 v0;
+  glm::vec3 v1;
+  glm::vec3 v2;
+};
+
+struct Box {
+  glm::vec3 min;
+  glm::vec3 max;
+};
+
+double getElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main() {
+  std::mt19937 random_engine(7);
+  std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+  auto random_vec3 = [&](float scale) {
+    return glm::vec3(distribution(random_engine), distribution(random_engine),
+                     distribution(random_engine)) *
+           scale;
+  };
+
+  // Rays from around the unit cube towards its inside, and triangles and
+  // boxes scattered inside it, so that a few of the tests hit as in a BVH
+  std::vector<Ray> rays(ray_count);
+  for (auto& ray : rays) {
+    ray.origin = glm::normalize(random_vec3(1.0f)) * 3.0f;
+    ray.direction = glm::normalize(random_vec3(0.5f) - ray.origin);
+    ray.inverse_direction = 1.0f / ray.direction;
+  }
+
+  std::vector<Triangle> triangles(block_count * ray_kernels::LANE_COUNT);
+  std::vector<Box> boxes(block_count * ray_kernels::LANE_COUNT);
+  for (auto& triangle : triangles) {
+    glm::vec3 center = random_vec3(1.0f);
+    triangle = {center + random_vec3(0.5f), center + random_vec3(0.5f),
+                center + random_vec3(0.5f)};
+  }
+  for (auto& box : boxes) {
+    glm::vec3 center = random_vec3(1.0f);
+    glm::vec3 extent = glm::abs(random_vec3(0.3f));
+    box = {center - extent, center + extent};
+  }
+
+  std::vector<ray_kernels::TriangleBlock> triangle_blocks(block_count);
+  std::vector<ray_kernels::BoxBlock> box_blocks(block_count);
+  for (size_t i = 0; i < triangles.size(); i++) {
+    auto& block = triangle_blocks[i / ray_kernels::LANE_COUNT];
+    size_t lane = i % ray_kernels::LANE_COUNT;
+    glm::vec3 edge1 = triangles[i].v1 - triangles[i].v0;
+    glm::vec3 edge2 = triangles[i].v2 - triangles[i].v0;
+    block.v0_x[lane] = triangles[i].v0.x;
+    block.v0_y[lane] = triangles[i].v0.y;
+    block.v0_z[lane] = triangles[i].v0.z;
+    block.edge1_x[lane] = edge1.x;
+    block.edge1_y[lane] = edge1.y;
+    block.edge1_z[lane] = edge1.z;
+    block.edge2_x[lane] = edge2.x;
+    block.edge2_y[lane] = edge2.y;
+    block.edge2_z[lane] = edge2.z;
+  }
+  for (size_t i = 0; i < boxes.size(); i++) {
+    auto& block = box_blocks[i / ray_kernels::LANE_COUNT];
+    size_t lane = i % ray_kernels::LANE_COUNT;
+    block.min_x[lane] = boxes[i].min.x;
+    block.min_y[lane] = boxes[i].min.y;
+    block.min_z[lane] = boxes[i].min.z;
+    block.max_x[lane] = boxes[i].max.x;
+    block.max_y[lane] = boxes[i].max.y;
+    block.max_z[lane] = boxes[i].max.z;
+  }
+
+  const float max_distance = std::numeric_limits<float>::max();
+  const double test_count = static_cast<double>(ray_count) *
+                            triangles.size() * repeat_count;
+
+  printf("backend: %s\n", ray_kernels::BACKEND_NAME);
+  printf("test,hit_rate,scalar_tests_per_sec,kernel_tests_per_sec,speedup,"
+         "mismatches\n");
+
+  // Nearest triangle of each block, one triangle at a time
+  size_t scalar_hit_count = 0;
+  std::vector<int> scalar_lanes(ray_count * block_count);
+  auto scalar_start = std::chrono::steady_clock::now();
+  for (int repeat = 0; repeat < repeat_count; repeat++) {
+    for (size_t r = 0; r < ray_count; r++) {
+      const auto& ray = rays[r];
+      for (size_t b = 0; b < block_count; b++) {
+        int nearest_lane = -1;
+        float nearest_distance = max_distance;
+        for (int lane = 0; lane < ray_kernels::LANE_COUNT; lane++) {
+          const auto& triangle = triangles[b * ray_kernels::LANE_COUNT + lane];
+          auto result = getRayIntersectionDistance(
+              ray.origin, ray.direction, triangle.v0, triangle.v1,
+              triangle.v2);
+          if (result.has_value() && result->distance < nearest_distance) {
+            nearest_lane = lane;
+            nearest_distance = result->distance;
+          }
+          scalar_hit_count += result.has_value();
+        }
+        scalar_lanes[r * block_count + b] = nearest_lane;
+      }
+    }
+  }
+  double scalar_ms = getElapsedMs(scalar_start);
+
+  size_t mismatch_count = 0;
+  auto kernel_start = std::chrono::steady_clock::now();
+  for (int repeat = 0; repeat < repeat_count; repeat++) {
+    for (size_t r = 0; r < ray_count; r++) {
+      const auto& ray = rays[r];
+      for (size_t b = 0; b < block_count; b++) {
+        auto hit = ray_kernels::intersectRayTriangleBlock(
+            ray.origin, ray.direction, triangle_blocks[b], max_distance);
+        mismatch_count += hit.lane != scalar_lanes[r * block_count + b];
+      }
+    }
+  }
+  double kernel_ms = getElapsedMs(kernel_start);
+
+  printf("triangle,%.2f,%.0f,%.0f,%.2f,%zu\n", scalar_hit_count / test_count,
+         test_count / (scalar_ms / 1000.0), test_count / (kernel_ms / 1000.0),
+         scalar_ms / kernel_ms, mismatch_count);
+
+  // Entry distance of every box
+  size_t box_hit_count = 0;
+  std::vector<float> scalar_distances(ray_count * boxes.size());
+  scalar_start = std::chrono::steady_clock::now();
+  for (int repeat = 0; repeat < repeat_count; repeat++) {
+    for (size_t r = 0; r < ray_count; r++) {
+      const auto& ray = rays[r];
+      for (size_t i = 0; i < boxes.size(); i++) {
+        auto distance =
+            getRayBoxDistance(ray.origin, ray.inverse_direction, boxes[i].min,
+                              boxes[i].max, max_distance);
+        scalar_distances[r * boxes.size() + i] = distance.value_or(-1.0f);
+        box_hit_count += distance.has_value();
+      }
+    }
+  }
+  scalar_ms = getElapsedMs(scalar_start);
+
+  mismatch_count = 0;
+  kernel_start = std::chrono::steady_clock::now();
+  for (int repeat = 0; repeat < repeat_count; repeat++) {
+    for (size_t r = 0; r < ray_count; r++) {
+      const auto& ray = rays[r];
+      for (size_t b = 0; b < block_count; b++) {
+        alignas(16) float distances[ray_kernels::LANE_COUNT];
+        int hit_bits = ray_kernels::intersectRayBoxBlock(
+            ray.origin, ray.inverse_direction, box_blocks[b], max_distance,
+            distances);
+        for (int lane = 0; lane < ray_kernels::LANE_COUNT; lane++) {
+          float distance = hit_bits >> lane & 1 ? distances[lane] : -1.0f;
+          mismatch_count +=
+              distance != scalar_distances[r * boxes.size() +
+                                           b * ray_kernels::LANE_COUNT + lane];
+        }
+      }
+    }
+  }
+  kernel_ms = getElapsedMs(kernel_start);
+
+  printf("box,%.2f,%.0f,%.0f,%.2f,%zu\n", box_hit_count / test_count,
+         test_count / (scalar_ms / 1000.0), test_count / (kernel_ms / 1000.0),
+         scalar_ms / kernel_ms, mismatch_count);
+
+  return 0;
+}
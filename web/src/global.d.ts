@@ -2,6 +2,10 @@ import {
   ClientEventComponent,
   ClientInputComponent,
   ClientStateComponent,
+  GeometryCacheStats,
+  GrMemoryBudgetPolicy,
+  GrMemoryStats,
+  PointerHit,
 } from "./types";
 
 // Declare the global window object extension
@@ -12,6 +16,15 @@ declare global {
     clientEventComponent: ClientEventComponent;
   }
 
+  // Functions exported from the WASM module with embind
+  declare const Module: {
+    getGrMemoryStats: () => GrMemoryStats;
+    setGrMemoryBudget: (bytes: number, policy: GrMemoryBudgetPolicy) => void;
+    resetGrMemoryPeak: () => void;
+    getGeometryCacheStats: () => GeometryCacheStats;
+    getPointerHit: () => PointerHit | null;
+  };
+
   declare const __APP_VERSION__: string;
 }
 
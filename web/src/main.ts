@@ -10,6 +10,7 @@ import { initControlsPane } from "./scripts/init-controls-pane";
 import { initVersionText } from "./scripts/init-version-text";
 import { initMobilePopup } from "./scripts/init-mobile-popup";
 import { initInitialInfoPopup } from "./scripts/init-initial-info-popup";
+import { loadWasmModule } from "./scripts/load-wasm-module";
 
 const clientInputComponent: ClientInputComponent = {
   pressedKeyMap: {
@@ -38,6 +39,12 @@ const clientEventComponent: ClientEventComponent = {
   changeModel: undefined,
   resetPaint: undefined,
   resetPosition: undefined,
+  // Open the page with `?stress` to run the stress test without any input,
+  // e.g. from a headless browser collecting the console output
+  runStressTest: new URLSearchParams(window.location.search).has("stress")
+    ? true
+    : undefined,
+  importMesh: undefined,
 };
 
 // Expose components to the global scope for WASM to access
@@ -56,3 +63,27 @@ initControlsPane();
 initVersionText();
 initMobilePopup();
 initInitialInfoPopup();
+
+// Open the page with `?pack=<url>` to start with an asset pack instead of a
+// preset
+const packUrl = new URLSearchParams(window.location.search).get("pack");
+if (packUrl) {
+  fetch(packUrl)
+    .then((response) => {
+      if (!response.ok) {
+        throw new Error(`${response.status} ${response.statusText}`);
+      }
+      return response.arrayBuffer();
+    })
+    .then((buffer) => {
+      clientEventComponent.importMesh = {
+        // The extension tells the WASM module how to read the bytes
+        fileName: new URL(packUrl, window.location.href).pathname,
+        bytes: new Uint8Array(buffer),
+      };
+    })
+    .catch((error) => console.error(`[import] ${packUrl} failed:`, error));
+}
+
+// Loaded last, once the components above are exposed
+loadWasmModule();
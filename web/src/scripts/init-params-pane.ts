@@ -82,4 +82,40 @@ export const initParamsPane = (
   resetPositionButton.on("click", () => {
     clientEventComponent.resetPosition = true;
   });
+
+  const runStressTestButton = actionsFolder.addButton({
+    title: "Run Stress Test",
+  });
+
+  runStressTestButton.on("click", () => {
+    clientEventComponent.runStressTest = true;
+  });
+
+  // OBJ and binary glTF files are parsed by the WASM module, which replaces
+  // the model with one part per material. Asset packs (.snpk) are read in
+  // place.
+  const importMeshInput = document.createElement("input");
+  importMeshInput.type = "file";
+  importMeshInput.accept = ".obj,.glb,.snpk";
+
+  importMeshInput.addEventListener("change", async () => {
+    const file = importMeshInput.files?.[0];
+    importMeshInput.value = "";
+    if (!file) {
+      return;
+    }
+
+    clientEventComponent.importMesh = {
+      fileName: file.name,
+      bytes: new Uint8Array(await file.arrayBuffer()),
+    };
+  });
+
+  const importMeshButton = actionsFolder.addButton({
+    title: "Import Mesh",
+  });
+
+  importMeshButton.on("click", () => {
+    importMeshInput.click();
+  });
 };
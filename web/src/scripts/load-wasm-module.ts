@@ -0,0 +1,40 @@
+// Smallest module using a SIMD128 instruction, which only validates in
+// browsers supporting WASM SIMD
+const simdTestModule = new Uint8Array([
+  0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1,
+  8, 0, 65, 0, 253, 15, 253, 98, 11,
+]);
+
+const scalarModuleSrc = "/ProjectSienna.js";
+const simdModuleSrc = "/ProjectSienna-simd.js";
+
+const loadScript = (src: string, onError?: () => void) => {
+  const script = document.createElement("script");
+  script.type = "module";
+  script.src = src;
+  if (onError != null) {
+    script.onerror = onError;
+  }
+  document.body.appendChild(script);
+};
+
+// Loads the SIMD flavor of the WASM module if the browser supports it and it
+// was built, or the scalar one. Open the page with `?scalar` to force the
+// scalar one, e.g. to compare frame times.
+export const loadWasmModule = () => {
+  const isScalarForced = new URLSearchParams(window.location.search).has(
+    "scalar"
+  );
+
+  if (isScalarForced || !WebAssembly.validate(simdTestModule)) {
+    console.log(`[wasm] loading ${scalarModuleSrc}`);
+    loadScript(scalarModuleSrc);
+    return;
+  }
+
+  console.log(`[wasm] loading ${simdModuleSrc}`);
+  loadScript(simdModuleSrc, () => {
+    console.log(`[wasm] falling back to ${scalarModuleSrc}`);
+    loadScript(scalarModuleSrc);
+  });
+};
@@ -2,6 +2,8 @@ export enum ModelOptions {
   Cube = 0,
   Plane = 1,
   Sphere = 2,
+  Stress = 3,
+  Car = 4,
 }
 
 export const modelOptionStrings = Object.keys(ModelOptions).filter((key) =>
@@ -26,6 +28,8 @@ export type ClientEventComponent = {
   changeModel: ModelOptions | undefined;
   resetPaint: boolean | undefined;
   resetPosition: boolean | undefined;
+  runStressTest: boolean | undefined;
+  importMesh: { fileName: string; bytes: Uint8Array } | undefined;
 };
 
 export type ClientStateComponent = {
@@ -37,3 +41,38 @@ export type ControlStrings = {
     [key: string]: string;
   };
 };
+
+export enum GrMemoryBudgetPolicy {
+  Log = 0,
+  Downscale = 1,
+  Refuse = 2,
+}
+
+export type GrMemoryStats = {
+  liveBytes: number;
+  peakBytes: number;
+  budgetBytes: number;
+  budgetPolicy: GrMemoryBudgetPolicy;
+  categories: {
+    [category: string]: { count: number; bytes: number };
+  };
+  owners: {
+    [owner: string]: number;
+  };
+};
+
+export type GeometryCacheStats = {
+  entryCount: number;
+  hitCount: number;
+  missCount: number;
+  gpuBytesSaved: number;
+  msAvoided: number;
+};
+
+export type PointerHit = {
+  paintableIndex: number;
+  partIndex: number;
+  distance: number;
+  barycentrics: [number, number, number];
+  uv: [number, number];
+};
@@ -1,8 +1,21 @@
 import { defineConfig } from 'vite';
 import { version } from './package.json';
 
+// SharedArrayBuffer, which WASM builds with pthreads need, is only available
+// on cross-origin isolated pages
+const crossOriginIsolationHeaders = {
+  'Cross-Origin-Opener-Policy': 'same-origin',
+  'Cross-Origin-Embedder-Policy': 'require-corp',
+};
+
 export default defineConfig({
   define: {
     __APP_VERSION__: JSON.stringify(version),
   },
+  server: {
+    headers: crossOriginIsolationHeaders,
+  },
+  preview: {
+    headers: crossOriginIsolationHeaders,
+  },
 });